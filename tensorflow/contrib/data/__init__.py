@@ -24,16 +24,22 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 
 @@Counter
 @@CheckpointInputPipelineHook
+@@ColumnarDataset
 @@CsvDataset
+@@IndexedTFRecordDataset
 @@LMDBDataset
 @@RandomDataset
 @@Reducer
+@@SharedMemoryDataset
+@@ShuffledTFRecordDataset
 @@SqlDataset
 @@TFRecordWriter
 
 @@assert_element_shape
 @@batch_and_drop_remainder
 @@bucket_by_sequence_length
+@@build_tf_record_index
+@@cache_in_memory
 @@choose_from_datasets
 @@copy_to_device
 @@dense_to_sparse_batch
@@ -57,11 +63,13 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@reduce_dataset
 @@sample_from_datasets
 @@scan
+@@serve_dataset_to_shared_memory
 @@shuffle_and_repeat
 @@sliding_window_batch
 @@sloppy_interleave
 @@unbatch
 @@unique
+@@write_columnar_file
 """
 
 from __future__ import absolute_import
@@ -76,6 +84,7 @@ from tensorflow.contrib.data.python.ops.batching import dense_to_sparse_batch
 from tensorflow.contrib.data.python.ops.batching import map_and_batch
 from tensorflow.contrib.data.python.ops.batching import padded_batch_and_drop_remainder
 from tensorflow.contrib.data.python.ops.batching import unbatch
+from tensorflow.contrib.data.python.ops.caching import cache_in_memory
 from tensorflow.contrib.data.python.ops.counter import Counter
 from tensorflow.contrib.data.python.ops.enumerate_ops import enumerate_dataset
 from tensorflow.contrib.data.python.ops.error_ops import ignore_errors
@@ -95,14 +104,21 @@ from tensorflow.contrib.data.python.ops.parsing_ops import parse_example_dataset
 from tensorflow.contrib.data.python.ops.prefetching_ops import copy_to_device
 from tensorflow.contrib.data.python.ops.prefetching_ops import prefetch_to_device
 from tensorflow.contrib.data.python.ops.random_ops import RandomDataset
+from tensorflow.contrib.data.python.ops.readers import build_tf_record_index
+from tensorflow.contrib.data.python.ops.readers import ColumnarDataset
 from tensorflow.contrib.data.python.ops.readers import CsvDataset
+from tensorflow.contrib.data.python.ops.readers import IndexedTFRecordDataset
 from tensorflow.contrib.data.python.ops.readers import LMDBDataset
 from tensorflow.contrib.data.python.ops.readers import make_batched_features_dataset
 from tensorflow.contrib.data.python.ops.readers import make_csv_dataset
 from tensorflow.contrib.data.python.ops.readers import read_batch_features
+from tensorflow.contrib.data.python.ops.readers import ShuffledTFRecordDataset
 from tensorflow.contrib.data.python.ops.readers import SqlDataset
+from tensorflow.contrib.data.python.ops.readers import write_columnar_file
 from tensorflow.contrib.data.python.ops.resampling import rejection_resample
 from tensorflow.contrib.data.python.ops.scan_ops import scan
+from tensorflow.contrib.data.python.ops.shared_memory import serve_dataset_to_shared_memory
+from tensorflow.contrib.data.python.ops.shared_memory import SharedMemoryDataset
 from tensorflow.contrib.data.python.ops.shuffle_ops import shuffle_and_repeat
 from tensorflow.contrib.data.python.ops.sliding import sliding_window_batch
 from tensorflow.contrib.data.python.ops.unique import unique
@@ -112,5 +128,8 @@ from tensorflow.contrib.data.python.ops.writers import TFRecordWriter
 from tensorflow.python.util.all_util import remove_undocumented
 remove_undocumented(__name__)
 
-# A constant that can be used to enable auto-tuning.
+# A constant that can be used to enable auto-tuning: as the `buffer_size` of
+# `prefetch()`, or the `num_parallel_calls` of `map()`, `map_and_batch()` and
+# `parse_example_dataset()`, whose values are then chosen by a model of the
+# input pipeline within the CPU and memory available.
 AUTOTUNE = -1
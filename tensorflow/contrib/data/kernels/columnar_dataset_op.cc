@@ -0,0 +1,621 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/contrib/data/kernels/columnar_file.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/casts.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/byte_order.h"
+
+namespace tensorflow {
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+// Copies the `n` little endian values of `src` to `dst`.
+template <typename T>
+void CopyValues(const char* src, int64 n, T* dst);
+
+template <>
+void CopyValues<float>(const char* src, int64 n, float* dst) {
+  if (port::kLittleEndian) {
+    memcpy(dst, src, n * sizeof(float));
+    return;
+  }
+  for (int64 i = 0; i < n; ++i) {
+    dst[i] = bit_cast<float>(core::DecodeFixed32(src + i * sizeof(float)));
+  }
+}
+
+template <>
+void CopyValues<int64>(const char* src, int64 n, int64* dst) {
+  if (port::kLittleEndian) {
+    memcpy(dst, src, n * sizeof(int64));
+    return;
+  }
+  for (int64 i = 0; i < n; ++i) {
+    dst[i] = core::DecodeFixed64(src + i * sizeof(int64));
+  }
+}
+
+class ColumnarDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ColumnarDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    std::vector<string> dense_columns;
+    DataTypeVector dense_types;
+    std::vector<PartialTensorShape> dense_shapes;
+    std::vector<string> sparse_columns;
+    DataTypeVector sparse_types;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_columns", &dense_columns));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_types", &dense_types));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dense_shapes", &dense_shapes));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_columns", &sparse_columns));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("sparse_types", &sparse_types));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES(ctx,
+                dense_columns.size() == dense_types.size() &&
+                    dense_columns.size() == dense_shapes.size(),
+                errors::InvalidArgument(
+                    "dense_columns, dense_types and dense_shapes must have "
+                    "the same length."));
+    OP_REQUIRES(ctx, sparse_columns.size() == sparse_types.size(),
+                errors::InvalidArgument(
+                    "sparse_columns and sparse_types must have the same "
+                    "length."));
+    for (int i = 0; i < dense_columns.size(); ++i) {
+      OP_REQUIRES(ctx, dense_shapes[i].IsFullyDefined(),
+                  errors::InvalidArgument("The shape of dense column ",
+                                          dense_columns[i],
+                                          " must be fully defined."));
+      TensorShape shape;
+      dense_shapes[i].AsTensorShape(&shape);
+      columns_.push_back({dense_columns[i], dense_types[i], false, shape});
+    }
+    for (int i = 0; i < sparse_columns.size(); ++i) {
+      columns_.push_back({sparse_columns[i], sparse_types[i], true, {}});
+    }
+    // The output components are sorted by column name.
+    std::sort(columns_.begin(), columns_.end(),
+              [](const Column& a, const Column& b) { return a.name < b.name; });
+    for (int i = 1; i < columns_.size(); ++i) {
+      OP_REQUIRES(ctx, columns_[i - 1].name != columns_[i].name,
+                  errors::InvalidArgument("Duplicate column ",
+                                          columns_[i].name));
+    }
+    OP_REQUIRES(ctx, columns_.size() == output_types_.size(),
+                errors::InvalidArgument(
+                    "output_types must have one type for each column."));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("Batch size must be greater than zero."));
+
+    string filter_column;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "filter_column",
+                                                    &filter_column));
+    double filter_min;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<double>(ctx, "filter_min", &filter_min));
+    double filter_max;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<double>(ctx, "filter_max", &filter_max));
+
+    *output = new Dataset(ctx, std::move(filenames), batch_size, filter_column,
+                          filter_min, filter_max, columns_, output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  struct Column {
+    string name;
+    DataType dtype;
+    bool sparse;
+    // The shape of the values of a dense column in each row.
+    TensorShape shape;
+  };
+
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            int64 batch_size, const string& filter_column, double filter_min,
+            double filter_max, const std::vector<Column>& columns,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          batch_size_(batch_size),
+          filter_column_(filter_column),
+          filter_min_(filter_min),
+          filter_max_(filter_max),
+          columns_(columns),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Columnar")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ColumnarDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* batch_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      Node* filter_column = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_column_, &filter_column));
+      Node* filter_min = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_min_, &filter_min));
+      Node* filter_max = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_max_, &filter_max));
+
+      std::vector<string> dense_columns;
+      DataTypeVector dense_types;
+      std::vector<PartialTensorShape> dense_shapes;
+      std::vector<string> sparse_columns;
+      DataTypeVector sparse_types;
+      for (const Column& column : columns_) {
+        if (column.sparse) {
+          sparse_columns.push_back(column.name);
+          sparse_types.push_back(column.dtype);
+        } else {
+          dense_columns.push_back(column.name);
+          dense_types.push_back(column.dtype);
+          dense_shapes.push_back(column.shape);
+        }
+      }
+      AttrValue dense_columns_attr;
+      AttrValue dense_types_attr;
+      AttrValue dense_shapes_attr;
+      AttrValue sparse_columns_attr;
+      AttrValue sparse_types_attr;
+      b->BuildAttrValue(dense_columns, &dense_columns_attr);
+      b->BuildAttrValue(dense_types, &dense_types_attr);
+      b->BuildAttrValue(dense_shapes, &dense_shapes_attr);
+      b->BuildAttrValue(sparse_columns, &sparse_columns_attr);
+      b->BuildAttrValue(sparse_types, &sparse_types_attr);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, batch_size, filter_column, filter_min, filter_max},
+          {{"dense_columns", dense_columns_attr},
+           {"dense_types", dense_types_attr},
+           {"dense_shapes", dense_shapes_attr},
+           {"sparse_columns", sparse_columns_attr},
+           {"sparse_types", sparse_types_attr}},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        const std::vector<Column>& columns = dataset()->columns_;
+        const int64 batch_size = dataset()->batch_size_;
+
+        // The rows of a batch may come from several row groups. The dense
+        // columns are copied straight into their batch, which is sliced if
+        // the input ends before it is full.
+        std::vector<Tensor> dense(columns.size());
+        std::vector<SparseBatch> sparse(columns.size());
+        for (int i = 0; i < columns.size(); ++i) {
+          if (columns[i].sparse) continue;
+          TensorShape shape({batch_size});
+          shape.AppendShape(columns[i].shape);
+          dense[i] = Tensor(ctx->allocator({}), columns[i].dtype, shape);
+        }
+        int64 num_rows = 0;
+        while (num_rows < batch_size) {
+          if (row_ == row_group_rows_) {
+            bool end_of_input;
+            TF_RETURN_IF_ERROR(ReadNextRowGroupLocked(ctx, &end_of_input));
+            if (end_of_input) break;
+            continue;
+          }
+          const int64 n =
+              std::min(batch_size - num_rows, row_group_rows_ - row_);
+          for (int i = 0; i < columns.size(); ++i) {
+            if (columns[i].sparse) {
+              AppendSparse(columns[i].dtype, data_[i], row_, n, num_rows,
+                           &sparse[i]);
+            } else {
+              CopyDense(columns[i].dtype, data_[i], row_, n, num_rows,
+                        &dense[i]);
+            }
+          }
+          row_ += n;
+          num_rows += n;
+        }
+        if (num_rows == 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        for (int i = 0; i < columns.size(); ++i) {
+          if (columns[i].sparse) {
+            out_tensors->push_back(
+                MakeSparse(ctx, columns[i].dtype, num_rows, &sparse[i]));
+          } else if (num_rows < batch_size) {
+            out_tensors->push_back(dense[i].Slice(0, num_rows));
+          } else {
+            out_tensors->push_back(std::move(dense[i]));
+          }
+        }
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("file_index"), file_index_));
+        if (reader_ != nullptr) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("next_row_group"),
+                                                 next_row_group_));
+          if (row_ < row_group_rows_) {
+            TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("row_group"),
+                                                   next_row_group_ - 1));
+            TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("row"), row_));
+          }
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        reader_.reset();
+        data_.clear();
+        row_group_rows_ = 0;
+        row_ = 0;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("file_index"), &file_index_));
+        if (file_index_ < 0 || file_index_ > dataset()->filenames_.size()) {
+          return errors::InvalidArgument("Invalid file index ", file_index_);
+        }
+        if (reader->Contains(full_name("next_row_group"))) {
+          if (file_index_ == dataset()->filenames_.size()) {
+            return errors::InvalidArgument("Invalid file index ", file_index_);
+          }
+          TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("next_row_group"),
+                                                &next_row_group_));
+          if (next_row_group_ < 0 ||
+              next_row_group_ > reader_->row_groups().size()) {
+            return errors::InvalidArgument("Invalid row group ",
+                                           next_row_group_);
+          }
+        }
+        if (reader->Contains(full_name("row_group"))) {
+          int64 row_group;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("row_group"), &row_group));
+          if (row_group < 0 || row_group >= reader_->row_groups().size()) {
+            return errors::InvalidArgument("Invalid row group ", row_group);
+          }
+          TF_RETURN_IF_ERROR(ReadRowGroupLocked(row_group));
+          int64 row;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("row"), &row));
+          if (row < 0 || row > row_group_rows_) {
+            return errors::InvalidArgument("Invalid row ", row);
+          }
+          row_ = row;
+        }
+        return Status::OK();
+      }
+
+     private:
+      // The values and the indices of the sparse column of a batch.
+      struct SparseBatch {
+        std::vector<int64> indices;
+        std::vector<float> floats;
+        std::vector<int64> int64s;
+        std::vector<string> strings;
+        int64 max_num_values = 0;
+      };
+
+      static void CopyDense(DataType dtype,
+                            const ColumnarFileReader::ColumnData& data,
+                            int64 row, int64 n, int64 batch_row,
+                            Tensor* out) {
+        const int64 width = out->NumElements() / out->dim_size(0);
+        const int64 begin = row * width;
+        const int64 num_values = n * width;
+        const int64 out_begin = batch_row * width;
+        switch (dtype) {
+          case DT_FLOAT:
+            CopyValues(data.values + begin * sizeof(float), num_values,
+                       out->flat<float>().data() + out_begin);
+            break;
+          case DT_INT64:
+            CopyValues(data.values + begin * sizeof(int64), num_values,
+                       out->flat<int64>().data() + out_begin);
+            break;
+          case DT_STRING: {
+            string* out_strings = out->flat<string>().data() + out_begin;
+            for (int64 i = 0; i < num_values; ++i) {
+              const StringPiece value = data.strings[begin + i];
+              out_strings[i].assign(value.data(), value.size());
+            }
+            break;
+          }
+          default:
+            LOG(FATAL) << "Should not happen.";
+        }
+      }
+
+      static void AppendSparse(DataType dtype,
+                               const ColumnarFileReader::ColumnData& data,
+                               int64 row, int64 n, int64 batch_row,
+                               SparseBatch* out) {
+        for (int64 i = 0; i < n; ++i) {
+          const int64 begin = data.row_splits[row + i];
+          const int64 num_values = data.row_splits[row + i + 1] - begin;
+          for (int64 j = 0; j < num_values; ++j) {
+            out->indices.push_back(batch_row + i);
+            out->indices.push_back(j);
+          }
+          out->max_num_values = std::max(out->max_num_values, num_values);
+          switch (dtype) {
+            case DT_FLOAT: {
+              const size_t size = out->floats.size();
+              out->floats.resize(size + num_values);
+              CopyValues(data.values + begin * sizeof(float), num_values,
+                         out->floats.data() + size);
+              break;
+            }
+            case DT_INT64: {
+              const size_t size = out->int64s.size();
+              out->int64s.resize(size + num_values);
+              CopyValues(data.values + begin * sizeof(int64), num_values,
+                         out->int64s.data() + size);
+              break;
+            }
+            case DT_STRING:
+              for (int64 j = 0; j < num_values; ++j) {
+                out->strings.emplace_back(data.strings[begin + j].data(),
+                                          data.strings[begin + j].size());
+              }
+              break;
+            default:
+              LOG(FATAL) << "Should not happen.";
+          }
+        }
+      }
+
+      // Returns the sparse batch as a variant vector of its indices, values
+      // and dense shape, as ParseExampleDataset does.
+      static Tensor MakeSparse(IteratorContext* ctx, DataType dtype,
+                               int64 num_rows, SparseBatch* batch) {
+        const int64 num_values = batch->indices.size() / 2;
+        Tensor indices(ctx->allocator({}), DT_INT64,
+                       TensorShape({num_values, 2}));
+        std::copy(batch->indices.begin(), batch->indices.end(),
+                  indices.flat<int64>().data());
+        Tensor values(ctx->allocator({}), dtype, TensorShape({num_values}));
+        switch (dtype) {
+          case DT_FLOAT:
+            std::copy(batch->floats.begin(), batch->floats.end(),
+                      values.flat<float>().data());
+            break;
+          case DT_INT64:
+            std::copy(batch->int64s.begin(), batch->int64s.end(),
+                      values.flat<int64>().data());
+            break;
+          case DT_STRING:
+            std::move(batch->strings.begin(), batch->strings.end(),
+                      values.flat<string>().data());
+            break;
+          default:
+            LOG(FATAL) << "Should not happen.";
+        }
+        Tensor dense_shape(ctx->allocator({}), DT_INT64, TensorShape({2}));
+        dense_shape.vec<int64>()(0) = num_rows;
+        dense_shape.vec<int64>()(1) = batch->max_num_values;
+
+        Tensor serialized_sparse(DT_VARIANT, TensorShape({3}));
+        auto serialized_sparse_t = serialized_sparse.vec<Variant>();
+        serialized_sparse_t(0) = std::move(indices);
+        serialized_sparse_t(1) = std::move(values);
+        serialized_sparse_t(2) = std::move(dense_shape);
+        return serialized_sparse;
+      }
+
+      // Opens the file `file_index_` and maps the columns of the dataset to
+      // the columns of the file.
+      Status OpenFileLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const string& filename = dataset()->filenames_[file_index_];
+        TF_RETURN_IF_ERROR(ColumnarFileReader::Open(env, filename, &reader_));
+        const auto& file_columns = reader_->columns();
+        projection_.clear();
+        for (const Column& column : dataset()->columns_) {
+          const int index = reader_->FindColumn(column.name);
+          if (index < 0) {
+            return errors::InvalidArgument("Column ", column.name,
+                                           " is not in ", filename);
+          }
+          const ColumnarFileReader::Column& file_column = file_columns[index];
+          if (file_column.dtype != column.dtype) {
+            return errors::InvalidArgument(
+                "Column ", column.name, " of ", filename, " has type ",
+                DataTypeString(file_column.dtype), " but expected type ",
+                DataTypeString(column.dtype));
+          }
+          if (!column.sparse &&
+              file_column.values_per_row != column.shape.num_elements()) {
+            return errors::InvalidArgument(
+                "Column ", column.name, " of ", filename, " has ",
+                file_column.values_per_row == 0
+                    ? string("a variable number of")
+                    : strings::StrCat(file_column.values_per_row),
+                " values per row, which do not match shape ",
+                column.shape.DebugString());
+          }
+          projection_.push_back(index);
+        }
+        filter_column_ = -1;
+        if (!dataset()->filter_column_.empty()) {
+          filter_column_ = reader_->FindColumn(dataset()->filter_column_);
+          if (filter_column_ < 0 ||
+              file_columns[filter_column_].dtype == DT_STRING) {
+            return errors::InvalidArgument(
+                "The filter column ", dataset()->filter_column_,
+                " is not a numeric column of ", filename);
+          }
+        }
+        next_row_group_ = 0;
+        return Status::OK();
+      }
+
+      // Returns false if the stats of row group `row_group` show that none
+      // of its rows have a value of the filter column in the filter range.
+      bool MayMatchFilterLocked(int64 row_group)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (filter_column_ < 0) return true;
+        const ColumnarFileReader::Chunk& chunk =
+            reader_->row_groups()[row_group].chunks[filter_column_];
+        // Stats that are NaN, as written by other writers, prove nothing.
+        if (!chunk.has_stats || std::isnan(chunk.min) ||
+            std::isnan(chunk.max)) {
+          return true;
+        }
+        return chunk.max >= dataset()->filter_min_ &&
+               chunk.min <= dataset()->filter_max_;
+      }
+
+      // Reads and decodes the projected columns of row group `row_group`.
+      Status ReadRowGroupLocked(int64 row_group)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        data_.clear();
+        data_.resize(projection_.size());
+        for (int i = 0; i < projection_.size(); ++i) {
+          TF_RETURN_IF_ERROR(
+              reader_->ReadColumn(row_group, projection_[i], &data_[i]));
+        }
+        row_group_rows_ = reader_->row_groups()[row_group].num_rows;
+        row_ = 0;
+        return Status::OK();
+      }
+
+      // Reads the next row group with rows that may match the filter,
+      // opening the next file as needed.
+      Status ReadNextRowGroupLocked(IteratorContext* ctx, bool* end_of_input)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (true) {
+          if (reader_ == nullptr) {
+            if (file_index_ == dataset()->filenames_.size()) {
+              *end_of_input = true;
+              return Status::OK();
+            }
+            TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+          }
+          if (next_row_group_ == reader_->row_groups().size()) {
+            reader_.reset();
+            data_.clear();
+            row_group_rows_ = 0;
+            row_ = 0;
+            ++file_index_;
+            continue;
+          }
+          const int64 row_group = next_row_group_++;
+          if (reader_->row_groups()[row_group].num_rows == 0 ||
+              !MayMatchFilterLocked(row_group)) {
+            continue;
+          }
+          TF_RETURN_IF_ERROR(ReadRowGroupLocked(row_group));
+          *end_of_input = false;
+          return Status::OK();
+        }
+      }
+
+      mutex mu_;
+      int64 file_index_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<ColumnarFileReader> reader_ GUARDED_BY(mu_);
+      // The index in the file of each column of the dataset, and of the
+      // filter column, or -1 if there is no filter.
+      std::vector<int> projection_ GUARDED_BY(mu_);
+      int filter_column_ GUARDED_BY(mu_) = -1;
+      int64 next_row_group_ GUARDED_BY(mu_) = 0;
+      // The columns of the current row group, and the next row to return.
+      std::vector<ColumnarFileReader::ColumnData> data_ GUARDED_BY(mu_);
+      int64 row_group_rows_ GUARDED_BY(mu_) = 0;
+      int64 row_ GUARDED_BY(mu_) = 0;
+    };
+
+    const std::vector<string> filenames_;
+    const int64 batch_size_;
+    const string filter_column_;
+    const double filter_min_;
+    const double filter_max_;
+    const std::vector<Column> columns_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::vector<Column> columns_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace tensorflow
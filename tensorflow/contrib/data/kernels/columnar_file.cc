@@ -0,0 +1,259 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/data/kernels/columnar_file.h"
+
+#include <string.h>
+
+#include "tensorflow/core/lib/core/casts.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "zlib.h"
+
+namespace tensorflow {
+
+const char kColumnarFileMagic[] = "TFCOL001";
+
+namespace {
+
+constexpr size_t kMagicSize = 8;
+// The fixed32 size of the footer and the trailing magic.
+constexpr size_t kTrailerSize = sizeof(uint32) + kMagicSize;
+// zlib compresses by at most 1032:1.
+constexpr uint64 kMaxCompressionRatio = 1032;
+
+// Reads `n` bytes at `offset` of `file` into `scratch`.
+Status ReadFully(RandomAccessFile* file, const string& filename,
+                 uint64 offset, size_t n, char* scratch) {
+  StringPiece data;
+  Status s = file->Read(offset, n, &data, scratch);
+  if (data.size() != n) {
+    if (s.ok() || errors::IsOutOfRange(s)) {
+      return errors::DataLoss("Truncated columnar file ", filename);
+    }
+    return s;
+  }
+  if (data.data() != scratch) memmove(scratch, data.data(), n);
+  return Status::OK();
+}
+
+bool GetByte(StringPiece* input, uint8* value) {
+  if (input->empty()) return false;
+  *value = static_cast<uint8>((*input)[0]);
+  input->remove_prefix(1);
+  return true;
+}
+
+bool GetDouble(StringPiece* input, double* value) {
+  if (input->size() < sizeof(uint64)) return false;
+  *value = bit_cast<double>(core::DecodeFixed64(input->data()));
+  input->remove_prefix(sizeof(uint64));
+  return true;
+}
+
+}  // namespace
+
+/* static */
+Status ColumnarFileReader::Open(Env* env, const string& filename,
+                                std::unique_ptr<ColumnarFileReader>* reader) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  std::unique_ptr<ColumnarFileReader> new_reader(
+      new ColumnarFileReader(filename, std::move(file)));
+  TF_RETURN_IF_ERROR(new_reader->ReadFooter(file_size));
+  *reader = std::move(new_reader);
+  return Status::OK();
+}
+
+ColumnarFileReader::ColumnarFileReader(const string& filename,
+                                       std::unique_ptr<RandomAccessFile> file)
+    : filename_(filename), file_(std::move(file)) {}
+
+Status ColumnarFileReader::ReadFooter(uint64 file_size) {
+  auto corrupted = [this]() {
+    return errors::DataLoss("Corrupted columnar file ", filename_);
+  };
+  if (file_size < kMagicSize + kTrailerSize) return corrupted();
+  char magic[kMagicSize];
+  TF_RETURN_IF_ERROR(ReadFully(file_.get(), filename_, 0, kMagicSize, magic));
+  char trailer[kTrailerSize];
+  TF_RETURN_IF_ERROR(ReadFully(file_.get(), filename_,
+                               file_size - kTrailerSize, kTrailerSize,
+                               trailer));
+  if (memcmp(magic, kColumnarFileMagic, kMagicSize) != 0 ||
+      memcmp(trailer + sizeof(uint32), kColumnarFileMagic, kMagicSize) != 0) {
+    return errors::InvalidArgument(filename_, " is not a columnar file.");
+  }
+
+  const uint64 footer_size = core::DecodeFixed32(trailer);
+  if (footer_size > file_size - kMagicSize - kTrailerSize) return corrupted();
+  const uint64 footer_offset = file_size - kTrailerSize - footer_size;
+  string footer;
+  footer.resize(footer_size);
+  TF_RETURN_IF_ERROR(ReadFully(file_.get(), filename_, footer_offset,
+                               footer_size, &footer[0]));
+
+  StringPiece input(footer);
+  uint32 num_columns;
+  if (!core::GetVarint32(&input, &num_columns)) return corrupted();
+  for (uint32 i = 0; i < num_columns; ++i) {
+    uint32 name_size;
+    uint32 dtype;
+    uint32 values_per_row;
+    if (!core::GetVarint32(&input, &name_size) || input.size() < name_size) {
+      return corrupted();
+    }
+    Column column;
+    column.name = string(input.data(), name_size);
+    input.remove_prefix(name_size);
+    if (!core::GetVarint32(&input, &dtype) ||
+        !core::GetVarint32(&input, &values_per_row)) {
+      return corrupted();
+    }
+    column.dtype = static_cast<DataType>(dtype);
+    if (column.dtype != DT_FLOAT && column.dtype != DT_INT64 &&
+        column.dtype != DT_STRING) {
+      return errors::Unimplemented("Column ", column.name, " of ", filename_,
+                                   " has unsupported type ", dtype);
+    }
+    column.values_per_row = values_per_row;
+    columns_.push_back(std::move(column));
+  }
+
+  uint64 num_row_groups;
+  if (!core::GetVarint64(&input, &num_row_groups)) return corrupted();
+  for (uint64 i = 0; i < num_row_groups; ++i) {
+    uint64 num_rows;
+    if (!core::GetVarint64(&input, &num_rows)) return corrupted();
+    RowGroup row_group;
+    row_group.num_rows = num_rows;
+    for (uint32 j = 0; j < num_columns; ++j) {
+      Chunk chunk;
+      uint8 compression;
+      uint8 has_stats;
+      if (!core::GetVarint64(&input, &chunk.offset) ||
+          !core::GetVarint64(&input, &chunk.size) ||
+          !GetByte(&input, &compression) ||
+          !core::GetVarint64(&input, &chunk.uncompressed_size) ||
+          !GetByte(&input, &has_stats) || compression > 1 ||
+          has_stats > 1) {
+        return corrupted();
+      }
+      chunk.compressed = compression == 1;
+      chunk.has_stats = has_stats == 1;
+      chunk.min = 0;
+      chunk.max = 0;
+      if (chunk.has_stats &&
+          (!GetDouble(&input, &chunk.min) || !GetDouble(&input, &chunk.max))) {
+        return corrupted();
+      }
+      if (chunk.offset < kMagicSize || chunk.offset > footer_offset ||
+          chunk.size > footer_offset - chunk.offset ||
+          (!chunk.compressed && chunk.uncompressed_size != chunk.size) ||
+          chunk.uncompressed_size / kMaxCompressionRatio > chunk.size) {
+        return corrupted();
+      }
+      // Every value, and every row of a variable length column, takes at
+      // least a byte.
+      const uint64 min_size =
+          columns_[j].values_per_row > 0 ? columns_[j].values_per_row : 1;
+      if (num_rows > chunk.uncompressed_size / min_size) return corrupted();
+      row_group.chunks.push_back(chunk);
+    }
+    row_groups_.push_back(std::move(row_group));
+  }
+  if (!input.empty()) return corrupted();
+  return Status::OK();
+}
+
+int ColumnarFileReader::FindColumn(StringPiece name) const {
+  for (int i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) return i;
+  }
+  return -1;
+}
+
+Status ColumnarFileReader::ReadColumn(int64 row_group, int column,
+                                      ColumnData* data) const {
+  const Column& col = columns_[column];
+  const Chunk& chunk = row_groups_[row_group].chunks[column];
+  const int64 num_rows = row_groups_[row_group].num_rows;
+  auto corrupted = [&]() {
+    return errors::DataLoss("Corrupted chunk of column ", col.name,
+                            " in row group ", row_group, " of ", filename_);
+  };
+
+  data->buffer.reset(new char[chunk.uncompressed_size]);
+  if (chunk.compressed) {
+    std::unique_ptr<char[]> compressed(new char[chunk.size]);
+    TF_RETURN_IF_ERROR(ReadFully(file_.get(), filename_, chunk.offset,
+                                 chunk.size, compressed.get()));
+    uLongf size = chunk.uncompressed_size;
+    if (uncompress(reinterpret_cast<Bytef*>(data->buffer.get()), &size,
+                   reinterpret_cast<const Bytef*>(compressed.get()),
+                   chunk.size) != Z_OK ||
+        size != chunk.uncompressed_size) {
+      return corrupted();
+    }
+  } else {
+    TF_RETURN_IF_ERROR(ReadFully(file_.get(), filename_, chunk.offset,
+                                 chunk.size, data->buffer.get()));
+  }
+
+  StringPiece input(data->buffer.get(), chunk.uncompressed_size);
+  data->row_splits.resize(num_rows + 1);
+  data->row_splits[0] = 0;
+  if (col.values_per_row > 0) {
+    for (int64 i = 0; i < num_rows; ++i) {
+      data->row_splits[i + 1] = data->row_splits[i] + col.values_per_row;
+    }
+  } else {
+    for (int64 i = 0; i < num_rows; ++i) {
+      uint64 num_values;
+      if (!core::GetVarint64(&input, &num_values) ||
+          num_values > input.size()) {
+        return corrupted();
+      }
+      data->row_splits[i + 1] = data->row_splits[i] + num_values;
+    }
+  }
+
+  const uint64 num_values = data->row_splits[num_rows];
+  data->values = nullptr;
+  data->strings.clear();
+  if (col.dtype == DT_STRING) {
+    if (num_values > input.size()) return corrupted();
+    data->strings.reserve(num_values);
+    for (uint64 i = 0; i < num_values; ++i) {
+      uint32 size;
+      if (!core::GetVarint32(&input, &size) || input.size() < size) {
+        return corrupted();
+      }
+      data->strings.emplace_back(input.data(), size);
+      input.remove_prefix(size);
+    }
+    if (!input.empty()) return corrupted();
+  } else {
+    const size_t width = DataTypeSize(col.dtype);
+    if (input.size() % width != 0 || input.size() / width != num_values) {
+      return corrupted();
+    }
+    data->values = input.data();
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
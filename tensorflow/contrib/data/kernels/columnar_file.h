@@ -0,0 +1,125 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_DATA_KERNELS_COLUMNAR_FILE_H_
+#define TENSORFLOW_CONTRIB_DATA_KERNELS_COLUMNAR_FILE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+// A columnar file stores a table whose rows are split into row groups. Each
+// row group stores the values of each column in a separate, optionally
+// compressed chunk, so that a reader only reads and decodes the columns it
+// needs. All integers are little endian.
+//
+//   file       := magic chunk* footer fixed32(footer size) magic
+//   footer     := varint32(num columns) column* varint64(num row groups)
+//                 row_group*
+//   column     := varint32(name size) name varint32(dtype)
+//                 varint32(values per row, 0 if variable)
+//   row_group  := varint64(num rows) chunk_info*  (one per column)
+//   chunk_info := varint64(offset) varint64(size) byte(compression)
+//                 varint64(uncompressed size) byte(has stats)
+//                 [fixed64(min) fixed64(max)]
+//
+// The dtype is a DataType of DT_FLOAT, DT_INT64 or DT_STRING. The compression
+// is 0 for none or 1 for zlib. The stats of a numeric chunk are the minimum
+// and the maximum of its values, as the bits of doubles. The uncompressed
+// chunk holds, for a variable length column, the varint64 number of values
+// of each row, followed by the values of all rows: fixed32 floats, fixed64
+// int64s, or varint32 sizes followed by the bytes of strings.
+//
+// The Python writer is `tf.contrib.data.write_columnar_file()`.
+
+extern const char kColumnarFileMagic[];
+
+// Reads the footer of a columnar file and the chunks of its columns.
+//
+// Every method is thread safe.
+class ColumnarFileReader {
+ public:
+  struct Column {
+    string name;
+    DataType dtype;
+    // The number of values of the column in each row, or 0 if it varies.
+    int64 values_per_row;
+  };
+
+  struct Chunk {
+    uint64 offset;
+    uint64 size;
+    bool compressed;
+    uint64 uncompressed_size;
+    bool has_stats;
+    double min;
+    double max;
+  };
+
+  struct RowGroup {
+    int64 num_rows;
+    // The chunks of the columns, in the order of `columns()`.
+    std::vector<Chunk> chunks;
+  };
+
+  // The values of a column in a row group. The values of row `i` are values
+  // [row_splits[i], row_splits[i + 1]).
+  struct ColumnData {
+    std::vector<int64> row_splits;
+    // The fixed-width values of a numeric column, in the uncompressed chunk.
+    const char* values = nullptr;
+    // The values of a string column, in the uncompressed chunk.
+    std::vector<StringPiece> strings;
+    // The uncompressed chunk, which stays in place when the data is moved.
+    std::unique_ptr<char[]> buffer;
+  };
+
+  // Opens `filename` and reads its footer.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnarFileReader>* reader);
+
+  const string& filename() const { return filename_; }
+  const std::vector<Column>& columns() const { return columns_; }
+  const std::vector<RowGroup>& row_groups() const { return row_groups_; }
+
+  // Returns the index of the column named `name`, or -1 if there is none.
+  int FindColumn(StringPiece name) const;
+
+  // Reads and decodes the chunk of column `column` in row group `row_group`.
+  Status ReadColumn(int64 row_group, int column, ColumnData* data) const;
+
+ private:
+  ColumnarFileReader(const string& filename,
+                     std::unique_ptr<RandomAccessFile> file);
+
+  Status ReadFooter(uint64 file_size);
+
+  const string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  std::vector<Column> columns_;
+  std::vector<RowGroup> row_groups_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ColumnarFileReader);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_DATA_KERNELS_COLUMNAR_FILE_H_
@@ -0,0 +1,475 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/data/kernels/shared_memory_channel.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kMagic[] = "TFSHMCH1";
+constexpr size_t kMagicSize = 8;
+// The header, the rings and their data are aligned to cache lines.
+constexpr size_t kAlignment = 64;
+// Each record is preceded by its fixed32 size.
+constexpr size_t kRecordHeaderSize = sizeof(uint32);
+// How often blocked readers and writers check whether their peer exited, and
+// writers whether they were cancelled.
+constexpr int64 kPollMicros = 100 * 1000;
+// How often `Open()` checks whether the segment has been created.
+constexpr int64 kOpenRetryMicros = 10 * 1000;
+
+// The states of the consumer of a ring.
+constexpr uint32 kIdle = 0;
+constexpr uint32 kAttached = 1;
+constexpr uint32 kDetached = 2;
+
+// The states of the server of a ring.
+constexpr uint32 kOpen = 0;
+constexpr uint32 kClosed = 1;
+constexpr uint32 kFailed = 2;
+
+size_t RoundUp(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool ProcessExited(pid_t pid) {
+  return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+void Lock(pthread_mutex_t* mu) {
+  const int result = pthread_mutex_lock(mu);
+#ifdef __linux__
+  // The previous owner died while holding the lock. The state that it guards
+  // is only a few integers that are updated together, so it is consistent.
+  if (result == EOWNERDEAD) pthread_mutex_consistent(mu);
+#else
+  (void)result;
+#endif
+}
+
+void Unlock(pthread_mutex_t* mu) { pthread_mutex_unlock(mu); }
+
+// Waits on `cond` for at most `kPollMicros`.
+void TimedWait(pthread_cond_t* cond, pthread_mutex_t* mu) {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  const int64 deadline_micros =
+      now.tv_sec * 1000000LL + now.tv_usec + kPollMicros;
+  struct timespec deadline;
+  deadline.tv_sec = deadline_micros / 1000000;
+  deadline.tv_nsec = (deadline_micros % 1000000) * 1000;
+  const int result = pthread_cond_timedwait(cond, mu, &deadline);
+#ifdef __linux__
+  if (result == EOWNERDEAD) pthread_mutex_consistent(mu);
+#else
+  (void)result;
+#endif
+}
+
+Status ErrnoError(const string& context, const string& path) {
+  return errors::Unavailable(context, " ", path, ": ", strerror(errno));
+}
+
+}  // namespace
+
+struct SharedMemoryChannel::Header {
+  char magic[kMagicSize];
+  uint32 num_consumers;
+  int32 server_pid;
+  uint64 ring_capacity;
+  // The distance between consecutive rings, including their data.
+  uint64 ring_stride;
+};
+
+struct SharedMemoryChannel::Ring {
+  pthread_mutex_t mu;
+  // Signaled when a record is written or the ring is closed.
+  pthread_cond_t not_empty;
+  // Signaled when a record is read or the consumer detaches.
+  pthread_cond_t not_full;
+  // The total numbers of bytes read from and written to the ring; the ring
+  // holds bytes [read_position, write_position) modulo its capacity.
+  uint64 read_position;
+  uint64 write_position;
+  uint32 consumer_state;
+  int32 consumer_pid;
+  uint32 server_state;
+  // Set once the ring will not be read anymore.
+  uint32 done;
+};
+
+/* static */
+size_t SharedMemoryChannel::RingsOffset() { return RoundUp(sizeof(Header)); }
+
+/* static */
+size_t SharedMemoryChannel::RingDataOffset() { return RoundUp(sizeof(Ring)); }
+
+SharedMemoryChannel::SharedMemoryChannel(const string& path, char* base,
+                                         size_t size, uint64 device,
+                                         uint64 inode)
+    : path_(path), base_(base), size_(size), device_(device), inode_(inode) {}
+
+SharedMemoryChannel::~SharedMemoryChannel() { munmap(base_, size_); }
+
+/* static */
+Status SharedMemoryChannel::Create(
+    const string& path, int num_consumers, uint64 ring_capacity,
+    std::unique_ptr<SharedMemoryChannel>* channel) {
+  if (num_consumers <= 0) {
+    return errors::InvalidArgument("`num_consumers` must be > 0");
+  }
+  if (ring_capacity <= kRecordHeaderSize) {
+    return errors::InvalidArgument("`ring_capacity` must be > ",
+                                   kRecordHeaderSize);
+  }
+  const uint64 ring_stride = RingDataOffset() + RoundUp(ring_capacity);
+  const size_t size = RingsOffset() + num_consumers * ring_stride;
+
+  // Build the segment under a temporary name, so that consumers only see it
+  // once it is initialized.
+  const string temp_path = strings::StrCat(path, ".tmp", getpid());
+  int fd = open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0660);
+  if (fd < 0) return ErrnoError("Could not create", temp_path);
+  if (ftruncate(fd, size) != 0) {
+    Status s = ErrnoError("Could not resize", temp_path);
+    close(fd);
+    unlink(temp_path.c_str());
+    return s;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    Status s = ErrnoError("Could not stat", temp_path);
+    close(fd);
+    unlink(temp_path.c_str());
+    return s;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    Status s = ErrnoError("Could not map", temp_path);
+    unlink(temp_path.c_str());
+    return s;
+  }
+  std::unique_ptr<SharedMemoryChannel> new_channel(
+      new SharedMemoryChannel(path, static_cast<char*>(base), size, st.st_dev,
+                              st.st_ino));
+
+  // The file is zero filled, so the positions of the rings start at zero.
+  Header* header = reinterpret_cast<Header*>(base);
+  header->num_consumers = num_consumers;
+  header->server_pid = getpid();
+  header->ring_capacity = ring_capacity;
+  header->ring_stride = ring_stride;
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+#endif
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  for (int i = 0; i < num_consumers; ++i) {
+    Ring* r = new_channel->ring(i);
+    pthread_mutex_init(&r->mu, &mutex_attr);
+    pthread_cond_init(&r->not_empty, &cond_attr);
+    pthread_cond_init(&r->not_full, &cond_attr);
+    r->consumer_state = kIdle;
+    r->server_state = kOpen;
+    r->done = 0;
+  }
+  pthread_condattr_destroy(&cond_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  memcpy(header->magic, kMagic, kMagicSize);
+
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    Status s = ErrnoError("Could not create", path);
+    unlink(temp_path.c_str());
+    return s;
+  }
+  *channel = std::move(new_channel);
+  return Status::OK();
+}
+
+/* static */
+Status SharedMemoryChannel::Open(
+    const string& path, int64 timeout_micros,
+    std::unique_ptr<SharedMemoryChannel>* channel) {
+  Env* env = Env::Default();
+  const uint64 deadline_micros = env->NowMicros() + timeout_micros;
+  int fd;
+  while ((fd = open(path.c_str(), O_RDWR)) < 0) {
+    if (errno != ENOENT || env->NowMicros() >= deadline_micros) {
+      return ErrnoError("Could not open", path);
+    }
+    env->SleepForMicroseconds(kOpenRetryMicros);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    Status s = ErrnoError("Could not stat", path);
+    close(fd);
+    return s;
+  }
+  const size_t size = st.st_size;
+  if (size < RingsOffset()) {
+    close(fd);
+    return errors::InvalidArgument(path, " is not a shared memory channel.");
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return ErrnoError("Could not map", path);
+  std::unique_ptr<SharedMemoryChannel> new_channel(
+      new SharedMemoryChannel(path, static_cast<char*>(base), size, st.st_dev,
+                              st.st_ino));
+
+  const Header* header = reinterpret_cast<const Header*>(base);
+  if (memcmp(header->magic, kMagic, kMagicSize) != 0 ||
+      header->num_consumers == 0 ||
+      header->ring_stride !=
+          RingDataOffset() + RoundUp(header->ring_capacity) ||
+      size != RingsOffset() + header->num_consumers * header->ring_stride) {
+    return errors::InvalidArgument(path, " is not a shared memory channel.");
+  }
+  *channel = std::move(new_channel);
+  return Status::OK();
+}
+
+int SharedMemoryChannel::num_consumers() const {
+  return reinterpret_cast<const Header*>(base_)->num_consumers;
+}
+
+uint64 SharedMemoryChannel::ring_capacity() const {
+  return reinterpret_cast<const Header*>(base_)->ring_capacity;
+}
+
+SharedMemoryChannel::Ring* SharedMemoryChannel::ring(int consumer) {
+  const Header* header = reinterpret_cast<const Header*>(base_);
+  return reinterpret_cast<Ring*>(base_ + RingsOffset() +
+                                 consumer * header->ring_stride);
+}
+
+/* static */
+bool SharedMemoryChannel::UpdateConsumerStateLocked(Ring* r) {
+  if (r->consumer_state != kAttached || !ProcessExited(r->consumer_pid)) {
+    return false;
+  }
+  r->consumer_state = kDetached;
+  r->done = 1;
+  return true;
+}
+
+void SharedMemoryChannel::CopyToRing(int consumer, uint64 position,
+                                     const char* data, size_t n) {
+  const uint64 capacity = ring_capacity();
+  char* ring_data = reinterpret_cast<char*>(ring(consumer)) + RingDataOffset();
+  const size_t offset = position % capacity;
+  const size_t first = std::min<size_t>(n, capacity - offset);
+  memcpy(ring_data + offset, data, first);
+  memcpy(ring_data, data + first, n - first);
+}
+
+void SharedMemoryChannel::CopyFromRing(int consumer, uint64 position,
+                                       char* data, size_t n) {
+  const uint64 capacity = ring_capacity();
+  const char* ring_data =
+      reinterpret_cast<const char*>(ring(consumer)) + RingDataOffset();
+  const size_t offset = position % capacity;
+  const size_t first = std::min<size_t>(n, capacity - offset);
+  memcpy(data, ring_data + offset, first);
+  memcpy(data + first, ring_data, n - first);
+}
+
+Status SharedMemoryChannel::Write(int consumer, StringPiece record,
+                                  CancellationManager* cancellation_manager,
+                                  bool* detached) {
+  const uint64 capacity = ring_capacity();
+  const uint64 n = kRecordHeaderSize + record.size();
+  if (n > capacity) {
+    return errors::InvalidArgument(
+        "An element of ", record.size(), " bytes does not fit in the ",
+        capacity, " byte rings of ", path_,
+        "; increase the ring capacity of the server.");
+  }
+  Ring* r = ring(consumer);
+  Lock(&r->mu);
+  while (true) {
+    UpdateConsumerStateLocked(r);
+    if (r->consumer_state == kDetached) {
+      Unlock(&r->mu);
+      *detached = true;
+      return Status::OK();
+    }
+    if (capacity - (r->write_position - r->read_position) >= n) break;
+    if (cancellation_manager != nullptr &&
+        cancellation_manager->IsCancelled()) {
+      Unlock(&r->mu);
+      return errors::Cancelled("Writing to consumer ", consumer, " of ", path_,
+                               " was cancelled.");
+    }
+    TimedWait(&r->not_full, &r->mu);
+  }
+  const uint64 position = r->write_position;
+  Unlock(&r->mu);
+
+  // The consumer does not read past `write_position`, so the record can be
+  // copied without holding the lock.
+  char size[kRecordHeaderSize];
+  core::EncodeFixed32(size, record.size());
+  CopyToRing(consumer, position, size, kRecordHeaderSize);
+  CopyToRing(consumer, position + kRecordHeaderSize, record.data(),
+             record.size());
+
+  Lock(&r->mu);
+  r->write_position = position + n;
+  pthread_cond_signal(&r->not_empty);
+  Unlock(&r->mu);
+  *detached = false;
+  return Status::OK();
+}
+
+void SharedMemoryChannel::Close(int consumer, const Status& status) {
+  Ring* r = ring(consumer);
+  Lock(&r->mu);
+  r->server_state = status.ok() ? kClosed : kFailed;
+  UpdateConsumerStateLocked(r);
+  pthread_cond_broadcast(&r->not_empty);
+  Unlock(&r->mu);
+  // The consumers may all have detached already.
+  MaybeRemove();
+}
+
+Status SharedMemoryChannel::Attach(int consumer) {
+  if (consumer < 0 || consumer >= num_consumers()) {
+    return errors::InvalidArgument("Consumer ", consumer, " is out of range; ",
+                                   path_, " has ", num_consumers(),
+                                   " consumers.");
+  }
+  Ring* r = ring(consumer);
+  Lock(&r->mu);
+  const bool newly_done = UpdateConsumerStateLocked(r);
+  Status s;
+  if (r->consumer_state == kAttached) {
+    s = errors::FailedPrecondition("Consumer ", consumer, " of ", path_,
+                                   " is already attached by process ",
+                                   r->consumer_pid, ".");
+  } else if (r->consumer_state == kDetached) {
+    s = errors::FailedPrecondition("Consumer ", consumer, " of ", path_,
+                                   " has detached, and its elements have been "
+                                   "dropped.");
+  } else {
+    r->consumer_state = kAttached;
+    r->consumer_pid = getpid();
+  }
+  Unlock(&r->mu);
+  if (newly_done) MaybeRemove();
+  return s;
+}
+
+void SharedMemoryChannel::Detach(int consumer) {
+  Ring* r = ring(consumer);
+  Lock(&r->mu);
+  r->consumer_state = kDetached;
+  const bool newly_done = !r->done;
+  r->done = 1;
+  pthread_cond_broadcast(&r->not_full);
+  Unlock(&r->mu);
+  // Once the ring is done, the file may already be gone, and another may be in
+  // its place.
+  if (newly_done) MaybeRemove();
+}
+
+Status SharedMemoryChannel::Read(int consumer, string* record,
+                                 bool* end_of_sequence) {
+  const Header* header = reinterpret_cast<const Header*>(base_);
+  Ring* r = ring(consumer);
+  Lock(&r->mu);
+  while (r->write_position == r->read_position) {
+    Status s;
+    if (r->server_state == kClosed) {
+      *end_of_sequence = true;
+    } else if (r->server_state == kFailed) {
+      s = errors::Aborted("The server of ", path_,
+                          " failed; see its log for the error.");
+    } else if (ProcessExited(header->server_pid)) {
+      s = errors::Aborted("The server of ", path_,
+                          " exited before sending all elements.");
+    } else {
+      TimedWait(&r->not_empty, &r->mu);
+      continue;
+    }
+    // The ring has nothing more to read.
+    const bool newly_done = !r->done;
+    r->done = 1;
+    Unlock(&r->mu);
+    if (newly_done) MaybeRemove();
+    return s;
+  }
+  const uint64 position = r->read_position;
+  const uint64 available = r->write_position - r->read_position;
+  Unlock(&r->mu);
+
+  // The server does not write before `read_position`, so the record can be
+  // copied without holding the lock.
+  char size_buffer[kRecordHeaderSize];
+  CopyFromRing(consumer, position, size_buffer, kRecordHeaderSize);
+  const uint64 size = core::DecodeFixed32(size_buffer);
+  if (available < kRecordHeaderSize + size) {
+    return errors::DataLoss("Corrupted record in ", path_);
+  }
+  record->resize(size);
+  CopyFromRing(consumer, position + kRecordHeaderSize, &(*record)[0], size);
+
+  Lock(&r->mu);
+  r->read_position = position + kRecordHeaderSize + size;
+  pthread_cond_signal(&r->not_full);
+  Unlock(&r->mu);
+  *end_of_sequence = false;
+  return Status::OK();
+}
+
+void SharedMemoryChannel::MaybeRemove() {
+  // A ring does not become undone, so the rings can be checked one at a time.
+  for (int i = 0; i < num_consumers(); ++i) {
+    Ring* r = ring(i);
+    Lock(&r->mu);
+    const bool done = r->done;
+    Unlock(&r->mu);
+    if (!done) return;
+  }
+  struct stat st;
+  if (stat(path_.c_str(), &st) == 0 && st.st_dev == device_ &&
+      st.st_ino == inode_) {
+    unlink(path_.c_str());
+  }
+}
+
+}  // namespace tensorflow
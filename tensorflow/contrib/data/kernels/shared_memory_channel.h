@@ -0,0 +1,133 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_DATA_KERNELS_SHARED_MEMORY_CHANNEL_H_
+#define TENSORFLOW_CONTRIB_DATA_KERNELS_SHARED_MEMORY_CHANNEL_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A set of single-producer, single-consumer ring buffers of records in a
+// shared memory segment, through which one server process sends the elements
+// of a dataset to several consumer processes on the same host.
+//
+// The segment is a file, normally under /dev/shm, that holds a header and one
+// ring per consumer. Each ring has a process-shared mutex and condition
+// variables; the records are copied in and out of the ring without holding
+// the mutex. A writer blocks while the ring is full, so a slow consumer slows
+// the server down instead of growing its buffers.
+//
+// The server creates the segment under a temporary name and renames it into
+// place, so consumers never see a partially initialized segment. A consumer
+// attaches to its ring, which fails if another process is attached to it. If
+// a consumer detaches or exits, the server stops writing to its ring; if the
+// server exits before closing the rings, the consumers fail.
+//
+// A ring is done once its consumer has read the end of the sequence or the
+// error of the server, or has detached or exited. The last process to see
+// every ring done removes the file, so that the consumers of a later run do
+// not read the elements of this one. A consumer that never attaches keeps the
+// file in place until it does, and reads its elements then, even if the server
+// has exited.
+//
+// Only implemented on POSIX systems.
+class SharedMemoryChannel {
+ public:
+  ~SharedMemoryChannel();
+
+  // Creates a segment at `path` with `num_consumers` rings of
+  // `ring_capacity` bytes each, replacing any existing file.
+  static Status Create(const string& path, int num_consumers,
+                       uint64 ring_capacity,
+                       std::unique_ptr<SharedMemoryChannel>* channel);
+
+  // Opens the segment at `path`, waiting up to `timeout_micros` for a server
+  // to create it.
+  static Status Open(const string& path, int64 timeout_micros,
+                     std::unique_ptr<SharedMemoryChannel>* channel);
+
+  int num_consumers() const;
+  uint64 ring_capacity() const;
+
+  // Server methods.
+
+  // Appends `record` to the ring of `consumer`, blocking while it is full.
+  // Sets `*detached` and drops the record if the consumer has detached or
+  // exited. Returns a cancelled error if `cancellation_manager`, which may be
+  // null, is cancelled while waiting, e.g. for a consumer that never attaches.
+  Status Write(int consumer, StringPiece record,
+               CancellationManager* cancellation_manager, bool* detached);
+
+  // Marks the ring of `consumer` as complete. Once the consumer has read the
+  // records before, it reads the end of sequence if `status` is OK, or an
+  // error otherwise.
+  void Close(int consumer, const Status& status);
+
+  // Consumer methods.
+
+  // Makes the calling process the consumer of the ring of `consumer`.
+  Status Attach(int consumer);
+
+  // Detaches from the ring of `consumer`, after which the server drops the
+  // records for it.
+  void Detach(int consumer);
+
+  // Reads the next record from the ring of `consumer`, blocking until there
+  // is one or the ring is closed.
+  Status Read(int consumer, string* record, bool* end_of_sequence);
+
+ private:
+  struct Header;
+  struct Ring;
+
+  SharedMemoryChannel(const string& path, char* base, size_t size,
+                      uint64 device, uint64 inode);
+
+  // The offsets of the first ring in the segment, and of the data of a ring
+  // in the ring.
+  static size_t RingsOffset();
+  static size_t RingDataOffset();
+
+  Ring* ring(int consumer);
+  // Detaches the consumer of `r` if it has exited, and returns whether it did.
+  // Requires `r->mu`.
+  static bool UpdateConsumerStateLocked(Ring* r);
+  // Copies `n` bytes between `data` and the ring of `consumer`, starting at
+  // `position`, wrapping around its end.
+  void CopyToRing(int consumer, uint64 position, const char* data, size_t n);
+  void CopyFromRing(int consumer, uint64 position, char* data, size_t n);
+  // Removes the file if every ring is done and it has not been replaced.
+  void MaybeRemove();
+
+  const string path_;
+  char* const base_;
+  const size_t size_;
+  // The identity of the file, so that `MaybeRemove()` leaves the segment of a
+  // newer server at `path_` in place.
+  const uint64 device_;
+  const uint64 inode_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryChannel);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CONTRIB_DATA_KERNELS_SHARED_MEMORY_CHANNEL_H_
@@ -0,0 +1,335 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/data/kernels/shared_memory_channel.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following ops.
+
+// How long a consumer waits for the server to create the channel.
+constexpr int64 kOpenTimeoutMicros = 60 * 1000 * 1000;
+
+// An element is sent as the varint64 number of its components, followed by
+// the varint64 length and the serialized `TensorProto` of each component.
+Status EncodeElement(const std::vector<Tensor>& element, string* record) {
+  record->clear();
+  core::PutVarint64(record, element.size());
+  string serialized;
+  for (const Tensor& t : element) {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Could not serialize a tensor of shape ",
+                              t.shape().DebugString(), ".");
+    }
+    core::PutVarint64(record, serialized.size());
+    record->append(serialized);
+  }
+  return Status::OK();
+}
+
+Status DecodeElement(StringPiece record, std::vector<Tensor>* element) {
+  uint64 num_components;
+  if (!core::GetVarint64(&record, &num_components)) {
+    return errors::DataLoss("Corrupted element in shared memory.");
+  }
+  element->reserve(num_components);
+  for (uint64 i = 0; i < num_components; ++i) {
+    uint64 length;
+    if (!core::GetVarint64(&record, &length) || length > record.size()) {
+      return errors::DataLoss("Corrupted element in shared memory.");
+    }
+    TensorProto proto;
+    element->emplace_back();
+    if (!proto.ParseFromArray(record.data(), length) ||
+        !element->back().FromProto(proto)) {
+      return errors::DataLoss("Corrupted tensor in shared memory.");
+    }
+    record.remove_prefix(length);
+  }
+  return Status::OK();
+}
+
+class DatasetToSharedMemoryOp : public AsyncOpKernel {
+ public:
+  explicit DatasetToSharedMemoryOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(), "dataset_to_shared_memory",
+            1 /* num_threads */, false /* low_latency_hint */)) {}
+
+  template <typename T>
+  Status ParseScalarArgument(OpKernelContext* ctx,
+                             const StringPiece& argument_name, T* output) {
+    const Tensor* argument_t;
+    TF_RETURN_IF_ERROR(ctx->input(argument_name, &argument_t));
+    if (!TensorShapeUtils::IsScalar(argument_t->shape())) {
+      return errors::InvalidArgument(argument_name, " must be a scalar");
+    }
+    *output = argument_t->scalar<T>()();
+    return Status::OK();
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The calls to `iterator->GetNext()` and to `channel->Write()` may block,
+    // so we issue them from the owned thread pool.
+    thread_pool_->Schedule([this, ctx, done]() {
+      string path;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ParseScalarArgument<string>(ctx, "path", &path), done);
+      int64 num_consumers;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ParseScalarArgument<int64>(ctx, "num_consumers", &num_consumers),
+          done);
+      OP_REQUIRES_ASYNC(
+          ctx, num_consumers > 0 && num_consumers <= kint32max,
+          errors::InvalidArgument("`num_consumers` must be > 0"), done);
+      int64 ring_capacity;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ParseScalarArgument<int64>(ctx, "ring_capacity", &ring_capacity),
+          done);
+      OP_REQUIRES_ASYNC(ctx, ring_capacity > 0,
+                        errors::InvalidArgument("`ring_capacity` must be > 0"),
+                        done);
+      bool broadcast;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ParseScalarArgument<bool>(ctx, "broadcast", &broadcast), done);
+
+      DatasetBase* dataset;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, GetDatasetFromVariantTensor(ctx->input(0), &dataset), done);
+      std::unique_ptr<IteratorBase> iterator;
+      OP_REQUIRES_OK_ASYNC(
+          ctx,
+          dataset->MakeIterator(IteratorContext(ctx),
+                                "DatasetToSharedMemoryOpIterator", &iterator),
+          done);
+      std::unique_ptr<SharedMemoryChannel> channel;
+      OP_REQUIRES_OK_ASYNC(ctx,
+                           SharedMemoryChannel::Create(path, num_consumers,
+                                                       ring_capacity, &channel),
+                           done);
+
+      Status s = Serve(ctx, iterator.get(), channel.get(), broadcast);
+      for (int i = 0; i < num_consumers; ++i) {
+        channel->Close(i, s);
+      }
+      OP_REQUIRES_OK_ASYNC(ctx, s, done);
+      done();
+    });
+  }
+
+ private:
+  // Sends the elements of `iterator` to the consumers of `channel`, until
+  // the end of the sequence, until all consumers have detached, or until the
+  // step is cancelled.
+  Status Serve(OpKernelContext* ctx, IteratorBase* iterator,
+               SharedMemoryChannel* channel, bool broadcast) {
+    const int num_consumers = channel->num_consumers();
+    // The consumer of the next element when sharding.
+    int next_consumer = 0;
+    std::vector<Tensor> components;
+    string record;
+    while (true) {
+      components.clear();
+      bool end_of_sequence;
+      TF_RETURN_IF_ERROR(iterator->GetNext(IteratorContext(ctx), &components,
+                                           &end_of_sequence));
+      if (end_of_sequence) return Status::OK();
+      TF_RETURN_IF_ERROR(EncodeElement(components, &record));
+
+      // In broadcast mode, every consumer gets every element. Otherwise, the
+      // elements are dealt round robin, skipping the consumers that have
+      // detached.
+      int num_detached = 0;
+      for (int i = 0; i < num_consumers; ++i) {
+        const int consumer =
+            broadcast ? i : (next_consumer + i) % num_consumers;
+        bool detached;
+        TF_RETURN_IF_ERROR(channel->Write(
+            consumer, record, ctx->cancellation_manager(), &detached));
+        if (detached) {
+          ++num_detached;
+        } else if (!broadcast) {
+          next_consumer = (consumer + 1) % num_consumers;
+          break;
+        }
+      }
+      if (num_detached == num_consumers) {
+        LOG(WARNING) << "All consumers of the shared memory channel have "
+                        "detached; stopping the server.";
+        return Status::OK();
+      }
+    }
+  }
+
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+class SharedMemoryDatasetOp : public DatasetOpKernel {
+ public:
+  explicit SharedMemoryDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    string path;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<string>(ctx, "path", &path));
+    int64 consumer_index;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "consumer_index",
+                                                   &consumer_index));
+    OP_REQUIRES(ctx, consumer_index >= 0 && consumer_index <= kint32max,
+                errors::InvalidArgument("`consumer_index` must be >= 0"));
+    *output = new Dataset(ctx, path, consumer_index, output_types_,
+                          output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const string& path, int64 consumer_index,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          path_(path),
+          consumer_index_(consumer_index),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::SharedMemory")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "SharedMemoryDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* path = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(path_, &path));
+      Node* consumer_index = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(consumer_index_, &consumer_index));
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {path, consumer_index}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        if (channel_) channel_->Detach(dataset()->consumer_index_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (!channel_) {
+          std::unique_ptr<SharedMemoryChannel> channel;
+          TF_RETURN_IF_ERROR(SharedMemoryChannel::Open(
+              dataset()->path_, kOpenTimeoutMicros, &channel));
+          TF_RETURN_IF_ERROR(channel->Attach(dataset()->consumer_index_));
+          channel_ = std::move(channel);
+        }
+        TF_RETURN_IF_ERROR(channel_->Read(dataset()->consumer_index_,
+                                          &record_, end_of_sequence));
+        if (*end_of_sequence) return Status::OK();
+        TF_RETURN_IF_ERROR(DecodeElement(record_, out_tensors));
+        if (out_tensors->size() != dataset()->output_types_.size()) {
+          return errors::InvalidArgument(
+              "Expected elements of ", dataset()->output_types_.size(),
+              " components from ", dataset()->path_, " but got ",
+              out_tensors->size(), ".");
+        }
+        for (size_t i = 0; i < out_tensors->size(); ++i) {
+          const Tensor& t = (*out_tensors)[i];
+          if (t.dtype() != dataset()->output_types_[i] ||
+              !dataset()->output_shapes_[i].IsCompatibleWith(t.shape())) {
+            return errors::InvalidArgument(
+                "Component ", i, " of an element from ", dataset()->path_,
+                " is a ", DataTypeString(t.dtype()), " tensor of shape ",
+                t.shape().DebugString(), ", which does not match the ",
+                DataTypeString(dataset()->output_types_[i]),
+                " type and the shape ",
+                dataset()->output_shapes_[i].DebugString(),
+                " of the dataset.");
+          }
+        }
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            "Checkpointing is not supported for SharedMemoryDataset.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            "Checkpointing is not supported for SharedMemoryDataset.");
+      }
+
+     private:
+      mutex mu_;
+      std::unique_ptr<SharedMemoryChannel> channel_ GUARDED_BY(mu_);
+      // The buffer of the last element read from the channel.
+      string record_ GUARDED_BY(mu_);
+    };
+
+    const string path_;
+    const int64 consumer_index_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToSharedMemory").Device(DEVICE_CPU),
+                        DatasetToSharedMemoryOp);
+REGISTER_KERNEL_BUILDER(Name("SharedMemoryDataset").Device(DEVICE_CPU),
+                        SharedMemoryDatasetOp);
+
+}  // namespace
+}  // namespace tensorflow
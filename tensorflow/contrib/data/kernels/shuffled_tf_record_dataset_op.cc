@@ -0,0 +1,353 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_index.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ShuffledTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ShuffledTFRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reshuffle_each_iteration",
+                                     &reshuffle_each_iteration_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+    // By TensorFlow convention, passing 0 for both seeds indicates
+    // that the shuffling should be seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    *output = new Dataset(ctx, std::move(filenames), seed, seed2,
+                          reshuffle_each_iteration_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames, int64 seed,
+            int64 seed2, bool reshuffle_each_iteration)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          seed_(seed),
+          seed2_(seed2),
+          reshuffle_each_iteration_(reshuffle_each_iteration),
+          parent_generator_(seed, seed2),
+          generator_(&parent_generator_) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      int64 iterator_seed = seed_;
+      int64 iterator_seed2 = seed2_;
+      if (reshuffle_each_iteration_) {
+        mutex_lock l(mu_);
+        iterator_seed = generator_();
+        iterator_seed2 = generator_();
+      }
+      return std::unique_ptr<IteratorBase>(new Iterator(
+          {this, strings::StrCat(prefix, "::ShuffledTFRecord")},
+          iterator_seed, iterator_seed2));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() const override {
+      return "ShuffledTFRecordDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* seed = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      AttrValue reshuffle_each_iteration;
+      b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, seed, seed2},
+          {std::make_pair("reshuffle_each_iteration",
+                          reshuffle_each_iteration)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    // The readers of all files, with the number of records before each.
+    struct Files {
+      std::vector<std::unique_ptr<io::IndexedRecordReader>> readers;
+      std::vector<int64> first_records;
+      int64 num_records = 0;
+    };
+
+    // Opens the files by their indexes, once for all iterators.
+    Status GetFiles(Env* env, std::shared_ptr<const Files>* files) const {
+      mutex_lock l(mu_);
+      if (files_ == nullptr) {
+        std::shared_ptr<Files> new_files = std::make_shared<Files>();
+        for (const string& filename : filenames_) {
+          std::unique_ptr<io::IndexedRecordReader> reader;
+          TF_RETURN_IF_ERROR(
+              io::IndexedRecordReader::Open(env, filename, &reader));
+          new_files->first_records.push_back(new_files->num_records);
+          new_files->num_records += reader->num_records();
+          new_files->readers.push_back(std::move(reader));
+        }
+        files_ = std::move(new_files);
+      }
+      *files = files_;
+      return Status::OK();
+    }
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      Iterator(const Params& params, int64 seed, int64 seed2)
+          : DatasetIterator<Dataset>(params), seed_(seed), seed2_(seed2) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(dataset()->GetFiles(ctx->env(), &files_));
+        ComputePermutationLocked();
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (position_ >= files_->num_records) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        ScheduleBatchesLocked(ctx);
+        std::shared_ptr<Batch> batch = batches_.front();
+        {
+          mutex_lock batch_l(batch->mu);
+          while (!batch->done) {
+            batch->cond_var.wait(batch_l);
+          }
+          TF_RETURN_IF_ERROR(batch->status);
+          Tensor result_tensor(ctx->allocator({}), DT_STRING, {});
+          result_tensor.scalar<string>()() =
+              std::move(batch->records[position_ - batch->begin]);
+          out_tensors->emplace_back(std::move(result_tensor));
+        }
+        if (++position_ == batch->end) {
+          batches_.pop_front();
+        }
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        // The permutation is recomputed from the seeds on restore.
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed"), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed2"), seed2_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("position"), position_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        int64 seed;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed"), &seed));
+        int64 seed2;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed2"), &seed2));
+        int64 position;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("position"), &position));
+        if (position < 0 || position > files_->num_records) {
+          return errors::InvalidArgument("Position ", position,
+                                         " is out of range of the ",
+                                         files_->num_records, " records.");
+        }
+        if (seed != seed_ || seed2 != seed2_) {
+          seed_ = seed;
+          seed2_ = seed2;
+          ComputePermutationLocked();
+        }
+        // The outstanding reads complete in the background.
+        batches_.clear();
+        position_ = position;
+        next_batch_begin_ = position;
+        return Status::OK();
+      }
+
+     private:
+      // The number of records read by one task, and the number of such
+      // tasks in flight. Records are read ahead of the one being returned
+      // so that the latency of random reads overlaps.
+      static constexpr int64 kBatchSize = 32;
+      static constexpr size_t kMaxBatchesInFlight = 8;
+
+      // The reads of the records at positions [begin, end) of the
+      // permutation.
+      struct Batch {
+        int64 begin;
+        int64 end;
+        mutex mu;
+        condition_variable cond_var;
+        bool done GUARDED_BY(mu) = false;
+        Status status GUARDED_BY(mu);
+        std::vector<string> records GUARDED_BY(mu);
+      };
+
+      // Shuffles all records with Fisher-Yates, seeded by the iterator.
+      void ComputePermutationLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_records = files_->num_records;
+        permutation_.resize(num_records);
+        for (int64 i = 0; i < num_records; ++i) {
+          permutation_[i] = i;
+        }
+        random::PhiloxRandom philox(seed_, seed2_);
+        random::SimplePhilox generator(&philox);
+        for (int64 i = num_records - 1; i > 0; --i) {
+          std::swap(permutation_[i], permutation_[generator.Uniform64(i + 1)]);
+        }
+      }
+
+      void ScheduleBatchesLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_records = files_->num_records;
+        while (batches_.size() < kMaxBatchesInFlight &&
+               next_batch_begin_ < num_records) {
+          std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+          batch->begin = next_batch_begin_;
+          batch->end = std::min(num_records, batch->begin + kBatchSize);
+          next_batch_begin_ = batch->end;
+          std::vector<int64> indices(permutation_.begin() + batch->begin,
+                                     permutation_.begin() + batch->end);
+          std::shared_ptr<const Files> files = files_;
+          (*ctx->runner())([files, indices, batch]() {
+            std::vector<string> records(indices.size());
+            Status s = ReadRecords(*files, indices, &records);
+            mutex_lock l(batch->mu);
+            batch->status = s;
+            batch->records = std::move(records);
+            batch->done = true;
+            batch->cond_var.notify_all();
+          });
+          batches_.push_back(std::move(batch));
+        }
+      }
+
+      // Reads the records of the global `indices` into `*records`, in the
+      // order of their offsets in the files.
+      static Status ReadRecords(const Files& files,
+                                const std::vector<int64>& indices,
+                                std::vector<string>* records) {
+        std::vector<size_t> order(indices.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+          order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&indices](size_t a, size_t b) {
+          return indices[a] < indices[b];
+        });
+        for (size_t i : order) {
+          const int64 index = indices[i];
+          const size_t file =
+              std::upper_bound(files.first_records.begin(),
+                               files.first_records.end(), index) -
+              files.first_records.begin() - 1;
+          TF_RETURN_IF_ERROR(files.readers[file]->ReadRecord(
+              index - files.first_records[file], &(*records)[i]));
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      int64 seed_ GUARDED_BY(mu_);
+      int64 seed2_ GUARDED_BY(mu_);
+      std::shared_ptr<const Files> files_ GUARDED_BY(mu_);
+      // The global indexes of the records, in the order they are returned.
+      std::vector<int64> permutation_ GUARDED_BY(mu_);
+      // The position in `permutation_` of the next record to return.
+      int64 position_ GUARDED_BY(mu_) = 0;
+      // The position of the first record of the next batch to schedule.
+      int64 next_batch_begin_ GUARDED_BY(mu_) = 0;
+      // The scheduled batches, the first of which holds `position_`.
+      std::deque<std::shared_ptr<Batch>> batches_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const int64 seed_;
+    const int64 seed2_;
+    const bool reshuffle_each_iteration_;
+
+    mutable mutex mu_;
+    mutable random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+    mutable random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        GUARDED_BY(mu_);
+    mutable std::shared_ptr<const Files> files_ GUARDED_BY(mu_);
+  };
+
+  bool reshuffle_each_iteration_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ShuffledTFRecordDataset").Device(DEVICE_CPU),
+                        ShuffledTFRecordDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -275,4 +275,146 @@ REGISTER_OP("LMDBDataset")
                       // stateful to inhibit constant folding.
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("ShuffledTFRecordDataset")
+    .Input("filenames: string")
+    .Input("seed: int64")
+    .Input("seed2: int64")
+    .Output("handle: variant")
+    .Attr("reshuffle_each_iteration: bool = true")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // `seed` and `seed2` must be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    })
+    .Doc(R"doc(
+Creates a dataset that emits all records of indexed TFRecord files, in an order
+drawn uniformly at random.
+
+Unlike `ShuffleDataset`, no buffer of elements is kept: a permutation of the
+indexes of all records is computed from the seeds, and the records are fetched
+by positional reads, several at a time, by the indexes of the files. The
+iterator state is just the seeds and the position in the permutation.
+
+filenames: A scalar or vector containing the names of uncompressed TFRecord
+  files with index files.
+seed: A scalar seed for the random number generator. If either seed or
+  seed2 is set to be non-zero, the random number generator is seeded
+  by the given seed.  Otherwise, a random seed is used.
+seed2: A second scalar seed to avoid seed collision.
+reshuffle_each_iteration: If true, each iterator over the dataset returns the
+  records in a different order.
+)doc");
+
+REGISTER_OP("ColumnarDataset")
+    .Input("filenames: string")
+    .Input("batch_size: int64")
+    .Input("filter_column: string")
+    .Input("filter_min: double")
+    .Input("filter_max: double")
+    .Output("handle: variant")
+    .Attr("dense_columns: list(string) >= 0")
+    .Attr("dense_types: list({float,int64,string}) >= 0")
+    .Attr("dense_shapes: list(shape) >= 0")
+    .Attr("sparse_columns: list(string) >= 0")
+    .Attr("sparse_types: list({float,int64,string}) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `filenames` must be a scalar or a vector.
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(0), 1, &unused));
+      // The other inputs must be scalars.
+      for (int i = 1; i < 5; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      return shape_inference::ScalarShape(c);
+    })
+    .Doc(R"doc(
+Creates a dataset that emits batches of the rows of columnar files.
+
+Only the chunks of the requested columns are read and decoded, and the values
+of a whole chunk are copied into the batches at once. Each dense column is
+batched into a tensor, and each sparse column into a sparse tensor, which is
+emitted as a variant vector of its indices, values and dense shape. The output
+components are sorted by column name. The last batch may be smaller.
+
+If `filter_column` is not empty, the row groups whose statistics show that no
+value of `filter_column` is in [`filter_min`, `filter_max`] are skipped. The
+other row groups are returned whole, so this only prunes the input.
+
+filenames: A scalar or vector containing the names of columnar files.
+batch_size: The number of rows in each batch.
+filter_column: The name of a numeric column to prune row groups by, or "".
+filter_min: The smallest value of `filter_column` to keep.
+filter_max: The largest value of `filter_column` to keep.
+dense_columns: The columns batched into dense tensors.
+dense_types: The types of the dense columns.
+dense_shapes: The shapes of the values of the dense columns in each row.
+sparse_columns: The columns batched into sparse tensors.
+sparse_types: The types of the sparse columns.
+)doc");
+
+REGISTER_OP("DatasetToSharedMemory")
+    .Input("input_dataset: variant")
+    .Input("path: string")
+    .Input("num_consumers: int64")
+    .Input("ring_capacity: int64")
+    .Input("broadcast: bool")
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Serves the elements of `input_dataset` to `SharedMemoryDataset`s in other
+processes on the same host.
+
+Creates a shared memory channel at `path` with one ring buffer per consumer,
+and writes the elements of `input_dataset` to the rings until the end of the
+sequence. The op blocks while the ring of the next consumer is full. Consumers
+that detach or exit are skipped, and the op stops once all of them have, or
+when the step is cancelled, e.g. by a timeout while a consumer never attaches.
+The channel is removed once every consumer has read all its elements or
+detached; a consumer that never attaches keeps it in place.
+
+input_dataset: A handle to the dataset to serve.
+path: The path of the channel, typically under /dev/shm.
+num_consumers: The number of consumer processes.
+ring_capacity: The size in bytes of the ring buffer of each consumer, which
+  must hold at least one serialized element.
+broadcast: If true, every consumer reads every element. Otherwise, the elements
+  are dealt to the consumers round robin.
+)doc");
+
+REGISTER_OP("SharedMemoryDataset")
+    .Input("path: string")
+    .Input("consumer_index: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // `path` and `consumer_index` must be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    })
+    .Doc(R"doc(
+Creates a dataset that reads the elements served by `DatasetToSharedMemory`.
+
+The iterator waits for the channel at `path` to be created and attaches to the
+ring of `consumer_index`, which only one iterator may do. The elements are
+decoded from the shared memory without going through the filesystem. The last
+consumer to finish removes the channel.
+
+path: The path of the channel.
+consumer_index: The index of the ring to read, in [0, `num_consumers`).
+)doc");
+
 }  // namespace tensorflow
@@ -0,0 +1,63 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from absl.testing import parameterized
+
+from tensorflow.contrib.data.python.ops import caching
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class CacheInMemoryTest(test.TestCase, parameterized.TestCase):
+
+  @parameterized.named_parameters(
+      ("Unbounded", 0, None),
+      ("Zlib", 0, "ZLIB"),
+      ("Spilling", 1000, None),
+      ("SpillingZlib", 1000, "ZLIB"),
+      ("SpillingEverything", 1, None),
+  )
+  def testRepeatedReads(self, memory_limit, compression_type):
+    dataset = dataset_ops.Dataset.range(100).map(
+        lambda x: (x, string_ops.as_string(x)))
+    dataset = dataset.apply(
+        caching.cache_in_memory(
+            memory_limit=memory_limit,
+            compression_type=compression_type,
+            spill_directory=self.get_temp_dir())).repeat(3)
+    next_element = dataset.make_one_shot_iterator().get_next()
+
+    with self.test_session() as sess:
+      for _ in range(3):
+        for i in range(100):
+          self.assertEqual((i, str(i).encode()), sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testInvalidArguments(self):
+    with self.assertRaises(ValueError):
+      caching.cache_in_memory(memory_limit=-1)
+    with self.assertRaises(ValueError):
+      caching.cache_in_memory(compression_type="GZIP")
+
+
+if __name__ == "__main__":
+  test.main()
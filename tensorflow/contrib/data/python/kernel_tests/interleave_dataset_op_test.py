@@ -805,6 +805,58 @@ class ParallelInterleaveDatasetTest(test.TestCase):
 
     self.assertAllEqual(results[0], results[1])
 
+  def testBufferOutputBytes(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        interleave_ops.parallel_interleave(
+            lambda x: dataset_ops.Dataset.range(10 * x, 10 * x + x),
+            cycle_length=3,
+            block_length=2,
+            buffer_output_elements=8,
+            buffer_output_bytes=16))
+    next_element = dataset.make_one_shot_iterator().get_next()
+
+    expected = self._interleave(
+        [range(10 * x, 10 * x + x) for x in range(10)], 3, 2)
+    with self.test_session() as sess:
+      for expected_element in expected:
+        self.assertEqual(expected_element, sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
+  def testMaxReordering(self):
+    straggler_event = threading.Event()
+
+    def wait_for_straggler(x):
+      if x == 0:
+        straggler_event.wait()
+      return x
+
+    def interleave_fn(x):
+      return dataset_ops.Dataset.range(10 * x, 10 * x + 3).map(
+          lambda y: script_ops.py_func(wait_for_straggler, [y], y.dtype))
+
+    dataset = dataset_ops.Dataset.range(2).apply(
+        interleave_ops.parallel_interleave(
+            interleave_fn,
+            cycle_length=2,
+            prefetch_input_elements=0,
+            max_reordering=2))
+    next_element = dataset.make_one_shot_iterator().get_next()
+
+    with self.test_session() as sess:
+      # The first input blocks, so up to two elements of the second input are
+      # produced ahead of it.
+      self.assertEqual(10, sess.run(next_element))
+      self.assertEqual(11, sess.run(next_element))
+      straggler_event.set()
+      remaining = []
+      for _ in range(4):
+        remaining.append(sess.run(next_element))
+      self.assertEqual(0, remaining[0])
+      self.assertItemsEqual([0, 1, 2, 12], remaining)
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+
 
 if __name__ == "__main__":
   test.main()
@@ -24,6 +24,8 @@ import numpy as np
 
 from tensorflow.contrib.data.python.kernel_tests import test_utils
 from tensorflow.contrib.data.python.ops import optimization
+from tensorflow.core.example import example_pb2
+from tensorflow.core.example import feature_pb2
 from tensorflow.python.client import session
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import constant_op
@@ -33,6 +35,7 @@ from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import check_ops
 from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import parsing_ops
 from tensorflow.python.platform import test
 
 
@@ -87,6 +90,56 @@ class MapVectorizationTest(test_utils.DatasetTestBase, parameterized.TestCase):
                                                      num_parallel_calls)
     self._assert_datasets_equal(unoptimized, optimized)
 
+  @parameterized.named_parameters(
+      ("Elementwise", lambda x: math_ops.exp(math_ops.to_float(x)) - 1.0),
+      ("Broadcast", lambda x: x * constant_op.constant([2, 3]) + 1),
+      ("Reshape", lambda x: array_ops.reshape(math_ops.square(x), [2, 1])),
+      # Gather has no vectorizer, so it runs in a MapDefun between the
+      # vectorized nodes.
+      ("Mixed", lambda x: math_ops.cast(
+          array_ops.gather(math_ops.abs(x) + 1, 1) * 3, dtypes.float32)),
+  )
+  def testVectorizedPipelineMatchesUnvectorized(self, map_fn):
+    # Enough elements for full batches and a partial last batch.
+    base_dataset = dataset_ops.Dataset.from_tensor_slices(
+        [[1, -2], [-3, 4], [5, 6]]).repeat(70)
+    unoptimized, optimized = self._get_test_datasets(
+        base_dataset, map_fn, num_parallel_calls=4)
+    self._assert_datasets_equal(unoptimized, optimized)
+
+  def testVectorizedParsingMatchesUnvectorized(self):
+    serialized_examples = []
+    for i in range(30):
+      raw = (np.arange(4, dtype=np.int32) + i).tobytes()
+      serialized_examples.append(
+          example_pb2.Example(
+              features=feature_pb2.Features(
+                  feature={
+                      "raw":
+                          feature_pb2.Feature(
+                              bytes_list=feature_pb2.BytesList(value=[raw])),
+                      "label":
+                          feature_pb2.Feature(
+                              int64_list=feature_pb2.Int64List(value=[i])),
+                  })).SerializeToString())
+
+    def map_fn(serialized):
+      features = parsing_ops.parse_single_example(
+          serialized, {
+              "raw": parsing_ops.FixedLenFeature([], dtypes.string),
+              "label": parsing_ops.FixedLenFeature([], dtypes.int64),
+          })
+      # The map function must have fully defined output shapes to be
+      # vectorized.
+      values = array_ops.reshape(
+          parsing_ops.decode_raw(features["raw"], dtypes.int32), [4])
+      return values, features["label"] * 2
+
+    base_dataset = dataset_ops.Dataset.from_tensor_slices(
+        serialized_examples).repeat(7)
+    unoptimized, optimized = self._get_test_datasets(base_dataset, map_fn)
+    self._assert_datasets_equal(unoptimized, optimized)
+
   def testOptimizationBadMapFn(self):
     # Test map functions that give an error
     def map_fn(x):
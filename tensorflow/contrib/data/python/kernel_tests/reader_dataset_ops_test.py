@@ -1078,5 +1078,175 @@ class MakeTFRecordDatasetTest(
       self.assertEqual(32, shape[0])
 
 
+class IndexedTFRecordDatasetTest(
+    reader_dataset_ops_test_base.TFRecordDatasetTestBase):
+
+  def testRead(self):
+    for filename in self.test_filenames:
+      readers.build_tf_record_index(filename)
+    dataset = readers.IndexedTFRecordDataset(self.test_filenames)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      for i in range(self._num_files):
+        for j in range(self._num_records):
+          self.assertEqual(self._record(i, j), sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testMissingIndex(self):
+    dataset = readers.IndexedTFRecordDataset(self.test_filenames)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.NotFoundError):
+        sess.run(get_next)
+
+  def testTruncatedFile(self):
+    with open(self.test_filenames[0], "ab") as f:
+      f.write(b"\0" * 5)
+    with self.assertRaises(errors.DataLossError):
+      readers.build_tf_record_index(self.test_filenames[0])
+
+
+class ShuffledTFRecordDatasetTest(
+    reader_dataset_ops_test_base.TFRecordDatasetTestBase):
+
+  def setUp(self):
+    super(ShuffledTFRecordDatasetTest, self).setUp()
+    for filename in self.test_filenames:
+      readers.build_tf_record_index(filename)
+    self._expected = [
+        self._record(i, j)
+        for i in range(self._num_files)
+        for j in range(self._num_records)
+    ]
+
+  def _read(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    records = []
+    with self.test_session() as sess:
+      while True:
+        try:
+          records.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          break
+    return records
+
+  def testReturnsEveryRecordOnce(self):
+    records = self._read(
+        readers.ShuffledTFRecordDataset(self.test_filenames, seed=7))
+    self.assertNotEqual(self._expected, records)
+    self.assertItemsEqual(self._expected, records)
+
+  def testFixedSeed(self):
+    dataset = readers.ShuffledTFRecordDataset(
+        self.test_filenames, seed=7, reshuffle_each_iteration=False)
+    self.assertEqual(self._read(dataset), self._read(dataset))
+    epochs = self._read(dataset.repeat(2))
+    self.assertEqual(epochs[:len(self._expected)],
+                     epochs[len(self._expected):])
+
+  def testReshuffleEachIteration(self):
+    dataset = readers.ShuffledTFRecordDataset(self.test_filenames, seed=7)
+    epochs = self._read(dataset.repeat(2))
+    first, second = epochs[:len(self._expected)], epochs[len(self._expected):]
+    self.assertNotEqual(first, second)
+    self.assertItemsEqual(first, second)
+
+
+class ColumnarDatasetTest(test.TestCase):
+
+  def setUp(self):
+    super(ColumnarDatasetTest, self).setUp()
+    self._filename = os.path.join(self.get_temp_dir(), "table.col")
+    readers.write_columnar_file(
+        self._filename, {
+            "id": np.arange(5),
+            "x": np.arange(10, dtype=np.float32).reshape([5, 2]),
+            "tags": [[b"a"], [], [b"b", b"c"], [b"d"], [b"e", b"f", b"g"]],
+            "unused": [b"u"] * 5,
+        },
+        row_group_size=2)
+
+  def _read(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    batches = []
+    with self.test_session() as sess:
+      while True:
+        try:
+          batches.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          break
+    return batches
+
+  def testDenseAndSparse(self):
+    dataset = readers.ColumnarDataset(
+        self._filename, {
+            "id": parsing_ops.FixedLenFeature([], dtypes.int64),
+            "x": parsing_ops.FixedLenFeature([2], dtypes.float32),
+            "tags": parsing_ops.VarLenFeature(dtypes.string),
+        },
+        batch_size=3)
+    self.assertEqual([None, 2], dataset.output_shapes["x"].as_list())
+    batches = self._read(dataset)
+    self.assertEqual(2, len(batches))
+    # The first batch spans two row groups.
+    self.assertAllEqual([0, 1, 2], batches[0]["id"])
+    self.assertAllEqual([[0, 1], [2, 3], [4, 5]], batches[0]["x"])
+    self.assertAllEqual([[0, 0], [2, 0], [2, 1]], batches[0]["tags"].indices)
+    self.assertAllEqual([b"a", b"b", b"c"], batches[0]["tags"].values)
+    self.assertAllEqual([3, 2], batches[0]["tags"].dense_shape)
+    self.assertAllEqual([3, 4], batches[1]["id"])
+    self.assertAllEqual([[6, 7], [8, 9]], batches[1]["x"])
+    self.assertAllEqual([b"d", b"e", b"f", b"g"], batches[1]["tags"].values)
+    self.assertAllEqual([2, 3], batches[1]["tags"].dense_shape)
+
+  def testFilter(self):
+    dataset = readers.ColumnarDataset(
+        [self._filename, self._filename],
+        {"id": parsing_ops.FixedLenFeature([], dtypes.int64)},
+        batch_size=10,
+        filter_column="id",
+        filter_range=(3, 10))
+    batches = self._read(dataset)
+    # The row group of ids 0 and 1 is skipped in both files.
+    self.assertEqual(1, len(batches))
+    self.assertAllEqual([2, 3, 4, 2, 3, 4], batches[0]["id"])
+
+  def testFilterWithNaN(self):
+    filename = os.path.join(self.get_temp_dir(), "nan.col")
+    nan = float("nan")
+    readers.write_columnar_file(
+        filename, {"v": np.array([1, nan, 2, 3, nan, nan, 10, 11],
+                                 dtype=np.float32)},
+        row_group_size=2)
+    dataset = readers.ColumnarDataset(
+        filename, {"v": parsing_ops.FixedLenFeature([], dtypes.float32)},
+        batch_size=10,
+        filter_column="v",
+        filter_range=(0, 5))
+    batches = self._read(dataset)
+    # A NaN does not hide the other values of its row group, and a row group
+    # of NaNs has no stats, so only the row group of 10 and 11 is skipped.
+    self.assertEqual(1, len(batches))
+    values = batches[0]["v"]
+    self.assertAllEqual([False, True, False, False, True, True],
+                        np.isnan(values))
+    self.assertAllEqual([1, 2, 3], values[~np.isnan(values)])
+
+  def testInvalidColumns(self):
+    for features in [{
+        "missing": parsing_ops.FixedLenFeature([], dtypes.int64)
+    }, {
+        "id": parsing_ops.FixedLenFeature([], dtypes.float32)
+    }, {
+        "tags": parsing_ops.FixedLenFeature([1], dtypes.string)
+    }]:
+      dataset = readers.ColumnarDataset(self._filename, features, batch_size=2)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        with self.assertRaises(errors.InvalidArgumentError):
+          sess.run(get_next)
+
+
 if __name__ == "__main__":
   test.main()
@@ -0,0 +1,64 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the ColumnarDataset serialization."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.contrib.data.python.kernel_tests.serialization import dataset_serialization_test_base
+from tensorflow.contrib.data.python.ops import readers
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import parsing_ops
+from tensorflow.python.platform import test
+
+
+class ColumnarDatasetSerializationTest(
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def setUp(self):
+    self._num_files = 2
+    self._num_rows = 10
+    self._filenames = []
+    for i in range(self._num_files):
+      filename = os.path.join(self.get_temp_dir(), "table.%d.col" % i)
+      ids = np.arange(i * self._num_rows, (i + 1) * self._num_rows)
+      readers.write_columnar_file(
+          filename, {
+              "id": ids,
+              "x": np.stack([ids, -ids], axis=1).astype(np.float32)
+          },
+          row_group_size=3)
+      self._filenames.append(filename)
+
+  def _build_dataset(self, batch_size):
+    return readers.ColumnarDataset(
+        self._filenames, {
+            "id": parsing_ops.FixedLenFeature([], dtypes.int64),
+            "x": parsing_ops.FixedLenFeature([2], dtypes.float32)
+        },
+        batch_size=batch_size)
+
+  def testColumnarCore(self):
+    num_outputs = self._num_files * self._num_rows // 4
+    self.run_core_tests(lambda: self._build_dataset(4),
+                        lambda: self._build_dataset(5), num_outputs)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -23,6 +23,7 @@ import zlib
 
 from tensorflow.contrib.data.python.kernel_tests import reader_dataset_ops_test_base
 from tensorflow.contrib.data.python.kernel_tests.serialization import dataset_serialization_test_base
+from tensorflow.contrib.data.python.ops import readers
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.platform import test
 
@@ -95,5 +96,21 @@ class TFRecordDatasetSerializationTest(
         lambda: self._build_iterator_graph(num_epochs * 2), num_outputs)
 
 
+  def _build_shuffled_iterator_graph(self, num_epochs, seed):
+    filenames = self._createFiles()
+    for filename in filenames:
+      readers.build_tf_record_index(filename)
+    return readers.ShuffledTFRecordDataset(
+        filenames, seed=seed).repeat(num_epochs)
+
+  def testShuffledTFRecordCore(self):
+    num_epochs = 2
+    num_outputs = num_epochs * self._num_files * self._num_records
+    self.run_core_tests(
+        lambda: self._build_shuffled_iterator_graph(num_epochs, seed=55),
+        lambda: self._build_shuffled_iterator_graph(num_epochs, seed=10),
+        num_outputs)
+
+
 if __name__ == "__main__":
   test.main()
@@ -0,0 +1,188 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for serving datasets through shared memory."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import gc
+import os
+import tempfile
+
+import numpy as np
+
+from tensorflow.contrib.data.python.ops import shared_memory
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.client import session
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+class SharedMemoryDatasetTest(test.TestCase):
+
+  def _path(self):
+    # A fresh channel for each test, as a channel whose consumers do not all
+    # attach, e.g. in `testElementLargerThanRing`, stays in place for them.
+    return os.path.join(tempfile.mkdtemp(dir=self.get_temp_dir()), "channel")
+
+  def _serve(self, path, num_elements, num_consumers, broadcast,
+             ring_capacity=None):
+    dataset = dataset_ops.Dataset.range(num_elements).map(
+        lambda x: (x, array_ops.fill([x % 5], math_ops.to_float(x))))
+    return shared_memory.serve_dataset_to_shared_memory(
+        dataset, path, num_consumers, ring_capacity=ring_capacity,
+        broadcast=broadcast)
+
+  def _read(self, sess, path, consumer_index, max_elements=None):
+    dataset = shared_memory.SharedMemoryDataset(
+        path, consumer_index, (dtypes.int64, dtypes.float32), ([], [None]))
+    next_element = dataset.make_one_shot_iterator().get_next()
+    elements = []
+    while max_elements is None or len(elements) < max_elements:
+      try:
+        elements.append(sess.run(next_element))
+      except errors.OutOfRangeError:
+        break
+    return elements
+
+  def _assertElements(self, expected_ids, elements):
+    self.assertEqual(expected_ids, [i for i, _ in elements])
+    for i, values in elements:
+      self.assertAllEqual(np.full([i % 5], i, dtype=np.float32), values)
+
+  def _run(self, num_elements, num_consumers, broadcast, ring_capacity=None):
+    path = self._path()
+    serve_op = self._serve(path, num_elements, num_consumers, broadcast,
+                           ring_capacity)
+    with self.test_session() as sess:
+      server = self.checkedThread(lambda: sess.run(serve_op))
+      server.start()
+      # The server blocks while the ring of the next consumer is full, so the
+      # consumers are read concurrently.
+      results = [None] * num_consumers
+
+      def read(consumer_index):
+        results[consumer_index] = self._read(sess, path, consumer_index)
+
+      consumers = [
+          self.checkedThread(read, args=(i,)) for i in range(num_consumers)
+      ]
+      for consumer in consumers:
+        consumer.start()
+      for consumer in consumers:
+        consumer.join()
+      server.join()
+    # The last of the server and consumers to finish removes the channel.
+    self.assertFalse(os.path.exists(path))
+    return results
+
+  def testBroadcast(self):
+    results = self._run(100, 3, broadcast=True)
+    for elements in results:
+      self._assertElements(list(range(100)), elements)
+
+  def testSharded(self):
+    results = self._run(100, 3, broadcast=False)
+    for consumer_index, elements in enumerate(results):
+      self._assertElements(list(range(consumer_index, 100, 3)), elements)
+
+  def testSmallRings(self):
+    # Each ring holds a few elements at most, so the server waits for the
+    # consumers.
+    results = self._run(1000, 2, broadcast=True, ring_capacity=512)
+    for elements in results:
+      self._assertElements(list(range(1000)), elements)
+
+  def testConsumerDetachesMidStream(self):
+    path = self._path()
+    serve_op = self._serve(path, 1000, 2, broadcast=False, ring_capacity=512)
+    with self.test_session() as sess:
+      server = self.checkedThread(lambda: sess.run(serve_op))
+      server.start()
+      results = [None, None]
+
+      def read_and_detach():
+        consumer_session = session.Session(graph=ops.Graph())
+        with consumer_session.graph.as_default():
+          results[0] = self._read(consumer_session, path, 0, max_elements=5)
+        # Deleting the session destroys the iterator, which detaches.
+        consumer_session.close()
+        del consumer_session
+        gc.collect()
+
+      def read():
+        results[1] = self._read(sess, path, 1)
+
+      consumers = [
+          self.checkedThread(read_and_detach),
+          self.checkedThread(read)
+      ]
+      for consumer in consumers:
+        consumer.start()
+      for consumer in consumers:
+        consumer.join()
+      server.join()
+    self.assertFalse(os.path.exists(path))
+
+    self._assertElements([0, 2, 4, 6, 8], results[0])
+    # Once consumer 0 detaches, the remaining shards go to consumer 1, except
+    # for the elements left in the ring of consumer 0, which are dropped.
+    ids = [i for i, _ in results[1]]
+    self._assertElements(sorted(ids), results[1])
+    self.assertTrue(set(range(1, 1000, 2)).issubset(ids))
+    self.assertIn(998, ids)
+    dropped = set(range(10, 1000)) - set(ids)
+    self.assertTrue(all(i % 2 == 0 for i in dropped))
+    # A serialized element takes more than 10 bytes of the 512 byte ring.
+    self.assertLess(len(dropped), 512 // 10)
+
+  def testServerWithoutConsumerIsCancelled(self):
+    # The ring of the consumer that never starts fills up, and the server
+    # waits for it until the step times out.
+    path = self._path()
+    serve_op = self._serve(path, 1000, 1, broadcast=False, ring_capacity=512)
+    with self.test_session() as sess:
+      with self.assertRaises(errors.DeadlineExceededError):
+        sess.run(serve_op, options=config_pb2.RunOptions(timeout_in_ms=500))
+
+  def testElementLargerThanRing(self):
+    path = self._path()
+    serve_op = self._serve(path, 10, 1, broadcast=False, ring_capacity=16)
+    with self.test_session() as sess:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "increase the ring capacity"):
+        sess.run(serve_op)
+
+  def testMismatchedTypes(self):
+    path = self._path()
+    serve_op = self._serve(path, 10, 1, broadcast=False)
+    dataset = shared_memory.SharedMemoryDataset(path, 0, dtypes.string)
+    next_element = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      server = self.checkedThread(lambda: sess.run(serve_op))
+      server.start()
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "Expected elements of 1 components"):
+        sess.run(next_element)
+      server.join()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -769,7 +769,8 @@ def map_and_batch(map_func,
     num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
         representing the number of elements to process in parallel. If not
         specified, `batch_size * num_parallel_batches` elements will be
-        processed in parallel.
+        processed in parallel. If the value `tf.contrib.data.AUTOTUNE` is
+        used, the number is chosen by the model of the input pipeline.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
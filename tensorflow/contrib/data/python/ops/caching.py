@@ -0,0 +1,103 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Memory cache dataset transformations."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_dataset_ops
+
+
+class _MemoryCacheDataset(dataset_ops.Dataset):
+  """A `Dataset` that caches elements of its input in a bounded memory cache."""
+
+  def __init__(self, input_dataset, memory_limit, compression_type,
+               spill_directory):
+    """See `cache_in_memory()` for details."""
+    super(_MemoryCacheDataset, self).__init__()
+    self._input_dataset = input_dataset
+    self._memory_limit = memory_limit
+    self._compression_type = compression_type
+    self._spill_directory = spill_directory
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.cache_dataset(
+        self._input_dataset._as_variant_tensor(),  # pylint: disable=protected-access
+        filename=ops.convert_to_tensor("", dtype=dtypes.string,
+                                       name="filename"),
+        memory_limit=self._memory_limit,
+        compression_type=self._compression_type,
+        spill_directory=self._spill_directory,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._input_dataset.output_classes
+
+  @property
+  def output_shapes(self):
+    return self._input_dataset.output_shapes
+
+  @property
+  def output_types(self):
+    return self._input_dataset.output_types
+
+
+def cache_in_memory(memory_limit=None, compression_type=None,
+                    spill_directory=None):
+  """Caches the elements of a `Dataset` in a bounded amount of memory.
+
+  Like `tf.data.Dataset.cache()`, the first iteration over the dataset reads
+  its input, and later iterations read the cached elements. The cached
+  elements can be compressed, and once they take up more than `memory_limit`
+  bytes, the following elements are spilled to a local file, which later
+  iterations read from ahead of time and in parallel:
+
+  ```python
+  dataset = dataset.map(decode_image).apply(
+      tf.contrib.data.cache_in_memory(memory_limit=8 << 30,
+                                      compression_type="SNAPPY"))
+  dataset = dataset.repeat(num_epochs)
+  ```
+
+  Args:
+    memory_limit: (Optional.) A Python integer, the number of bytes of
+      (compressed) elements to keep in memory. Defaults to no limit.
+    compression_type: (Optional.) `"SNAPPY"` or `"ZLIB"`, to compress the
+      cached elements with. Defaults to no compression.
+    spill_directory: (Optional.) The local directory to spill elements beyond
+      `memory_limit` to. Defaults to a temporary directory.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+  memory_limit = memory_limit or 0
+  if memory_limit < 0:
+    raise ValueError("`memory_limit` must be non-negative, got %d." %
+                     memory_limit)
+  compression_type = compression_type or ""
+  if compression_type not in ("", "SNAPPY", "ZLIB"):
+    raise ValueError("Unsupported `compression_type`: %r." % compression_type)
+  spill_directory = spill_directory or ""
+
+  def _apply_fn(dataset):
+    return _MemoryCacheDataset(dataset, memory_limit, compression_type,
+                               spill_directory)
+
+  return _apply_fn
@@ -37,7 +37,9 @@ def parallel_interleave(map_func,
                         block_length=1,
                         sloppy=False,
                         buffer_output_elements=None,
-                        prefetch_input_elements=None):
+                        prefetch_input_elements=None,
+                        buffer_output_bytes=None,
+                        max_reordering=None):
   """A parallel version of the `Dataset.interleave()` transformation.
 
   `parallel_interleave()` maps `map_func` across its input to produce nested
@@ -63,6 +65,17 @@ def parallel_interleave(map_func,
   WARNING: If `sloppy` is `True`, the order of produced elements is not
   deterministic.
 
+  Setting `max_reordering` is a middle ground between the two: when the nested
+  dataset whose turn it is has no element ready, up to `max_reordering`
+  elements are taken from the other nested datasets before waiting for it. This
+  hides the latency of a slow file, but the order of produced elements is then
+  not deterministic either.
+
+  The time that `get_next` spends waiting for each nested dataset is added to
+  the "parallel_interleave:input_stall_microseconds" histogram of the
+  `tf.contrib.data.StatsAggregator` of the pipeline, if any, once that dataset
+  is exhausted.
+
   Args:
     map_func: A function mapping a nested structure of tensors to a `Dataset`.
     cycle_length: The number of input `Dataset`s to interleave from in parallel.
@@ -76,6 +89,13 @@ def parallel_interleave(map_func,
       each interleaved iterator).
     prefetch_input_elements: The number of input elements to transform to
       iterators before they are needed for interleaving.
+    buffer_output_bytes: (Optional.) If set, the maximum number of bytes that
+      each iterator being interleaved buffers, in addition to the
+      `buffer_output_elements` limit. Each iterator buffers at least one
+      element.
+    max_reordering: (Optional.) If `sloppy` is false, the number of elements
+      that may be produced out of order while waiting for a nested dataset
+      whose turn it is. Defaults to 0, which keeps the order deterministic.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
@@ -84,7 +104,9 @@ def parallel_interleave(map_func,
   def _apply_fn(dataset):
     return readers.ParallelInterleaveDataset(
         dataset, map_func, cycle_length, block_length, sloppy,
-        buffer_output_elements, prefetch_input_elements)
+        buffer_output_elements, prefetch_input_elements,
+        buffer_output_bytes=buffer_output_bytes,
+        max_reordering=max_reordering)
 
   return _apply_fn
 
@@ -121,7 +121,9 @@ def parse_example_dataset(features, num_parallel_calls=1):
    features: A `dict` mapping feature keys to `FixedLenFeature`,
      `VarLenFeature`, and `SparseFeature` values.
    num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
-      representing the number of parsing processes to call in parallel.
+      representing the number of parsing processes to call in parallel. If
+      the value `tf.contrib.data.AUTOTUNE` is used, the number is chosen by
+      the model of the input pipeline.
 
   Returns:
     A dataset transformation function, which can be passed to
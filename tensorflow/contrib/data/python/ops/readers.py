@@ -19,6 +19,8 @@ from __future__ import print_function
 
 import collections
 import csv
+import struct
+import zlib
 
 import numpy as np
 
@@ -31,13 +33,18 @@ from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.data.util import convert
 from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import random_seed
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.lib.io import file_io
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import parsing_ops as core_parsing_ops
 from tensorflow.python.platform import gfile
+from tensorflow.python.util import compat
 from tensorflow.python.util import deprecation
 
 _ACCEPTABLE_CSV_TYPES = (dtypes.float32, dtypes.float64, dtypes.int32,
@@ -984,6 +991,380 @@ class SqlDataset(dataset_ops.Dataset):
     return self._output_types
 
 
+# The suffix and the magic of record index files; see
+# tensorflow/core/lib/io/record_index.h.
+_RECORD_INDEX_SUFFIX = ".idx"
+_RECORD_INDEX_MAGIC = b"TFRIDX01"
+# The sizes of the header and the footer of a TFRecord.
+_RECORD_HEADER_SIZE = 12
+_RECORD_FOOTER_SIZE = 4
+
+
+def build_tf_record_index(filename):
+  """Writes the index file of an uncompressed TFRecord file.
+
+  The index holds the offset of every record in the file, and lets an
+  `IndexedTFRecordDataset` read the file in parallel. It is written to
+  `filename + ".idx"`. Only the framing of the records is read here; their
+  checksums are verified when they are read by the dataset.
+
+  Args:
+    filename: The name of an uncompressed TFRecord file.
+
+  Raises:
+    DataLossError: If the file is truncated.
+  """
+  offsets = []
+  with gfile.GFile(filename, "rb") as f:
+    size = f.size()
+    offset = 0
+    while offset < size:
+      f.seek(offset)
+      header = f.read(_RECORD_HEADER_SIZE)
+      next_offset = size + 1
+      if len(header) == _RECORD_HEADER_SIZE:
+        length, = struct.unpack("<Q", header[:8])
+        next_offset = (
+            offset + _RECORD_HEADER_SIZE + length + _RECORD_FOOTER_SIZE)
+      if next_offset > size:
+        raise errors.DataLossError(
+            None, None, "truncated record at %d of %s" % (offset, filename))
+      offsets.append(offset)
+      offset = next_offset
+  index = _RECORD_INDEX_MAGIC + struct.pack("<%dQ" % len(offsets), *offsets)
+  file_io.atomic_write_string_to_file(filename + _RECORD_INDEX_SUFFIX, index)
+
+
+class IndexedTFRecordDataset(dataset_ops.Dataset):
+  """A `Dataset` of the records of uncompressed, indexed TFRecord files.
+
+  Unlike `tf.data.TFRecordDataset`, which reads each file sequentially, this
+  dataset splits every file into chunks of records by its index, and reads and
+  verifies several chunks in parallel, in large positional reads. The records
+  are produced in order. The index files are written by `RecordWriter` in C++,
+  or by `tf.contrib.data.build_tf_record_index()`.
+  """
+
+  def __init__(self, filenames):
+    """Creates an `IndexedTFRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+    """
+    super(IndexedTFRecordDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtypes.string, name="filenames")
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.tf_record_dataset(
+        self._filenames,
+        compression_type=constant_op.constant("", dtype=dtypes.string),
+        buffer_size=constant_op.constant(0, dtype=dtypes.int64),
+        use_index=True)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.TensorShape([])
+
+  @property
+  def output_types(self):
+    return dtypes.string
+
+
+class ShuffledTFRecordDataset(dataset_ops.Dataset):
+  """A `Dataset` of all records of indexed TFRecord files, globally shuffled.
+
+  Every iteration returns all records of all files exactly once, in an order
+  drawn uniformly at random, as with a shuffle buffer as large as the data.
+  No elements are buffered to achieve this: the order is a permutation of the
+  indexes of the records, and the records are fetched by positional reads,
+  several at a time. Memory is proportional to the number of records, not to
+  their size, and the first element is available without filling a buffer.
+
+  The files must be uncompressed and indexed; see
+  `tf.contrib.data.build_tf_record_index()`. Random reads are only fast on
+  storage that serves them well, such as local SSDs.
+  """
+
+  def __init__(self, filenames, seed=None, reshuffle_each_iteration=True):
+    """Creates a `ShuffledTFRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+        random seed that will be used to create the permutation. See
+        `tf.set_random_seed` for behavior.
+      reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+        that the records should be returned in a different order each time
+        the dataset is iterated over.
+    """
+    super(ShuffledTFRecordDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtypes.string, name="filenames")
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    self._reshuffle_each_iteration = reshuffle_each_iteration
+
+  def _as_variant_tensor(self):
+    return contrib_gen_dataset_ops.shuffled_tf_record_dataset(
+        self._filenames,
+        seed=self._seed,
+        seed2=self._seed2,
+        reshuffle_each_iteration=self._reshuffle_each_iteration)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.TensorShape([])
+
+  @property
+  def output_types(self):
+    return dtypes.string
+
+
+# The format of columnar files; see
+# tensorflow/contrib/data/kernels/columnar_file.h.
+_COLUMNAR_FILE_MAGIC = b"TFCOL001"
+
+
+def _varint(value):
+  """Encodes a non-negative integer as a varint."""
+  encoded = bytearray()
+  while value >= 0x80:
+    encoded.append((value & 0x7f) | 0x80)
+    value >>= 7
+  encoded.append(value)
+  return bytes(encoded)
+
+
+def _columnar_column(name, values):
+  """Returns the type, the values per row and the rows of a column."""
+  rows = [np.asarray(row).reshape([-1]) for row in values]
+  lengths = set(len(row) for row in rows)
+  # Empty rows have no type of their own.
+  typed_rows = [row for row in rows if row.size]
+  all_values = np.concatenate(typed_rows) if typed_rows else np.asarray(values)
+  if all_values.dtype.kind in "biu":
+    dtype = dtypes.int64
+    rows = [row.astype("<i8") for row in rows]
+  elif all_values.dtype.kind == "f":
+    dtype = dtypes.float32
+    rows = [row.astype("<f4") for row in rows]
+  elif all_values.dtype.kind in "SUO":
+    dtype = dtypes.string
+  else:
+    raise TypeError("Column %s has unsupported type %s" %
+                    (name, all_values.dtype))
+  values_per_row = lengths.pop() if len(lengths) == 1 else 0
+  return dtype, values_per_row, rows
+
+
+def _columnar_chunk(dtype, values_per_row, rows):
+  """Returns the uncompressed chunk of `rows` and the stats of its values."""
+  parts = []
+  if not values_per_row:
+    parts.extend(_varint(len(row)) for row in rows)
+  stats = None
+  if dtype == dtypes.string:
+    for row in rows:
+      for value in row:
+        value = compat.as_bytes(value)
+        parts.append(_varint(len(value)))
+        parts.append(value)
+  else:
+    values = np.concatenate(rows) if rows else np.zeros([0])
+    parts.append(values.tobytes())
+    # NaNs match no filter range, so they are left out of the stats; a chunk
+    # of NaNs only has no stats and is never skipped.
+    if dtype == dtypes.float32:
+      values = values[~np.isnan(values)]
+    if values.size:
+      stats = (float(values.min()), float(values.max()))
+  return b"".join(parts), stats
+
+
+def write_columnar_file(filename, columns, row_group_size=1024,
+                        compress=True):
+  """Writes a table to a columnar file, to be read by `ColumnarDataset`.
+
+  Each column is given by the values of its rows. A row of a column holds a
+  scalar or a list of values. If all rows of a column have the same number of
+  values, the column can be read as a dense tensor; otherwise it can only be
+  read as a sparse tensor. Integer columns are stored as `tf.int64`, floating
+  point columns as `tf.float32` and string columns as `tf.string`.
+
+  The rows are stored in row groups of `row_group_size` rows, in which each
+  column is compressed separately, with the minimum and the maximum of the
+  values of numeric columns.
+
+  Args:
+    filename: The name of the file to write.
+    columns: A `dict` mapping column names to sequences of rows, such as
+      numpy arrays, which must all have the same length.
+    row_group_size: (Optional.) The number of rows in each row group.
+    compress: (Optional.) Whether to compress the chunks with zlib.
+
+  Raises:
+    ValueError: If the columns do not have the same number of rows.
+    TypeError: If a column has an unsupported type.
+  """
+  names = sorted(columns)
+  specs = [_columnar_column(name, columns[name]) for name in names]
+  num_rows = set(len(rows) for _, _, rows in specs)
+  if len(num_rows) > 1:
+    raise ValueError("All columns must have the same number of rows.")
+  num_rows = num_rows.pop() if num_rows else 0
+
+  data = [_COLUMNAR_FILE_MAGIC]
+  offset = len(_COLUMNAR_FILE_MAGIC)
+  footer = [_varint(len(names))]
+  for name, (dtype, values_per_row, _) in zip(names, specs):
+    name = compat.as_bytes(name)
+    footer.extend([
+        _varint(len(name)), name,
+        _varint(dtype.as_datatype_enum),
+        _varint(values_per_row)
+    ])
+  row_groups = range(0, num_rows, row_group_size)
+  footer.append(_varint(len(row_groups)))
+  for begin in row_groups:
+    end = min(begin + row_group_size, num_rows)
+    footer.append(_varint(end - begin))
+    for dtype, values_per_row, rows in specs:
+      chunk, stats = _columnar_chunk(dtype, values_per_row, rows[begin:end])
+      stored = zlib.compress(chunk) if compress else chunk
+      data.append(stored)
+      footer.extend([
+          _varint(offset), _varint(len(stored)),
+          b"\x01" if compress else b"\x00",
+          _varint(len(chunk)),
+          b"\x00" if stats is None else b"\x01" + struct.pack("<2d", *stats)
+      ])
+      offset += len(stored)
+  footer = b"".join(footer)
+  data.extend([footer, struct.pack("<I", len(footer)), _COLUMNAR_FILE_MAGIC])
+  file_io.atomic_write_string_to_file(filename, b"".join(data))
+
+
+class ColumnarDataset(dataset_ops.Dataset):
+  """A `Dataset` of batches of the rows of columnar files.
+
+  A columnar file stores each column of each group of rows separately, so
+  that only the requested columns are read and decoded, a whole chunk of
+  values at a time, rather than whole rows. The files are written by
+  `tf.contrib.data.write_columnar_file()`.
+
+  Each element is a `dict` mapping the name of each requested column to a
+  batch of its values: a `tf.Tensor` for a `tf.FixedLenFeature` and a
+  `tf.SparseTensor` for a `tf.VarLenFeature`.
+
+  Row groups can be pruned by the statistics of a numeric column: with
+  `filter_column="a"` and `filter_range=(0, 10)`, a row group is skipped if
+  the statistics show that none of its values of column "a" are in [0, 10].
+  The other row groups are returned whole, so the filter should be applied
+  again with `Dataset.filter()` if only the matching rows are wanted.
+  """
+
+  def __init__(self,
+               filenames,
+               features,
+               batch_size,
+               filter_column=None,
+               filter_range=None):
+    """Creates a `ColumnarDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      features: A `dict` mapping column names to `FixedLenFeature` or
+        `VarLenFeature` values. The shape of a `FixedLenFeature` is the shape
+        of the values of the column in each row; it has no default value.
+      batch_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
+        rows in each batch. The last batch may be smaller.
+      filter_column: (Optional.) The name of a numeric column, whose chunk
+        statistics are used to skip row groups.
+      filter_range: (Optional.) A pair of the smallest and the largest values
+        of `filter_column` to keep.
+
+    Raises:
+      ValueError: If a `FixedLenFeature` has a default value.
+      TypeError: If a feature is not a `FixedLenFeature` or a `VarLenFeature`.
+    """
+    super(ColumnarDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtypes.string, name="filenames")
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtypes.int64, name="batch_size")
+    self._filter_column = ops.convert_to_tensor(
+        filter_column or "", dtypes.string, name="filter_column")
+    filter_min, filter_max = filter_range or (-np.inf, np.inf)
+    self._filter_min = ops.convert_to_tensor(
+        filter_min, dtypes.float64, name="filter_min")
+    self._filter_max = ops.convert_to_tensor(
+        filter_max, dtypes.float64, name="filter_max")
+
+    self._dense_columns = []
+    self._dense_types = []
+    self._dense_shapes = []
+    self._sparse_columns = []
+    self._sparse_types = []
+    self._output_classes = {}
+    self._output_shapes = {}
+    self._output_types = {}
+    for name in sorted(features):
+      feature = features[name]
+      if isinstance(feature, core_parsing_ops.FixedLenFeature):
+        if feature.default_value is not None:
+          raise ValueError("Column %s cannot have a default value." % name)
+        shape = tensor_shape.as_shape(feature.shape)
+        self._dense_columns.append(name)
+        self._dense_types.append(feature.dtype)
+        self._dense_shapes.append(shape)
+        self._output_classes[name] = ops.Tensor
+        self._output_shapes[name] = tensor_shape.TensorShape(
+            [None]).concatenate(shape)
+      elif isinstance(feature, core_parsing_ops.VarLenFeature):
+        self._sparse_columns.append(name)
+        self._sparse_types.append(feature.dtype)
+        self._output_classes[name] = sparse_tensor.SparseTensor
+        self._output_shapes[name] = tensor_shape.TensorShape([None, None])
+      else:
+        raise TypeError("Column %s must be a FixedLenFeature or a "
+                        "VarLenFeature, but is %s." % (name, feature))
+      self._output_types[name] = feature.dtype
+
+  def _as_variant_tensor(self):
+    return contrib_gen_dataset_ops.columnar_dataset(
+        self._filenames,
+        self._batch_size,
+        self._filter_column,
+        self._filter_min,
+        self._filter_max,
+        dense_columns=self._dense_columns,
+        dense_types=self._dense_types,
+        dense_shapes=self._dense_shapes,
+        sparse_columns=self._sparse_columns,
+        sparse_types=self._sparse_types,
+        **dataset_ops.flat_structure(self))
+
+  @property
+  def output_classes(self):
+    return self._output_classes
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
 class LMDBDataset(dataset_ops.Dataset):
   """A LMDB Dataset that reads the lmdb file."""
 
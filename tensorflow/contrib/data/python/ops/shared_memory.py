@@ -0,0 +1,151 @@
+# Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Sharing the elements of a dataset between processes on the same host."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.data.python.ops import contrib_op_loader  # pylint: disable=unused-import
+from tensorflow.contrib.data.python.ops import gen_dataset_ops
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import nest
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_shape
+
+# The default size in bytes of the ring buffer of each consumer.
+_DEFAULT_RING_CAPACITY = 64 * 1024 * 1024
+
+
+def serve_dataset_to_shared_memory(dataset,
+                                   path,
+                                   num_consumers,
+                                   ring_capacity=None,
+                                   broadcast=False):
+  """Returns a `tf.Operation` that serves a dataset through shared memory.
+
+  When several training processes on the same host run the same input
+  pipeline, the pipeline can instead run once in a server process, and each
+  training process reads its elements with a `SharedMemoryDataset`:
+
+  ```python
+  # In the server process.
+  dataset = tf.data.TFRecordDataset(filenames).map(parse).batch(32)
+  serve_op = tf.contrib.data.serve_dataset_to_shared_memory(
+      dataset, "/dev/shm/input", num_consumers=4)
+  sess.run(serve_op)  # Returns once all elements have been served.
+
+  # In consumer process `i`.
+  dataset = tf.contrib.data.SharedMemoryDataset(
+      "/dev/shm/input", i, output_types, output_shapes)
+  ```
+
+  The elements are copied into one ring buffer per consumer, from which the
+  consumers decode them without going through the filesystem. The server
+  blocks while the buffer of the next consumer is full, and skips the
+  consumers that have exited. Since a consumer that never starts leaves its
+  buffer full, run the server with a timeout (`tf.RunOptions.timeout_in_ms`)
+  if that can happen. The channel file is removed once every consumer
+  has read all its elements or detached, so that the consumers of a later run
+  wait for a new server; a consumer that never attaches keeps the file, and its
+  elements, in place. This is only supported on POSIX systems.
+
+  Args:
+    dataset: A `tf.data.Dataset` whose elements are dense tensors.
+    path: A `tf.string` scalar, the path of the shared memory channel. It
+      should be on a memory filesystem such as /dev/shm.
+    num_consumers: A `tf.int64` scalar, the number of consumer processes.
+    ring_capacity: (Optional.) A `tf.int64` scalar, the size in bytes of the
+      buffer of each consumer, which must hold at least one serialized element.
+      Defaults to 64MB.
+    broadcast: (Optional.) A `tf.bool` scalar. If true, every consumer reads
+      every element; otherwise, the elements are dealt to the consumers round
+      robin, so that each reads a disjoint shard. Defaults to false.
+
+  Returns:
+    A `tf.Operation` that, when run, serves the elements of `dataset`.
+
+  Raises:
+    TypeError: If `dataset` is not a `tf.data.Dataset` of dense tensors.
+  """
+  if not isinstance(dataset, dataset_ops.Dataset):
+    raise TypeError("`dataset` must be a `tf.data.Dataset` object.")
+  for output_class in nest.flatten(dataset.output_classes):
+    if output_class is not ops.Tensor:
+      raise TypeError(
+          "`dataset` must produce dense tensors whereas it produces {0}".format(
+              dataset.output_classes))
+  if ring_capacity is None:
+    ring_capacity = _DEFAULT_RING_CAPACITY
+  return gen_dataset_ops.dataset_to_shared_memory(
+      dataset._as_variant_tensor(),  # pylint: disable=protected-access
+      ops.convert_to_tensor(path, dtypes.string, name="path"),
+      ops.convert_to_tensor(num_consumers, dtypes.int64, name="num_consumers"),
+      ops.convert_to_tensor(ring_capacity, dtypes.int64, name="ring_capacity"),
+      ops.convert_to_tensor(broadcast, dtypes.bool, name="broadcast"))
+
+
+class SharedMemoryDataset(dataset_ops.Dataset):
+  """A `Dataset` of the elements served by another process.
+
+  See `tf.contrib.data.serve_dataset_to_shared_memory`.
+  """
+
+  def __init__(self, path, consumer_index, output_types, output_shapes=None):
+    """Creates a `SharedMemoryDataset`.
+
+    Each iterator waits for the server to create the channel, and attaches to
+    the buffer of `consumer_index`, which only one iterator may do at a time.
+    The iterators cannot be checkpointed.
+
+    Args:
+      path: A `tf.string` scalar, the path of the shared memory channel.
+      consumer_index: A `tf.int64` scalar, the index of this consumer, in
+        `[0, num_consumers)`.
+      output_types: A nested structure of `tf.DType` objects, the types of the
+        components of the served elements.
+      output_shapes: (Optional.) A nested structure of `tf.TensorShape` objects
+        matching `output_types`. Defaults to unknown shapes.
+    """
+    super(SharedMemoryDataset, self).__init__()
+    self._path = ops.convert_to_tensor(path, dtypes.string, name="path")
+    self._consumer_index = ops.convert_to_tensor(
+        consumer_index, dtypes.int64, name="consumer_index")
+    self._output_types = nest.map_structure(dtypes.as_dtype, output_types)
+    if output_shapes is None:
+      self._output_shapes = nest.map_structure(
+          lambda _: tensor_shape.TensorShape(None), self._output_types)
+    else:
+      self._output_shapes = nest.map_structure_up_to(
+          self._output_types, tensor_shape.as_shape, output_shapes)
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.shared_memory_dataset(
+        self._path,
+        self._consumer_index,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_classes(self):
+    return nest.map_structure(lambda _: ops.Tensor, self._output_types)
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
@@ -337,21 +337,32 @@ def gen_zipped_test_file(name, file):
         srcs = [file],
     )
 
-def gen_selected_ops(name, model):
+def gen_selected_ops(name, model = None, models = [], kernel_variant = ""):
     """Generate the library that includes only used ops.
 
     Args:
       name: Name of the generated library.
       model: TFLite model to interpret.
+      models: Additional TFLite models; the union of their ops is registered.
+      kernel_variant: Kernel variant to register for the ops which have one:
+        "reference", "generic_optimized" or "neon_optimized". Empty keeps the
+        variants picked by BuiltinOpResolver.
     """
     out = name + "_registration.cc"
     tool = "//tensorflow/contrib/lite/tools:generate_op_registrations"
     tflite_path = "//tensorflow/contrib/lite"
+    all_models = ([model] if model else []) + models
     native.genrule(
         name = name,
-        srcs = [model],
+        srcs = all_models,
         outs = [out],
-        cmd = ("$(location %s) --input_model=$(location %s) --output_registration=$(location %s) --tflite_path=%s") %
-              (tool, model, out, tflite_path[2:]),
+        cmd = ("$(location %s) --input_models=%s --output_registration=$(location %s) --kernel_variant=%s --tflite_path=%s") %
+              (
+                  tool,
+                  ",".join(["$(location %s)" % m for m in all_models]),
+                  out,
+                  kernel_variant,
+                  tflite_path[2:],
+              ),
         tools = [tool],
     )
@@ -17,6 +17,153 @@ limitations under the License.
 #include <stdio.h>
 #include <string.h>
 
+// Allocations from the static region are aligned to this many bytes.
+#define TFLITE_STATIC_ARENA_ALIGNMENT 16
+
+// Each allocation from the static region is preceded by a header, padded to
+// the alignment, that records the size of the whole block. Blocks tile the
+// region from its beginning up to `static_arena_top`.
+typedef union {
+  struct {
+    size_t size;
+    bool free;
+  } block;
+  char padding[TFLITE_STATIC_ARENA_ALIGNMENT];
+} TfLiteStaticArenaHeader;
+
+#ifdef TFLITE_STATIC_ARENA_SIZE
+static TfLiteStaticArenaHeader static_arena_buffer
+    [(TFLITE_STATIC_ARENA_SIZE + sizeof(TfLiteStaticArenaHeader) - 1) /
+     sizeof(TfLiteStaticArenaHeader)];
+static char* static_arena_begin = (char*)static_arena_buffer;
+static char* static_arena_end =
+    (char*)static_arena_buffer + TFLITE_STATIC_ARENA_SIZE;
+static char* static_arena_top = (char*)static_arena_buffer;
+#else
+static char* static_arena_begin = NULL;
+static char* static_arena_end = NULL;
+static char* static_arena_top = NULL;
+#endif
+static bool static_arena_exhausted = false;
+
+static size_t TfLiteStaticArenaRoundUp(size_t size) {
+  return (size + TFLITE_STATIC_ARENA_ALIGNMENT - 1) &
+         ~(size_t)(TFLITE_STATIC_ARENA_ALIGNMENT - 1);
+}
+
+void TfLiteStaticArenaInit(void* buffer, size_t size) {
+  static_arena_begin = NULL;
+  static_arena_end = NULL;
+  if (buffer) {
+    uintptr_t begin = (uintptr_t)buffer;
+    uintptr_t aligned = TfLiteStaticArenaRoundUp(begin);
+    static_arena_begin = (char*)aligned;
+    static_arena_end = (char*)buffer + size;
+    if (aligned - begin > size) static_arena_end = static_arena_begin;
+  }
+  static_arena_top = static_arena_begin;
+  static_arena_exhausted = false;
+}
+
+size_t TfLiteStaticArenaUsedBytes(void) {
+  return static_arena_top - static_arena_begin;
+}
+
+bool TfLiteStaticArenaExhausted(void) { return static_arena_exhausted; }
+
+static bool TfLiteStaticArenaOwns(const void* ptr) {
+  return (const char*)ptr >= static_arena_begin &&
+         (const char*)ptr < static_arena_end;
+}
+
+// Returns the first free block of at least `size` bytes, merging adjacent
+// free blocks on the way, and splits off the rest of the block if it can hold
+// another allocation. Returns NULL if there is none below the top.
+static TfLiteStaticArenaHeader* TfLiteStaticArenaFindFree(size_t size) {
+  char* p = static_arena_begin;
+  while (p < static_arena_top) {
+    TfLiteStaticArenaHeader* header = (TfLiteStaticArenaHeader*)p;
+    if (header->block.free) {
+      char* next = p + header->block.size;
+      while (next < static_arena_top &&
+             ((TfLiteStaticArenaHeader*)next)->block.free) {
+        header->block.size += ((TfLiteStaticArenaHeader*)next)->block.size;
+        next = p + header->block.size;
+      }
+      if (header->block.size >= size) {
+        size_t rest = header->block.size - size;
+        if (rest >= sizeof(TfLiteStaticArenaHeader) +
+                        TFLITE_STATIC_ARENA_ALIGNMENT) {
+          TfLiteStaticArenaHeader* split =
+              (TfLiteStaticArenaHeader*)(p + size);
+          split->block.size = rest;
+          split->block.free = true;
+          header->block.size = size;
+        }
+        return header;
+      }
+    }
+    p += header->block.size;
+  }
+  return NULL;
+}
+
+void* TfLiteMalloc(size_t size) {
+  if (!static_arena_begin) return malloc(size);
+  size_t capacity = static_arena_end - static_arena_begin;
+  size_t block_size =
+      size > capacity
+          ? capacity + 1
+          : TfLiteStaticArenaRoundUp(size) + sizeof(TfLiteStaticArenaHeader);
+  TfLiteStaticArenaHeader* header = TfLiteStaticArenaFindFree(block_size);
+  if (!header) {
+    if (block_size > (size_t)(static_arena_end - static_arena_top)) {
+      static_arena_exhausted = true;
+#ifdef TFLITE_STATIC_ARENA
+      fprintf(stderr,
+              "TF Lite static arena exhausted: %u bytes requested, %u of %u "
+              "bytes used.\n",
+              (unsigned)size, (unsigned)TfLiteStaticArenaUsedBytes(),
+              (unsigned)capacity);
+      abort();
+#endif
+      return NULL;
+    }
+    header = (TfLiteStaticArenaHeader*)static_arena_top;
+    header->block.size = block_size;
+    static_arena_top += block_size;
+  }
+  header->block.free = false;
+  return header + 1;
+}
+
+void TfLiteFree(void* ptr) {
+  if (!ptr) return;
+  if (!TfLiteStaticArenaOwns(ptr)) {
+    free(ptr);
+    return;
+  }
+  // Blocks freed below the top are reused by later allocations of the same or
+  // a smaller size; freeing the topmost block also lowers the top past any
+  // free blocks below it, so that allocations repeated on every Invoke() or
+  // resize keep the used size constant.
+  TfLiteStaticArenaHeader* header = (TfLiteStaticArenaHeader*)ptr - 1;
+  header->block.free = true;
+  if ((char*)header + header->block.size != static_arena_top) return;
+  char* free_run = NULL;
+  char* p = static_arena_begin;
+  while (p < static_arena_top) {
+    TfLiteStaticArenaHeader* block = (TfLiteStaticArenaHeader*)p;
+    if (!block->block.free) {
+      free_run = NULL;
+    } else if (!free_run) {
+      free_run = p;
+    }
+    p += block->block.size;
+  }
+  static_arena_top = free_run;
+}
+
 int TfLiteIntArrayGetSizeInBytes(int size) {
   static TfLiteIntArray dummy;
   return sizeof(dummy) + sizeof(dummy.data[0]) * size;
@@ -24,8 +171,8 @@ int TfLiteIntArrayGetSizeInBytes(int size) {
 
 TfLiteIntArray* TfLiteIntArrayCreate(int size) {
   TfLiteIntArray* ret =
-      (TfLiteIntArray*)malloc(TfLiteIntArrayGetSizeInBytes(size));
-  ret->size = size;
+      (TfLiteIntArray*)TfLiteMalloc(TfLiteIntArrayGetSizeInBytes(size));
+  if (ret) ret->size = size;
   return ret;
 }
 
@@ -58,11 +205,11 @@ TfLiteIntArray* TfLiteIntArrayCopy(TfLiteIntArray* src) {
   return ret;
 }
 
-void TfLiteIntArrayFree(TfLiteIntArray* a) { free(a); }
+void TfLiteIntArrayFree(TfLiteIntArray* a) { TfLiteFree(a); }
 
 void TfLiteTensorDataFree(TfLiteTensor* t) {
   if (t->allocation_type == kTfLiteDynamic && t->data.raw) {
-    free(t->data.raw);
+    TfLiteFree(t->data.raw);
   }
   t->data.raw = NULL;
 }
@@ -94,9 +241,17 @@ void TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor) {
     return;
   }
   if (!tensor->data.raw) {
-    tensor->data.raw = (char*) malloc(num_bytes);
+    tensor->data.raw = (char*) TfLiteMalloc(num_bytes);
   } else if (num_bytes > tensor->bytes) {
-    tensor->data.raw = (char*) realloc(tensor->data.raw, num_bytes);
+    if (static_arena_begin) {
+      // The static region has no realloc; grow by copying into a new block.
+      char* data = (char*)TfLiteMalloc(num_bytes);
+      if (data) memcpy(data, tensor->data.raw, tensor->bytes);
+      TfLiteFree(tensor->data.raw);
+      tensor->data.raw = data;
+    } else {
+      tensor->data.raw = (char*) realloc(tensor->data.raw, num_bytes);
+    }
   }
   tensor->bytes = num_bytes;
 }
@@ -68,6 +68,37 @@ typedef struct _TfLiteDelegate TfLiteDelegate;
 
 #define kOptionalTensor (-1)
 
+// Allocation entry points used by the runtime for dims arrays, op parameters,
+// dynamic tensor data and the tensor arena. By default they forward to
+// malloc() and free().
+void* TfLiteMalloc(size_t size);
+void TfLiteFree(void* ptr);
+
+// Memory-bounded mode for microcontrollers. After this call every TfLiteMalloc
+// is served from the `size` bytes at `buffer`: by the first freed block that
+// is large enough, or else by bumping the top of the region. Freeing the
+// topmost block lowers the top again, so the region does not grow when the
+// same allocations are repeated on every Invoke() or resize. Once the region
+// is exhausted, TfLiteMalloc returns NULL and TfLiteStaticArenaExhausted()
+// reports it.
+// Passing a NULL buffer goes back to the system heap; objects holding memory
+// from the previous region must be destroyed before that. Not thread-safe.
+//
+// When built with TFLITE_STATIC_ARENA, C++ operator new/delete are routed
+// through TfLiteMalloc/TfLiteFree too, which covers kernel user data and
+// std::vector storage, and an exhausted region aborts at the allocation site
+// instead of returning NULL. Defining TFLITE_STATIC_ARENA_SIZE as well
+// reserves the region as a static array, so a model that does not fit the RAM
+// fails at link time.
+void TfLiteStaticArenaInit(void* buffer, size_t size);
+
+// Number of bytes of the static region below its top, including block headers
+// and freed blocks that have not been reused yet.
+size_t TfLiteStaticArenaUsedBytes(void);
+
+// Whether a TfLiteMalloc has failed since the last TfLiteStaticArenaInit.
+bool TfLiteStaticArenaExhausted(void);
+
 // Fixed size list of integers. Used for dimensions and inputs/outputs tensor
 // indices
 typedef struct {
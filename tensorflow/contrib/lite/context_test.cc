@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/contrib/lite/context.h"
+#include <string.h>
 #include <gtest/gtest.h>
 #include "tensorflow/contrib/lite/testing/util.h"
 
@@ -66,6 +67,86 @@ TEST(IntArray, TestIntArrayEqual) {
   TfLiteIntArrayFree(d);
 }
 
+TEST(StaticArena, ServesAllocationsFromRegion) {
+  alignas(16) char buffer[256];
+  TfLiteStaticArenaInit(buffer, sizeof(buffer));
+  TfLiteIntArray* a = TfLiteIntArrayCreate(3);
+  TfLiteIntArray* b = TfLiteIntArrayCreate(5);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_GE(reinterpret_cast<char*>(a), buffer);
+  EXPECT_LT(reinterpret_cast<char*>(b), buffer + sizeof(buffer));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 16, 0);
+  EXPECT_EQ(b->size, 5);
+  // Each block has a 16 byte header, and the 16 and 24 byte arrays are padded
+  // to 16 bytes.
+  const size_t used_bytes = (16 + 16) + (16 + 32);
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), used_bytes);
+  // Freeing the topmost block lowers the top past the free blocks below it.
+  TfLiteIntArrayFree(a);
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), used_bytes);
+  TfLiteIntArrayFree(b);
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), 0);
+  EXPECT_FALSE(TfLiteStaticArenaExhausted());
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
+TEST(StaticArena, ReusesFreedBlocks) {
+  alignas(16) char buffer[256];
+  TfLiteStaticArenaInit(buffer, sizeof(buffer));
+  void* a = TfLiteMalloc(64);
+  void* b = TfLiteMalloc(16);
+  void* c = TfLiteMalloc(16);
+  const size_t used_bytes = TfLiteStaticArenaUsedBytes();
+  // A freed block is reused by an allocation of the same or a smaller size,
+  // and the rest of it is split off for the next one.
+  TfLiteFree(a);
+  EXPECT_EQ(TfLiteMalloc(64), a);
+  TfLiteFree(a);
+  void* d = TfLiteMalloc(16);
+  EXPECT_EQ(d, a);
+  void* e = TfLiteMalloc(16);
+  EXPECT_LT(e, b);
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), used_bytes);
+  // Adjacent free blocks are merged for larger allocations.
+  TfLiteFree(b);
+  TfLiteFree(d);
+  TfLiteFree(e);
+  EXPECT_EQ(TfLiteMalloc(80), a);
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), used_bytes);
+  TfLiteFree(c);
+  EXPECT_FALSE(TfLiteStaticArenaExhausted());
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
+TEST(StaticArena, ReportsExhaustion) {
+  alignas(16) char buffer[64];
+  TfLiteStaticArenaInit(buffer, sizeof(buffer));
+  EXPECT_NE(TfLiteMalloc(48), nullptr);
+  EXPECT_EQ(TfLiteIntArrayCreate(8), nullptr);
+  EXPECT_TRUE(TfLiteStaticArenaExhausted());
+  TfLiteStaticArenaInit(nullptr, 0);
+  EXPECT_FALSE(TfLiteStaticArenaExhausted());
+  EXPECT_EQ(TfLiteStaticArenaUsedBytes(), 0);
+}
+
+TEST(StaticArena, GrowsDynamicTensorsByCopying) {
+  alignas(16) char buffer[256];
+  TfLiteStaticArenaInit(buffer, sizeof(buffer));
+  TfLiteTensor t = {};
+  t.allocation_type = kTfLiteDynamic;
+  TfLiteTensorRealloc(8, &t);
+  ASSERT_NE(t.data.raw, nullptr);
+  memcpy(t.data.raw, "abcdefg", 8);
+  TfLiteTensorRealloc(32, &t);
+  ASSERT_NE(t.data.raw, nullptr);
+  EXPECT_STREQ(t.data.raw, "abcdefg");
+  EXPECT_GE(t.data.raw, buffer);
+  EXPECT_LT(t.data.raw, buffer + sizeof(buffer));
+  TfLiteTensorFree(&t);
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
 }  // namespace tflite
 
 int main(int argc, char** argv) {
@@ -0,0 +1,299 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/reference/reference_delegate.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/contrib/lite/builtin_ops.h"
+#include "tensorflow/contrib/lite/context_util.h"
+#include "tensorflow/contrib/lite/profiling/time.h"
+#include "tensorflow/contrib/lite/util.h"
+
+namespace tflite {
+namespace reference_delegate {
+namespace kernel {
+
+// A delegated partition. The replaced nodes are copied out of the interpreter
+// when the kernel is created, since GetNodeAndRegistration is only available
+// while the delegate is being prepared.
+struct OpData {
+  ReferenceDelegate* delegate;
+  int partition_index;
+  std::vector<std::pair<TfLiteNode, TfLiteRegistration>> nodes;
+  std::vector<int> inputs;
+  std::vector<int> outputs;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  const TfLiteDelegateParams* params =
+      reinterpret_cast<const TfLiteDelegateParams*>(buffer);
+  auto* op_data = new OpData;
+  op_data->delegate = static_cast<ReferenceDelegate*>(params->delegate);
+
+  std::vector<int> node_indices;
+  for (int node_index : TfLiteIntArrayView(params->nodes_to_replace)) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context->GetNodeAndRegistration(context, node_index, &node,
+                                        &registration) != kTfLiteOk) {
+      delete op_data;
+      return nullptr;
+    }
+    // The copy shares inputs, outputs, builtin_data and user_data with the
+    // original node, which keeps ownership of them. Temporaries are replaced
+    // by the kernels' Prepare, so the copy gets its own array.
+    TfLiteNode node_copy = *node;
+    node_copy.temporaries = TfLiteIntArrayCreate(0);
+    op_data->nodes.emplace_back(node_copy, *registration);
+    node_indices.push_back(node_index);
+  }
+  for (int tensor_index : TfLiteIntArrayView(params->input_tensors)) {
+    op_data->inputs.push_back(tensor_index);
+  }
+  for (int tensor_index : TfLiteIntArrayView(params->output_tensors)) {
+    op_data->outputs.push_back(tensor_index);
+  }
+  op_data->partition_index = op_data->delegate->AddPartition(node_indices);
+  return op_data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  auto* op_data = reinterpret_cast<OpData*>(buffer);
+  for (auto& node_and_registration : op_data->nodes) {
+    TfLiteIntArrayFree(node_and_registration.first.temporaries);
+  }
+  delete op_data;
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE(context, op_data != nullptr);
+
+  std::set<int> internal_tensors;
+  for (auto& node_and_registration : op_data->nodes) {
+    TfLiteNode& sub_node = node_and_registration.first;
+    const TfLiteRegistration& registration = node_and_registration.second;
+    if (registration.prepare) {
+      TF_LITE_ENSURE_STATUS(registration.prepare(context, &sub_node));
+    }
+    for (int tensor_index : TfLiteIntArrayView(sub_node.outputs)) {
+      if (std::find(op_data->outputs.begin(), op_data->outputs.end(),
+                    tensor_index) == op_data->outputs.end()) {
+        internal_tensors.insert(tensor_index);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(sub_node.temporaries)) {
+      internal_tensors.insert(tensor_index);
+    }
+  }
+
+  // Tensors produced and consumed inside the partition, and the scratch
+  // tensors of the replaced nodes, are not visible to the memory planner.
+  // Declaring them as temporaries of the delegate node gives them arena
+  // memory for as long as the partition runs.
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = ConvertVectorToTfLiteIntArray(
+      std::vector<int>(internal_tensors.begin(), internal_tensors.end()));
+  return kTfLiteOk;
+}
+
+TfLiteStatus Invoke(TfLiteContext* context, TfLiteNode* node) {
+  auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+  ReferenceDelegate* delegate = op_data->delegate;
+  ReferenceDelegate::Stats* stats = delegate->mutable_stats();
+  const uint64_t start_us = profiling::time::NowMicros();
+
+  for (int tensor_index : op_data->inputs) {
+    const TfLiteTensor& tensor = context->tensors[tensor_index];
+    // Constants would be uploaded once, and outputs of this delegate left in
+    // its memory are already there.
+    if (tensor.allocation_type == kTfLiteMmapRo ||
+        (tensor.delegate == delegate && tensor.data_is_stale)) {
+      continue;
+    }
+    std::vector<char>* buffer = delegate->GetBuffer(tensor_index);
+    buffer->resize(tensor.bytes);
+    memcpy(buffer->data(), tensor.data.raw, tensor.bytes);
+    ++stats->input_copies;
+    stats->input_copy_bytes += tensor.bytes;
+  }
+
+  for (int i = 0; i < static_cast<int>(op_data->nodes.size()); ++i) {
+    TfLiteNode& sub_node = op_data->nodes[i].first;
+    const TfLiteRegistration& registration = op_data->nodes[i].second;
+    if (registration.invoke(context, &sub_node) != kTfLiteOk) {
+      context->ReportError(context, "Node %d of delegated partition %d failed.",
+                           i, op_data->partition_index);
+      return kTfLiteError;
+    }
+  }
+
+  // The kernels ran in CPU memory, so the copy into the delegate buffer below
+  // stands for the accelerator producing its output. Without buffer handles
+  // that counts as copying the output back; with them the CPU copy is only
+  // refreshed by CopyFromBufferHandle.
+  const bool use_buffer_handles = delegate->options().use_buffer_handles;
+  for (int tensor_index : op_data->outputs) {
+    TfLiteTensor* tensor = &context->tensors[tensor_index];
+    std::vector<char>* buffer = delegate->GetBuffer(tensor_index);
+    buffer->resize(tensor->bytes);
+    memcpy(buffer->data(), tensor->data.raw, tensor->bytes);
+    if (use_buffer_handles) {
+      tensor->buffer_handle = tensor_index;
+      tensor->data_is_stale = true;
+    } else {
+      ++stats->output_copies;
+      stats->output_copy_bytes += tensor->bytes;
+    }
+  }
+
+  ReferenceDelegate::PartitionStats& partition =
+      stats->partitions[op_data->partition_index];
+  ++partition.invocations;
+  partition.total_time_us += profiling::time::NowMicros() - start_us;
+  return kTfLiteOk;
+}
+
+TfLiteRegistration GetKernel() {
+  TfLiteRegistration registration{&Init,   &Free,   &Prepare,
+                                  &Invoke, nullptr, kTfLiteBuiltinDelegate};
+  registration.custom_name = "ReferenceDelegate";
+  return registration;
+}
+
+}  // namespace kernel
+
+namespace delegate {
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  auto* reference_delegate = static_cast<ReferenceDelegate*>(delegate);
+
+  TfLiteIntArray* plan;
+  TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+
+  std::vector<int> supported_nodes;
+  for (int node_index : TfLiteIntArrayView(plan)) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+        context, node_index, &node, &registration));
+    if (node->delegate == nullptr &&
+        reference_delegate->IsSupported(*registration)) {
+      supported_nodes.push_back(node_index);
+    }
+  }
+
+  TfLiteIntArray* nodes_to_replace =
+      ConvertVectorToTfLiteIntArray(supported_nodes);
+  TfLiteStatus status = context->ReplaceSubgraphsWithDelegateKernels(
+      context, kernel::GetKernel(), nodes_to_replace, delegate);
+  TfLiteIntArrayFree(nodes_to_replace);
+  return status;
+}
+
+TfLiteStatus CopyFromBufferHandle(TfLiteContext* context,
+                                  TfLiteDelegate* delegate,
+                                  TfLiteBufferHandle buffer_handle, void* data,
+                                  size_t size) {
+  auto* reference_delegate = static_cast<ReferenceDelegate*>(delegate);
+  if (!reference_delegate->HasBuffer(buffer_handle)) {
+    context->ReportError(context, "Invalid buffer handle %d.", buffer_handle);
+    return kTfLiteError;
+  }
+  const std::vector<char>* buffer =
+      reference_delegate->GetBuffer(buffer_handle);
+  if (buffer->size() != size) {
+    context->ReportError(context,
+                         "Buffer handle %d holds %d bytes, %d requested.",
+                         buffer_handle, static_cast<int>(buffer->size()),
+                         static_cast<int>(size));
+    return kTfLiteError;
+  }
+  memcpy(data, buffer->data(), size);
+  ReferenceDelegate::Stats* stats = reference_delegate->mutable_stats();
+  ++stats->buffer_handle_syncs;
+  stats->buffer_handle_sync_bytes += size;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CopyToBufferHandle(TfLiteContext* context,
+                                TfLiteDelegate* delegate,
+                                TfLiteBufferHandle buffer_handle, void* data,
+                                size_t size) {
+  auto* reference_delegate = static_cast<ReferenceDelegate*>(delegate);
+  std::vector<char>* buffer = reference_delegate->GetBuffer(buffer_handle);
+  buffer->assign(static_cast<char*>(data), static_cast<char*>(data) + size);
+  return kTfLiteOk;
+}
+
+void FreeBufferHandle(TfLiteContext* context, TfLiteDelegate* delegate,
+                      TfLiteBufferHandle* handle) {
+  *handle = kTfLiteNullBufferHandle;
+}
+
+}  // namespace delegate
+}  // namespace reference_delegate
+
+ReferenceDelegate::ReferenceDelegate(const Options& options)
+    : TfLiteDelegate{
+          /*data_=*/nullptr,
+          /*Prepare=*/&reference_delegate::delegate::Prepare,
+          /*CopyFromBufferHandle=*/
+          &reference_delegate::delegate::CopyFromBufferHandle,
+          /*CopyToBufferHandle=*/
+          &reference_delegate::delegate::CopyToBufferHandle,
+          /*FreeBufferHandle=*/&reference_delegate::delegate::FreeBufferHandle},
+      options_(options) {}
+
+ReferenceDelegate::~ReferenceDelegate() {}
+
+void ReferenceDelegate::ResetStats() {
+  stats_.input_copies = 0;
+  stats_.input_copy_bytes = 0;
+  stats_.output_copies = 0;
+  stats_.output_copy_bytes = 0;
+  stats_.buffer_handle_syncs = 0;
+  stats_.buffer_handle_sync_bytes = 0;
+  for (PartitionStats& partition : stats_.partitions) {
+    partition.invocations = 0;
+    partition.total_time_us = 0;
+  }
+}
+
+bool ReferenceDelegate::IsSupported(
+    const TfLiteRegistration& registration) const {
+  if (registration.builtin_code == kTfLiteBuiltinDelegate) {
+    return false;
+  }
+  if (registration.builtin_code == kTfLiteBuiltinCustom) {
+    return registration.custom_name != nullptr &&
+           options_.supported_custom_ops.count(registration.custom_name) > 0;
+  }
+  if (options_.supported_builtin_ops.empty() &&
+      options_.supported_custom_ops.empty()) {
+    return true;
+  }
+  return options_.supported_builtin_ops.count(registration.builtin_code) > 0;
+}
+
+int ReferenceDelegate::AddPartition(const std::vector<int>& nodes) {
+  stats_.partitions.emplace_back();
+  stats_.partitions.back().nodes = nodes;
+  return stats_.partitions.size() - 1;
+}
+
+}  // namespace tflite
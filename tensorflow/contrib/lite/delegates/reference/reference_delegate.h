@@ -0,0 +1,121 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CONTRIB_LITE_DELEGATES_REFERENCE_REFERENCE_DELEGATE_H_
+#define TENSORFLOW_CONTRIB_LITE_DELEGATES_REFERENCE_REFERENCE_DELEGATE_H_
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// WARNING: This is an experimental interface that is subject to change.
+// A delegate that claims a configurable set of ops and runs them on the CPU
+// with the kernels they were registered with, while behaving like an
+// accelerator with its own memory at the partition boundaries. It runs on any
+// platform, which makes it possible to measure how a graph gets partitioned
+// and what the partitioning costs (boundary copies, buffer handle syncs and
+// time spent per partition) without an actual accelerator.
+//
+// The interpreter must be destructed before the delegate. This delegate may
+// be used with several interpreters, but not concurrently.
+//
+// Usage:
+//   ReferenceDelegate::Options options;
+//   options.supported_builtin_ops = {BuiltinOperator_CONV_2D,
+//                                    BuiltinOperator_ADD};
+//   ReferenceDelegate delegate(options);
+//   interpreter->ModifyGraphWithDelegate(&delegate);
+//   ... run inference ...
+//   const ReferenceDelegate::Stats& stats = delegate.stats();
+class ReferenceDelegate : public TfLiteDelegate {
+ public:
+  struct Options {
+    // Builtin operators (BuiltinOperator values) claimed by the delegate. If
+    // both this and supported_custom_ops are empty, every builtin op is
+    // claimed.
+    std::set<int> supported_builtin_ops;
+    // Custom operators claimed by the delegate, by name.
+    std::set<std::string> supported_custom_ops;
+    // If true, the outputs of a partition stay in delegate memory: the
+    // tensors are marked stale and consumers outside the delegate read them
+    // through CopyFromBufferHandle, as they would with a real accelerator.
+    // Otherwise every output is copied back to the CPU as soon as the
+    // partition finishes.
+    bool use_buffer_handles = false;
+  };
+
+  struct PartitionStats {
+    // Indices of the original nodes replaced by this partition.
+    std::vector<int> nodes;
+    int64_t invocations = 0;
+    // Time spent in the partition, including its boundary copies.
+    int64_t total_time_us = 0;
+  };
+
+  struct Stats {
+    // Copies of non-constant tensors into the delegate at the input boundary
+    // of a partition, and their total size.
+    int64_t input_copies = 0;
+    int64_t input_copy_bytes = 0;
+    // Copies of partition outputs back to the CPU when buffer handles are not
+    // in use, and their total size.
+    int64_t output_copies = 0;
+    int64_t output_copy_bytes = 0;
+    // Number and size of CopyFromBufferHandle calls, i.e. of stale tensors
+    // made readable through EnsureTensorDataIsReadable.
+    int64_t buffer_handle_syncs = 0;
+    int64_t buffer_handle_sync_bytes = 0;
+    // One entry per delegated partition, in creation order.
+    std::vector<PartitionStats> partitions;
+  };
+
+  explicit ReferenceDelegate(const Options& options);
+  ~ReferenceDelegate();
+
+  const Options& options() const { return options_; }
+  const Stats& stats() const { return stats_; }
+  // Clears all counters, keeping the list of partitions.
+  void ResetStats();
+
+  // Returns whether the delegate claims the given op.
+  bool IsSupported(const TfLiteRegistration& registration) const;
+
+  // Used by the delegate kernels. Registers a new partition and returns its
+  // index in stats().partitions.
+  int AddPartition(const std::vector<int>& nodes);
+  Stats* mutable_stats() { return &stats_; }
+  // Delegate memory for a tensor, keyed by tensor index, which is also used
+  // as its buffer handle.
+  std::vector<char>* GetBuffer(int tensor_index) {
+    return &buffers_[tensor_index];
+  }
+  bool HasBuffer(int tensor_index) const {
+    return buffers_.count(tensor_index) > 0;
+  }
+
+ private:
+  Options options_;
+  Stats stats_;
+  std::map<int, std::vector<char>> buffers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_CONTRIB_LITE_DELEGATES_REFERENCE_REFERENCE_DELEGATE_H_
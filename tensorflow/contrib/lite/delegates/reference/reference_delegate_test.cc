@@ -0,0 +1,176 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/delegates/reference/reference_delegate.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/register.h"
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+// Builds the graph
+//   t2 = t0 + t1; t3 = t2 * t1; t4 = t3 + t1
+// over float tensors of shape [2].
+class ReferenceDelegateTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    interpreter_.reset(new Interpreter);
+    ASSERT_EQ(interpreter_->AddTensors(5), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetInputs({0, 1}), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetOutputs({4}), kTfLiteOk);
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_EQ(interpreter_->SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {2}, TfLiteQuantizationParams()),
+                kTfLiteOk);
+    }
+    const TfLiteRegistration* add =
+        resolver_.FindOp(BuiltinOperator_ADD, /*version=*/1);
+    const TfLiteRegistration* mul =
+        resolver_.FindOp(BuiltinOperator_MUL, /*version=*/1);
+    AddNode({0, 1}, {2}, add);
+    AddNode({2, 1}, {3}, mul);
+    AddNode({3, 1}, {4}, add);
+  }
+
+  void AddNode(const std::vector<int>& inputs, const std::vector<int>& outputs,
+               const TfLiteRegistration* registration) {
+    // Add and Mul share the layout of their builtin parameters.
+    auto* params =
+        reinterpret_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    ASSERT_EQ(interpreter_->AddNodeWithParameters(inputs, outputs, nullptr, 0,
+                                                  params, registration),
+              kTfLiteOk);
+  }
+
+  std::vector<float> Run() {
+    float* input0 = interpreter_->typed_tensor<float>(0);
+    float* input1 = interpreter_->typed_tensor<float>(1);
+    input0[0] = 1.f;
+    input0[1] = 2.f;
+    input1[0] = 3.f;
+    input1[1] = 4.f;
+    EXPECT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    const float* output = interpreter_->typed_tensor<float>(4);
+    return std::vector<float>(output, output + 2);
+  }
+
+  // Delegates the graph, keeping the delegate alive until after the
+  // interpreter is destroyed.
+  ReferenceDelegate* Delegate(const ReferenceDelegate::Options& options) {
+    delegate_.reset(new ReferenceDelegate(options));
+    EXPECT_EQ(interpreter_->ModifyGraphWithDelegate(delegate_.get()),
+              kTfLiteOk);
+    return delegate_.get();
+  }
+
+  ops::builtin::BuiltinOpResolver resolver_;
+  std::unique_ptr<ReferenceDelegate> delegate_;
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+TEST_F(ReferenceDelegateTest, SplitsAroundUnsupportedOps) {
+  ReferenceDelegate::Options options;
+  options.supported_builtin_ops = {BuiltinOperator_ADD};
+  ReferenceDelegate* delegate = Delegate(options);
+  ASSERT_EQ(interpreter_->execution_plan().size(), 3);
+
+  // (1 + 3) * 3 + 3 and (2 + 4) * 4 + 4.
+  EXPECT_THAT(Run(), ElementsAre(15.f, 28.f));
+
+  const ReferenceDelegate::Stats& stats = delegate->stats();
+  ASSERT_EQ(stats.partitions.size(), 2);
+  EXPECT_THAT(stats.partitions[0].nodes, ElementsAre(0));
+  EXPECT_THAT(stats.partitions[1].nodes, ElementsAre(2));
+  EXPECT_EQ(stats.partitions[0].invocations, 1);
+  EXPECT_EQ(stats.partitions[1].invocations, 1);
+  // Each partition copies both of its inputs in and its output back.
+  EXPECT_EQ(stats.input_copies, 4);
+  EXPECT_EQ(stats.input_copy_bytes, 4 * 2 * sizeof(float));
+  EXPECT_EQ(stats.output_copies, 2);
+  EXPECT_EQ(stats.output_copy_bytes, 2 * 2 * sizeof(float));
+  EXPECT_EQ(stats.buffer_handle_syncs, 0);
+}
+
+TEST_F(ReferenceDelegateTest, ClaimsConnectedOpsAsOnePartition) {
+  ReferenceDelegate* delegate = Delegate(ReferenceDelegate::Options());
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+
+  // The intermediate tensors only exist inside the partition.
+  EXPECT_THAT(Run(), ElementsAre(15.f, 28.f));
+
+  const ReferenceDelegate::Stats& stats = delegate->stats();
+  ASSERT_EQ(stats.partitions.size(), 1);
+  EXPECT_THAT(stats.partitions[0].nodes, ElementsAre(0, 1, 2));
+  EXPECT_EQ(stats.input_copies, 2);
+  EXPECT_EQ(stats.output_copies, 1);
+}
+
+TEST_F(ReferenceDelegateTest, BufferHandlesSyncOnRead) {
+  ReferenceDelegate::Options options;
+  options.supported_builtin_ops = {BuiltinOperator_ADD};
+  options.use_buffer_handles = true;
+  ReferenceDelegate* delegate = Delegate(options);
+
+  EXPECT_THAT(Run(), ElementsAre(15.f, 28.f));
+
+  const ReferenceDelegate::Stats& stats = delegate->stats();
+  EXPECT_EQ(stats.input_copies, 4);
+  EXPECT_EQ(stats.output_copies, 0);
+  // t2 is read by the Mul on the CPU, and t4 is a graph output.
+  EXPECT_EQ(stats.buffer_handle_syncs, 2);
+  EXPECT_EQ(stats.buffer_handle_sync_bytes, 2 * 2 * sizeof(float));
+}
+
+TEST_F(ReferenceDelegateTest, ResetStats) {
+  ReferenceDelegate::Options options;
+  options.supported_builtin_ops = {BuiltinOperator_MUL};
+  ReferenceDelegate* delegate = Delegate(options);
+  Run();
+  Run();
+  EXPECT_EQ(delegate->stats().partitions[0].invocations, 2);
+  EXPECT_EQ(delegate->stats().input_copies, 4);
+
+  delegate->ResetStats();
+  EXPECT_EQ(delegate->stats().input_copies, 0);
+  ASSERT_EQ(delegate->stats().partitions.size(), 1);
+  EXPECT_THAT(delegate->stats().partitions[0].nodes, ElementsAre(1));
+  EXPECT_EQ(delegate->stats().partitions[0].invocations, 0);
+}
+
+TEST_F(ReferenceDelegateTest, CustomOpsOnlyWhenListed) {
+  ReferenceDelegate::Options options;
+  options.supported_custom_ops = {"MyCustomOp"};
+  ReferenceDelegate* delegate = Delegate(options);
+  // No builtin op is claimed once a custom op list is given.
+  EXPECT_THAT(interpreter_->execution_plan(), ElementsAreArray({0, 1, 2}));
+  EXPECT_TRUE(delegate->stats().partitions.empty());
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -47,6 +47,11 @@ limitations under the License.
 
 #define LOG(x) std::cerr
 
+#ifdef TFLITE_SELECTED_OPS
+// Generated by tools/generate_op_registrations for the deployed models.
+void RegisterSelectedOps(::tflite::MutableOpResolver* resolver);
+#endif
+
 namespace tflite {
 namespace label_image {
 
@@ -434,7 +439,12 @@ void RunInference(Settings* s)
 	std::cout << "Build Model: " << time2 - time1 <<	" milliseconds\r\n";
 	model->error_reporter();
 
+#ifdef TFLITE_SELECTED_OPS
+	tflite::MutableOpResolver resolver;
+	RegisterSelectedOps(&resolver);
+#else
 	tflite::ops::builtin::BuiltinOpResolver resolver;
+#endif
 
 	tflite::InterpreterBuilder(*model, resolver)(&interpreter);
 	if (!interpreter) {
@@ -151,7 +151,7 @@ Interpreter::~Interpreter() {
     TfLiteIntArrayFree(node.inputs);
     TfLiteIntArrayFree(node.outputs);
     TfLiteIntArrayFree(node.temporaries);
-    if (node.builtin_data) free(node.builtin_data);
+    if (node.builtin_data) TfLiteFree(node.builtin_data);
     OpFree(nodeAndReg.second, node.user_data);
     node.builtin_data = nullptr;
   }
@@ -223,7 +223,7 @@ TfLiteDelegateParams* CreateDelegateParams(TfLiteDelegate* delegate,
 
   // Step 2: Allocate the memory.
   // Use `char*` for conveniently step through the allocated space by bytes.
-  char* allocation = reinterpret_cast<char*>(malloc(allocation_size));
+  char* allocation = reinterpret_cast<char*>(TfLiteMalloc(allocation_size));
 
   // Step 3: Fill all data structures structures.
   TfLiteDelegateParams* params =
@@ -449,6 +449,12 @@ TfLiteStatus Interpreter::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
+  if (TfLiteStaticArenaExhausted()) {
+    ReportError(&context_, "Static arena exhausted after %d bytes.",
+                static_cast<int>(TfLiteStaticArenaUsedBytes()));
+    return kTfLiteError;
+  }
+
   state_ = kStateInvokable;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
@@ -474,7 +480,10 @@ TfLiteStatus Interpreter::ResetVariableTensorsToZero() {
                       kTfLiteArenaRwPersistent);
     TF_LITE_ENSURE(&context_, tensor.data.raw != nullptr);
 
-    memset(tensor.data.raw, 0, tensor.bytes);
+    // Quantized tensors are reset to the value representing a real zero.
+    const int zero_value =
+        tensor.type == kTfLiteUInt8 ? tensor.params.zero_point : 0;
+    memset(tensor.data.raw, zero_value, tensor.bytes);
   }
   return kTfLiteOk;
 }
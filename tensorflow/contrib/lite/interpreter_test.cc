@@ -275,6 +275,103 @@ TEST(BasicInterpreter, CheckArenaAllocation) {
   ASSERT_EQ(interpreter.tensor(9)->data.raw, interpreter.tensor(5)->data.raw);
 }
 
+TEST(BasicInterpreter, StaticArenaAllocation) {
+  alignas(16) static char buffer[16 * 1024];
+  {
+    Interpreter interpreter;
+    ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+    TfLiteStaticArenaInit(buffer, sizeof(buffer));
+
+    TfLiteQuantizationParams quant;
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    for (int i = 0; i < 3; ++i) {
+      interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {256},
+                                               quant);
+    }
+    interpreter.SetInputs({0});
+    interpreter.SetOutputs({2});
+    interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg);
+    interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+    for (int i = 0; i < 3; ++i) {
+      char* data = interpreter.tensor(i)->data.raw;
+      ASSERT_GE(data, buffer);
+      ASSERT_LE(data + 256 * sizeof(float), buffer + sizeof(buffer));
+    }
+    EXPECT_LE(TfLiteStaticArenaUsedBytes(), sizeof(buffer));
+  }
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
+TEST(BasicInterpreter, StaticArenaTooSmall) {
+  alignas(16) static char buffer[1024];
+  {
+    Interpreter interpreter;
+    ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    for (int i = 0; i < 2; ++i) {
+      interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {1024},
+                                               quant);
+    }
+    interpreter.SetInputs({0});
+    interpreter.SetOutputs({1});
+    interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg);
+
+    TfLiteStaticArenaInit(buffer, sizeof(buffer));
+    ASSERT_NE(interpreter.AllocateTensors(), kTfLiteOk);
+  }
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
+TEST(BasicInterpreter, StaticArenaStableAcrossInvokes) {
+  alignas(16) static char buffer[16 * 1024];
+  {
+    Interpreter interpreter;
+    ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+    TfLiteStaticArenaInit(buffer, sizeof(buffer));
+
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 2; ++i) {
+      interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {256},
+                                               quant);
+    }
+    interpreter.SetInputs({0});
+    interpreter.SetOutputs({1});
+    // Resizes its dynamic output and allocates scratch memory on every call,
+    // like the kernels that build a VectorOfTensors.
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      SetTensorToDynamic(&context->tensors[node->outputs->data[0]]);
+      return kTfLiteOk;
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      void* scratch = TfLiteMalloc(100);
+      TF_LITE_ENSURE(context, scratch != nullptr);
+      TfLiteFree(scratch);
+      TF_LITE_ENSURE_STATUS(context->ResizeTensor(
+          context, output, TfLiteIntArrayCopy(input->dims)));
+      memcpy(output->data.raw, input->data.raw, input->bytes);
+      return kTfLiteOk;
+    };
+    interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg);
+
+    size_t used_bytes = 0;
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(interpreter.ResizeInputTensor(0, {256}), kTfLiteOk);
+      ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+      ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+      if (i == 0) used_bytes = TfLiteStaticArenaUsedBytes();
+      EXPECT_EQ(TfLiteStaticArenaUsedBytes(), used_bytes);
+    }
+    EXPECT_FALSE(TfLiteStaticArenaExhausted());
+  }
+  TfLiteStaticArenaInit(nullptr, 0);
+}
+
 TEST(BasicInterpreter, BufferAccess) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
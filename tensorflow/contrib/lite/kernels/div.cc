@@ -39,6 +39,14 @@ constexpr int kOutputTensor = 0;
 
 struct OpData {
   bool requires_broadcast;
+
+  // Parameters used in the quantized path: input1_scale /
+  // (input2_scale * output_scale) as a fixed-point multiplier and shift, and
+  // the activation range.
+  int32_t output_multiplier;
+  int output_shift;
+  int32_t output_activation_min;
+  int32_t output_activation_max;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -52,6 +60,7 @@ void Free(TfLiteContext* context, void* buffer) {
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  auto* params = reinterpret_cast<TfLiteDivParams*>(node->builtin_data);
   OpData* data = reinterpret_cast<OpData*>(node->user_data);
 
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 2);
@@ -64,6 +73,29 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, input1->type, input2->type);
   output->type = input2->type;
 
+  if (output->type == kTfLiteUInt8) {
+    TF_LITE_ENSURE(context, input2->params.scale > 0);
+    TF_LITE_ENSURE(context, output->params.scale > 0);
+    const double real_multiplier =
+        static_cast<double>(input1->params.scale) /
+        (static_cast<double>(input2->params.scale) * output->params.scale);
+    QuantizeMultiplier(real_multiplier, &data->output_multiplier,
+                       &data->output_shift);
+    // The quotient carries kDivQuotientFractionalBits fractional bits, which
+    // the rescaling has to shift out without overflowing either way.
+    const int shift =
+        data->output_shift - reference_ops::kDivQuotientFractionalBits;
+    if (shift > 0 || shift < -31) {
+      context->ReportError(context,
+                           "Div scale ratio %f is out of the supported range.",
+                           real_multiplier);
+      return kTfLiteError;
+    }
+    CalculateActivationRangeUint8(params->activation, output,
+                                  &data->output_activation_min,
+                                  &data->output_activation_max);
+  }
+
   data->requires_broadcast = !HaveSameShapes(input1, input2);
 
   TfLiteIntArray* output_size = nullptr;
@@ -121,6 +153,40 @@ void EvalDiv(TfLiteContext* context, TfLiteNode* node, TfLiteDivParams* params,
 #undef TF_LITE_DIV
 }
 
+template <KernelType kernel_type>
+void EvalQuantized(TfLiteContext* context, TfLiteNode* node,
+                   TfLiteDivParams* params, const OpData* data,
+                   const TfLiteTensor* input1, const TfLiteTensor* input2,
+                   TfLiteTensor* output) {
+  tflite::ArithmeticParams op_params;
+  op_params.input1_offset = -input1->params.zero_point;
+  op_params.input2_offset = -input2->params.zero_point;
+  op_params.output_offset = output->params.zero_point;
+  op_params.output_multiplier = data->output_multiplier;
+  op_params.output_shift = data->output_shift;
+  op_params.quantized_activation_min = data->output_activation_min;
+  op_params.quantized_activation_max = data->output_activation_max;
+#define TF_LITE_DIV(type, opname)                                      \
+  type::opname(op_params, GetTensorShape(input1),                      \
+               GetTensorData<uint8_t>(input1), GetTensorShape(input2), \
+               GetTensorData<uint8_t>(input2), GetTensorShape(output), \
+               GetTensorData<uint8_t>(output))
+  if (kernel_type == kReference) {
+    if (data->requires_broadcast) {
+      TF_LITE_DIV(reference_ops, BroadcastDiv4DSlow);
+    } else {
+      TF_LITE_DIV(reference_ops, Div);
+    }
+  } else {
+    if (data->requires_broadcast) {
+      TF_LITE_DIV(optimized_ops, BroadcastDiv4DSlow);
+    } else {
+      TF_LITE_DIV(optimized_ops, Div);
+    }
+  }
+#undef TF_LITE_DIV
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params = reinterpret_cast<TfLiteDivParams*>(node->builtin_data);
@@ -132,6 +198,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   if (output->type == kTfLiteFloat32 || output->type == kTfLiteInt32) {
     EvalDiv<kernel_type>(context, node, params, data, input1, input2, output);
+  } else if (output->type == kTfLiteUInt8) {
+    EvalQuantized<kernel_type>(context, node, params, data, input1, input2,
+                               output);
   } else {
     context->ReportError(
         context,
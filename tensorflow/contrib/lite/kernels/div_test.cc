@@ -59,6 +59,22 @@ class IntegerDivOpModel : public BaseDivOpModel {
   std::vector<int32_t> GetOutput() { return ExtractVector<int32_t>(output_); }
 };
 
+class QuantizedDivOpModel : public BaseDivOpModel {
+ public:
+  using BaseDivOpModel::BaseDivOpModel;
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+};
+
+// For quantized Div, the error shouldn't exceed 2*step of the output range.
+float GetTolerance(float min, float max) {
+  float kQuantizedStep = (max - min) / 255.0;
+  return 2.0 * kQuantizedStep;
+}
+
 TEST(FloatDivOpTest, NoActivation) {
   FloatDivOpModel m({TensorType_FLOAT32, {1, 2, 2, 1}},
                     {TensorType_FLOAT32, {1, 2, 2, 1}},
@@ -165,6 +181,89 @@ TEST(IntegerDivOpTest, WithBroadcast) {
   }
 }
 
+TEST(QuantizedDivOpTest, NoActivation) {
+  float kQuantizedTolerance = GetTolerance(-4.0, 4.0);
+  QuantizedDivOpModel m({TensorType_UINT8, {1, 2, 2, 1}, -2.0, 2.0},
+                        {TensorType_UINT8, {1, 2, 2, 1}, -2.0, 2.0},
+                        {TensorType_UINT8, {}, -4.0, 4.0},
+                        ActivationFunctionType_NONE);
+  m.QuantizeAndPopulate<uint8_t>(m.input1(), {-1.0, 1.0, -1.2, 1.6});
+  m.QuantizeAndPopulate<uint8_t>(m.input2(), {0.5, 1.0, -1.6, 2.0});
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(
+                  ArrayFloatNear({-2.0, 1.0, 0.75, 0.8}, kQuantizedTolerance)));
+}
+
+TEST(QuantizedDivOpTest, ActivationRELU_N1_TO_1) {
+  float kQuantizedTolerance = GetTolerance(-4.0, 4.0);
+  QuantizedDivOpModel m({TensorType_UINT8, {1, 2, 2, 1}, -2.0, 2.0},
+                        {TensorType_UINT8, {1, 2, 2, 1}, -2.0, 2.0},
+                        {TensorType_UINT8, {}, -4.0, 4.0},
+                        ActivationFunctionType_RELU_N1_TO_1);
+  m.QuantizeAndPopulate<uint8_t>(m.input1(), {-1.0, 1.0, -1.2, 1.6});
+  m.QuantizeAndPopulate<uint8_t>(m.input2(), {0.5, 1.0, -1.6, 2.0});
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(
+                  ArrayFloatNear({-1.0, 1.0, 0.75, 0.8}, kQuantizedTolerance)));
+}
+
+TEST(QuantizedDivOpTest, DivideByZeroSaturates) {
+  QuantizedDivOpModel m({TensorType_UINT8, {3}, -2.0, 2.0},
+                        {TensorType_UINT8, {3}, 0.0, 2.0},
+                        {TensorType_UINT8, {}, -4.0, 4.0},
+                        ActivationFunctionType_NONE);
+  m.QuantizeAndPopulate<uint8_t>(m.input1(), {-1.0, 1.0, 0.0});
+  m.QuantizeAndPopulate<uint8_t>(m.input2(), {0.0, 0.0, 0.0});
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-4.0, 4.0, 0.0}, GetTolerance(-4.0, 4.0))));
+}
+
+TEST(QuantizedDivOpTest, WithBroadcast) {
+  float kQuantizedTolerance = GetTolerance(-4.0, 4.0);
+  std::vector<std::vector<int>> test_shapes = {
+      {6}, {2, 3}, {2, 1, 3}, {1, 3, 1, 2}};
+  for (int i = 0; i < test_shapes.size(); ++i) {
+    QuantizedDivOpModel m({TensorType_UINT8, test_shapes[i], -2.0, 2.0},
+                          {TensorType_UINT8, {}, -2.0, 2.0},  // always a scalar
+                          {TensorType_UINT8, {}, -4.0, 4.0},
+                          ActivationFunctionType_NONE);
+    m.QuantizeAndPopulate<uint8_t>(m.input1(), {-2.0, 0.2, 0.7, 0.8, 1.1, 2.0});
+    m.QuantizeAndPopulate<uint8_t>(m.input2(), {1.0});
+    m.Invoke();
+    EXPECT_THAT(m.GetDequantizedOutput(),
+                ElementsAreArray(ArrayFloatNear(
+                    {-2.0, 0.2, 0.7, 0.8, 1.1, 2.0}, kQuantizedTolerance)))
+        << "With shape number " << i;
+  }
+}
+
+// Large enough to take the table-based path of the optimized kernel.
+TEST(QuantizedDivOpTest, LargeInput) {
+  float kQuantizedTolerance = GetTolerance(-4.0, 4.0);
+  QuantizedDivOpModel m({TensorType_UINT8, {1, 16, 16, 2}, -2.0, 2.0},
+                        {TensorType_UINT8, {1, 16, 16, 2}, -2.0, 2.0},
+                        {TensorType_UINT8, {}, -4.0, 4.0},
+                        ActivationFunctionType_NONE);
+  std::vector<float> input1;
+  std::vector<float> input2;
+  std::vector<float> expected;
+  for (int i = 0; i < 512; ++i) {
+    input1.push_back(-2.0f + (i % 64) / 16.0f);
+    input2.push_back((i % 2 ? -1.0f : 1.0f) * (0.5f + (i % 48) / 32.0f));
+    expected.push_back(
+        std::max(-4.0f, std::min(4.0f, input1.back() / input2.back())));
+  }
+  m.QuantizeAndPopulate<uint8_t>(m.input1(), input1);
+  m.QuantizeAndPopulate<uint8_t>(m.input2(), input2);
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(expected, kQuantizedTolerance)));
+}
+
 }  // namespace
 }  // namespace tflite
 
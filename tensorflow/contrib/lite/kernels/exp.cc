@@ -16,6 +16,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
@@ -26,9 +27,15 @@ namespace ops {
 namespace builtin {
 namespace exp {
 
-// This file has reference implementation of Exp.
+// This file has two implementations of Exp.
 enum KernelType {
   kReference,
+  kGenericOptimized,
+};
+
+struct OpData {
+  // Quantized result for each uint8 input value, used by the optimized kernel.
+  uint8_t lookup_table[256];
 };
 
 struct ExpContext {
@@ -40,18 +47,40 @@ struct ExpContext {
   TfLiteTensor* output;
 };
 
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  return new OpData;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 1);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
 
   ExpContext op_context(context, node);
   TfLiteIntArray* output_dims = TfLiteIntArrayCopy(op_context.input->dims);
   op_context.output->type = op_context.input->type;
+
+  if (op_context.input->type == kTfLiteUInt8) {
+    TF_LITE_ENSURE(context, op_context.output->params.scale > 0);
+    uint8_t all_inputs[256];
+    for (int i = 0; i < 256; ++i) {
+      all_inputs[i] = static_cast<uint8_t>(i);
+    }
+    reference_ops::Exp(all_inputs, 256, op_context.input->params.zero_point,
+                       op_context.input->params.scale,
+                       op_context.output->params.zero_point,
+                       op_context.output->params.scale, data->lookup_table);
+  }
   return context->ResizeTensor(context, op_context.output, output_dims);
 }
 
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
   ExpContext op_context(context, node);
 
 #define TF_LITE_EXP(kernel_type, data_type)                               \
@@ -60,17 +89,30 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                               GetTensorData<data_type>(op_context.output))
 
   // TODO(kanlig): supports half, bfloat16, float64, complex64, and complex128.
-  if (kernel_type == kReference) {
-    switch (op_context.input->type) {
-      case kTfLiteFloat32:
-        TF_LITE_EXP(reference_ops, float);
-        break;
-      default:
-        context->ReportError(context,
-                             "Type %d is currently not supported by Exp.",
-                             op_context.input->type);
-        return kTfLiteError;
-    }
+  switch (op_context.input->type) {
+    case kTfLiteFloat32:
+      TF_LITE_EXP(reference_ops, float);
+      break;
+    case kTfLiteUInt8:
+      if (kernel_type == kReference) {
+        reference_ops::Exp(GetTensorData<uint8_t>(op_context.input),
+                           NumElements(op_context.input),
+                           op_context.input->params.zero_point,
+                           op_context.input->params.scale,
+                           op_context.output->params.zero_point,
+                           op_context.output->params.scale,
+                           GetTensorData<uint8_t>(op_context.output));
+      } else {
+        optimized_ops::Exp(GetTensorData<uint8_t>(op_context.input),
+                           NumElements(op_context.input), data->lookup_table,
+                           GetTensorData<uint8_t>(op_context.output));
+      }
+      break;
+    default:
+      context->ReportError(context,
+                           "Type %d is currently not supported by Exp.",
+                           op_context.input->type);
+      return kTfLiteError;
   }
 #undef TF_LITE_EXP
   return kTfLiteOk;
@@ -79,13 +121,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace exp
 
 TfLiteRegistration* Register_EXP_REF() {
-  static TfLiteRegistration r = {nullptr, nullptr, exp::Prepare,
+  static TfLiteRegistration r = {exp::Init, exp::Free, exp::Prepare,
                                  exp::Eval<exp::kReference>};
   return &r;
 }
 
-// TODO(kanlig): add optimized implementation of Exp.
-TfLiteRegistration* Register_EXP() { return Register_EXP_REF(); }
+TfLiteRegistration* Register_EXP_GENERIC_OPT() {
+  static TfLiteRegistration r = {exp::Init, exp::Free, exp::Prepare,
+                                 exp::Eval<exp::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_EXP() { return Register_EXP_GENERIC_OPT(); }
 
 }  // namespace builtin
 }  // namespace ops
@@ -25,7 +25,7 @@ using ::testing::ElementsAreArray;
 
 class ExpOpModel : public SingleOpModel {
  public:
-  ExpOpModel(const TensorData& input, const TensorType& output) {
+  ExpOpModel(const TensorData& input, const TensorData& output) {
     input_ = AddInput(input);
     output_ = AddOutput(output);
     SetBuiltinOp(BuiltinOperator_EXP, BuiltinOptions_ExpOptions,
@@ -44,6 +44,13 @@ class ExpOpModel : public SingleOpModel {
   }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
 
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+  int input() { return input_; }
+
  protected:
   int input_;
   int output_;
@@ -51,7 +58,7 @@ class ExpOpModel : public SingleOpModel {
 
 TEST(ExpOpTest, FloatTest) {
   std::initializer_list<float> data = {1.0, 0.0, -1.0, 1.0, 1.0, -1.0};
-  ExpOpModel m({TensorType_FLOAT32, {3, 1, 2}}, TensorType_FLOAT32);
+  ExpOpModel m({TensorType_FLOAT32, {3, 1, 2}}, {TensorType_FLOAT32, {}});
   m.SetInput<float>(data);
   m.Invoke();
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({3, 1, 2}));
@@ -60,6 +67,20 @@ TEST(ExpOpTest, FloatTest) {
                   {2.71828, 1, 0.367879, 2.71828, 2.71828, 0.367879})));
 }
 
+TEST(ExpOpTest, Uint8Test) {
+  // Output error is dominated by the input step scaled by exp(max input).
+  const float kQuantizedTolerance = 2 * (8.0 / 255.0);
+  ExpOpModel m({TensorType_UINT8, {3, 1, 2}, -3.0, 3.0},
+               {TensorType_UINT8, {}, 0.0, 8.0});
+  m.QuantizeAndPopulate<uint8_t>(m.input(), {1.0, 0.0, -1.0, 1.5, 2.0, -3.0});
+  m.Invoke();
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({3, 1, 2}));
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {2.71828, 1, 0.367879, 4.48169, 7.38906, 0.0497871},
+                  kQuantizedTolerance)));
+}
+
 }  // namespace
 }  // namespace tflite
 
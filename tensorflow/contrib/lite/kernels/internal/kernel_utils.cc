@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 
+#include "fixedpoint/fixedpoint.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 
 namespace tflite {
@@ -703,5 +704,166 @@ void LstmStep(
                                output_state_ptr);
     }
 
+void LstmStep(
+    const uint8_t* input_ptr_batch, const int8_t* input_to_input_weights_ptr,
+    const int8_t* input_to_forget_weights_ptr,
+    const int8_t* input_to_cell_weights_ptr,
+    const int8_t* input_to_output_weights_ptr,
+    const int8_t* recurrent_to_input_weights_ptr,
+    const int8_t* recurrent_to_forget_weights_ptr,
+    const int8_t* recurrent_to_cell_weights_ptr,
+    const int8_t* recurrent_to_output_weights_ptr,
+    const int8_t* cell_to_input_weights_ptr,
+    const int8_t* cell_to_forget_weights_ptr,
+    const int8_t* cell_to_output_weights_ptr,
+    const int32_t* input_gate_bias_ptr, const int32_t* forget_gate_bias_ptr,
+    const int32_t* cell_bias_ptr, const int32_t* output_gate_bias_ptr,
+    const int8_t* projection_weights_ptr, const int32_t* projection_bias_ptr,
+    const IntegerLstmParameter* integer_params, int n_batch, int n_cell,
+    int n_input, int n_output, int16_t* input_gate_scratch,
+    int16_t* forget_gate_scratch, int16_t* cell_scratch,
+    int16_t* output_gate_scratch, uint8_t* output_state_ptr,
+    int16_t* cell_state_ptr, uint8_t* output_ptr_batch) {
+  const IntegerLstmParameter& p = *integer_params;
+  // Since we have already checked that weights are all there or none, we can
+  // check the existence of only one to get the condition.
+  const bool use_cifg = (input_to_input_weights_ptr == nullptr);
+  const bool use_peephole = (cell_to_output_weights_ptr != nullptr);
+  const int n_gate = n_batch * n_cell;
+
+  // Initialize scratch buffers with zero, the biases are added to the
+  // accumulators of the input matmuls below.
+  if (!use_cifg) {
+    std::fill_n(input_gate_scratch, n_gate, 0);
+  }
+  std::fill_n(forget_gate_scratch, n_gate, 0);
+  std::fill_n(cell_scratch, n_gate, 0);
+  std::fill_n(output_gate_scratch, n_gate, 0);
+
+  // For each batch and cell: compute input_weight * input.
+  if (!use_cifg) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_input_weights_ptr, n_cell, n_input, input_ptr_batch,
+        p.input_zero_point, input_gate_bias_ptr, p.input_to_input_multiplier,
+        p.input_to_input_shift, n_batch, input_gate_scratch);
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input_to_forget_weights_ptr, n_cell, n_input, input_ptr_batch,
+      p.input_zero_point, forget_gate_bias_ptr, p.input_to_forget_multiplier,
+      p.input_to_forget_shift, n_batch, forget_gate_scratch);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input_to_cell_weights_ptr, n_cell, n_input, input_ptr_batch,
+      p.input_zero_point, cell_bias_ptr, p.input_to_cell_multiplier,
+      p.input_to_cell_shift, n_batch, cell_scratch);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input_to_output_weights_ptr, n_cell, n_input, input_ptr_batch,
+      p.input_zero_point, output_gate_bias_ptr, p.input_to_output_multiplier,
+      p.input_to_output_shift, n_batch, output_gate_scratch);
+
+  // For each batch and cell: compute recurrent_weight * output_state.
+  if (!use_cifg) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_input_weights_ptr, n_cell, n_output, output_state_ptr,
+        p.output_zero_point, /*bias=*/nullptr,
+        p.recurrent_to_input_multiplier, p.recurrent_to_input_shift, n_batch,
+        input_gate_scratch);
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_forget_weights_ptr, n_cell, n_output, output_state_ptr,
+      p.output_zero_point, /*bias=*/nullptr, p.recurrent_to_forget_multiplier,
+      p.recurrent_to_forget_shift, n_batch, forget_gate_scratch);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_cell_weights_ptr, n_cell, n_output, output_state_ptr,
+      p.output_zero_point, /*bias=*/nullptr, p.recurrent_to_cell_multiplier,
+      p.recurrent_to_cell_shift, n_batch, cell_scratch);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_output_weights_ptr, n_cell, n_output, output_state_ptr,
+      p.output_zero_point, /*bias=*/nullptr, p.recurrent_to_output_multiplier,
+      p.recurrent_to_output_shift, n_batch, output_gate_scratch);
+
+  // For each batch and cell: update input gate.
+  if (!use_cifg) {
+    if (use_peephole) {
+      tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+          cell_to_input_weights_ptr, n_cell, cell_state_ptr, n_batch,
+          p.cell_to_input_multiplier, p.cell_to_input_shift,
+          input_gate_scratch);
+    }
+    tensor_utils::ApplySigmoidToVector(input_gate_scratch, n_gate,
+                                       input_gate_scratch);
+  }
+
+  // For each batch and cell: update forget gate.
+  if (use_peephole) {
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        cell_to_forget_weights_ptr, n_cell, cell_state_ptr, n_batch,
+        p.cell_to_forget_multiplier, p.cell_to_forget_shift,
+        forget_gate_scratch);
+  }
+  tensor_utils::ApplySigmoidToVector(forget_gate_scratch, n_gate,
+                                     forget_gate_scratch);
+
+  // For each batch and cell: update the cell. The gates are in Q0.15, the
+  // cell state keeps 15 - cell_integer_bits fractional bits.
+  tensor_utils::VectorVectorCwiseProduct(forget_gate_scratch, cell_state_ptr,
+                                         n_gate, /*shift=*/15, cell_state_ptr);
+  tensor_utils::ApplyTanhToVector(cell_scratch, n_gate, /*integer_bits=*/3,
+                                  cell_scratch);
+  if (use_cifg) {
+    tensor_utils::Sub1Vector(forget_gate_scratch, n_gate,
+                             forget_gate_scratch);
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_scratch, forget_gate_scratch, n_gate,
+        /*shift=*/15 + p.cell_integer_bits, cell_state_ptr);
+  } else {
+    tensor_utils::VectorVectorCwiseProductAccumulate(
+        cell_scratch, input_gate_scratch, n_gate,
+        /*shift=*/15 + p.cell_integer_bits, cell_state_ptr);
+  }
+  if (p.quantized_cell_clip > 0) {
+    tensor_utils::ClipVector(cell_state_ptr, n_gate, p.quantized_cell_clip,
+                             cell_state_ptr);
+  }
+
+  // For each batch and cell: update the output gate.
+  if (use_peephole) {
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        cell_to_output_weights_ptr, n_cell, cell_state_ptr, n_batch,
+        p.cell_to_output_multiplier, p.cell_to_output_shift,
+        output_gate_scratch);
+  }
+  tensor_utils::ApplySigmoidToVector(output_gate_scratch, n_gate,
+                                     output_gate_scratch);
+  tensor_utils::ApplyTanhToVector(cell_state_ptr, n_gate, p.cell_integer_bits,
+                                  cell_scratch);
+  tensor_utils::VectorVectorCwiseProduct(output_gate_scratch, cell_scratch,
+                                         n_gate, /*shift=*/15,
+                                         output_gate_scratch);
+
+  // For each batch: update the projection and output_state.
+  if (projection_weights_ptr != nullptr) {
+    tensor_utils::MatrixBatchVectorMultiply(
+        projection_weights_ptr, n_output, n_cell, output_gate_scratch,
+        projection_bias_ptr, p.hidden_multiplier, p.hidden_shift,
+        p.output_zero_point, p.output_min, p.output_max, n_batch,
+        output_ptr_batch);
+  } else {
+    const int left_shift = p.hidden_shift > 0 ? p.hidden_shift : 0;
+    const int right_shift = p.hidden_shift > 0 ? 0 : -p.hidden_shift;
+    for (int i = 0; i < n_batch * n_output; ++i) {
+      int32_t value =
+          gemmlowp::RoundingDivideByPOT(
+              gemmlowp::SaturatingRoundingDoublingHighMul(
+                  output_gate_scratch[i] * (1 << left_shift),
+                  p.hidden_multiplier),
+              right_shift) +
+          p.output_zero_point;
+      value = std::min(p.output_max, std::max(p.output_min, value));
+      output_ptr_batch[i] = static_cast<uint8_t>(value);
+    }
+  }
+  std::copy_n(output_ptr_batch, n_batch * n_output, output_state_ptr);
+}
+
 }  // namespace kernel_utils
 }  // namespace tflite
@@ -239,6 +239,84 @@ void LstmStepWithAuxInput(
     int8_t* quantized_output_state_ptr, int8_t* quantized_cell_state_ptr,
     float* output_state_ptr, float* cell_state_ptr, float* output_ptr_batch);
 
+// Rescaling parameters of the integer LSTM step below. They are computed once
+// from the tensor scales (see QuantizeMultiplier) when the op is prepared.
+struct IntegerLstmParameter {
+  // Multipliers from the input/recurrent matmul accumulators into the Q3.12
+  // gate pre-activations, one per gate (input, forget, cell, output).
+  int32_t input_to_input_multiplier;
+  int input_to_input_shift;
+  int32_t input_to_forget_multiplier;
+  int input_to_forget_shift;
+  int32_t input_to_cell_multiplier;
+  int input_to_cell_shift;
+  int32_t input_to_output_multiplier;
+  int input_to_output_shift;
+  int32_t recurrent_to_input_multiplier;
+  int recurrent_to_input_shift;
+  int32_t recurrent_to_forget_multiplier;
+  int recurrent_to_forget_shift;
+  int32_t recurrent_to_cell_multiplier;
+  int recurrent_to_cell_shift;
+  int32_t recurrent_to_output_multiplier;
+  int recurrent_to_output_shift;
+  // Multipliers from the peephole products into the Q3.12 pre-activations.
+  int32_t cell_to_input_multiplier;
+  int cell_to_input_shift;
+  int32_t cell_to_forget_multiplier;
+  int cell_to_forget_shift;
+  int32_t cell_to_output_multiplier;
+  int cell_to_output_shift;
+  // Multiplier from the Q0.15 hidden state (through the projection, if any)
+  // to the output.
+  int32_t hidden_multiplier;
+  int hidden_shift;
+  // Number of integer bits of the 16-bit cell state. Must be at most 6.
+  int cell_integer_bits;
+  // Quantized cell clip, 0 means no clipping.
+  int16_t quantized_cell_clip;
+  // Zero points of the input and of the output (and activation state), and
+  // the range the output is clamped to, which accounts for proj_clip.
+  int32_t input_zero_point;
+  int32_t output_zero_point;
+  int32_t output_min;
+  int32_t output_max;
+};
+
+// Same as above but fully integer: the input, output and output state are
+// asymmetrically quantized 8-bit values, the weights are symmetric 8-bit
+// values, the biases are 32-bit values with the scale of the corresponding
+// matmul accumulator and the cell state is a 16-bit fixed-point value.
+//
+// Temporary pre-allocated storage of size 'n_batch * n_cell' for the gates:
+//   input_gate_scratch (unused with CIFG), forget_gate_scratch, cell_scratch,
+//   output_gate_scratch.
+//
+// Outputs:
+//   output_state_ptr - size 'n_batch * n_output'
+//   cell_state_ptr   - size 'n_batch * n_cell'
+//   output_ptr_batch - size 'n_batch * n_output'
+void LstmStep(
+    const uint8_t* input_ptr_batch, const int8_t* input_to_input_weights_ptr,
+    const int8_t* input_to_forget_weights_ptr,
+    const int8_t* input_to_cell_weights_ptr,
+    const int8_t* input_to_output_weights_ptr,
+    const int8_t* recurrent_to_input_weights_ptr,
+    const int8_t* recurrent_to_forget_weights_ptr,
+    const int8_t* recurrent_to_cell_weights_ptr,
+    const int8_t* recurrent_to_output_weights_ptr,
+    const int8_t* cell_to_input_weights_ptr,
+    const int8_t* cell_to_forget_weights_ptr,
+    const int8_t* cell_to_output_weights_ptr,
+    const int32_t* input_gate_bias_ptr, const int32_t* forget_gate_bias_ptr,
+    const int32_t* cell_bias_ptr, const int32_t* output_gate_bias_ptr,
+    const int8_t* projection_weights_ptr, const int32_t* projection_bias_ptr,
+    const IntegerLstmParameter* integer_params, int n_batch, int n_cell,
+    int n_input, int n_output, int16_t* input_gate_scratch,
+    int16_t* forget_gate_scratch, int16_t* cell_scratch,
+    int16_t* output_gate_scratch, uint8_t* output_state_ptr,
+    int16_t* cell_state_ptr, uint8_t* output_ptr_batch);
+
 }  // namespace kernel_utils
 }  // namespace tflite
 #endif  // TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_KERNEL_UTILS_H_
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
@@ -604,6 +605,88 @@ void NeonVectorShiftLeft(float* vector, int v_size, float shift_value) {
   vector[v_size - 1] = shift_value;
 }
 
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result) {
+  const int kWeightsPerNeonLane = 8;
+  // If m_cols is not divisible by kWeightsPerNeonLane, the remaining columns
+  // are processed sequentially starting at postamble_start.
+  const int postamble_start = m_cols - (m_cols & (kWeightsPerNeonLane - 1));
+  const int16x8_t zero_point_16x8 = vdupq_n_s16(vector_zero_point);
+
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int8_t* row_ptr = matrix;
+    for (int row = 0; row < m_rows; ++row, ++result, row_ptr += m_cols) {
+      int32x4_t dotprod_32x4 = vmovq_n_s32(0);
+      int col = 0;
+      for (; col < postamble_start; col += kWeightsPerNeonLane) {
+        // Widen 8 vector values to 16 bits and remove their zero point. The
+        // difference always fits in 16 bits since both operands are uint8.
+        const int16x8_t s1_16x8 = vsubq_s16(
+            vreinterpretq_s16_u16(vmovl_u8(vld1_u8(vectors + col))),
+            zero_point_16x8);
+        const int16x8_t s2_16x8 = vmovl_s8(vld1_s8(row_ptr + col));
+        dotprod_32x4 = vmlal_s16(dotprod_32x4, vget_low_s16(s1_16x8),
+                                 vget_low_s16(s2_16x8));
+        dotprod_32x4 = vmlal_s16(dotprod_32x4, vget_high_s16(s1_16x8),
+                                 vget_high_s16(s2_16x8));
+      }
+      const int64x2_t pairwise_added = vpaddlq_s32(dotprod_32x4);
+      int32 dotprod = (bias == nullptr) ? 0 : bias[row];
+      dotprod += vgetq_lane_s64(pairwise_added, 0) +
+                 vgetq_lane_s64(pairwise_added, 1);
+      // Postamble loop.
+      for (; col < m_cols; ++col) {
+        dotprod += row_ptr[col] * (vectors[col] - vector_zero_point);
+      }
+      const int32 value =
+          *result + MultiplyByQuantizedMultiplier(dotprod, multiplier, shift);
+      *result = static_cast<int16_t>(
+          std::min<int32>(32767, std::max<int32>(-32768, value)));
+    }
+  }
+}
+
+void NeonMatrixBatchVectorMultiply(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const int16_t* __restrict__ vectors, const int32_t* bias,
+    int32_t multiplier, int shift, int32_t output_zero_point,
+    int32_t output_min, int32_t output_max, int n_batch,
+    uint8_t* __restrict__ result) {
+  const int kWeightsPerNeonLane = 8;
+  const int postamble_start = m_cols - (m_cols & (kWeightsPerNeonLane - 1));
+
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int8_t* row_ptr = matrix;
+    for (int row = 0; row < m_rows; ++row, ++result, row_ptr += m_cols) {
+      int32x4_t dotprod_32x4 = vmovq_n_s32(0);
+      int col = 0;
+      for (; col < postamble_start; col += kWeightsPerNeonLane) {
+        const int16x8_t s1_16x8 = vld1q_s16(vectors + col);
+        const int16x8_t s2_16x8 = vmovl_s8(vld1_s8(row_ptr + col));
+        dotprod_32x4 = vmlal_s16(dotprod_32x4, vget_low_s16(s1_16x8),
+                                 vget_low_s16(s2_16x8));
+        dotprod_32x4 = vmlal_s16(dotprod_32x4, vget_high_s16(s1_16x8),
+                                 vget_high_s16(s2_16x8));
+      }
+      const int64x2_t pairwise_added = vpaddlq_s32(dotprod_32x4);
+      int32 dotprod = (bias == nullptr) ? 0 : bias[row];
+      dotprod += vgetq_lane_s64(pairwise_added, 0) +
+                 vgetq_lane_s64(pairwise_added, 1);
+      // Postamble loop.
+      for (; col < m_cols; ++col) {
+        dotprod += row_ptr[col] * vectors[col];
+      }
+      int32 value = MultiplyByQuantizedMultiplier(dotprod, multiplier, shift) +
+                    output_zero_point;
+      value = std::min(output_max, std::max(output_min, value));
+      *result = static_cast<uint8_t>(value);
+    }
+  }
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
@@ -138,6 +138,65 @@ void ReductionSumVector(const float* input_vector, float* output_vector,
                    reduction_size);
 }
 
+void MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result) {
+  NEON_OR_PORTABLE(MatrixBatchVectorMultiplyAccumulate, matrix, m_rows, m_cols,
+                   vectors, vector_zero_point, bias, multiplier, shift, n_batch,
+                   result);
+}
+
+void MatrixBatchVectorMultiply(const int8_t* __restrict__ matrix, int m_rows,
+                               int m_cols, const int16_t* __restrict__ vectors,
+                               const int32_t* bias, int32_t multiplier,
+                               int shift, int32_t output_zero_point,
+                               int32_t output_min, int32_t output_max,
+                               int n_batch, uint8_t* __restrict__ result) {
+  NEON_OR_PORTABLE(MatrixBatchVectorMultiply, matrix, m_rows, m_cols, vectors,
+                   bias, multiplier, shift, output_zero_point, output_min,
+                   output_max, n_batch, result);
+}
+
+void VectorBatchVectorCwiseProductAccumulate(const int8_t* vector, int v_size,
+                                             const int16_t* batch_vector,
+                                             int n_batch, int32_t multiplier,
+                                             int shift, int16_t* result) {
+  PortableVectorBatchVectorCwiseProductAccumulate(
+      vector, v_size, batch_vector, n_batch, multiplier, shift, result);
+}
+
+void ApplySigmoidToVector(const int16_t* vector, int v_size, int16_t* result) {
+  PortableApplySigmoidToVector(vector, v_size, result);
+}
+
+void ApplyTanhToVector(const int16_t* vector, int v_size, int integer_bits,
+                       int16_t* result) {
+  PortableApplyTanhToVector(vector, v_size, integer_bits, result);
+}
+
+void VectorVectorCwiseProduct(const int16_t* vector1, const int16_t* vector2,
+                              int v_size, int shift, int16_t* result) {
+  PortableVectorVectorCwiseProduct(vector1, vector2, v_size, shift, result);
+}
+
+void VectorVectorCwiseProductAccumulate(const int16_t* vector1,
+                                        const int16_t* vector2, int v_size,
+                                        int shift, int16_t* result) {
+  PortableVectorVectorCwiseProductAccumulate(vector1, vector2, v_size, shift,
+                                             result);
+}
+
+void Sub1Vector(const int16_t* vector, int v_size, int16_t* result) {
+  PortableSub1Vector(vector, v_size, result);
+}
+
+void ClipVector(const int16_t* vector, int v_size, int16_t abs_limit,
+                int16_t* result) {
+  PortableClipVector(vector, v_size, abs_limit, result);
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
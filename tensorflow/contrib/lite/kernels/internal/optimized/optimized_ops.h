@@ -57,7 +57,6 @@ using reference_ops::BroadcastSub4DSlow;
 using reference_ops::Concatenation;
 using reference_ops::DepthConcatenation;
 using reference_ops::Dequantize;
-using reference_ops::Div;
 using reference_ops::FakeQuant;
 using reference_ops::Gather;
 using reference_ops::Greater;
@@ -3239,6 +3238,102 @@ void BroadcastDiv(const T* input1_data, const Dims<4>& input1_dims,
                      DimsToShape(output_dims), output_data);
 }
 
+template <typename T>
+inline void Div(const ArithmeticParams& params,
+                const RuntimeShape& input1_shape, const T* input1_data,
+                const RuntimeShape& input2_shape, const T* input2_data,
+                const RuntimeShape& output_shape, T* output_data) {
+  reference_ops::Div(params, input1_shape, input1_data, input2_shape,
+                     input2_data, output_shape, output_data);
+}
+
+// TODO(b/80418076): Move to legacy ops file, update invocations.
+// Legacy Dims<4>.
+template <typename T>
+inline void Div(const T* input1_data, const Dims<4>& input1_dims,
+                const T* input2_data, const Dims<4>& input2_dims,
+                T output_activation_min, T output_activation_max,
+                T* output_data, const Dims<4>& output_dims) {
+  reference_ops::Div(input1_data, input1_dims, input2_data, input2_dims,
+                     output_activation_min, output_activation_max,
+                     output_data, output_dims);
+}
+
+// Quantized Div. The reciprocals of all 256 possible input2 values are
+// tabulated up front, which replaces the per-element 32-bit division of the
+// reference implementation with a multiplication.
+inline void Div(const ArithmeticParams& params,
+                const RuntimeShape& input1_shape, const uint8* input1_data,
+                const RuntimeShape& input2_shape, const uint8* input2_data,
+                const RuntimeShape& output_shape, uint8* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  gemmlowp::ScopedProfilingLabel label("Div/8bit");
+  const int flat_size =
+      MatchingFlatSize(input1_shape, input2_shape, output_shape);
+  // Building the table costs as many divisions as it saves on small inputs.
+  if (flat_size < 256) {
+    reference_ops::Div(params, input1_shape, input1_data, input2_shape,
+                       input2_data, output_shape, output_data);
+    return;
+  }
+
+  // The reciprocals carry kExtraBits more fractional bits than the quotient,
+  // so the rounding error of the table stays below half a quotient unit.
+  constexpr int kExtraBits = 8;
+  constexpr int32 kOne = 1 << (reference_ops::kDivQuotientFractionalBits +
+                               kExtraBits);
+  int32 reciprocal[256];
+  for (int i = 0; i < 256; ++i) {
+    const int32 denominator = params.input2_offset + i;
+    const int32 abs_denominator = std::abs(denominator);
+    if (abs_denominator == 0) {
+      reciprocal[i] = 0;
+      continue;
+    }
+    reciprocal[i] = (kOne + abs_denominator / 2) / abs_denominator;
+    if (denominator < 0) {
+      reciprocal[i] = -reciprocal[i];
+    }
+  }
+
+  const int shift =
+      params.output_shift - reference_ops::kDivQuotientFractionalBits;
+  for (int i = 0; i < flat_size; ++i) {
+    const uint8 input2 = input2_data[i];
+    if (params.input2_offset + input2 == 0) {
+      output_data[i] =
+          reference_ops::DivElementwise(params, input1_data[i], input2);
+      continue;
+    }
+    const int64_t product =
+        static_cast<int64_t>(params.input1_offset + input1_data[i]) *
+        reciprocal[input2];
+    const int32 quotient = static_cast<int32>(
+        (product + (1 << (kExtraBits - 1))) >> kExtraBits);
+    const int32 unclamped_result =
+        params.output_offset +
+        MultiplyByQuantizedMultiplier(quotient, params.output_multiplier,
+                                      shift);
+    const int32 clamped_output =
+        std::min(params.quantized_activation_max,
+                 std::max(params.quantized_activation_min, unclamped_result));
+    output_data[i] = static_cast<uint8>(clamped_output);
+  }
+}
+
+inline void BroadcastDiv4DSlow(const ArithmeticParams& params,
+                               const RuntimeShape& input1_shape,
+                               const uint8* input1_data,
+                               const RuntimeShape& input2_shape,
+                               const uint8* input2_data,
+                               const RuntimeShape& output_shape,
+                               uint8* output_data) {
+  reference_ops::BroadcastDiv4DSlow(params, input1_shape, input1_data,
+                                    input2_shape, input2_data, output_shape,
+                                    output_data);
+}
+
 // TODO(aselle): This is not actually optimized yet.
 inline void SubNonBroadcast(const ArithmeticParams& params,
                             const RuntimeShape& input1_shape,
@@ -4112,6 +4207,64 @@ inline void LocalResponseNormalization(
   }
 }
 
+inline void LocalResponseNormalization(
+    const tflite::LocalResponseNormalizationParams& op_params,
+    const RuntimeShape& input_shape, const uint8* input_data,
+    const RuntimeShape& output_shape, uint8* output_data) {
+  gemmlowp::ScopedProfilingLabel label("LocalResponseNormalization/8bit");
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  const int range = op_params.range;
+  const int32 input_zero_point = op_params.input_zero_point;
+  const float accum_scale =
+      op_params.alpha * op_params.input_scale * op_params.input_scale;
+  const float input_to_output_scale =
+      op_params.input_scale / op_params.output_scale;
+  const float bias = op_params.bias;
+  const float beta = op_params.beta;
+
+  for (int i = 0; i < outer_size; ++i) {
+    const uint8* input_ptr = input_data + i * depth;
+    uint8* output_ptr = output_data + i * depth;
+    // Sum of squares over the window [c - range, c + range], slid along the
+    // depth dimension one channel at a time.
+    int32 accum = 0;
+    for (int c = 0; c < std::min(range, depth); ++c) {
+      const int32 input_val = input_ptr[c] - input_zero_point;
+      accum += input_val * input_val;
+    }
+    for (int c = 0; c < depth; ++c) {
+      if (c + range < depth) {
+        const int32 input_val = input_ptr[c + range] - input_zero_point;
+        accum += input_val * input_val;
+      }
+      if (c - range - 1 >= 0) {
+        const int32 input_val = input_ptr[c - range - 1] - input_zero_point;
+        accum -= input_val * input_val;
+      }
+      const float denominator = bias + accum_scale * accum;
+      // In a few cases, the pow computation could benefit from speedups.
+      float multiplier;
+      if (beta == 1.f) {
+        multiplier = 1.f / denominator;
+      } else if (beta == 0.5f) {
+        multiplier = 1.f / std::sqrt(denominator);
+      } else {
+        multiplier = std::pow(denominator, -beta);
+      }
+      const float quantized =
+          TfLiteRound((input_ptr[c] - input_zero_point) *
+                      input_to_output_scale * multiplier) +
+          op_params.output_zero_point;
+      output_ptr[c] =
+          static_cast<uint8>(std::max(0.0f, std::min(255.0f, quantized)));
+    }
+  }
+}
+
 inline void Softmax(const float* input_data, const RuntimeShape& input_shape,
                     float beta, float* output_data,
                     const RuntimeShape& output_shape) {
@@ -5044,6 +5197,17 @@ inline void Tanh(const int16* input_data, const RuntimeShape& input_shape,
   }
 }
 
+// Quantized Exp as a lookup into a table holding the quantized result for each
+// of the 256 input values, e.g. as computed once by reference_ops::Exp when
+// the quantization parameters become known.
+inline void Exp(const uint8* input_data, const size_t num_elements,
+                const uint8* lookup_table, uint8* output_data) {
+  gemmlowp::ScopedProfilingLabel label("Exp/8bit");
+  for (size_t idx = 0; idx < num_elements; ++idx) {
+    output_data[idx] = lookup_table[input_data[idx]];
+  }
+}
+
 template <typename SrcT, typename DstT>
 inline void Cast(const RuntimeShape& input_shape, const SrcT* input_data,
                  const RuntimeShape& output_shape, DstT* output_data) {
@@ -172,6 +172,55 @@ void PortableReductionSumVector(const float* input_vector, float* output_vector,
 void NeonReductionSumVector(const float* input_vector, float* output_vector,
                             int output_size, int reduction_size);
 
+// Integer LSTM primitives.
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result);
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result);
+
+void PortableMatrixBatchVectorMultiply(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const int16_t* __restrict__ vectors, const int32_t* bias,
+    int32_t multiplier, int shift, int32_t output_zero_point,
+    int32_t output_min, int32_t output_max, int n_batch,
+    uint8_t* __restrict__ result);
+void NeonMatrixBatchVectorMultiply(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const int16_t* __restrict__ vectors, const int32_t* bias,
+    int32_t multiplier, int shift, int32_t output_zero_point,
+    int32_t output_min, int32_t output_max, int n_batch,
+    uint8_t* __restrict__ result);
+
+void PortableVectorBatchVectorCwiseProductAccumulate(
+    const int8_t* vector, int v_size, const int16_t* batch_vector, int n_batch,
+    int32_t multiplier, int shift, int16_t* result);
+
+void PortableApplySigmoidToVector(const int16_t* vector, int v_size,
+                                  int16_t* result);
+
+void PortableApplyTanhToVector(const int16_t* vector, int v_size,
+                               int integer_bits, int16_t* result);
+
+void PortableVectorVectorCwiseProduct(const int16_t* vector1,
+                                      const int16_t* vector2, int v_size,
+                                      int shift, int16_t* result);
+
+void PortableVectorVectorCwiseProductAccumulate(const int16_t* vector1,
+                                                const int16_t* vector2,
+                                                int v_size, int shift,
+                                                int16_t* result);
+
+void PortableSub1Vector(const int16_t* vector, int v_size, int16_t* result);
+
+void PortableClipVector(const int16_t* vector, int v_size, int16_t abs_limit,
+                        int16_t* result);
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
@@ -15,9 +15,12 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 #include <algorithm>
+#include <limits>
 
+#include "fixedpoint/fixedpoint.h"
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/internal/common.h"
 #include "tensorflow/contrib/lite/kernels/internal/round.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 
@@ -27,6 +30,25 @@ limitations under the License.
 
 namespace tflite {
 namespace tensor_utils {
+namespace {
+
+inline int16_t SaturateToInt16(int32_t x) {
+  return static_cast<int16_t>(
+      std::min<int32_t>(std::numeric_limits<int16_t>::max(),
+                        std::max<int32_t>(std::numeric_limits<int16_t>::min(),
+                                          x)));
+}
+
+template <int IntegerBits>
+void PortableApplyTanhToVectorImpl(const int16_t* vector, int v_size,
+                                   int16_t* result) {
+  using FInput = gemmlowp::FixedPoint<std::int16_t, IntegerBits>;
+  for (int v = 0; v < v_size; v++) {
+    result[v] = gemmlowp::tanh(FInput::FromRaw(vector[v])).raw();
+  }
+}
+
+}  // namespace
 
 float PortableClip(float f, float abs_limit) {
   float result = (abs_limit < f) ? abs_limit : f;
@@ -243,5 +265,132 @@ void PortableReductionSumVector(const float* input_vector, float* output_vector,
   }
 }
 
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result) {
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int8_t* row_ptr = matrix;
+    for (int row = 0; row < m_rows; ++row, ++result) {
+      int32_t dotprod = (bias == nullptr) ? 0 : bias[row];
+      for (int col = 0; col < m_cols; ++col, ++row_ptr) {
+        dotprod += (*row_ptr) * (vectors[col] - vector_zero_point);
+      }
+      const int32_t scaled =
+          MultiplyByQuantizedMultiplier(dotprod, multiplier, shift);
+      *result = SaturateToInt16(*result + scaled);
+    }
+  }
+}
+
+void PortableMatrixBatchVectorMultiply(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const int16_t* __restrict__ vectors, const int32_t* bias,
+    int32_t multiplier, int shift, int32_t output_zero_point,
+    int32_t output_min, int32_t output_max, int n_batch,
+    uint8_t* __restrict__ result) {
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const int8_t* row_ptr = matrix;
+    for (int row = 0; row < m_rows; ++row, ++result) {
+      int32_t dotprod = (bias == nullptr) ? 0 : bias[row];
+      for (int col = 0; col < m_cols; ++col, ++row_ptr) {
+        dotprod += (*row_ptr) * vectors[col];
+      }
+      int32_t value =
+          MultiplyByQuantizedMultiplier(dotprod, multiplier, shift) +
+          output_zero_point;
+      value = std::min(output_max, std::max(output_min, value));
+      *result = static_cast<uint8_t>(value);
+    }
+  }
+}
+
+void PortableVectorBatchVectorCwiseProductAccumulate(
+    const int8_t* vector, int v_size, const int16_t* batch_vector, int n_batch,
+    int32_t multiplier, int shift, int16_t* result) {
+  for (int b = 0; b < n_batch; b++) {
+    for (int v = 0; v < v_size; v++) {
+      const int32_t prod = static_cast<int32_t>(vector[v]) * (*batch_vector++);
+      const int32_t scaled =
+          MultiplyByQuantizedMultiplier(prod, multiplier, shift);
+      *result = SaturateToInt16(*result + scaled);
+      ++result;
+    }
+  }
+}
+
+void PortableApplySigmoidToVector(const int16_t* vector, int v_size,
+                                  int16_t* result) {
+  using F3 = gemmlowp::FixedPoint<std::int16_t, 3>;
+  for (int v = 0; v < v_size; v++) {
+    result[v] = gemmlowp::logistic(F3::FromRaw(vector[v])).raw();
+  }
+}
+
+void PortableApplyTanhToVector(const int16_t* vector, int v_size,
+                               int integer_bits, int16_t* result) {
+  switch (integer_bits) {
+    case 0:
+      PortableApplyTanhToVectorImpl<0>(vector, v_size, result);
+      break;
+    case 1:
+      PortableApplyTanhToVectorImpl<1>(vector, v_size, result);
+      break;
+    case 2:
+      PortableApplyTanhToVectorImpl<2>(vector, v_size, result);
+      break;
+    case 3:
+      PortableApplyTanhToVectorImpl<3>(vector, v_size, result);
+      break;
+    case 4:
+      PortableApplyTanhToVectorImpl<4>(vector, v_size, result);
+      break;
+    case 5:
+      PortableApplyTanhToVectorImpl<5>(vector, v_size, result);
+      break;
+    case 6:
+      PortableApplyTanhToVectorImpl<6>(vector, v_size, result);
+      break;
+    default:
+      TF_LITE_FATAL("Unsupported number of integer bits for tanh.");
+  }
+}
+
+void PortableVectorVectorCwiseProduct(const int16_t* vector1,
+                                      const int16_t* vector2, int v_size,
+                                      int shift, int16_t* result) {
+  for (int v = 0; v < v_size; v++) {
+    const int32_t prod = static_cast<int32_t>(vector1[v]) * vector2[v];
+    result[v] = SaturateToInt16(gemmlowp::RoundingDivideByPOT(prod, shift));
+  }
+}
+
+void PortableVectorVectorCwiseProductAccumulate(const int16_t* vector1,
+                                                const int16_t* vector2,
+                                                int v_size, int shift,
+                                                int16_t* result) {
+  for (int v = 0; v < v_size; v++) {
+    const int32_t prod = static_cast<int32_t>(vector1[v]) * vector2[v];
+    const int32_t scaled = gemmlowp::RoundingDivideByPOT(prod, shift);
+    result[v] = SaturateToInt16(result[v] + scaled);
+  }
+}
+
+void PortableSub1Vector(const int16_t* vector, int v_size, int16_t* result) {
+  static const int16_t kOne = std::numeric_limits<int16_t>::max();
+  for (int v = 0; v < v_size; v++) {
+    *result++ = kOne - *vector++;
+  }
+}
+
+void PortableClipVector(const int16_t* vector, int v_size, int16_t abs_limit,
+                        int16_t* result) {
+  for (int v = 0; v < v_size; v++) {
+    *result++ = std::min<int16_t>(abs_limit,
+                                  std::max<int16_t>(-abs_limit, *vector++));
+  }
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
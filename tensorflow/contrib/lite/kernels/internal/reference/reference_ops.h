@@ -1650,6 +1650,94 @@ inline void Div(const ArithmeticParams& params,
   }
 }
 
+// Number of fractional bits kept in the quotient of quantized Div before it is
+// rescaled to the output scale.
+constexpr int kDivQuotientFractionalBits = 16;
+
+// Divides two zero-point adjusted uint8 values. params.output_multiplier and
+// params.output_shift hold input1_scale / (input2_scale * output_scale) in the
+// convention of QuantizeMultiplier. Division by zero saturates to the
+// activation range.
+inline uint8 DivElementwise(const ArithmeticParams& params, uint8 input1,
+                            uint8 input2) {
+  const int32 numerator = params.input1_offset + input1;
+  const int32 denominator = params.input2_offset + input2;
+  int32 unclamped_result;
+  if (denominator == 0) {
+    if (numerator == 0) {
+      unclamped_result = params.output_offset;
+    } else {
+      unclamped_result = numerator > 0 ? params.quantized_activation_max
+                                       : params.quantized_activation_min;
+    }
+  } else {
+    const int32 abs_numerator = std::abs(numerator)
+                                << kDivQuotientFractionalBits;
+    const int32 abs_denominator = std::abs(denominator);
+    int32 quotient = (abs_numerator + abs_denominator / 2) / abs_denominator;
+    if ((numerator < 0) != (denominator < 0)) {
+      quotient = -quotient;
+    }
+    unclamped_result =
+        params.output_offset +
+        MultiplyByQuantizedMultiplier(
+            quotient, params.output_multiplier,
+            params.output_shift - kDivQuotientFractionalBits);
+  }
+  const int32 clamped_output =
+      std::min(params.quantized_activation_max,
+               std::max(params.quantized_activation_min, unclamped_result));
+  return static_cast<uint8>(clamped_output);
+}
+
+inline void Div(const ArithmeticParams& params,
+                const RuntimeShape& input1_shape, const uint8* input1_data,
+                const RuntimeShape& input2_shape, const uint8* input2_data,
+                const RuntimeShape& output_shape, uint8* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  gemmlowp::ScopedProfilingLabel label("Div/8bit");
+  const int flat_size =
+      MatchingFlatSize(input1_shape, input2_shape, output_shape);
+  for (int i = 0; i < flat_size; ++i) {
+    output_data[i] = DivElementwise(params, input1_data[i], input2_data[i]);
+  }
+}
+
+inline void BroadcastDiv4DSlow(const ArithmeticParams& params,
+                               const RuntimeShape& unextended_input1_shape,
+                               const uint8* input1_data,
+                               const RuntimeShape& unextended_input2_shape,
+                               const uint8* input2_data,
+                               const RuntimeShape& unextended_output_shape,
+                               uint8* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  gemmlowp::ScopedProfilingLabel label("BroadcastDiv/8bit");
+  TFLITE_DCHECK_LE(unextended_input1_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(unextended_input2_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(unextended_output_shape.DimensionsCount(), 4);
+  RuntimeShape output_shape =
+      RuntimeShape::ExtendedShape(4, unextended_output_shape);
+
+  NdArrayDesc<4> desc1;
+  NdArrayDesc<4> desc2;
+  NdArrayDescsForElementwiseBroadcast(unextended_input1_shape,
+                                      unextended_input2_shape, &desc1, &desc2);
+
+  for (int b = 0; b < output_shape.Dims(0); ++b) {
+    for (int y = 0; y < output_shape.Dims(1); ++y) {
+      for (int x = 0; x < output_shape.Dims(2); ++x) {
+        for (int c = 0; c < output_shape.Dims(3); ++c) {
+          output_data[Offset(output_shape, b, y, x, c)] = DivElementwise(
+              params, input1_data[SubscriptToIndex(desc1, b, y, x, c)],
+              input2_data[SubscriptToIndex(desc2, b, y, x, c)]);
+        }
+      }
+    }
+  }
+}
+
 // TODO(b/80418076): Move to legacy ops file, update invocations.
 // Legacy Dims<4>.
 template <typename T>
@@ -2856,8 +2944,11 @@ inline void LocalResponseNormalization(
 
   for (int i = 0; i < outer_size; ++i) {
     for (int c = 0; c < depth; ++c) {
-      const int begin_input_c = std::max(static_cast<int32>(0), c - op_params.range);
-      const int end_input_c = std::min(static_cast<int32>(depth), c + op_params.range);
+      // The window [c - range, c + range] is inclusive, as TF's depth_radius.
+      const int begin_input_c =
+          std::max(static_cast<int32>(0), c - op_params.range);
+      const int end_input_c =
+          std::min(static_cast<int32>(depth), c + op_params.range + 1);
       float accum = 0.f;
       for (int input_c = begin_input_c; input_c < end_input_c; ++input_c) {
         const float input_val = input_data[i * depth + input_c];
@@ -2870,6 +2961,46 @@ inline void LocalResponseNormalization(
   }
 }
 
+// The uint8 variant accumulates the squared zero-point adjusted inputs in
+// integer arithmetic and requantizes the normalized value using the scales and
+// zero points in op_params.
+inline void LocalResponseNormalization(
+    const tflite::LocalResponseNormalizationParams& op_params,
+    const RuntimeShape& input_shape, const uint8* input_data,
+    const RuntimeShape& output_shape, uint8* output_data) {
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+  const float input_scale = op_params.input_scale;
+  const float accum_scale = op_params.alpha * input_scale * input_scale;
+
+  for (int i = 0; i < outer_size; ++i) {
+    for (int c = 0; c < depth; ++c) {
+      const int begin_input_c =
+          std::max(static_cast<int32>(0), c - op_params.range);
+      const int end_input_c =
+          std::min(static_cast<int32>(depth), c + op_params.range + 1);
+      int32 accum = 0;
+      for (int input_c = begin_input_c; input_c < end_input_c; ++input_c) {
+        const int32 input_val =
+            input_data[i * depth + input_c] - op_params.input_zero_point;
+        accum += input_val * input_val;
+      }
+      const float multiplier =
+          std::pow(op_params.bias + accum_scale * accum, -op_params.beta);
+      const float input_val =
+          input_scale * (input_data[i * depth + c] - op_params.input_zero_point);
+      const float quantized =
+          TfLiteRound(input_val * multiplier / op_params.output_scale) +
+          op_params.output_zero_point;
+      output_data[i * depth + c] =
+          static_cast<uint8>(std::max(0.0f, std::min(255.0f, quantized)));
+    }
+  }
+}
+
 inline void Softmax(const float* input_data, const RuntimeShape& input_shape,
                     float beta, float* output_data,
                     const RuntimeShape& output_shape) {
@@ -3812,6 +3943,20 @@ inline void Exp(const T* input_data, const size_t num_elements,
   }
 }
 
+inline void Exp(const uint8* input_data, const size_t num_elements,
+                int32 input_zero_point, float input_scale,
+                int32 output_zero_point, float output_scale,
+                uint8* output_data) {
+  for (size_t idx = 0; idx < num_elements; ++idx) {
+    const float value =
+        std::exp(input_scale * (input_data[idx] - input_zero_point));
+    const float quantized =
+        TfLiteRound(value / output_scale) + output_zero_point;
+    output_data[idx] =
+        static_cast<uint8>(std::max(0.0f, std::min(255.0f, quantized)));
+  }
+}
+
 // A generic reduce method that can be used for reduce_sum, reduce_mean, etc.
 // This method iterates through input data and reduce elements along the
 // dimensions given in axis.
@@ -4083,6 +4228,72 @@ inline bool Mean(const T* input_data, int32 input_zero_point, float input_scale,
   return true;
 }
 
+// Computes the sum of quantized elements across dimensions given in axis. The
+// raw sum is accumulated in temp_sum, then rescaled to the output quantization
+// and clamped to the range of T.
+template <typename T, typename U>
+inline bool QuantizedSum(const T* input_data, int32 input_zero_point,
+                         float input_scale, const int* input_dims,
+                         const int input_num_dims, T* output_data,
+                         int32 output_zero_point, float output_scale,
+                         const int* output_dims, const int output_num_dims,
+                         const int* axis, const int num_axis_dimensions,
+                         bool keep_dims, int* temp_index, int* resolved_axis,
+                         U* temp_sum) {
+  // Reset output data.
+  size_t num_outputs = 1;
+  for (int idx = 0; idx < output_num_dims; ++idx) {
+    size_t current = static_cast<size_t>(output_dims[idx]);
+    // Overflow prevention.
+    if (num_outputs > std::numeric_limits<size_t>::max() / current) {
+      return false;
+    }
+    num_outputs *= current;
+  }
+  for (size_t idx = 0; idx < num_outputs; ++idx) {
+    output_data[idx] = T();
+    temp_sum[idx] = U();
+  }
+
+  // Resolve axis.
+  int num_resolved_axis = 0;
+  if (!ResolveAxis(input_num_dims, axis, num_axis_dimensions, resolved_axis,
+                   &num_resolved_axis)) {
+    return false;
+  }
+
+  if (!ReduceSumImpl<T, U>(input_data, input_dims, output_dims, input_num_dims,
+                           output_num_dims, resolved_axis, num_resolved_axis,
+                           temp_index, temp_sum)) {
+    return false;
+  }
+
+  // Each output accumulated num_elements_in_axis zero points.
+  U num_elements_in_axis = 1;
+  for (int idx = 0; idx < num_resolved_axis; ++idx) {
+    size_t current = static_cast<size_t>(input_dims[resolved_axis[idx]]);
+    // Overflow prevention.
+    if (current > (std::numeric_limits<U>::max() / num_elements_in_axis)) {
+      return false;
+    }
+    num_elements_in_axis *= current;
+  }
+
+  const float scale = input_scale / output_scale;
+  const float zero_point_sum =
+      static_cast<float>(input_zero_point) * num_elements_in_axis;
+  const float min_value = static_cast<float>(std::numeric_limits<T>::min());
+  const float max_value = static_cast<float>(std::numeric_limits<T>::max());
+  for (size_t idx = 0; idx < num_outputs; ++idx) {
+    const float value =
+        round((static_cast<float>(temp_sum[idx]) - zero_point_sum) * scale) +
+        output_zero_point;
+    output_data[idx] =
+        static_cast<T>(std::max(min_value, std::min(max_value, value)));
+  }
+  return true;
+}
+
 template <typename T>
 void Minimum(const RuntimeShape& input1_shape, const T* input1_data,
              const T* input2_data, const RuntimeShape& output_shape,
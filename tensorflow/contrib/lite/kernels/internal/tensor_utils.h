@@ -152,6 +152,69 @@ void VectorShiftLeft(float* vector, int v_size, float shift_value);
 // added to get one element of output.
 void ReductionSumVector(const float* input_vector, float* output_vector,
                         int output_size, int reduction_size);
+
+// The functions below are the building blocks of the integer LSTM kernel,
+// which uses symmetric 8-bit weights and 16-bit fixed-point gates and cell
+// state. Gate pre-activations are in Q3.12 format, gate outputs in Q0.15.
+// Rescaling follows the convention of QuantizeMultiplier, i.e. a real
+// multiplier M is represented by a Q0.31 `multiplier` and a power-of-two
+// `shift` (positive means left shift).
+
+// Multiplies a symmetrically quantized 8-bit matrix of shape [m_rows, m_cols]
+// by a batch of asymmetrically quantized uint8 vectors (zero point
+// `vector_zero_point`). The optional per-row 32-bit `bias` is added to each
+// dot product, which is then rescaled by multiplier/shift and saturating-added
+// to the int16 `result` buffer of shape [n_batch, m_rows].
+void MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ matrix, int m_rows, int m_cols,
+    const uint8_t* __restrict__ vectors, int32_t vector_zero_point,
+    const int32_t* bias, int32_t multiplier, int shift, int n_batch,
+    int16_t* __restrict__ result);
+
+// Multiplies a symmetrically quantized 8-bit matrix of shape [m_rows, m_cols]
+// by a batch of int16 vectors. The optional per-row 32-bit `bias` is added to
+// each dot product, which is then rescaled by multiplier/shift, offset by
+// `output_zero_point` and stored, clamped to [output_min, output_max], in the
+// uint8 `result` buffer of shape [n_batch, m_rows].
+void MatrixBatchVectorMultiply(const int8_t* __restrict__ matrix, int m_rows,
+                               int m_cols, const int16_t* __restrict__ vectors,
+                               const int32_t* bias, int32_t multiplier,
+                               int shift, int32_t output_zero_point,
+                               int32_t output_min, int32_t output_max,
+                               int n_batch, uint8_t* __restrict__ result);
+
+// Cwise product of an 8-bit vector and an int16 batch-vector, rescaled by
+// multiplier/shift and saturating-accumulated to the int16 result.
+void VectorBatchVectorCwiseProductAccumulate(const int8_t* vector, int v_size,
+                                             const int16_t* batch_vector,
+                                             int n_batch, int32_t multiplier,
+                                             int shift, int16_t* result);
+
+// Apply sigmoid to elements of a vector, from Q3.12 to Q0.15.
+void ApplySigmoidToVector(const int16_t* vector, int v_size, int16_t* result);
+
+// Apply tanh to elements of a vector with `integer_bits` integer bits (at most
+// 6), producing Q0.15 values.
+void ApplyTanhToVector(const int16_t* vector, int v_size, int integer_bits,
+                       int16_t* result);
+
+// Cwise product of two int16 vectors. The 32-bit products are rounding-shifted
+// right by `shift` bits and saturated to int16.
+void VectorVectorCwiseProduct(const int16_t* vector1, const int16_t* vector2,
+                              int v_size, int shift, int16_t* result);
+
+// Same as above, but the saturated products are saturating-added to result.
+void VectorVectorCwiseProductAccumulate(const int16_t* vector1,
+                                        const int16_t* vector2, int v_size,
+                                        int shift, int16_t* result);
+
+// Compute "1.0 - elements of vector" for Q0.15 values (used in CIFG).
+void Sub1Vector(const int16_t* vector, int v_size, int16_t* result);
+
+// Clip elements of an int16 vector using a abs_limit value.
+void ClipVector(const int16_t* vector, int v_size, int16_t abs_limit,
+                int16_t* result);
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
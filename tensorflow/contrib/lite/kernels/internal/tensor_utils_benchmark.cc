@@ -0,0 +1,149 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Times the portable and, where available, the NEON implementations of the
+// tensor_utils primitives of the integer LSTM kernel, on the matrix sizes of
+// the gate and projection matmuls of typical speech models.
+//
+// Usage: tensor_utils_benchmark [min_seconds_per_benchmark]
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/contrib/lite/kernels/internal/optimized/cpu_check.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/tensor_utils_impl.h"
+
+namespace tflite {
+namespace tensor_utils {
+namespace {
+
+double min_seconds = 0.5;
+
+// Runs `fn` until `min_seconds` have elapsed and prints the mean time per
+// call, and the number of multiply-accumulates (or activations) per second.
+void Run(const char* name, int m_rows, int m_cols, int n_batch,
+         const std::function<void()>& fn) {
+  using Clock = std::chrono::steady_clock;
+  fn();  // Warm up the caches.
+  int64_t iterations = 0;
+  const Clock::time_point start = Clock::now();
+  double elapsed = 0;
+  do {
+    for (int i = 0; i < 16; ++i) fn();
+    iterations += 16;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < min_seconds);
+  const double micros = elapsed * 1e6 / iterations;
+  const double ops = static_cast<double>(m_rows) * m_cols * n_batch;
+  std::printf("%-44s %5d x %5d, batch %2d: %10.2f us %10.1f Mop/s\n", name,
+              m_rows, m_cols, n_batch, micros, ops / micros);
+}
+
+template <typename T>
+std::vector<T> RandomVector(int size, int min, int max) {
+  std::vector<T> values(size);
+  for (T& v : values) {
+    v = static_cast<T>(min + std::rand() % (max - min + 1));
+  }
+  return values;
+}
+
+void BenchmarkInputMatmul(int m_rows, int m_cols, int n_batch) {
+  const auto matrix = RandomVector<int8_t>(m_rows * m_cols, -127, 127);
+  const auto vectors = RandomVector<uint8_t>(m_cols * n_batch, 0, 255);
+  const auto bias = RandomVector<int32_t>(m_rows, -1000, 1000);
+  std::vector<int16_t> result(m_rows * n_batch);
+  const int32_t multiplier = 1 << 30;
+  const int shift = -8;
+  Run("Portable MatrixBatchVectorMultiplyAccumulate", m_rows, m_cols, n_batch,
+      [&]() {
+        PortableMatrixBatchVectorMultiplyAccumulate(
+            matrix.data(), m_rows, m_cols, vectors.data(), 128, bias.data(),
+            multiplier, shift, n_batch, result.data());
+      });
+#ifdef USE_NEON
+  if (TestCPUFeatureNeon()) {
+    Run("Neon MatrixBatchVectorMultiplyAccumulate", m_rows, m_cols, n_batch,
+        [&]() {
+          NeonMatrixBatchVectorMultiplyAccumulate(
+              matrix.data(), m_rows, m_cols, vectors.data(), 128, bias.data(),
+              multiplier, shift, n_batch, result.data());
+        });
+  }
+#endif
+}
+
+void BenchmarkProjectionMatmul(int m_rows, int m_cols, int n_batch) {
+  const auto matrix = RandomVector<int8_t>(m_rows * m_cols, -127, 127);
+  const auto vectors = RandomVector<int16_t>(m_cols * n_batch, -32768, 32767);
+  const auto bias = RandomVector<int32_t>(m_rows, -1000, 1000);
+  std::vector<uint8_t> result(m_rows * n_batch);
+  const int32_t multiplier = 1 << 30;
+  const int shift = -16;
+  Run("Portable MatrixBatchVectorMultiply", m_rows, m_cols, n_batch, [&]() {
+    PortableMatrixBatchVectorMultiply(matrix.data(), m_rows, m_cols,
+                                      vectors.data(), bias.data(), multiplier,
+                                      shift, 128, 0, 255, n_batch,
+                                      result.data());
+  });
+#ifdef USE_NEON
+  if (TestCPUFeatureNeon()) {
+    Run("Neon MatrixBatchVectorMultiply", m_rows, m_cols, n_batch, [&]() {
+      NeonMatrixBatchVectorMultiply(matrix.data(), m_rows, m_cols,
+                                    vectors.data(), bias.data(), multiplier,
+                                    shift, 128, 0, 255, n_batch,
+                                    result.data());
+    });
+  }
+#endif
+}
+
+// The activations only have portable implementations; they are timed as
+// n_batch vectors of m_rows values.
+void BenchmarkActivations(int m_rows, int n_batch) {
+  const int size = m_rows * n_batch;
+  const auto vector = RandomVector<int16_t>(size, -32768, 32767);
+  std::vector<int16_t> result(size);
+  Run("Portable ApplySigmoidToVector", m_rows, 1, n_batch, [&]() {
+    PortableApplySigmoidToVector(vector.data(), size, result.data());
+  });
+  Run("Portable ApplyTanhToVector", m_rows, 1, n_batch, [&]() {
+    PortableApplyTanhToVector(vector.data(), size, /*integer_bits=*/3,
+                              result.data());
+  });
+}
+
+}  // namespace
+}  // namespace tensor_utils
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  using namespace tflite::tensor_utils;  // NOLINT(build/namespaces)
+  if (argc > 1) min_seconds = std::atof(argv[1]);
+  std::printf("NEON %s\n",
+              tflite::TestCPUFeatureNeon() ? "available" : "not available");
+  // The gate matmuls of an LSTM layer with n_cell = 2048 on 512 inputs, and
+  // its projection from 2048 cells to 640 outputs.
+  for (int n_batch : {1, 8}) {
+    BenchmarkInputMatmul(2048, 512, n_batch);
+    BenchmarkInputMatmul(2048, 640, n_batch);
+    BenchmarkProjectionMatmul(640, 2048, n_batch);
+    BenchmarkActivations(2048, n_batch);
+  }
+  return 0;
+}
@@ -712,5 +712,121 @@ TEST(uKernels, ReductionSumVectorTest) {
   EXPECT_THAT(result2, ElementsAreArray(ArrayFloatNear({1.0, 3.5})));
 }
 
+TEST(uKernels, MatrixBatchVectorMultiplyAccumulateInt16Test) {
+  constexpr int kRow = 2;
+  constexpr int kCol = 3;
+  constexpr int kBatch = 2;
+  static int8_t matrix[kRow * kCol] = {1, 2, 3, -1, -2, -3};
+  // Dequantized with zero point 128: {1, 2, 3} and {0, -1, -2}.
+  static uint8_t vectors[kBatch * kCol] = {129, 130, 131, 128, 127, 126};
+  static int32_t bias[kRow] = {4, -4};
+  std::vector<int16_t> output(kRow * kBatch, 1);
+  // A multiplier of 0.5.
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vectors,
+                                      /*vector_zero_point=*/128, bias,
+                                      /*multiplier=*/1 << 30, /*shift=*/0,
+                                      kBatch, output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({10, -8, -1, 3}));
+}
+
+TEST(uKernels, MatrixBatchVectorMultiplyInt16Test) {
+  constexpr int kRow = 2;
+  constexpr int kCol = 3;
+  constexpr int kBatch = 2;
+  static int8_t matrix[kRow * kCol] = {1, 2, 3, -1, -2, -3};
+  static int16_t vectors[kBatch * kCol] = {10, 20, 30, -40, 0, 40};
+  std::vector<uint8_t> output(kRow * kBatch);
+  // A multiplier of 1/16.
+  MatrixBatchVectorMultiply(matrix, kRow, kCol, vectors, /*bias=*/nullptr,
+                            /*multiplier=*/1 << 30, /*shift=*/-3,
+                            /*output_zero_point=*/128, /*output_min=*/0,
+                            /*output_max=*/135, kBatch, output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({135, 119, 133, 123}));
+}
+
+TEST(uKernels, VectorBatchVectorCwiseProductAccumulateInt16Test) {
+  constexpr int kVectorSize = 2;
+  constexpr int kBatch = 2;
+  static int8_t vector[kVectorSize] = {1, -2};
+  static int16_t batch_vector[kVectorSize * kBatch] = {100, 200, -100, 50};
+  std::vector<int16_t> output(kVectorSize * kBatch, 0);
+  // A multiplier of 0.5.
+  VectorBatchVectorCwiseProductAccumulate(vector, kVectorSize, batch_vector,
+                                          kBatch, /*multiplier=*/1 << 30,
+                                          /*shift=*/0, output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({50, -200, -50, -50}));
+}
+
+TEST(uKernels, ApplySigmoidToVectorInt16Test) {
+  constexpr int kVectorSize = 3;
+  // 0.0, 1.0 and -1.0 in Q3.12.
+  static int16_t input[kVectorSize] = {0, 4096, -4096};
+  int16_t output[kVectorSize];
+  ApplySigmoidToVector(input, kVectorSize, output);
+  std::vector<float> result;
+  for (int16_t v : output) {
+    result.push_back(v / 32768.0f);
+  }
+  EXPECT_THAT(result, ElementsAreArray(ArrayFloatNear(
+                          {0.5, 0.73105858, 0.26894142}, 1e-3)));
+}
+
+TEST(uKernels, ApplyTanhToVectorInt16Test) {
+  constexpr int kVectorSize = 3;
+  // 0.0, 1.0 and -2.0 in Q3.12 and in Q4.11.
+  static int16_t input_q3[kVectorSize] = {0, 4096, -8192};
+  static int16_t input_q4[kVectorSize] = {0, 2048, -4096};
+  int16_t output_q3[kVectorSize];
+  int16_t output_q4[kVectorSize];
+  ApplyTanhToVector(input_q3, kVectorSize, /*integer_bits=*/3, output_q3);
+  ApplyTanhToVector(input_q4, kVectorSize, /*integer_bits=*/4, output_q4);
+  for (int i = 0; i < kVectorSize; ++i) {
+    EXPECT_EQ(output_q3[i], output_q4[i]);
+  }
+  std::vector<float> result;
+  for (int16_t v : output_q3) {
+    result.push_back(v / 32768.0f);
+  }
+  EXPECT_THAT(result, ElementsAreArray(ArrayFloatNear(
+                          {0.0, 0.76159416, -0.96402758}, 1e-3)));
+}
+
+TEST(uKernels, VectorVectorCwiseProductInt16Test) {
+  constexpr int kVectorSize = 3;
+  static int16_t input1[kVectorSize] = {16384, -16384, 8192};
+  static int16_t input2[kVectorSize] = {16384, 16384, -32768};
+  std::vector<int16_t> output(kVectorSize);
+  VectorVectorCwiseProduct(input1, input2, kVectorSize, /*shift=*/15,
+                           output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({8192, -8192, -8192}));
+}
+
+TEST(uKernels, VectorVectorCwiseProductAccumulateInt16Test) {
+  constexpr int kVectorSize = 3;
+  static int16_t input1[kVectorSize] = {16384, -16384, 32767};
+  static int16_t input2[kVectorSize] = {16384, 16384, 32767};
+  std::vector<int16_t> output(kVectorSize, 100);
+  VectorVectorCwiseProductAccumulate(input1, input2, kVectorSize,
+                                     /*shift=*/15, output.data());
+  // The last product saturates.
+  EXPECT_THAT(output, testing::ElementsAreArray({8292, -8092, 32767}));
+}
+
+TEST(uKernels, Sub1VectorInt16Test) {
+  constexpr int kVectorSize = 3;
+  static int16_t input[kVectorSize] = {0, 16384, 32767};
+  std::vector<int16_t> output(kVectorSize);
+  Sub1Vector(input, kVectorSize, output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({32767, 16383, 0}));
+}
+
+TEST(uKernels, ClipVectorInt16Test) {
+  constexpr int kVectorSize = 4;
+  static int16_t input[kVectorSize] = {-300, -100, 100, 300};
+  std::vector<int16_t> output(kVectorSize);
+  ClipVector(input, kVectorSize, /*abs_limit=*/200, output.data());
+  EXPECT_THAT(output, testing::ElementsAreArray({-200, -100, 100, 200}));
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
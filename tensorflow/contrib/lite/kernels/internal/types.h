@@ -802,6 +802,11 @@ struct LocalResponseNormalizationParams {
   double bias;
   double alpha;
   double beta;
+  // uint8 inference params.
+  int32 input_zero_point;
+  float input_scale;
+  int32 output_zero_point;
+  float output_scale;
 };
 
 struct LogisticParams {
@@ -43,8 +43,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE_EQ(context, NumDimensions(input), 4);
 
-  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, output->type == kTfLiteFloat32 ||
+                              output->type == kTfLiteUInt8);
   TF_LITE_ENSURE_EQ(context, input->type, output->type);
+  if (output->type == kTfLiteUInt8) {
+    TF_LITE_ENSURE(context, output->params.scale > 0);
+  }
 
   TfLiteIntArray* output_size = TfLiteIntArrayCreate(4);
   output_size->data[0] = input->dims->data[0];
@@ -63,28 +67,39 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+#define TF_LITE_LOCAL_RESPONSE_NORM(type, data_type)                          \
+  type::LocalResponseNormalization(                                          \
+      op_params, GetTensorShape(input), GetTensorData<data_type>(input),     \
+      GetTensorShape(output), GetTensorData<data_type>(output))
+  tflite::LocalResponseNormalizationParams op_params;
+  op_params.range = params->radius;
+  op_params.bias = params->bias;
+  op_params.alpha = params->alpha;
+  op_params.beta = params->beta;
   if (output->type == kTfLiteFloat32) {
-#define TF_LITE_LOCAL_RESPONSE_NORM(type)                            \
-  tflite::LocalResponseNormalizationParams op_params;                \
-  op_params.range = params->radius;                                  \
-  op_params.bias = params->bias;                                     \
-  op_params.alpha = params->alpha;                                   \
-  op_params.beta = params->beta;                                     \
-  type::LocalResponseNormalization(                                  \
-      op_params, GetTensorShape(input), GetTensorData<float>(input), \
-      GetTensorShape(output), GetTensorData<float>(output))
     if (kernel_type == kReference) {
-      TF_LITE_LOCAL_RESPONSE_NORM(reference_ops);
+      TF_LITE_LOCAL_RESPONSE_NORM(reference_ops, float);
     }
     if (kernel_type == kGenericOptimized) {
-      TF_LITE_LOCAL_RESPONSE_NORM(optimized_ops);
+      TF_LITE_LOCAL_RESPONSE_NORM(optimized_ops, float);
+    }
+  } else if (output->type == kTfLiteUInt8) {
+    op_params.input_zero_point = input->params.zero_point;
+    op_params.input_scale = input->params.scale;
+    op_params.output_zero_point = output->params.zero_point;
+    op_params.output_scale = output->params.scale;
+    if (kernel_type == kReference) {
+      TF_LITE_LOCAL_RESPONSE_NORM(reference_ops, uint8_t);
+    }
+    if (kernel_type == kGenericOptimized) {
+      TF_LITE_LOCAL_RESPONSE_NORM(optimized_ops, uint8_t);
     }
-#undef TF_LITE_LOCAL_RESPONSE_NORM
   } else {
-    context->ReportError(context, "Output type is %d, requires float.",
+    context->ReportError(context, "Output type is %d, requires float or uint8.",
                          output->type);
     return kTfLiteError;
   }
+#undef TF_LITE_LOCAL_RESPONSE_NORM
 
   return kTfLiteOk;
 }
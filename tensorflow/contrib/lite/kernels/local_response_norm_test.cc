@@ -13,19 +13,31 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <gtest/gtest.h>
+#include "absl/memory/memory.h"
 #include "tensorflow/contrib/lite/interpreter.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/kernels/test_util.h"
 #include "tensorflow/contrib/lite/model.h"
 
 namespace tflite {
+
+namespace ops {
+namespace builtin {
+
+TfLiteRegistration* Register_LOCAL_RESPONSE_NORM_REF();
+TfLiteRegistration* Register_LOCAL_RESPONSE_NORM_GENERIC_OPT();
+
+}  // namespace builtin
+}  // namespace ops
+
 namespace {
 
 using ::testing::ElementsAreArray;
 
 class LocalResponseNormOpModel : public SingleOpModel {
  public:
-  LocalResponseNormOpModel(std::initializer_list<int> input_shape, int radius,
+  LocalResponseNormOpModel(TfLiteRegistration* registration,
+                           std::initializer_list<int> input_shape, int radius,
                            float bias, float alpha, float beta) {
     input_ = AddInput(TensorType_FLOAT32);
     output_ = AddOutput(TensorType_FLOAT32);
@@ -34,6 +46,8 @@ class LocalResponseNormOpModel : public SingleOpModel {
                  CreateLocalResponseNormalizationOptions(builder_, radius, bias,
                                                          alpha, beta)
                      .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_LOCAL_RESPONSE_NORMALIZATION, registration);
     BuildInterpreter({input_shape});
   }
 
@@ -48,9 +62,25 @@ class LocalResponseNormOpModel : public SingleOpModel {
   int output_;
 };
 
-TEST(LocalResponseNormOpTest, SameAsL2Norm) {
-  LocalResponseNormOpModel m({1, 1, 1, 6}, /*radius=*/20, /*bias=*/0.0,
-                             /*alpha=*/1.0, /*beta=*/0.5);
+const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
+    {"Reference", ops::builtin::Register_LOCAL_RESPONSE_NORM_REF()},
+    {"GenericOptimized",
+     ops::builtin::Register_LOCAL_RESPONSE_NORM_GENERIC_OPT()},
+});
+
+// Both kernels sum the squares over the inclusive window
+// [c - radius, c + radius], so they are checked against the same values.
+class LocalResponseNormOpTest : public SingleOpTest {
+ protected:
+  const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
+    return *kKernelMap;
+  }
+};
+
+TEST_P(LocalResponseNormOpTest, SameAsL2Norm) {
+  LocalResponseNormOpModel m(GetRegistration(), {1, 1, 1, 6},
+                             /*radius=*/20, /*bias=*/0.0, /*alpha=*/1.0,
+                             /*beta=*/0.5);
   m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
   m.Invoke();
   // The result is every input divided by 2.
@@ -59,9 +89,10 @@ TEST(LocalResponseNormOpTest, SameAsL2Norm) {
       ElementsAreArray(ArrayFloatNear({-0.55, 0.3, 0.35, 0.6, -0.35, 0.05})));
 }
 
-TEST(LocalResponseNormOpTest, WithAlpha) {
-  LocalResponseNormOpModel m({1, 1, 1, 6}, /*radius=*/20, /*bias=*/0.0,
-                             /*alpha=*/4.0, /*beta=*/0.5);
+TEST_P(LocalResponseNormOpTest, WithAlpha) {
+  LocalResponseNormOpModel m(GetRegistration(), {1, 1, 1, 6},
+                             /*radius=*/20, /*bias=*/0.0, /*alpha=*/4.0,
+                             /*beta=*/0.5);
   m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
   m.Invoke();
   // The result is every input divided by 3.
@@ -69,9 +100,10 @@ TEST(LocalResponseNormOpTest, WithAlpha) {
                                  {-0.275, 0.15, 0.175, 0.3, -0.175, 0.025})));
 }
 
-TEST(LocalResponseNormOpTest, WithBias) {
-  LocalResponseNormOpModel m({1, 1, 1, 6}, /*radius=*/20, /*bias=*/9.0,
-                             /*alpha=*/4.0, /*beta=*/0.5);
+TEST_P(LocalResponseNormOpTest, WithBias) {
+  LocalResponseNormOpModel m(GetRegistration(), {1, 1, 1, 6},
+                             /*radius=*/20, /*bias=*/9.0, /*alpha=*/4.0,
+                             /*beta=*/0.5);
   m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
   m.Invoke();
   // The result is every input divided by 5.
@@ -80,9 +112,10 @@ TEST(LocalResponseNormOpTest, WithBias) {
       ElementsAreArray(ArrayFloatNear({-0.22, 0.12, 0.14, 0.24, -0.14, 0.02})));
 }
 
-TEST(LocalResponseNormOpTest, SmallRadius) {
-  LocalResponseNormOpModel m({1, 1, 1, 6}, /*radius=*/2, /*bias=*/9.0,
-                             /*alpha=*/4.0, /*beta=*/0.5);
+TEST_P(LocalResponseNormOpTest, SmallRadius) {
+  LocalResponseNormOpModel m(GetRegistration(), {1, 1, 1, 6},
+                             /*radius=*/2, /*bias=*/9.0, /*alpha=*/4.0,
+                             /*beta=*/0.5);
   m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
   m.Invoke();
   EXPECT_THAT(
@@ -91,6 +124,77 @@ TEST(LocalResponseNormOpTest, SmallRadius) {
           {-0.264926, 0.125109, 0.140112, 0.267261, -0.161788, 0.0244266})));
 }
 
+class QuantizedLocalResponseNormOpModel : public SingleOpModel {
+ public:
+  QuantizedLocalResponseNormOpModel(TfLiteRegistration* registration,
+                                    const TensorData& input,
+                                    const TensorData& output, int radius,
+                                    float bias, float alpha, float beta) {
+    input_ = AddInput(input);
+    output_ = AddOutput(output);
+    SetBuiltinOp(BuiltinOperator_LOCAL_RESPONSE_NORMALIZATION,
+                 BuiltinOptions_LocalResponseNormalizationOptions,
+                 CreateLocalResponseNormalizationOptions(builder_, radius, bias,
+                                                         alpha, beta)
+                     .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_LOCAL_RESPONSE_NORMALIZATION, registration);
+    BuildInterpreter({GetShape(input_)});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    QuantizeAndPopulate<uint8_t>(input_, data);
+  }
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+ private:
+  int input_;
+  int output_;
+};
+
+// The error shouldn't exceed about one step of the output range.
+const float kQuantizedTolerance = 1.5 * (2.0 / 255.0);
+
+class QuantizedLocalResponseNormOpTest : public LocalResponseNormOpTest {};
+
+TEST_P(QuantizedLocalResponseNormOpTest, SameAsL2Norm) {
+  QuantizedLocalResponseNormOpModel m(
+      GetRegistration(), {TensorType_UINT8, {1, 1, 1, 6}, -2.0, 2.0},
+      {TensorType_UINT8, {1, 1, 1, 6}, -1.0, 1.0}, /*radius=*/20,
+      /*bias=*/0.0, /*alpha=*/1.0, /*beta=*/0.5);
+  m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-0.55, 0.3, 0.35, 0.6, -0.35, 0.05}, kQuantizedTolerance)));
+}
+
+TEST_P(QuantizedLocalResponseNormOpTest, SmallRadius) {
+  QuantizedLocalResponseNormOpModel m(
+      GetRegistration(), {TensorType_UINT8, {1, 1, 1, 6}, -2.0, 2.0},
+      {TensorType_UINT8, {1, 1, 1, 6}, -1.0, 1.0}, /*radius=*/2,
+      /*bias=*/9.0, /*alpha=*/4.0, /*beta=*/0.75);
+  m.SetInput({-1.1, 0.6, 0.7, 1.2, -0.7, 0.1});
+  m.Invoke();
+  EXPECT_THAT(m.GetDequantizedOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-0.130014, 0.0571288, 0.0626851, 0.126129, -0.0777801,
+                   0.0120724},
+                  kQuantizedTolerance)));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    LocalResponseNormOpTest, LocalResponseNormOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
+
+INSTANTIATE_TEST_CASE_P(
+    QuantizedLocalResponseNormOpTest, QuantizedLocalResponseNormOpTest,
+    ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
+
 }  // namespace
 }  // namespace tflite
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
 #include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
@@ -45,6 +47,10 @@ struct OpData {
   int activation_state_tensor_index;
   int cell_state_tensor_index;
   int scratch_tensor_index;
+
+  // Rescaling parameters of the integer kernel, only used when the input is
+  // quantized.
+  kernel_utils::IntegerLstmParameter integer_lstm_param;
 };
 
 // For full inputs kernel (20-inputs).
@@ -246,6 +252,176 @@ TfLiteStatus CheckInputTensorDimensions(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+// Checks the tensor types of the integer kernel and precomputes the
+// multipliers used to rescale its intermediate results. The input, output and
+// activation state are asymmetric uint8 tensors, the weights symmetric int8
+// values stored in uint8 tensors, the biases int32 tensors and the cell state
+// an int16 tensor whose scale is a power of two.
+TfLiteStatus PopulateIntegerLstmParams(TfLiteContext* context,
+                                       TfLiteNode* node,
+                                       const TfLiteTensor* output,
+                                       const TfLiteTensor* activation_state,
+                                       const TfLiteTensor* cell_state,
+                                       OpData* op_data) {
+  const auto* params = reinterpret_cast<TfLiteLSTMParams*>(node->builtin_data);
+  kernel_utils::IntegerLstmParameter* integer_param =
+      &op_data->integer_lstm_param;
+  const TfLiteTensor* input = GetInput(context, node, kInputTensor);
+
+  TF_LITE_ENSURE_EQ(context, params->activation, kTfLiteActTanh);
+  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, activation_state->type, kTfLiteUInt8);
+  TF_LITE_ENSURE_EQ(context, activation_state->params.scale,
+                    output->params.scale);
+  TF_LITE_ENSURE_EQ(context, activation_state->params.zero_point,
+                    output->params.zero_point);
+  TF_LITE_ENSURE_EQ(context, cell_state->type, kTfLiteInt16);
+
+  // The cell state is in Q(cell_integer_bits).(15 - cell_integer_bits).
+  int cell_state_log2;
+  TF_LITE_ENSURE(context,
+                 CheckedLog2(cell_state->params.scale, &cell_state_log2));
+  integer_param->cell_integer_bits = 15 + cell_state_log2;
+  TF_LITE_ENSURE(context, integer_param->cell_integer_bits >= 0);
+  TF_LITE_ENSURE(context, integer_param->cell_integer_bits <= 6);
+
+  // Gate pre-activations are in Q3.12.
+  const double gate_scale = 1.0 / (1 << 12);
+  // Quantizes the multiplier from the accumulator of weights times vector
+  // values into the gate pre-activations. Missing optional weights get a zero
+  // multiplier.
+  auto quantize_gate_multiplier = [&](int weights_index, double vector_scale,
+                                      int bias_index, int32_t* multiplier,
+                                      int* shift) -> TfLiteStatus {
+    const TfLiteTensor* weights =
+        GetOptionalInputTensor(context, node, weights_index);
+    if (weights == nullptr) {
+      *multiplier = 0;
+      *shift = 0;
+      return kTfLiteOk;
+    }
+    TF_LITE_ENSURE_EQ(context, weights->type, kTfLiteUInt8);
+    if (bias_index >= 0) {
+      const TfLiteTensor* bias = GetOptionalInputTensor(context, node,
+                                                        bias_index);
+      TF_LITE_ENSURE(context, bias != nullptr);
+      TF_LITE_ENSURE_EQ(context, bias->type, kTfLiteInt32);
+    }
+    QuantizeMultiplier(vector_scale * weights->params.scale / gate_scale,
+                       multiplier, shift);
+    return kTfLiteOk;
+  };
+
+  const double input_scale = input->params.scale;
+  const double output_scale = output->params.scale;
+  const double cell_scale = cell_state->params.scale;
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kInputToInputWeightsTensor, input_scale,
+                        kInputGateBiasTensor,
+                        &integer_param->input_to_input_multiplier,
+                        &integer_param->input_to_input_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kInputToForgetWeightsTensor, input_scale,
+                        kForgetGateBiasTensor,
+                        &integer_param->input_to_forget_multiplier,
+                        &integer_param->input_to_forget_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kInputToCellWeightsTensor, input_scale,
+                        kCellGateBiasTensor,
+                        &integer_param->input_to_cell_multiplier,
+                        &integer_param->input_to_cell_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kInputToOutputWeightsTensor, input_scale,
+                        kOutputGateBiasTensor,
+                        &integer_param->input_to_output_multiplier,
+                        &integer_param->input_to_output_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kRecurrentToInputWeightsTensor, output_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->recurrent_to_input_multiplier,
+                        &integer_param->recurrent_to_input_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kRecurrentToForgetWeightsTensor, output_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->recurrent_to_forget_multiplier,
+                        &integer_param->recurrent_to_forget_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kRecurrentToCellWeightsTensor, output_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->recurrent_to_cell_multiplier,
+                        &integer_param->recurrent_to_cell_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kRecurrentToOutputWeightsTensor, output_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->recurrent_to_output_multiplier,
+                        &integer_param->recurrent_to_output_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kCellToInputWeightsTensor, cell_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->cell_to_input_multiplier,
+                        &integer_param->cell_to_input_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kCellToForgetWeightsTensor, cell_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->cell_to_forget_multiplier,
+                        &integer_param->cell_to_forget_shift));
+  TF_LITE_ENSURE_OK(context,
+                    quantize_gate_multiplier(
+                        kCellToOutputWeightsTensor, cell_scale,
+                        /*bias_index=*/-1,
+                        &integer_param->cell_to_output_multiplier,
+                        &integer_param->cell_to_output_shift));
+
+  // The hidden state is in Q0.15 and is either projected or requantized
+  // directly to the output.
+  const double hidden_scale = 1.0 / (1 << 15);
+  const TfLiteTensor* projection_weights =
+      GetOptionalInputTensor(context, node, kProjectionWeightsTensor);
+  double hidden_multiplier = hidden_scale / output_scale;
+  if (projection_weights != nullptr) {
+    TF_LITE_ENSURE_EQ(context, projection_weights->type, kTfLiteUInt8);
+    const TfLiteTensor* projection_bias =
+        GetOptionalInputTensor(context, node, kProjectionBiasTensor);
+    if (projection_bias != nullptr) {
+      TF_LITE_ENSURE_EQ(context, projection_bias->type, kTfLiteInt32);
+    }
+    hidden_multiplier *= projection_weights->params.scale;
+  }
+  QuantizeMultiplier(hidden_multiplier, &integer_param->hidden_multiplier,
+                     &integer_param->hidden_shift);
+
+  integer_param->quantized_cell_clip = 0;
+  if (params->cell_clip > 0.0) {
+    integer_param->quantized_cell_clip = static_cast<int16_t>(
+        std::min(static_cast<double>(std::numeric_limits<int16_t>::max()),
+                 std::round(params->cell_clip / cell_scale)));
+  }
+
+  integer_param->input_zero_point = input->params.zero_point;
+  integer_param->output_zero_point = output->params.zero_point;
+  integer_param->output_min = std::numeric_limits<uint8_t>::min();
+  integer_param->output_max = std::numeric_limits<uint8_t>::max();
+  if (params->proj_clip > 0.0) {
+    const int32_t clip =
+        static_cast<int32_t>(std::round(params->proj_clip / output_scale));
+    integer_param->output_min = std::max(
+        integer_param->output_min, output->params.zero_point - clip);
+    integer_param->output_max = std::min(
+        integer_param->output_max, output->params.zero_point + clip);
+  }
+  return kTfLiteOk;
+}
+
 // Resize the output, state tensors based on the sizes of the input tensors.
 // Allocate a temporary scratch tensor. Also check that the sizes of the input
 // tensors match each other.
@@ -262,7 +438,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Inferring batch size, number of outputs and number of cells from the
   // input tensors.
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
-  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context,
+                 input->type == kTfLiteFloat32 || input->type == kTfLiteUInt8);
   TF_LITE_ENSURE(context, input->dims->size > 1);
   const int n_batch = input->dims->data[0];
   const int n_input = input->dims->data[1];
@@ -309,6 +486,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // TODO(mirkov): create a utility/macro for this check, so all Ops can use it.
   const bool is_hybrid_op = (input_to_output_weights->type == kTfLiteUInt8 &&
                              input->type == kTfLiteFloat32);
+  const bool is_integer_op = (input->type == kTfLiteUInt8);
+  if (is_integer_op) {
+    TF_LITE_ENSURE_OK(context, PopulateIntegerLstmParams(context, node, output,
+                                                         activation_state,
+                                                         cell_state, op_data));
+  }
 
   TfLiteIntArrayFree(node->temporaries);
   if (is_hybrid_op) {
@@ -320,7 +503,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   // Create a scratch buffer tensor.
   TfLiteTensor* scratch_buffer = GetTemporary(context, node, /*index=*/0);
-  scratch_buffer->type = input->type;
+  scratch_buffer->type = is_integer_op ? kTfLiteInt16 : input->type;
   scratch_buffer->allocation_type = kTfLiteArenaRw;
 
   const TfLiteTensor* input_to_input_weights =
@@ -681,6 +864,104 @@ TfLiteStatus EvalHybrid(
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalInteger(
+    const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights,
+    const TfLiteTensor* cell_to_input_weights,
+    const TfLiteTensor* cell_to_forget_weights,
+    const TfLiteTensor* cell_to_output_weights,
+    const TfLiteTensor* input_gate_bias, const TfLiteTensor* forget_gate_bias,
+    const TfLiteTensor* cell_bias, const TfLiteTensor* output_gate_bias,
+    const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
+    const kernel_utils::IntegerLstmParameter* integer_lstm_param,
+    TfLiteTensor* scratch_buffer, TfLiteTensor* activation_state,
+    TfLiteTensor* cell_state, TfLiteTensor* output) {
+  const int n_batch = input->dims->data[0];
+  const int n_input = input->dims->data[1];
+  // n_cell and n_output will be the same size when there is no projection.
+  const int n_cell = input_to_output_weights->dims->data[0];
+  const int n_output = recurrent_to_output_weights->dims->data[1];
+
+  // Since we have already checked that weights are all there or none, we can
+  // check the existence of only one to get the condition.
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  const bool use_peephole = (cell_to_output_weights != nullptr);
+
+  int16_t* input_gate_scratch = nullptr;
+  int16_t* cell_scratch = nullptr;
+  int16_t* forget_gate_scratch = nullptr;
+  int16_t* output_gate_scratch = nullptr;
+  if (use_cifg) {
+    cell_scratch = scratch_buffer->data.i16;
+    forget_gate_scratch = scratch_buffer->data.i16 + n_cell * n_batch;
+    output_gate_scratch = scratch_buffer->data.i16 + 2 * n_cell * n_batch;
+  } else {
+    input_gate_scratch = scratch_buffer->data.i16;
+    cell_scratch = scratch_buffer->data.i16 + n_cell * n_batch;
+    forget_gate_scratch = scratch_buffer->data.i16 + 2 * n_cell * n_batch;
+    output_gate_scratch = scratch_buffer->data.i16 + 3 * n_cell * n_batch;
+  }
+
+  // Check optional tensors, the respective pointers can be null.
+  const int8_t* input_to_input_weights_ptr = nullptr;
+  const int8_t* recurrent_to_input_weights_ptr = nullptr;
+  const int32_t* input_gate_bias_ptr = nullptr;
+  if (!use_cifg) {
+    input_to_input_weights_ptr =
+        reinterpret_cast<int8_t*>(input_to_input_weights->data.uint8);
+    recurrent_to_input_weights_ptr =
+        reinterpret_cast<int8_t*>(recurrent_to_input_weights->data.uint8);
+    input_gate_bias_ptr = input_gate_bias->data.i32;
+  }
+
+  const int8_t* cell_to_input_weights_ptr = nullptr;
+  const int8_t* cell_to_forget_weights_ptr = nullptr;
+  const int8_t* cell_to_output_weights_ptr = nullptr;
+  if (use_peephole) {
+    if (!use_cifg) {
+      cell_to_input_weights_ptr =
+          reinterpret_cast<int8_t*>(cell_to_input_weights->data.uint8);
+    }
+    cell_to_forget_weights_ptr =
+        reinterpret_cast<int8_t*>(cell_to_forget_weights->data.uint8);
+    cell_to_output_weights_ptr =
+        reinterpret_cast<int8_t*>(cell_to_output_weights->data.uint8);
+  }
+
+  const int8_t* projection_weights_ptr =
+      (projection_weights == nullptr)
+          ? nullptr
+          : reinterpret_cast<int8_t*>(projection_weights->data.uint8);
+  const int32_t* projection_bias_ptr =
+      (projection_bias == nullptr) ? nullptr : projection_bias->data.i32;
+
+  kernel_utils::LstmStep(
+      input->data.uint8, input_to_input_weights_ptr,
+      reinterpret_cast<int8_t*>(input_to_forget_weights->data.uint8),
+      reinterpret_cast<int8_t*>(input_to_cell_weights->data.uint8),
+      reinterpret_cast<int8_t*>(input_to_output_weights->data.uint8),
+      recurrent_to_input_weights_ptr,
+      reinterpret_cast<int8_t*>(recurrent_to_forget_weights->data.uint8),
+      reinterpret_cast<int8_t*>(recurrent_to_cell_weights->data.uint8),
+      reinterpret_cast<int8_t*>(recurrent_to_output_weights->data.uint8),
+      cell_to_input_weights_ptr, cell_to_forget_weights_ptr,
+      cell_to_output_weights_ptr, input_gate_bias_ptr,
+      forget_gate_bias->data.i32, cell_bias->data.i32,
+      output_gate_bias->data.i32, projection_weights_ptr, projection_bias_ptr,
+      integer_lstm_param, n_batch, n_cell, n_input, n_output,
+      input_gate_scratch, forget_gate_scratch, cell_scratch,
+      output_gate_scratch, activation_state->data.uint8, cell_state->data.i16,
+      output->data.uint8);
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const auto* params = reinterpret_cast<TfLiteLSTMParams*>(node->builtin_data);
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
@@ -749,6 +1030,18 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                        scratch_buffer, activation_state, cell_state, output);
     }
     case kTfLiteUInt8: {
+      if (input->type == kTfLiteUInt8) {
+        return EvalInteger(
+            input, input_to_input_weights, input_to_forget_weights,
+            input_to_cell_weights, input_to_output_weights,
+            recurrent_to_input_weights, recurrent_to_forget_weights,
+            recurrent_to_cell_weights, recurrent_to_output_weights,
+            cell_to_input_weights, cell_to_forget_weights,
+            cell_to_output_weights, input_gate_bias, forget_gate_bias,
+            cell_bias, output_gate_bias, projection_weights, projection_bias,
+            &op_data->integer_lstm_param, scratch_buffer, activation_state,
+            cell_state, output);
+      }
       TfLiteTensor* input_quantized = GetTemporary(context, node, /*index=*/1);
       TfLiteTensor* activation_state_quantized =
           GetTemporary(context, node, /*index=*/2);
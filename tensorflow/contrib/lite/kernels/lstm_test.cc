@@ -292,6 +292,227 @@ class HybridLSTMOpModel : public LSTMOpModel {
   }
 };
 
+// An LSTM whose input, output and states are quantized, which runs the integer
+// kernel. The weights are symmetrically quantized with fixed scales, the gate
+// biases with the scale of the corresponding input matmul, and the projection
+// bias with the scale of the projection matmul of the Q0.15 hidden state.
+class IntegerLSTMOpModel : public SingleOpModel {
+ public:
+  IntegerLSTMOpModel(int n_batch, int n_input, int n_cell, int n_output,
+                     bool use_cifg, bool use_peephole, float input_min,
+                     float input_max, float output_min, float output_max,
+                     float weight_scale, float peephole_scale,
+                     float cell_scale, bool use_projection_weights = false,
+                     bool use_projection_bias = false,
+                     float projection_scale = 0.0, float cell_clip = 0.0,
+                     float proj_clip = 0.0)
+      : n_batch_(n_batch),
+        n_input_(n_input),
+        n_cell_(n_cell),
+        n_output_(n_output),
+        weight_scale_(weight_scale),
+        projection_scale_(projection_scale) {
+    input_ = AddInput({TensorType_UINT8, {n_batch, n_input}, input_min,
+                       input_max});
+    input_scale_ = GetScale(input_);
+    const TensorData input_weights{
+        TensorType_UINT8, {n_cell, n_input}, 0, 0, weight_scale, 0};
+    const TensorData recurrent_weights{
+        TensorType_UINT8, {n_cell, n_output}, 0, 0, weight_scale, 0};
+    const TensorData peephole_weights{
+        TensorType_UINT8, {n_cell}, 0, 0, peephole_scale, 0};
+    const TensorData bias{
+        TensorType_INT32, {n_cell}, 0, 0, input_scale_ * weight_scale, 0};
+
+    input_to_input_weights_ =
+        use_cifg ? AddNullInput() : AddInput(input_weights);
+    input_to_forget_weights_ = AddInput(input_weights);
+    input_to_cell_weights_ = AddInput(input_weights);
+    input_to_output_weights_ = AddInput(input_weights);
+
+    recurrent_to_input_weights_ =
+        use_cifg ? AddNullInput() : AddInput(recurrent_weights);
+    recurrent_to_forget_weights_ = AddInput(recurrent_weights);
+    recurrent_to_cell_weights_ = AddInput(recurrent_weights);
+    recurrent_to_output_weights_ = AddInput(recurrent_weights);
+
+    if (use_peephole) {
+      cell_to_input_weights_ =
+          use_cifg ? AddNullInput() : AddInput(peephole_weights);
+      cell_to_forget_weights_ = AddInput(peephole_weights);
+      cell_to_output_weights_ = AddInput(peephole_weights);
+    } else {
+      cell_to_input_weights_ = AddNullInput();
+      cell_to_forget_weights_ = AddNullInput();
+      cell_to_output_weights_ = AddNullInput();
+    }
+
+    input_gate_bias_ = use_cifg ? AddNullInput() : AddInput(bias);
+    forget_gate_bias_ = AddInput(bias);
+    cell_bias_ = AddInput(bias);
+    output_gate_bias_ = AddInput(bias);
+
+    if (use_projection_weights) {
+      projection_weights_ = AddInput(
+          {TensorType_UINT8, {n_output, n_cell}, 0, 0, projection_scale, 0});
+      projection_bias_ =
+          use_projection_bias
+              ? AddInput({TensorType_INT32,
+                          {n_output},
+                          0,
+                          0,
+                          projection_scale / (1 << 15),
+                          0})
+              : AddNullInput();
+    } else {
+      projection_weights_ = AddNullInput();
+      projection_bias_ = AddNullInput();
+    }
+
+    // Adding the 2 input state tensors.
+    AddInput({TensorType_UINT8, {n_output * n_batch}, output_min, output_max},
+             true);
+    AddInput({TensorType_INT16, {n_cell * n_batch}, 0, 0, cell_scale, 0},
+             true);
+
+    output_ = AddOutput({TensorType_UINT8, {}, output_min, output_max});
+
+    SetBuiltinOp(BuiltinOperator_LSTM, BuiltinOptions_LSTMOptions,
+                 CreateLSTMOptions(builder_, ActivationFunctionType_TANH,
+                                   cell_clip, proj_clip)
+                     .Union());
+
+    // The shapes are already part of the tensors.
+    BuildInterpreter({});
+  }
+
+  void SetInputToInputWeights(const std::vector<float>& f) {
+    QuantizeWeights(input_to_input_weights_, f);
+  }
+  void SetInputToForgetWeights(const std::vector<float>& f) {
+    QuantizeWeights(input_to_forget_weights_, f);
+  }
+  void SetInputToCellWeights(const std::vector<float>& f) {
+    QuantizeWeights(input_to_cell_weights_, f);
+  }
+  void SetInputToOutputWeights(const std::vector<float>& f) {
+    QuantizeWeights(input_to_output_weights_, f);
+  }
+  void SetRecurrentToInputWeights(const std::vector<float>& f) {
+    QuantizeWeights(recurrent_to_input_weights_, f);
+  }
+  void SetRecurrentToForgetWeights(const std::vector<float>& f) {
+    QuantizeWeights(recurrent_to_forget_weights_, f);
+  }
+  void SetRecurrentToCellWeights(const std::vector<float>& f) {
+    QuantizeWeights(recurrent_to_cell_weights_, f);
+  }
+  void SetRecurrentToOutputWeights(const std::vector<float>& f) {
+    QuantizeWeights(recurrent_to_output_weights_, f);
+  }
+  void SetCellToInputWeights(const std::vector<float>& f) {
+    QuantizeWeights(cell_to_input_weights_, f);
+  }
+  void SetCellToForgetWeights(const std::vector<float>& f) {
+    QuantizeWeights(cell_to_forget_weights_, f);
+  }
+  void SetCellToOutputWeights(const std::vector<float>& f) {
+    QuantizeWeights(cell_to_output_weights_, f);
+  }
+  void SetInputGateBias(const std::vector<float>& f) {
+    QuantizeBias(input_gate_bias_, f);
+  }
+  void SetForgetGateBias(const std::vector<float>& f) {
+    QuantizeBias(forget_gate_bias_, f);
+  }
+  void SetCellBias(const std::vector<float>& f) { QuantizeBias(cell_bias_, f); }
+  void SetOutputGateBias(const std::vector<float>& f) {
+    QuantizeBias(output_gate_bias_, f);
+  }
+
+  void SetProjectionWeights(const std::vector<float>& f) {
+    QuantizeWeights(projection_weights_, f);
+  }
+  void SetProjectionBias(const std::vector<float>& f) {
+    std::vector<int32_t> q;
+    for (float v : f) {
+      q.push_back(static_cast<int32_t>(
+          std::round(v * (1 << 15) / projection_scale_)));
+    }
+    PopulateTensor(projection_bias_, q);
+  }
+
+  void SetInput(const std::vector<float>& f) {
+    QuantizeAndPopulate<uint8_t>(input_, f);
+  }
+
+  std::vector<float> GetDequantizedInput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(input_),
+                               GetScale(input_), GetZeroPoint(input_));
+  }
+
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<uint8_t>(ExtractVector<uint8_t>(output_),
+                               GetScale(output_), GetZeroPoint(output_));
+  }
+
+  int num_inputs() { return n_input_; }
+  int num_outputs() { return n_output_; }
+
+ private:
+  void QuantizeWeights(int index, const std::vector<float>& f) {
+    const float scale = GetScale(index);
+    std::vector<uint8_t> q;
+    for (float v : f) {
+      q.push_back(
+          static_cast<uint8_t>(static_cast<int8_t>(std::round(v / scale))));
+    }
+    PopulateTensor(index, q);
+  }
+
+  void QuantizeBias(int index, const std::vector<float>& f) {
+    std::vector<int32_t> q;
+    for (float v : f) {
+      q.push_back(
+          static_cast<int32_t>(std::round(v / (input_scale_ * weight_scale_))));
+    }
+    PopulateTensor(index, q);
+  }
+
+  int input_;
+  int input_to_input_weights_;
+  int input_to_forget_weights_;
+  int input_to_cell_weights_;
+  int input_to_output_weights_;
+
+  int recurrent_to_input_weights_;
+  int recurrent_to_forget_weights_;
+  int recurrent_to_cell_weights_;
+  int recurrent_to_output_weights_;
+
+  int cell_to_input_weights_;
+  int cell_to_forget_weights_;
+  int cell_to_output_weights_;
+
+  int input_gate_bias_;
+  int forget_gate_bias_;
+  int cell_bias_;
+  int output_gate_bias_;
+
+  int projection_weights_;
+  int projection_bias_;
+
+  int output_;
+
+  int n_batch_;
+  int n_input_;
+  int n_cell_;
+  int n_output_;
+  float input_scale_;
+  float weight_scale_;
+  float projection_scale_;
+};
+
 class BaseLstmTest : public ::testing::Test {
  protected:
   // Weights of the LSTM model. Some are optional.
@@ -1394,6 +1615,393 @@ TEST_F(NoCifgPeepholeProjectionNoClippingLstmTest, HybridLstmBlackBoxTest) {
   VerifyGoldens(lstm_input_, lstm_golden_output_, &lstm, /*tolerance=*/0.00467);
 }
 
+// Runs the integer LSTM on a sequence of single batch inputs and compares its
+// dequantized outputs with the float goldens.
+void VerifyIntegerGoldens(const std::vector<float>& input,
+                          const std::vector<float>& golden_output,
+                          IntegerLSTMOpModel* lstm, float tolerance) {
+  const int num_inputs = lstm->num_inputs();
+  const int num_outputs = lstm->num_outputs();
+  const int input_sequence_size = input.size() / num_inputs;
+  for (int i = 0; i < input_sequence_size; ++i) {
+    lstm->SetInput(std::vector<float>(input.begin() + i * num_inputs,
+                                      input.begin() + (i + 1) * num_inputs));
+    lstm->Invoke();
+    const std::vector<float> expected(
+        golden_output.begin() + i * num_outputs,
+        golden_output.begin() + (i + 1) * num_outputs);
+    EXPECT_THAT(lstm->GetDequantizedOutput(),
+                ElementsAreArray(ArrayFloatNear(expected, tolerance)));
+  }
+}
+
+TEST(IntegerLstmOpTest, NoCifgNoPeepholeNoProjectionNoClipping) {
+  IntegerLSTMOpModel lstm(/*n_batch=*/1, /*n_input=*/2, /*n_cell=*/4,
+                          /*n_output=*/4, /*use_cifg=*/false,
+                          /*use_peephole=*/false, /*input_min=*/-5.0,
+                          /*input_max=*/5.0, /*output_min=*/-1.0,
+                          /*output_max=*/1.0, /*weight_scale=*/1.0 / 200,
+                          /*peephole_scale=*/0.0, /*cell_scale=*/1.0 / 2048);
+
+  lstm.SetInputToInputWeights({-0.45018822, -0.02338299, -0.0870589,
+                               -0.34550029, 0.04266912, -0.15680569,
+                               -0.34856534, 0.43890524});
+  lstm.SetInputToCellWeights({-0.50013041, 0.1370284, 0.11810488, 0.2013163,
+                              -0.20583314, 0.44344562, 0.22077113,
+                              -0.29909778});
+  lstm.SetInputToForgetWeights({0.09701663, 0.20334584, -0.50592935,
+                                -0.31343272, -0.40032279, 0.44781327,
+                                0.01387155, -0.35593212});
+  lstm.SetInputToOutputWeights({-0.25065863, -0.28290087, 0.04613829,
+                                0.40525138, 0.44272184, 0.03897077,
+                                -0.1556896, 0.19487578});
+  lstm.SetInputGateBias({0., 0., 0., 0.});
+  lstm.SetCellBias({0., 0., 0., 0.});
+  lstm.SetForgetGateBias({1., 1., 1., 1.});
+  lstm.SetOutputGateBias({0., 0., 0., 0.});
+  lstm.SetRecurrentToInputWeights(
+      {-0.0063535, -0.2042388, 0.31454784, -0.35746509, 0.28902304, 0.08183324,
+       -0.16555229, 0.02286911, -0.13566875, 0.03034258, 0.48091322,
+       -0.12528998, 0.24077177, -0.51332325, -0.33502164, 0.10629296});
+  lstm.SetRecurrentToCellWeights(
+      {-0.3407414, 0.24443203, -0.2078532, 0.26320225, 0.05695659,
+       -0.00123841, -0.4744786, -0.35869038, -0.06418842, -0.13502428,
+       -0.501764, 0.22830659, -0.46367589, 0.26016325, -0.03894562,
+       -0.16368064});
+  lstm.SetRecurrentToForgetWeights(
+      {-0.48684245, -0.06655136, 0.42224967, 0.2112639, 0.27654213,
+       0.20864892, -0.07646349, 0.45877004, 0.00141793, -0.14609534,
+       0.36447752, 0.09196436, 0.28053468, 0.01560611, -0.20127171,
+       -0.01140004});
+  lstm.SetRecurrentToOutputWeights(
+      {0.43385774, -0.17194885, 0.2718237, 0.09215671, 0.24107647,
+       -0.39835793, 0.18212086, 0.01301402, 0.48572797, -0.50656658,
+       0.20047462, -0.20607421, -0.51818722, -0.15390486, 0.0468148,
+       0.39922136});
+
+  VerifyIntegerGoldens({2., 3., 3., 4., 1., 1.},
+                       {-0.02973187, 0.1229473, 0.20885126, -0.15358765,
+                        -0.03716109, 0.12507336, 0.41193449, -0.20860538,
+                        -0.15053082, 0.09120187, 0.24278517, -0.12222792},
+                       &lstm, /*tolerance=*/0.01);
+}
+
+TEST(IntegerLstmOpTest, CifgPeepholeNoProjectionNoClipping) {
+  IntegerLSTMOpModel lstm(/*n_batch=*/1, /*n_input=*/2, /*n_cell=*/4,
+                          /*n_output=*/4, /*use_cifg=*/true,
+                          /*use_peephole=*/true, /*input_min=*/-5.0,
+                          /*input_max=*/5.0, /*output_min=*/-1.0,
+                          /*output_max=*/1.0, /*weight_scale=*/1.0 / 200,
+                          /*peephole_scale=*/1.0 / 100,
+                          /*cell_scale=*/1.0 / 2048);
+
+  lstm.SetInputToCellWeights({-0.49770179, -0.27711356, -0.09624726,
+                              0.05100781, 0.04717243, 0.48944736,
+                              -0.38535351, -0.17212132});
+  lstm.SetInputToForgetWeights({-0.55291498, -0.42866567, 0.13056988,
+                                -0.3633365, -0.22755712, 0.28253698,
+                                0.24407166, 0.33826375});
+  lstm.SetInputToOutputWeights({0.10725588, -0.02335852, -0.55932593,
+                                -0.09426838, -0.44257352, 0.54939759,
+                                0.01533556, 0.42751634});
+  lstm.SetCellBias({0., 0., 0., 0.});
+  lstm.SetForgetGateBias({1., 1., 1., 1.});
+  lstm.SetOutputGateBias({0., 0., 0., 0.});
+  lstm.SetRecurrentToCellWeights(
+      {0.54066205, -0.32668582, -0.43562764, -0.56094903, 0.42957711,
+       0.01841056, -0.32764608, -0.33027974, -0.10826075, 0.20675004,
+       0.19069612, -0.03026325, -0.54532051, 0.33003211, 0.44901288,
+       0.21193194});
+  lstm.SetRecurrentToForgetWeights(
+      {-0.13832897, -0.0515101, -0.2359007, -0.16661474, -0.14340827,
+       0.36986142, 0.23414481, 0.55899, 0.10798943, -0.41174671, 0.17751795,
+       -0.34484994, -0.35874045, -0.11352962, 0.27268326, 0.54058349});
+  lstm.SetRecurrentToOutputWeights(
+      {0.41613156, 0.42610586, -0.16495961, -0.5663873, 0.30579174,
+       -0.05115908, -0.33941799, 0.23364776, 0.11178309, 0.09481031,
+       -0.26424935, 0.46261835, 0.50248802, 0.26114327, -0.43736315,
+       0.33149987});
+  lstm.SetCellToForgetWeights({0.47485286, -0.51955009, -0.24458408,
+                               0.31544167});
+  lstm.SetCellToOutputWeights({-0.17135078, 0.82760304, 0.85573703,
+                               -0.77109635});
+
+  VerifyIntegerGoldens({2., 3., 3., 4., 1., 1.},
+                       {-0.36444446, -0.00352185, 0.12886585, -0.05163646,
+                        -0.42312205, -0.01218222, 0.24201041, -0.08124574,
+                        -0.358325, -0.04621704, 0.21641694, -0.06471302},
+                       &lstm, /*tolerance=*/0.01);
+}
+
+// The float parameters of an LSTM, rounded to the quantized values that the
+// integer kernel sees, and a float implementation of its steps to compare the
+// integer kernel with on configurations without goldens.
+class LstmReference {
+ public:
+  LstmReference(int n_batch, int n_input, int n_cell, int n_output,
+                bool use_cifg, bool use_peephole, bool use_projection_weights,
+                bool use_projection_bias, float cell_clip, float proj_clip)
+      : n_batch_(n_batch),
+        n_input_(n_input),
+        n_cell_(n_cell),
+        n_output_(n_output),
+        use_cifg_(use_cifg),
+        use_peephole_(use_peephole),
+        use_projection_weights_(use_projection_weights),
+        use_projection_bias_(use_projection_bias),
+        cell_clip_(cell_clip),
+        proj_clip_(proj_clip),
+        output_state_(n_batch * n_output, 0.0f),
+        cell_state_(n_batch * n_cell, 0.0f) {}
+
+  // Draws the weights from a fixed sequence, sets them on `lstm` and keeps
+  // their quantized values.
+  void SetWeights(float weight_scale, float peephole_scale,
+                  float projection_scale, IntegerLSTMOpModel* lstm) {
+    const int input_size = n_cell_ * n_input_;
+    const int recurrent_size = n_cell_ * n_output_;
+    if (!use_cifg_) {
+      input_to_input_ = Draw(input_size, 0.5, weight_scale);
+      recurrent_to_input_ = Draw(recurrent_size, 0.5, weight_scale);
+      input_gate_bias_ = Draw(n_cell_, 0.5, 0.0);
+      lstm->SetInputToInputWeights(input_to_input_);
+      lstm->SetRecurrentToInputWeights(recurrent_to_input_);
+      lstm->SetInputGateBias(input_gate_bias_);
+    }
+    input_to_forget_ = Draw(input_size, 0.5, weight_scale);
+    input_to_cell_ = Draw(input_size, 0.5, weight_scale);
+    input_to_output_ = Draw(input_size, 0.5, weight_scale);
+    recurrent_to_forget_ = Draw(recurrent_size, 0.5, weight_scale);
+    recurrent_to_cell_ = Draw(recurrent_size, 0.5, weight_scale);
+    recurrent_to_output_ = Draw(recurrent_size, 0.5, weight_scale);
+    forget_gate_bias_ = Draw(n_cell_, 0.5, 0.0);
+    for (float& b : forget_gate_bias_) b += 1.0f;
+    cell_bias_ = Draw(n_cell_, 0.5, 0.0);
+    output_gate_bias_ = Draw(n_cell_, 0.5, 0.0);
+    lstm->SetInputToForgetWeights(input_to_forget_);
+    lstm->SetInputToCellWeights(input_to_cell_);
+    lstm->SetInputToOutputWeights(input_to_output_);
+    lstm->SetRecurrentToForgetWeights(recurrent_to_forget_);
+    lstm->SetRecurrentToCellWeights(recurrent_to_cell_);
+    lstm->SetRecurrentToOutputWeights(recurrent_to_output_);
+    lstm->SetForgetGateBias(forget_gate_bias_);
+    lstm->SetCellBias(cell_bias_);
+    lstm->SetOutputGateBias(output_gate_bias_);
+    if (use_peephole_) {
+      if (!use_cifg_) {
+        cell_to_input_ = Draw(n_cell_, 0.5, peephole_scale);
+        lstm->SetCellToInputWeights(cell_to_input_);
+      }
+      cell_to_forget_ = Draw(n_cell_, 0.5, peephole_scale);
+      cell_to_output_ = Draw(n_cell_, 0.5, peephole_scale);
+      lstm->SetCellToForgetWeights(cell_to_forget_);
+      lstm->SetCellToOutputWeights(cell_to_output_);
+    }
+    if (use_projection_weights_) {
+      projection_ = Draw(n_output_ * n_cell_, 0.5, projection_scale);
+      lstm->SetProjectionWeights(projection_);
+      if (use_projection_bias_) {
+        projection_bias_ = Draw(n_output_, 0.1, 0.0);
+        lstm->SetProjectionBias(projection_bias_);
+      }
+    }
+  }
+
+  // Runs a step on `input`, of n_batch x n_input values, and returns the
+  // output.
+  std::vector<float> Step(const std::vector<float>& input) {
+    const int n_gate = n_batch_ * n_cell_;
+    std::vector<float> input_gate(n_gate), forget_gate(n_gate),
+        cell_gate(n_gate), output_gate(n_gate), hidden(n_gate);
+    for (int b = 0; b < n_batch_; ++b) {
+      const float* x = input.data() + b * n_input_;
+      const float* h = output_state_.data() + b * n_output_;
+      float* c = cell_state_.data() + b * n_cell_;
+      for (int i = 0; i < n_cell_; ++i) {
+        const int g = b * n_cell_ + i;
+        forget_gate[g] = Gate(input_to_forget_, recurrent_to_forget_,
+                              cell_to_forget_, forget_gate_bias_, x, h, c, i);
+        cell_gate[g] = std::tanh(Gate(input_to_cell_, recurrent_to_cell_, {},
+                                      cell_bias_, x, h, c, i));
+        if (use_cifg_) {
+          input_gate[g] = 1.0f - forget_gate[g];
+        } else {
+          input_gate[g] = Gate(input_to_input_, recurrent_to_input_,
+                               cell_to_input_, input_gate_bias_, x, h, c, i);
+        }
+        output_gate[g] = Gate(input_to_output_, recurrent_to_output_, {},
+                              output_gate_bias_, x, h, c, i);
+      }
+      for (int i = 0; i < n_cell_; ++i) {
+        const int g = b * n_cell_ + i;
+        c[i] = forget_gate[g] * c[i] + input_gate[g] * cell_gate[g];
+        if (cell_clip_ > 0.0f) {
+          c[i] = std::min(cell_clip_, std::max(-cell_clip_, c[i]));
+        }
+        float o = output_gate[g];
+        if (use_peephole_) o += cell_to_output_[i] * c[i];
+        hidden[g] = Sigmoid(o) * std::tanh(c[i]);
+      }
+    }
+    for (int b = 0; b < n_batch_; ++b) {
+      for (int o = 0; o < n_output_; ++o) {
+        float value;
+        if (use_projection_weights_) {
+          value = use_projection_bias_ ? projection_bias_[o] : 0.0f;
+          for (int i = 0; i < n_cell_; ++i) {
+            value += projection_[o * n_cell_ + i] * hidden[b * n_cell_ + i];
+          }
+        } else {
+          value = hidden[b * n_cell_ + o];
+        }
+        if (proj_clip_ > 0.0f) {
+          value = std::min(proj_clip_, std::max(-proj_clip_, value));
+        }
+        output_state_[b * n_output_ + o] = value;
+      }
+    }
+    return output_state_;
+  }
+
+ private:
+  static float Sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+  // Returns values in [-range, range], rounded to multiples of `scale` if it
+  // is positive.
+  std::vector<float> Draw(int size, float range, float scale) {
+    std::vector<float> values;
+    for (int i = 0; i < size; ++i) {
+      seed_ = seed_ * 1103515245 + 12345;
+      float v = range * (static_cast<float>((seed_ >> 8) % 2001) / 1000 - 1);
+      if (scale > 0.0f) v = std::round(v / scale) * scale;
+      values.push_back(v);
+    }
+    return values;
+  }
+
+  // Returns the pre-activation of the gate of cell `i`, passed through a
+  // sigmoid for all gates but the cell gate (whose peephole is empty).
+  float Gate(const std::vector<float>& input_weights,
+             const std::vector<float>& recurrent_weights,
+             const std::vector<float>& peephole_weights,
+             const std::vector<float>& bias, const float* x, const float* h,
+             const float* c, int i) {
+    float value = bias[i];
+    for (int j = 0; j < n_input_; ++j) {
+      value += input_weights[i * n_input_ + j] * x[j];
+    }
+    for (int j = 0; j < n_output_; ++j) {
+      value += recurrent_weights[i * n_output_ + j] * h[j];
+    }
+    if (&input_weights == &input_to_cell_ ||
+        &input_weights == &input_to_output_) {
+      // The cell gate has no peephole, and the output gate peephole uses the
+      // updated cell state.
+      return value;
+    }
+    if (use_peephole_) value += peephole_weights[i] * c[i];
+    return Sigmoid(value);
+  }
+
+  const int n_batch_;
+  const int n_input_;
+  const int n_cell_;
+  const int n_output_;
+  const bool use_cifg_;
+  const bool use_peephole_;
+  const bool use_projection_weights_;
+  const bool use_projection_bias_;
+  const float cell_clip_;
+  const float proj_clip_;
+  uint32_t seed_ = 42;
+
+  std::vector<float> input_to_input_, input_to_forget_, input_to_cell_,
+      input_to_output_;
+  std::vector<float> recurrent_to_input_, recurrent_to_forget_,
+      recurrent_to_cell_, recurrent_to_output_;
+  std::vector<float> cell_to_input_, cell_to_forget_, cell_to_output_;
+  std::vector<float> input_gate_bias_, forget_gate_bias_, cell_bias_,
+      output_gate_bias_;
+  std::vector<float> projection_, projection_bias_;
+  std::vector<float> output_state_;
+  std::vector<float> cell_state_;
+};
+
+// Runs `num_steps` steps of an integer LSTM with n_input = 5, n_cell = 20 and
+// n_output = 16 and of its float reference, on the same quantized inputs.
+void VerifyIntegerLstmWithReference(int n_batch, bool use_cifg,
+                                    bool use_peephole,
+                                    bool use_projection_weights,
+                                    bool use_projection_bias, float cell_clip,
+                                    float proj_clip, float tolerance) {
+  const int n_input = 5;
+  const int n_cell = 20;
+  const int n_output = use_projection_weights ? 16 : n_cell;
+  const int num_steps = 4;
+  const float weight_scale = 1.0 / 200;
+  const float peephole_scale = 1.0 / 100;
+  const float projection_scale = 1.0 / 200;
+  IntegerLSTMOpModel lstm(
+      n_batch, n_input, n_cell, n_output, use_cifg, use_peephole,
+      /*input_min=*/-5.0, /*input_max=*/5.0, /*output_min=*/-1.0,
+      /*output_max=*/1.0, weight_scale, peephole_scale,
+      /*cell_scale=*/1.0 / 2048, use_projection_weights, use_projection_bias,
+      projection_scale, cell_clip, proj_clip);
+  LstmReference reference(n_batch, n_input, n_cell, n_output, use_cifg,
+                          use_peephole, use_projection_weights,
+                          use_projection_bias, cell_clip, proj_clip);
+  reference.SetWeights(weight_scale, peephole_scale, projection_scale, &lstm);
+
+  for (int step = 0; step < num_steps; ++step) {
+    std::vector<float> input;
+    for (int i = 0; i < n_batch * n_input; ++i) {
+      input.push_back(static_cast<float>((step * 7 + i * 3) % 11) / 2 - 2.5);
+    }
+    lstm.SetInput(input);
+    lstm.Invoke();
+    EXPECT_THAT(lstm.GetDequantizedOutput(),
+                ElementsAreArray(ArrayFloatNear(
+                    reference.Step(lstm.GetDequantizedInput()), tolerance)))
+        << "step " << step;
+  }
+}
+
+TEST(IntegerLstmOpTest, NoCifgPeepholeProjectionNoClippingBatched) {
+  VerifyIntegerLstmWithReference(/*n_batch=*/2, /*use_cifg=*/false,
+                                 /*use_peephole=*/true,
+                                 /*use_projection_weights=*/true,
+                                 /*use_projection_bias=*/false,
+                                 /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+                                 /*tolerance=*/0.02);
+}
+
+TEST(IntegerLstmOpTest, NoCifgPeepholeProjectionBiasNoClippingBatched) {
+  VerifyIntegerLstmWithReference(/*n_batch=*/3, /*use_cifg=*/false,
+                                 /*use_peephole=*/true,
+                                 /*use_projection_weights=*/true,
+                                 /*use_projection_bias=*/true,
+                                 /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+                                 /*tolerance=*/0.02);
+}
+
+TEST(IntegerLstmOpTest, CifgNoPeepholeNoProjectionClippingBatched) {
+  VerifyIntegerLstmWithReference(/*n_batch=*/2, /*use_cifg=*/true,
+                                 /*use_peephole=*/false,
+                                 /*use_projection_weights=*/false,
+                                 /*use_projection_bias=*/false,
+                                 /*cell_clip=*/0.5, /*proj_clip=*/0.0,
+                                 /*tolerance=*/0.02);
+}
+
+TEST(IntegerLstmOpTest, NoCifgPeepholeProjectionClippingBatched) {
+  VerifyIntegerLstmWithReference(/*n_batch=*/2, /*use_cifg=*/false,
+                                 /*use_peephole=*/true,
+                                 /*use_projection_weights=*/true,
+                                 /*use_projection_bias=*/true,
+                                 /*cell_clip=*/0.5, /*proj_clip=*/0.2,
+                                 /*tolerance=*/0.02);
+}
+
 }  // namespace
 }  // namespace tflite
 
@@ -229,6 +229,12 @@ TfLiteStatus PrepareMean(TfLiteContext* context, TfLiteNode* node) {
   return ResizeTempSum(context, &op_context, temp_sum);
 }
 
+TfLiteStatus PrepareSum(TfLiteContext* context, TfLiteNode* node) {
+  // Quantized reduce_sum accumulates into the same int32 buffer as
+  // reduce_mean before rescaling to the output quantization.
+  return PrepareMean(context, node);
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalMean(TfLiteContext* context, TfLiteNode* node) {
   OpContext op_context(context, node);
@@ -337,6 +343,38 @@ enum ReduceType {
   kAny,
 };
 
+// Sums quantized values, requantizing the result to the output scale and
+// zero point since the sum generally does not fit the input range.
+TfLiteStatus EvalQuantizedSum(TfLiteContext* context, TfLiteNode* node,
+                              OpContext* op_context) {
+  int num_axis = static_cast<int>(NumElements(op_context->axis));
+  TfLiteTensor* temp_index = GetTemporary(context, node, /*index=*/0);
+  TfLiteTensor* resolved_axis = GetTemporary(context, node, /*index=*/1);
+  TfLiteTensor* temp_sum = GetTemporary(context, node, /*index=*/2);
+  // Resize the output tensor if the output tensor is dynamic.
+  if (IsDynamicTensor(op_context->output)) {
+    TF_LITE_ENSURE_OK(context,
+                      ResizeTempAxis(context, op_context, resolved_axis));
+    TF_LITE_ENSURE_OK(context, ResizeOutputTensor(context, op_context));
+    TF_LITE_ENSURE_OK(context, ResizeTempSum(context, op_context, temp_sum));
+  }
+  TF_LITE_ENSURE(
+      context,
+      reference_ops::QuantizedSum<>(
+          GetTensorData<uint8_t>(op_context->input),
+          op_context->input->params.zero_point,
+          op_context->input->params.scale, op_context->input->dims->data,
+          op_context->input->dims->size,
+          GetTensorData<uint8_t>(op_context->output),
+          op_context->output->params.zero_point,
+          op_context->output->params.scale, op_context->output->dims->data,
+          op_context->output->dims->size, GetTensorData<int>(op_context->axis),
+          num_axis, op_context->params->keep_dims,
+          GetTensorData<int>(temp_index), GetTensorData<int>(resolved_axis),
+          GetTensorData<int>(temp_sum)));
+  return kTfLiteOk;
+}
+
 // Eval for determined input type and reduce type.
 template <typename T>
 TfLiteStatus EvalType(TfLiteContext* context, TfLiteNode* node,
@@ -406,6 +444,14 @@ TfLiteStatus EvalGeneric(TfLiteContext* context, TfLiteNode* node) {
       return EvalType<int64_t>(context, node, &op_context, reduce_type);
       break;
     case kTfLiteUInt8:
+      if (reduce_type == kSum) {
+        return EvalQuantizedSum(context, node, &op_context);
+      }
+      if (reduce_type == kProd) {
+        context->ReportError(context,
+                             "Reduce prod does not support quantized UINT8.");
+        return kTfLiteError;
+      }
       return EvalType<uint8_t>(context, node, &op_context, reduce_type);
       break;
     case kTfLiteBool:
@@ -427,7 +473,7 @@ TfLiteRegistration* Register_MEAN_REF() {
 
 TfLiteRegistration* Register_SUM_REF() {
   static TfLiteRegistration r = {
-      reduce::Init, reduce::Free, reduce::PrepareSimple,
+      reduce::Init, reduce::Free, reduce::PrepareSum,
       reduce::EvalGeneric<reduce::kReference, reduce::kSum>};
   return &r;
 }
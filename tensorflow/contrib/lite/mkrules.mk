@@ -16,6 +16,7 @@
 # to be used to compile all .c files.
 
 CROSS_CPP = $(ZEPHYR_SDK_INSTALL_DIR)/arm-zephyr-eabi/bin/arm-zephyr-eabi-g++
+CROSS_SIZE = $(ZEPHYR_SDK_INSTALL_DIR)/arm-zephyr-eabi/bin/arm-zephyr-eabi-size
 
 vpath %.cc . $(TFLITE_BASE)/tensorflow/contrib/lite/examples/label_image/
 vpath %.cc . $(TFLITE_BASE)/tensorflow/contrib/lite/
@@ -24,6 +25,7 @@ vpath %.cc . $(TFLITE_BASE)/tensorflow/contrib/lite/kernels/internal/
 vpath %.cc . $(TFLITE_BASE)/tensorflow/contrib/lite/kernels/internal/reference/
 vpath %.cc . $(TFLITE_MCU_THIRD_PARTY_BASE)/farmhash/src/
 vpath %.c . $(TFLITE_MCU_THIRD_PARTY_BASE)/fft2d/
+vpath %.cc . $(dir $(TFLITE_SELECTED_OPS_SRC))
 $(TFLITE_BUILD)/%.o : %.cc
 	$(ECHO) "CPP $< to $@"
 	$(Q)$(CROSS_CPP) $(TF_CPPFLAGS) -c -MD -o $@ $<
@@ -41,3 +43,16 @@ LIBTFLITE = libtflite.a
 # other file to cause needed effect, e.g. relinking with new lib.
 $(LIBTFLITE): $(TFLITE_OBJS)
 	$(AR) rcs $(BUILD)/$(LIBTFLITE) $^
+
+# Prints the code size (text + data) of the library. Pass
+# TFLITE_SIZE_BASELINE=<libtflite.a from a build without TFLITE_SELECTED_OPS_MK>
+# to also print the delta against it.
+tflite-size: $(LIBTFLITE)
+	$(Q)size=`$(CROSS_SIZE) -t $(BUILD)/$(LIBTFLITE) | tail -n 1 | awk '{ print $$1 + $$2 }'`; \
+	echo "$(LIBTFLITE): $$size bytes"; \
+	if [ -n "$(TFLITE_SIZE_BASELINE)" ]; then \
+	  base=`$(CROSS_SIZE) -t $(TFLITE_SIZE_BASELINE) | tail -n 1 | awk '{ print $$1 + $$2 }'`; \
+	  echo "baseline: $$base bytes, delta: `expr $$size - $$base` bytes"; \
+	fi
+
+.PHONY: tflite-size
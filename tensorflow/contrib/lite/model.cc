@@ -293,21 +293,21 @@ void FlatBufferIntVectorToArray(int max_size_of_buffer,
   }
 }
 
-// Allocate a structure using C malloc, but make sure the structure is a
+// Allocate a structure using TfLiteMalloc, but make sure the structure is a
 // POD structure that doesn't require constructors to run. The reason we do
 // this, is that Interpreter's C extension part will take ownership and wants
-// to use malloc() and free().
+// to use TfLiteMalloc() and TfLiteFree().
 template <class T>
 T* MallocPOD() {
   static_assert(std::is_pod<T>::value, "Builtin data structure must be POD.");
-  return static_cast<T*>(malloc(sizeof(T)));
+  return static_cast<T*>(TfLiteMalloc(sizeof(T)));
 }
 
 // Parse the appropriate data out of the op.
 //
 // This handles builtin data explicitly as there are flatbuffer schemas.
 // If it returns kTfLiteOk, it passes the data out with `builtin_data`, which
-// need to be released by calling `free`.`
+// need to be released by calling `TfLiteFree`.`
 // If it returns kTfLiteError, `builtin_data` will be `nullptr`.
 TfLiteStatus ParseOpData(const Operator* op, BuiltinOperator op_type,
                          ErrorReporter* error_reporter, void** builtin_data) {
@@ -386,7 +386,7 @@ TfLiteStatus ParseOpData(const Operator* op, BuiltinOperator op_type,
             ConvertTensorType(schema_params->out_data_type(),
                               &params->out_data_type, error_reporter);
         if (in_status != kTfLiteOk || out_status != kTfLiteOk) {
-          free(params);
+          TfLiteFree(params);
           return kTfLiteError;
         }
       }
@@ -107,7 +107,13 @@ TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
-    char* new_alloc = new char[required_size];
+    char* new_alloc = static_cast<char*>(TfLiteMalloc(required_size));
+    if (new_alloc == nullptr) {
+      context->ReportError(context,
+                           "Failed to allocate %d bytes for the tensor arena.",
+                           static_cast<int>(required_size));
+      return kTfLiteError;
+    }
     char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
         AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
 
@@ -77,7 +77,10 @@ class SimpleMemoryArena {
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
-  std::unique_ptr<char[]> underlying_buffer_;
+  struct BufferDeleter {
+    void operator()(char* buffer) const { TfLiteFree(buffer); }
+  };
+  std::unique_ptr<char, BufferDeleter> underlying_buffer_;
   size_t underlying_buffer_size_;
   char* underlying_buffer_aligned_ptr_;
   // TODO(maciekc): add list iterator to the ArenaAlloc to lookup quickly.
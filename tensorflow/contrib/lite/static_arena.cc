@@ -0,0 +1,56 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Routes C++ allocations through TfLiteMalloc/TfLiteFree when TF Lite is built
+// in memory-bounded mode (see TfLiteStaticArenaInit in context.h). Kernels
+// allocate their user data with `new` and the interpreter keeps its nodes and
+// tensors in std::vectors, so without this their storage would still come
+// from the system heap.
+#ifdef TFLITE_STATIC_ARENA
+
+#include <new>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace {
+
+void* StaticArenaNew(size_t size) {
+  // TfLiteMalloc aborts instead of returning NULL in this mode; zero-sized
+  // requests still need a unique address.
+  return TfLiteMalloc(size ? size : 1);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return StaticArenaNew(size); }
+void* operator new[](size_t size) { return StaticArenaNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return StaticArenaNew(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return StaticArenaNew(size);
+}
+
+void operator delete(void* ptr) noexcept { TfLiteFree(ptr); }
+void operator delete[](void* ptr) noexcept { TfLiteFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { TfLiteFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { TfLiteFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  TfLiteFree(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  TfLiteFree(ptr);
+}
+
+#endif  // TFLITE_STATIC_ARENA
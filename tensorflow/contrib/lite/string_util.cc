@@ -79,7 +79,7 @@ int DynamicBuffer::WriteToBuffer(char** buffer) {
                   + sizeof(int32_t) * (num_strings + 2);  // size of header
 
   // Caller will take ownership of buffer.
-  *buffer = reinterpret_cast<char*>(malloc(bytes));
+  *buffer = reinterpret_cast<char*>(TfLiteMalloc(bytes));
 
   // Set num of string
   memcpy(*buffer, &num_strings, sizeof(int32_t));
@@ -37,10 +37,26 @@ TFLITE_KERNELS_SRC := $(filter-out $(TFLITE_KERNELS_TEST_SRC),$(TFLITE_KERNELS_S
 
 TFLITE_KERNELS_BASE_SRC = $(notdir $(TFLITE_KERNELS_SRC))
 
+# Selective registration. Point TFLITE_SELECTED_OPS_MK at the fragment written
+# by tools/generate_op_registrations --input_models=<models>
+# --output_registration=<file.cc> --output_kernel_sources=<file.mk> to build
+# only the kernels the models use, plus the generated RegisterSelectedOps().
+# register.cc, and with it BuiltinOpResolver, is left out.
+TFLITE_KERNELS_SUPPORT_SRC = eigen_support.cc gemm_support.cc kernel_util.cc
+
+ifneq ($(TFLITE_SELECTED_OPS_MK),)
+include $(TFLITE_SELECTED_OPS_MK)
+TFLITE_KERNELS_BASE_SRC := $(filter $(TFLITE_KERNELS_SUPPORT_SRC) $(TFLITE_SELECTED_KERNELS_SRC),$(TFLITE_KERNELS_BASE_SRC))
+TFLITE_KERNELS_BASE_SRC += $(notdir $(TFLITE_SELECTED_OPS_SRC))
+TF_CPPFLAGS += -DTFLITE_SELECTED_OPS
+endif
+
 TFLITE_KERNELS_INTERNAL_SRC = $(wildcard $(TFLITE_BASE)/tensorflow/contrib/lite/kernels/internal/*.cc)
 
 TFLITE_KERNELS_INTERNAL_TEST_SRC = $(wildcard $(TFLITE_BASE)/tensorflow/contrib/lite/kernels/internal/*test*.cc)
 
+TFLITE_KERNELS_INTERNAL_TEST_SRC += $(wildcard $(TFLITE_BASE)/tensorflow/contrib/lite/kernels/internal/*_benchmark.cc)
+
 TFLITE_KERNELS_INTERNAL_SRC := $(filter-out $(TFLITE_KERNELS_INTERNAL_TEST_SRC),$(TFLITE_KERNELS_INTERNAL_SRC))
 
 TFLITE_KERNELS_INTERNAL_BASE_SRC = $(notdir $(TFLITE_KERNELS_INTERNAL_SRC))
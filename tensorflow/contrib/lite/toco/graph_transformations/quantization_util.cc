@@ -40,6 +40,10 @@ bool GetQuantizedDataTypeNumericalRange(ArrayDataType data_type,
                                         double* out_min_value,
                                         double* out_max_value) {
   switch (data_type) {
+    case ArrayDataType::kInt8:
+      *out_min_value = -128;
+      *out_max_value = 127;
+      return true;
     case ArrayDataType::kUint8:
       *out_min_value = 0;
       *out_max_value = 255;
@@ -192,6 +196,9 @@ void QuantizeArray(GraphTransformation* transformation, Model* model,
   }
 
   switch (adjusted_data_type) {
+    case ArrayDataType::kInt8:
+      return QuantizeArray<ArrayDataType::kInt8>(transformation, model, name,
+                                                 quantization_params);
     case ArrayDataType::kUint8:
       return QuantizeArray<ArrayDataType::kUint8>(transformation, model, name,
                                                   quantization_params);
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/graph_transformations/lstm_utils.h"
 #include "tensorflow/contrib/lite/toco/graph_transformations/quantization_util.h"
 #include "tensorflow/contrib/lite/toco/model.h"
 #include "tensorflow/contrib/lite/toco/model_flags.pb.h"
@@ -63,7 +64,10 @@ bool SupportsQuantization(const Operator& op) {
          type == OperatorType::kArgMax || type == OperatorType::kRelu ||
          type == OperatorType::kRelu1 || type == OperatorType::kRelu6 ||
          type == OperatorType::kShape || type == OperatorType::kExpandDims ||
-         type == OperatorType::kPack || type == OperatorType::kTopK_V2;
+         type == OperatorType::kPack || type == OperatorType::kTopK_V2 ||
+         type == OperatorType::kDiv || type == OperatorType::kExp ||
+         type == OperatorType::kLocalResponseNormalization ||
+         type == OperatorType::kReduceMax || type == OperatorType::kReduceMin;
 }
 
 // The quantized op allows output arrays of type float using
@@ -164,16 +168,138 @@ QuantizationPoints GetQuantizationPoints(ArrayDataType data_type) {
   }
 }
 
+bool IsFullLstmCell(const Operator& op) {
+  return op.type == OperatorType::kLstmCell &&
+         static_cast<const LstmCellOperator&>(op).kernel_type ==
+             LstmCellOperator::KERNEL_FULL;
+}
+
+// Chooses symmetric int8 quantization params, as used for the weights of the
+// full LSTM kernel.
+void ChooseSymmetricInt8QuantizationParams(
+    const MinMax& minmax, QuantizationParams* quantization_params) {
+  const double max_abs = std::max(std::abs(minmax.min), std::abs(minmax.max));
+  quantization_params->zero_point = 0;
+  quantization_params->scale = max_abs == 0 ? 1. : max_abs / 127.;
+}
+
+// Chooses symmetric int16 quantization params with a power-of-two scale, as
+// required for the cell state of the full LSTM kernel. Its integer arithmetic
+// supports at most 6 integer bits, larger values saturate.
+void ChoosePowerOfTwoInt16QuantizationParams(
+    const MinMax& minmax, QuantizationParams* quantization_params) {
+  const double max_abs = std::max(std::abs(minmax.min), std::abs(minmax.max));
+  int integer_bits = 0;
+  while (integer_bits < 6 && (1 << integer_bits) < max_abs) {
+    integer_bits++;
+  }
+  quantization_params->zero_point = 0;
+  quantization_params->scale = std::ldexp(1., integer_bits - 15);
+}
+
+// Chooses the quantization of the inputs of the full (20 inputs) LSTM kernel
+// which are not regular uint8 activations: symmetric int8 weights, int32
+// biases with the scale of the matching input matmul and the int16 cell
+// state. Returns false for the other inputs.
+bool ChooseQuantizationForFullLstmInput(
+    GraphTransformation* transformation, Model* model, const Operator& op,
+    std::size_t input_index, ArrayDataType* quantized_data_type,
+    QuantizationParams* quantization_params) {
+  const auto& input = op.inputs[input_index];
+  switch (input_index) {
+    case kInputToInputWeightsTensor:
+    case kInputToForgetWeightsTensor:
+    case kInputToCellWeightsTensor:
+    case kInputToOutputWeightsTensor:
+    case kRecurrentToInputWeightsTensor:
+    case kRecurrentToForgetWeightsTensor:
+    case kRecurrentToCellWeightsTensor:
+    case kRecurrentToOutputWeightsTensor:
+    case kCellToInputWeightsTensor:
+    case kCellToForgetWeightsTensor:
+    case kCellToOutputWeightsTensor:
+    case kProjectionWeightsTensor:
+      *quantized_data_type = ArrayDataType::kInt8;
+      ChooseSymmetricInt8QuantizationParams(GetOrComputeMinMax(model, input),
+                                            quantization_params);
+      break;
+    case kInputGateBiasTensor:
+    case kForgetGateBiasTensor:
+    case kCellGateBiasTensor:
+    case kOutputGateBiasTensor:
+    case kProjectionBiasTensor: {
+      // The gate biases are added to the accumulators of the input matmuls,
+      // the projection bias to the accumulator of the Q0.15 hidden state
+      // times the projection weights.
+      const auto& weights = model->GetArray(
+          op.inputs[input_index == kProjectionBiasTensor
+                        ? kProjectionWeightsTensor
+                        : input_index - kInputGateBiasTensor +
+                              kInputToInputWeightsTensor]);
+      const auto& activations = model->GetArray(op.inputs[kInputTensor]);
+      if (!weights.quantization_params || !activations.quantization_params) {
+        transformation->AddMessageF(
+            "Input array %s is a bias vector but has no qparams", input);
+        return false;
+      }
+      const double activations_scale =
+          input_index == kProjectionBiasTensor
+              ? 1. / (1 << 15)
+              : activations.quantization_params->scale;
+      *quantized_data_type = ArrayDataType::kInt32;
+      quantization_params->zero_point = 0;
+      quantization_params->scale =
+          activations_scale * weights.quantization_params->scale;
+      break;
+    }
+    case kInputActivationStateTensor: {
+      // The kernel requires the activation state and the output to share
+      // their quantization params.
+      const auto& output = model->GetArray(op.outputs[kOutputTensor]);
+      if (!output.minmax) {
+        return false;
+      }
+      *quantized_data_type = ArrayDataType::kUint8;
+      ChooseQuantizationParamsForArrayAndQuantizedDataType(
+          output, *quantized_data_type, quantization_params);
+      break;
+    }
+    case kInputCellStateTensor:
+      *quantized_data_type = ArrayDataType::kInt16;
+      ChoosePowerOfTwoInt16QuantizationParams(GetOrComputeMinMax(model, input),
+                                              quantization_params);
+      break;
+    default:
+      return false;
+  }
+  transformation->AddMessageF(
+      "Input array %s of the full LSTM kernel. Chose to quantize as %s "
+      "with zero_point=%d, scale=%g",
+      input, ArrayDataTypeName(*quantized_data_type),
+      quantization_params->zero_point, quantization_params->scale);
+  return true;
+}
+
 bool ChooseQuantizationForOperatorInput(
     GraphTransformation* transformation, Model* model, const Operator& op,
     std::size_t input_index, ArrayDataType* quantized_data_type,
     QuantizationParams* quantization_params) {
   const auto& input = op.inputs[input_index];
+  if (model->IsOptionalArray(input)) {
+    return false;
+  }
   auto& array = model->GetArray(input);
   if (array.data_type != ArrayDataType::kFloat) {
     return false;
   }
 
+  if (IsFullLstmCell(op) &&
+      ChooseQuantizationForFullLstmInput(transformation, model, op,
+                                         input_index, quantized_data_type,
+                                         quantization_params)) {
+    return true;
+  }
+
   // Quantization of bias vectors
   bool is_bias_vector = false;
   int activations_input_index;
@@ -369,7 +495,14 @@ bool ChooseQuantizationForOperatorOutput(
     return true;
   }
   const MinMax& minmax = GetOrComputeMinMax(model, output);
-  if (op.type == OperatorType::kLstmCell) {
+  if (IsFullLstmCell(op)) {
+    // The cell state output must match the cell state input of the next step.
+    if (output_index == kCellStateTensor) {
+      *quantized_data_type = ArrayDataType::kInt16;
+      ChoosePowerOfTwoInt16QuantizationParams(minmax, quantization_params);
+      return true;
+    }
+  } else if (op.type == OperatorType::kLstmCell) {
     if (output_index == LstmCellOperator::STATE_OUTPUT ||
         output_index == LstmCellOperator::ACTIV_TEMP) {
       *quantized_data_type = ArrayDataType::kInt16;
@@ -463,6 +596,9 @@ bool Quantize::Run(Model* model, std::size_t op_index) {
   //
   // Let us just guard this assumption by the following assertion:
   for (const auto& input : op.inputs) {
+    if (model->IsOptionalArray(input)) {
+      continue;
+    }
     const auto& input_array = model->GetArray(input);
     if (IsInputArray(*model, input) &&
         input_array.data_type == ArrayDataType::kFloat) {
@@ -480,6 +616,9 @@ bool Quantize::Run(Model* model, std::size_t op_index) {
   }
 
   for (const auto& input : op.inputs) {
+    if (model->IsOptionalArray(input)) {
+      continue;
+    }
     const auto& array = model->GetArray(input);
     if (array.data_type == ArrayDataType::kFloat) {
       if (!array.minmax && !array.buffer) {
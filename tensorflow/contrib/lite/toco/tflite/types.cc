@@ -32,7 +32,7 @@ DataBuffer::FlatBufferOffset CopyStringToBuffer(
   int bytes = dyn_buffer.WriteToBuffer(&tensor_buffer);
   std::vector<uint8_t> dst_data(bytes);
   memcpy(dst_data.data(), tensor_buffer, bytes);
-  free(tensor_buffer);
+  TfLiteFree(tensor_buffer);
   return builder->CreateVector(dst_data.data(), bytes);
 }
 
@@ -94,6 +94,9 @@ void CopyBuffer(const ::tflite::Buffer& buffer, Array* array) {
       return ::tflite::TensorType_INT32;
     case ArrayDataType::kInt64:
       return ::tflite::TensorType_INT64;
+    // TF Lite has no int8 tensors. Symmetric int8 values (such as the weights
+    // of the full LSTM kernel) are stored in uint8 tensors instead.
+    case ArrayDataType::kInt8:
     case ArrayDataType::kUint8:
       return ::tflite::TensorType_UINT8;
     case ArrayDataType::kString:
@@ -147,6 +150,8 @@ flatbuffers::Offset<flatbuffers::Vector<uint8_t>> DataBuffer::Serialize(
       return CopyBuffer<ArrayDataType::kInt64>(array, builder);
     case ArrayDataType::kString:
       return CopyStringToBuffer(array, builder);
+    case ArrayDataType::kInt8:
+      return CopyBuffer<ArrayDataType::kInt8>(array, builder);
     case ArrayDataType::kUint8:
       return CopyBuffer<ArrayDataType::kUint8>(array, builder);
     case ArrayDataType::kBool:
@@ -81,6 +81,11 @@ TEST(DataType, SupportedTypes) {
   }
 }
 
+TEST(DataType, Int8IsStoredAsUint8) {
+  EXPECT_EQ(::tflite::TensorType_UINT8,
+            DataType::Serialize(ArrayDataType::kInt8));
+}
+
 TEST(DataType, UnsupportedTypes) {
   for (::tflite::TensorType t : kUnsupportedTfLiteTypes) {
     EXPECT_DEATH(DataType::Deserialize(t), "Unhandled tensor type.");
@@ -148,6 +153,12 @@ TEST(DataBuffer, Uint8) {
               ::testing::ElementsAre(127, 244));
 }
 
+TEST(DataBuffer, Int8) {
+  Array recovered = ToFlatBufferAndBack<ArrayDataType::kInt8>({-127, 5});
+  EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kUint8>().data,
+              ::testing::ElementsAre(129, 5));
+}
+
 TEST(DataBuffer, Int32) {
   Array recovered = ToFlatBufferAndBack<ArrayDataType::kInt32>({1, 1 << 30});
   EXPECT_THAT(recovered.GetBuffer<ArrayDataType::kInt32>().data,
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -44,4 +45,224 @@ void ReadOpsFromModel(const ::tflite::Model* model,
   }
 }
 
+void ReadOpVersionsFromModel(const ::tflite::Model* model,
+                             std::map<string, int>* builtin_ops,
+                             std::map<string, int>* custom_ops) {
+  if (!model) return;
+  auto opcodes = model->operator_codes();
+  if (!opcodes) return;
+  for (const auto* opcode : *opcodes) {
+    std::map<string, int>* ops = custom_ops;
+    string name;
+    if (opcode->builtin_code() != ::tflite::BuiltinOperator_CUSTOM) {
+      ops = builtin_ops;
+      name = tflite::EnumNameBuiltinOperator(opcode->builtin_code());
+    } else {
+      name = opcode->custom_code()->c_str();
+    }
+    int& version = (*ops)[name];
+    version = std::max(version, std::max(opcode->version(), 1));
+  }
+}
+
+namespace {
+
+struct BuiltinOpKernel {
+  const char* op;
+  // Source file under kernels/.
+  const char* source;
+  // The variants are registered by Register_<variant_prefix>_REF etc.
+  const char* variant_prefix;
+  int variants;
+};
+
+// Kernels of the ops registered by BuiltinOpResolver. Keep in sync with
+// kernels/register.cc.
+const BuiltinOpKernel kBuiltinOpKernels[] = {
+    {"ADD", "add.cc", "ADD", kReference | kGenericOptimized | kNeonOptimized},
+    {"ARG_MAX", "arg_min_max.cc", nullptr, 0},
+    {"ARG_MIN", "arg_min_max.cc", nullptr, 0},
+    {"AVERAGE_POOL_2D", "pooling.cc", "AVERAGE_POOL",
+     kReference | kGenericOptimized},
+    {"BATCH_TO_SPACE_ND", "batch_to_space_nd.cc", "BATCH_TO_SPACE_ND",
+     kReference | kGenericOptimized},
+    {"BIDIRECTIONAL_SEQUENCE_LSTM", "bidirectional_sequence_lstm.cc", nullptr,
+     0},
+    {"BIDIRECTIONAL_SEQUENCE_RNN", "bidirectional_sequence_rnn.cc", nullptr, 0},
+    {"CAST", "cast.cc", nullptr, 0},
+    {"CONCATENATION", "concatenation.cc", "CONCATENATION",
+     kReference | kGenericOptimized},
+    {"CONV_2D", "conv.cc", "CONVOLUTION", kReference | kGenericOptimized},
+    {"DEPTHWISE_CONV_2D", "depthwise_conv.cc", "DEPTHWISE_CONVOLUTION",
+     kReference | kGenericOptimized | kNeonOptimized},
+    {"DEQUANTIZE", "dequantize.cc", nullptr, 0},
+    {"DIV", "div.cc", "DIV", kReference | kGenericOptimized | kNeonOptimized},
+    {"EMBEDDING_LOOKUP", "embedding_lookup.cc", nullptr, 0},
+    {"EMBEDDING_LOOKUP_SPARSE", "embedding_lookup_sparse.cc", nullptr, 0},
+    {"EQUAL", "comparisons.cc", nullptr, 0},
+    {"EXP", "exp.cc", "EXP", kReference | kGenericOptimized},
+    {"EXPAND_DIMS", "expand_dims.cc", nullptr, 0},
+    {"FAKE_QUANT", "fake_quant.cc", "FAKE_QUANT", kReference},
+    {"FLOOR", "floor.cc", nullptr, 0},
+    {"FLOOR_DIV", "floor_div.cc", nullptr, 0},
+    {"FULLY_CONNECTED", "fully_connected.cc", "FULLY_CONNECTED",
+     kReference | kGenericOptimized | kNeonOptimized},
+    {"GATHER", "gather.cc", nullptr, 0},
+    {"GREATER", "comparisons.cc", nullptr, 0},
+    {"GREATER_EQUAL", "comparisons.cc", nullptr, 0},
+    {"HASHTABLE_LOOKUP", "hashtable_lookup.cc", nullptr, 0},
+    {"L2_NORMALIZATION", "l2norm.cc", "L2NORM", kReference | kGenericOptimized},
+    {"L2_POOL_2D", "pooling.cc", "L2_POOL", kReference | kGenericOptimized},
+    {"LESS", "comparisons.cc", nullptr, 0},
+    {"LESS_EQUAL", "comparisons.cc", nullptr, 0},
+    {"LOCAL_RESPONSE_NORMALIZATION", "local_response_norm.cc",
+     "LOCAL_RESPONSE_NORM", kReference | kGenericOptimized},
+    {"LOG", "elementwise.cc", nullptr, 0},
+    {"LOGICAL_AND", "logical.cc", nullptr, 0},
+    {"LOGICAL_NOT", "elementwise.cc", nullptr, 0},
+    {"LOGICAL_OR", "logical.cc", nullptr, 0},
+    {"LOGISTIC", "activations.cc", nullptr, 0},
+    {"LOG_SOFTMAX", "activations.cc", nullptr, 0},
+    {"LSH_PROJECTION", "lsh_projection.cc", nullptr, 0},
+    {"LSTM", "lstm.cc", nullptr, 0},
+    {"MAXIMUM", "maximum_minimum.cc", "MAXIMUM", kReference},
+    {"MAX_POOL_2D", "pooling.cc", "MAX_POOL", kReference | kGenericOptimized},
+    {"MEAN", "reduce.cc", "MEAN", kReference},
+    {"MINIMUM", "maximum_minimum.cc", "MINIMUM", kReference},
+    {"MUL", "mul.cc", "MUL", kReference | kGenericOptimized | kNeonOptimized},
+    {"NEG", "neg.cc", nullptr, 0},
+    {"NOT_EQUAL", "comparisons.cc", nullptr, 0},
+    {"ONE_HOT", "one_hot.cc", nullptr, 0},
+    {"PACK", "pack.cc", nullptr, 0},
+    {"PAD", "pad.cc", "PAD", kReference | kGenericOptimized},
+    {"PADV2", "pad.cc", "PADV2", kReference | kGenericOptimized},
+    {"POW", "pow.cc", nullptr, 0},
+    {"PRELU", "activations.cc", nullptr, 0},
+    {"REDUCE_ANY", "reduce.cc", "REDUCE_ANY", kReference},
+    {"REDUCE_MAX", "reduce.cc", "REDUCE_MAX", kReference},
+    {"REDUCE_MIN", "reduce.cc", "REDUCE_MIN", kReference},
+    {"REDUCE_PROD", "reduce.cc", "REDUCE_PROD", kReference},
+    {"RELU", "activations.cc", nullptr, 0},
+    {"RELU6", "activations.cc", nullptr, 0},
+    {"RELU_N1_TO_1", "activations.cc", nullptr, 0},
+    {"RESHAPE", "reshape.cc", nullptr, 0},
+    {"RESIZE_BILINEAR", "resize_bilinear.cc", "RESIZE_BILINEAR",
+     kReference | kGenericOptimized | kNeonOptimized},
+    {"RNN", "basic_rnn.cc", nullptr, 0},
+    {"RSQRT", "elementwise.cc", nullptr, 0},
+    {"SELECT", "select.cc", nullptr, 0},
+    {"SHAPE", "shape.cc", nullptr, 0},
+    {"SIN", "elementwise.cc", nullptr, 0},
+    {"SKIP_GRAM", "skip_gram.cc", nullptr, 0},
+    {"SLICE", "slice.cc", nullptr, 0},
+    {"SOFTMAX", "activations.cc", nullptr, 0},
+    {"SPACE_TO_BATCH_ND", "space_to_batch_nd.cc", "SPACE_TO_BATCH_ND",
+     kReference | kGenericOptimized},
+    {"SPACE_TO_DEPTH", "space_to_depth.cc", "SPACE_TO_DEPTH",
+     kReference | kGenericOptimized},
+    {"SPARSE_TO_DENSE", "sparse_to_dense.cc", nullptr, 0},
+    {"SPLIT", "split.cc", nullptr, 0},
+    {"SQRT", "elementwise.cc", nullptr, 0},
+    {"SQUEEZE", "squeeze.cc", nullptr, 0},
+    {"STRIDED_SLICE", "strided_slice.cc", "STRIDED_SLICE", kReference},
+    {"SUB", "sub.cc", "SUB", kReference | kGenericOptimized | kNeonOptimized},
+    {"SUM", "reduce.cc", "SUM", kReference},
+    {"SVDF", "svdf.cc", nullptr, 0},
+    {"TANH", "activations.cc", nullptr, 0},
+    {"TILE", "tile.cc", nullptr, 0},
+    {"TOPK_V2", "topk_v2.cc", nullptr, 0},
+    {"TRANSPOSE", "transpose.cc", "TRANSPOSE", kReference},
+    {"TRANSPOSE_CONV", "transpose_conv.cc", nullptr, 0},
+    {"UNIDIRECTIONAL_SEQUENCE_LSTM", "unidirectional_sequence_lstm.cc", nullptr,
+     0},
+    {"UNIDIRECTIONAL_SEQUENCE_RNN", "unidirectional_sequence_rnn.cc", nullptr,
+     0},
+    {"UNPACK", "unpack.cc", nullptr, 0},
+};
+
+struct CustomOpKernel {
+  const char* op;
+  const char* source;
+  const char* registration;
+};
+
+// Custom ops implemented in kernels/ whose registration function does not
+// follow NormalizeCustomOpName.
+const CustomOpKernel kCustomOpKernels[] = {
+    {"AudioSpectrogram", "audio_spectrogram.cc", "AUDIO_SPECTROGRAM"},
+    {"Mfcc", "mfcc.cc", "MFCC"},
+    {"TFLite_Detection_PostProcess", "detection_postprocess.cc",
+     "DETECTION_POSTPROCESS"},
+};
+
+const BuiltinOpKernel* FindBuiltinOpKernel(const string& builtin_op) {
+  for (const auto& kernel : kBuiltinOpKernels) {
+    if (builtin_op == kernel.op) return &kernel;
+  }
+  return nullptr;
+}
+
+const CustomOpKernel* FindCustomOpKernel(const string& custom_op) {
+  for (const auto& kernel : kCustomOpKernels) {
+    if (custom_op == kernel.op) return &kernel;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+bool ParseKernelVariant(const string& name, KernelVariant* variant) {
+  if (name.empty() || name == "default") {
+    *variant = kDefaultKernel;
+  } else if (name == "reference") {
+    *variant = kReference;
+  } else if (name == "generic_optimized") {
+    *variant = kGenericOptimized;
+  } else if (name == "neon_optimized") {
+    *variant = kNeonOptimized;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+string GetBuiltinOpRegistrationName(const string& builtin_op,
+                                    KernelVariant variant) {
+  const BuiltinOpKernel* kernel = FindBuiltinOpKernel(builtin_op);
+  if (!kernel || !(kernel->variants & variant)) {
+    return "Register_" + builtin_op;
+  }
+  string suffix;
+  switch (variant) {
+    case kReference:
+      suffix = "_REF";
+      break;
+    case kGenericOptimized:
+      suffix = "_GENERIC_OPT";
+      break;
+    case kNeonOptimized:
+      suffix = "_NEON_OPT";
+      break;
+    case kDefaultKernel:
+      break;
+  }
+  return string("Register_") + kernel->variant_prefix + suffix;
+}
+
+string GetCustomOpRegistrationName(const string& custom_op) {
+  const CustomOpKernel* kernel = FindCustomOpKernel(custom_op);
+  if (kernel) return string("Register_") + kernel->registration;
+  return "Register_" + NormalizeCustomOpName(custom_op);
+}
+
+string GetBuiltinOpKernelSource(const string& builtin_op) {
+  const BuiltinOpKernel* kernel = FindBuiltinOpKernel(builtin_op);
+  return kernel ? kernel->source : "";
+}
+
+string GetCustomOpKernelSource(const string& custom_op) {
+  const CustomOpKernel* kernel = FindCustomOpKernel(custom_op);
+  return kernel ? kernel->source : "";
+}
+
 }  // namespace tflite
@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CONTRIB_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 #define TENSORFLOW_CONTRIB_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 
+#include <map>
+#include <vector>
+
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/string.h"
 
@@ -34,6 +37,40 @@ void ReadOpsFromModel(const ::tflite::Model* model,
                       std::vector<string>* builtin_ops,
                       std::vector<string>* custom_ops);
 
+// Read ops from the TFLite model together with the highest version of each
+// op that it uses. Results are merged into the maps, so calling this for
+// several models produces the union of their ops.
+void ReadOpVersionsFromModel(const ::tflite::Model* model,
+                             std::map<string, int>* builtin_ops,
+                             std::map<string, int>* custom_ops);
+
+// Kernel variants that can be selected for the builtin ops which provide
+// them. kDefaultKernel keeps the variant picked by register.cc.
+enum KernelVariant {
+  kDefaultKernel = 0,
+  kReference = 1,
+  kGenericOptimized = 2,
+  kNeonOptimized = 4,
+};
+
+// Parse a kernel variant name ("", "reference", "generic_optimized" or
+// "neon_optimized"). Returns false for unknown names.
+bool ParseKernelVariant(const string& name, KernelVariant* variant);
+
+// Name of the function registering `builtin_op` (e.g. "CONV_2D") with the
+// given kernel variant, e.g. "Register_CONVOLUTION_REF". Falls back to the
+// default "Register_CONV_2D" if the op has no such variant.
+string GetBuiltinOpRegistrationName(const string& builtin_op,
+                                    KernelVariant variant);
+
+// Name of the function registering the custom op, e.g. "Register_MFCC".
+string GetCustomOpRegistrationName(const string& custom_op);
+
+// Source file under kernels/ implementing the op (e.g. "conv.cc"), or an
+// empty string if the op is not part of the TF Lite kernels.
+string GetBuiltinOpKernelSource(const string& builtin_op);
+string GetCustomOpKernelSource(const string& custom_op);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_CONTRIB_LITE_TOOLS_GEN_OP_REGISTRATION_H_
@@ -15,18 +15,24 @@ limitations under the License.
 
 #include <cassert>
 #include <fstream>
+#include <iostream>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
 #include "tensorflow/contrib/lite/tools/gen_op_registration.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/util/command_line_flags.h"
 
 const char kInputModelFlag[] = "input_model";
+const char kInputModelsFlag[] = "input_models";
 const char kOutputRegistrationFlag[] = "output_registration";
+const char kOutputKernelSourcesFlag[] = "output_kernel_sources";
+const char kKernelVariantFlag[] = "kernel_variant";
 const char kTfLitePathFlag[] = "tflite_path";
 
 using tensorflow::Flag;
@@ -34,11 +40,22 @@ using tensorflow::Flags;
 using tensorflow::string;
 
 void ParseFlagAndInit(int argc, char** argv, string* input_model,
-                      string* output_registration, string* tflite_path) {
+                      string* input_models, string* output_registration,
+                      string* output_kernel_sources, string* kernel_variant,
+                      string* tflite_path) {
   std::vector<tensorflow::Flag> flag_list = {
       Flag(kInputModelFlag, input_model, "path to the tflite model"),
+      Flag(kInputModelsFlag, input_models,
+           "comma-separated paths to tflite models; the union of their ops "
+           "is registered"),
       Flag(kOutputRegistrationFlag, output_registration,
            "filename for generated registration code"),
+      Flag(kOutputKernelSourcesFlag, output_kernel_sources,
+           "optional filename for a makefile fragment listing the kernel "
+           "sources needed by the selected ops"),
+      Flag(kKernelVariantFlag, kernel_variant,
+           "kernel variant to register where available: reference, "
+           "generic_optimized or neon_optimized (default: as register.cc)"),
       Flag(kTfLitePathFlag, tflite_path, "Path to tensorflow lite dir"),
   };
 
@@ -50,8 +67,9 @@ namespace {
 
 void GenerateFileContent(const std::string& tflite_path,
                          const std::string& filename,
-                         const std::vector<string>& builtin_ops,
-                         const std::vector<string>& custom_ops) {
+                         const std::map<string, int>& builtin_ops,
+                         const std::map<string, int>& custom_ops,
+                         ::tflite::KernelVariant kernel_variant) {
   std::ofstream fout(filename);
 
   fout << "#include \"" << tflite_path << "/model.h\"\n";
@@ -63,7 +81,9 @@ void GenerateFileContent(const std::string& tflite_path,
     fout << "namespace builtin {\n";
     fout << "// Forward-declarations for the builtin ops.\n";
     for (const auto& op : builtin_ops) {
-      fout << "TfLiteRegistration* Register_" << op << "();\n";
+      fout << "TfLiteRegistration* "
+           << ::tflite::GetBuiltinOpRegistrationName(op.first, kernel_variant)
+           << "();\n";
     }
     fout << "}  // namespace builtin\n";
   }
@@ -72,8 +92,8 @@ void GenerateFileContent(const std::string& tflite_path,
     fout << "namespace custom {\n";
     fout << "// Forward-declarations for the custom ops.\n";
     for (const auto& op : custom_ops) {
-      fout << "TfLiteRegistration* Register_"
-           << ::tflite::NormalizeCustomOpName(op) << "();\n";
+      fout << "TfLiteRegistration* "
+           << ::tflite::GetCustomOpRegistrationName(op.first) << "();\n";
     }
     fout << "}  // namespace custom\n";
   }
@@ -82,36 +102,86 @@ void GenerateFileContent(const std::string& tflite_path,
 
   fout << "void RegisterSelectedOps(::tflite::MutableOpResolver* resolver) {\n";
   for (const auto& op : builtin_ops) {
-    fout << "  resolver->AddBuiltin(::tflite::BuiltinOperator_" << op
-         << ", ::tflite::ops::builtin::Register_" << op << "());\n";
+    fout << "  resolver->AddBuiltin(::tflite::BuiltinOperator_" << op.first
+         << ", ::tflite::ops::builtin::"
+         << ::tflite::GetBuiltinOpRegistrationName(op.first, kernel_variant)
+         << "(), 1, " << op.second << ");\n";
   }
   for (const auto& op : custom_ops) {
-    fout << "  resolver->AddCustom(\"" << op
-         << "\", ::tflite::ops::custom::Register_"
-         << ::tflite::NormalizeCustomOpName(op) << "());\n";
+    fout << "  resolver->AddCustom(\"" << op.first
+         << "\", ::tflite::ops::custom::"
+         << ::tflite::GetCustomOpRegistrationName(op.first) << "(), 1, "
+         << op.second << ");\n";
   }
   fout << "}\n";
   fout.close();
 }
+
+// Writes a makefile fragment for tflite_zephyr.mk listing the kernel sources
+// needed by the selected ops, so that the others are not compiled at all.
+void GenerateKernelSources(const std::string& filename,
+                           const std::string& registration,
+                           const std::map<string, int>& builtin_ops,
+                           const std::map<string, int>& custom_ops) {
+  std::set<string> sources;
+  for (const auto& op : builtin_ops) {
+    string source = ::tflite::GetBuiltinOpKernelSource(op.first);
+    if (!source.empty()) sources.insert(source);
+  }
+  for (const auto& op : custom_ops) {
+    string source = ::tflite::GetCustomOpKernelSource(op.first);
+    if (!source.empty()) sources.insert(source);
+  }
+
+  std::ofstream fout(filename);
+  fout << "# Generated by generate_op_registrations. Do not edit.\n";
+  fout << "TFLITE_SELECTED_OPS_SRC = " << registration << "\n";
+  fout << "TFLITE_SELECTED_KERNELS_SRC =";
+  for (const auto& source : sources) {
+    fout << " " << source;
+  }
+  fout << "\n";
+  fout.close();
+}
 }  // namespace
 
 int main(int argc, char** argv) {
   string input_model;
+  string input_models;
   string output_registration;
+  string output_kernel_sources;
+  string kernel_variant_name;
   string tflite_path;
-  ParseFlagAndInit(argc, argv, &input_model, &output_registration,
-                   &tflite_path);
-
-  std::vector<string> builtin_ops;
-  std::vector<string> custom_ops;
-  std::ifstream fin(input_model);
-  std::stringstream content;
-  content << fin.rdbuf();
-  // Need to store content data first, otherwise, it won't work in bazel.
-  string content_str = content.str();
-  const ::tflite::Model* model = ::tflite::GetModel(content_str.data());
-  ::tflite::ReadOpsFromModel(model, &builtin_ops, &custom_ops);
+  ParseFlagAndInit(argc, argv, &input_model, &input_models,
+                   &output_registration, &output_kernel_sources,
+                   &kernel_variant_name, &tflite_path);
+
+  ::tflite::KernelVariant kernel_variant;
+  if (!::tflite::ParseKernelVariant(kernel_variant_name, &kernel_variant)) {
+    std::cerr << "Unknown kernel variant: " << kernel_variant_name << "\n";
+    return 1;
+  }
+
+  std::vector<string> model_paths =
+      absl::StrSplit(input_models, ',', absl::SkipEmpty());
+  if (!input_model.empty()) model_paths.push_back(input_model);
+
+  std::map<string, int> builtin_ops;
+  std::map<string, int> custom_ops;
+  for (const string& model_path : model_paths) {
+    std::ifstream fin(model_path);
+    std::stringstream content;
+    content << fin.rdbuf();
+    // Need to store content data first, otherwise, it won't work in bazel.
+    string content_str = content.str();
+    const ::tflite::Model* model = ::tflite::GetModel(content_str.data());
+    ::tflite::ReadOpVersionsFromModel(model, &builtin_ops, &custom_ops);
+  }
   GenerateFileContent(tflite_path, output_registration, builtin_ops,
-                      custom_ops);
+                      custom_ops, kernel_variant);
+  if (!output_kernel_sources.empty()) {
+    GenerateKernelSources(output_kernel_sources, output_registration,
+                          builtin_ops, custom_ops);
+  }
   return 0;
 }
@@ -78,6 +78,52 @@ TEST_F(GenOpRegistrationTest, TestNormalizeCustomOpName) {
     EXPECT_EQ(NormalizeCustomOpName(test.first), test.second);
   }
 }
+
+TEST(GenOpRegistrationVersionsTest, TestMergesModels) {
+  std::map<string, int> builtin_ops;
+  std::map<string, int> custom_ops;
+  for (const char* path : {"tensorflow/contrib/lite/testdata/test_model.bin",
+                           "tensorflow/contrib/lite/testdata/empty_model.bin",
+                           "tensorflow/contrib/lite/testdata/test_model.bin"}) {
+    auto model = FlatBufferModel::BuildFromFile(path);
+    if (model) {
+      ReadOpVersionsFromModel(model->GetModel(), &builtin_ops, &custom_ops);
+    }
+  }
+  EXPECT_EQ(builtin_ops, (std::map<string, int>{{"CONV_2D", 1}}));
+  EXPECT_EQ(custom_ops, (std::map<string, int>{{"testing_op", 1}}));
+}
+
+TEST(GenOpRegistrationVariantTest, TestRegistrationNames) {
+  KernelVariant variant;
+  ASSERT_TRUE(ParseKernelVariant("reference", &variant));
+  EXPECT_EQ(variant, kReference);
+  EXPECT_FALSE(ParseKernelVariant("fastest", &variant));
+
+  EXPECT_EQ(GetBuiltinOpRegistrationName("CONV_2D", kDefaultKernel),
+            "Register_CONV_2D");
+  EXPECT_EQ(GetBuiltinOpRegistrationName("CONV_2D", kReference),
+            "Register_CONVOLUTION_REF");
+  EXPECT_EQ(GetBuiltinOpRegistrationName("ADD", kNeonOptimized),
+            "Register_ADD_NEON_OPT");
+  // Ops without the requested variant keep their default registration.
+  EXPECT_EQ(GetBuiltinOpRegistrationName("CONV_2D", kNeonOptimized),
+            "Register_CONV_2D");
+  EXPECT_EQ(GetBuiltinOpRegistrationName("RESHAPE", kReference),
+            "Register_RESHAPE");
+
+  EXPECT_EQ(GetCustomOpRegistrationName("TFLite_Detection_PostProcess"),
+            "Register_DETECTION_POSTPROCESS");
+  EXPECT_EQ(GetCustomOpRegistrationName("CustomOp"), "Register_CUSTOM_OP");
+}
+
+TEST(GenOpRegistrationVariantTest, TestKernelSources) {
+  EXPECT_EQ(GetBuiltinOpKernelSource("CONV_2D"), "conv.cc");
+  EXPECT_EQ(GetBuiltinOpKernelSource("MAX_POOL_2D"), "pooling.cc");
+  EXPECT_EQ(GetBuiltinOpKernelSource("NOT_AN_OP"), "");
+  EXPECT_EQ(GetCustomOpKernelSource("Mfcc"), "mfcc.cc");
+  EXPECT_EQ(GetCustomOpKernelSource("testing_op"), "");
+}
 }  // namespace tflite
 
 int main(int argc, char** argv) {
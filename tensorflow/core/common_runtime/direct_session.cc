@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/memory_timeline.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -125,6 +128,20 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   return thread_pool;
 }
 
+// Returns the scheduler shared by all sessions that run steps on the
+// process-wide "pool".
+FairShareScheduler* GlobalFairShareScheduler(thread::ThreadPool* pool) {
+  static std::map<thread::ThreadPool*, FairShareScheduler*>* schedulers =
+      new std::map<thread::ThreadPool*, FairShareScheduler*>;
+  static mutex* mu = new mutex();
+  mutex_lock l(*mu);
+  FairShareScheduler*& scheduler = (*schedulers)[pool];
+  if (scheduler == nullptr) {
+    scheduler = new FairShareScheduler(pool);
+  }
+  return scheduler;
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -269,13 +286,35 @@ DirectSession::DirectSession(const SessionOptions& options,
   } else {
     thread_pools_.emplace_back(GlobalThreadPool(options), false /* owned */);
   }
+  if (options_.config.experimental().use_fair_share_scheduling()) {
+    for (const auto& p_and_owned : thread_pools_) {
+      if (p_and_owned.first == nullptr) {
+        fair_share_schedulers_.push_back(nullptr);
+      } else if (p_and_owned.second) {
+        fair_share_schedulers_.push_back(
+            new FairShareScheduler(p_and_owned.first));
+      } else {
+        fair_share_schedulers_.push_back(
+            GlobalFairShareScheduler(p_and_owned.first));
+      }
+    }
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
-  const Status status =
+  Status status =
       ReadBoolFromEnvVar("TF_SYNC_ON_FINISH", true, &sync_on_finish_);
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  status = ReadBoolFromEnvVar("TF_USE_STEP_ARENA", false, &use_step_arena_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
+  status = ReadBoolFromEnvVar("TF_EXECUTOR_USE_MEASURED_COSTS", false,
+                              &use_measured_costs_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
   // NOTE(mrry): We do not need to use a unique string for the session
   // handle, because DirectSession owns its devices. This may change
   // in future versions.
@@ -324,6 +363,10 @@ DirectSession::~DirectSession() {
   for (const auto& p_and_owned : thread_pools_) {
     if (p_and_owned.second) delete p_and_owned.first;
   }
+  // The schedulers of owned pools are deleted once the pools are drained.
+  for (size_t i = 0; i < fair_share_schedulers_.size(); ++i) {
+    if (thread_pools_[i].second) delete fair_share_schedulers_[i];
+  }
 
   execution_state_.reset(nullptr);
   flib_def_.reset(nullptr);
@@ -527,6 +570,15 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     args.stats_collector = run_state.collector.get();
   }
 
+  MemoryTimelineCollector* memory_timeline = nullptr;
+  if (run_options.experimental().memory_timeline_max_events() > 0) {
+    memory_timeline = new MemoryTimelineCollector(
+        run_options.experimental().memory_timeline_max_events());
+    args.memory_timeline = memory_timeline;
+  }
+  // Allocations that outlive the step hold their own references.
+  core::ScopedUnref unref_memory_timeline(memory_timeline);
+
   std::unique_ptr<DeviceTracer> tracer;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
     tracer = CreateDeviceTracer();
@@ -586,6 +638,30 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
                                            pool](Executor::Args::Closure c) {
     SchedClosure(pool, std::move(c));
   };
+  FairShareScheduler::Step* fair_share_step = nullptr;
+#ifndef __ANDROID__
+  if (pool != nullptr &&
+      options_.config.experimental().use_inter_op_locality_hints()) {
+    // Spread concurrent steps over the workers, and keep the work of each
+    // step near its own worker.
+    const int home = static_cast<int>(step_id % pool->NumThreads());
+    default_runner = [pool, home](Executor::Args::Closure c) {
+      pool->ScheduleWithHint(std::move(c), home, home + 1);
+    };
+  }
+  if (pool != nullptr && !fair_share_schedulers_.empty()) {
+    // A step without a pool of its own runs on the first pool, see above.
+    const int pool_index = std::max(run_options.inter_op_thread_pool(), 0);
+    FairShareScheduler* scheduler = fair_share_schedulers_[pool_index];
+    fair_share_step =
+        scheduler->NewStep(run_options.experimental().priority());
+    default_runner = [scheduler, fair_share_step](Executor::Args::Closure c) {
+      scheduler->Schedule(fair_share_step, std::move(c));
+    };
+  }
+#endif  // __ANDROID__
+  // Closures that are already queued hold their own references on the step.
+  core::ScopedUnref unref_fair_share_step(fair_share_step);
   for (const auto& item : executors_and_keys->items) {
     // TODO(zhengxq): support partial run.
     // TODO(zhengxq): if the device picks its own threadpool, we need to assign
@@ -636,6 +712,10 @@ Status DirectSession::RunInternal(int64 step_id, const RunOptions& run_options,
     run_state.collector->Finalize();
   }
 
+  if (memory_timeline != nullptr) {
+    memory_timeline->Export(run_metadata->mutable_step_stats());
+  }
+
   // Build and return the cost model as instructed.
   if (update_cost_model) {
     // Build the cost model
@@ -1199,6 +1279,8 @@ Status DirectSession::CreateExecutors(
     LocalExecutorParams params;
     params.device = device;
     params.function_library = lib;
+    params.use_step_arena = use_step_arena_;
+    params.use_measured_costs = use_measured_costs_;
     auto opseg = device->op_segment();
     params.create_kernel = [this, lib, opseg](const NodeDef& ndef,
                                               OpKernel** kernel) {
@@ -51,6 +51,7 @@ class CostModel;
 class DebugGateway;
 class Device;
 class DirectSessionFactory;
+class FairShareScheduler;
 
 class DirectSession : public Session {
  public:
@@ -321,11 +322,18 @@ class DirectSession : public Session {
   // The thread-pools to use for running ops, with a bool indicating if the pool
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
+  // If fair-share scheduling is enabled, the scheduler of each of
+  // thread_pools_, owned iff the pool is.
+  std::vector<FairShareScheduler*> fair_share_schedulers_;
 
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
+  // If true, CPU executors serve step-local tensors from a per-step arena.
+  bool use_step_arena_ = false;
+  // If true, executors schedule nodes by their measured costs.
+  bool use_measured_costs_ = false;
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
 
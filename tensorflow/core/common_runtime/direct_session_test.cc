@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/costmodel.h"
+#include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
@@ -41,6 +43,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -2217,6 +2221,276 @@ void BM_FeedFetchCallable(int iters, int num_feeds) {
 BENCHMARK(BM_FeedFetch)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 BENCHMARK(BM_FeedFetchCallable)->Arg(1)->Arg(2)->Arg(5)->Arg(10);
 
+TEST(DirectSessionTest, NumaAffinityCreatesDevicePerNode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  std::vector<DeviceAttributes> devices;
+  TF_ASSERT_OK(session->ListDevices(&devices));
+  std::vector<DeviceAttributes> cpu_devices;
+  for (const DeviceAttributes& device : devices) {
+    if (device.device_type() == DEVICE_CPU) cpu_devices.push_back(device);
+  }
+  if (!port::NUMAEnabled()) {
+    EXPECT_EQ(1, cpu_devices.size());
+    return;
+  }
+  ASSERT_EQ(port::NUMANumNodes(), cpu_devices.size());
+  for (int i = 0; i < cpu_devices.size(); ++i) {
+    EXPECT_EQ(i, cpu_devices[i].locality().numa_node());
+  }
+
+  // Work placed on the last node runs on that node's device.
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* y = test::graph::Matmul(&graph, a, a, false, false);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  graph::SetDefaultDevice(cpu_devices.back().name(), &def);
+  TF_ASSERT_OK(session->Create(def));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y->name() + ":0"}, {}, &outputs));
+  test::ExpectTensorEqual<float>(
+      outputs[0], test::AsTensor<float>({7, 10, 15, 22}, TensorShape({2, 2})));
+}
+
+TEST(DirectSessionTest, InterOpLocalityHints) {
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(4);
+  options.config.set_use_per_session_threads(true);
+  options.config.mutable_experimental()->set_use_inter_op_locality_hints(true);
+  std::unique_ptr<Session> session(NewSession(options));
+
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  std::vector<string> fetches;
+  for (int i = 0; i < 8; ++i) {
+    fetches.push_back(test::graph::Matmul(&graph, a, a, false, false)->name() +
+                      ":0");
+  }
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  TF_ASSERT_OK(session->Create(def));
+
+  // Concurrent steps each get their own home worker.
+  thread::ThreadPool steps(Env::Default(), "steps", 4);
+  for (int i = 0; i < 16; ++i) {
+    steps.Schedule([&session, &fetches]() {
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run({}, fetches, {}, &outputs));
+      ASSERT_EQ(fetches.size(), outputs.size());
+      for (const Tensor& output : outputs) {
+        test::ExpectTensorEqual<float>(
+            output,
+            test::AsTensor<float>({7, 10, 15, 22}, TensorShape({2, 2})));
+      }
+    });
+  }
+}
+
+TEST(DirectSessionTest, FairShareScheduling) {
+  SessionOptions options;
+  options.config.set_inter_op_parallelism_threads(2);
+  options.config.set_use_per_session_threads(true);
+  options.config.mutable_experimental()->set_use_fair_share_scheduling(true);
+  std::unique_ptr<Session> session(NewSession(options));
+
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* y = test::graph::Matmul(&graph, a, a, false, false);
+  for (int i = 0; i < 16; ++i) {
+    y = test::graph::Matmul(&graph, y, a, false, false);
+  }
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  TF_ASSERT_OK(session->Create(def));
+
+  // Steps of different priorities compete for the two inter-op threads.
+  thread::ThreadPool steps(Env::Default(), "steps", 4);
+  for (int i = 0; i < 16; ++i) {
+    steps.Schedule([&session, y, i]() {
+      RunOptions run_options;
+      run_options.mutable_experimental()->set_priority(i % 3 - 1);
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->Run(run_options, {}, {y->name() + ":0"}, {},
+                                &outputs, nullptr));
+      ASSERT_EQ(1, outputs.size());
+      EXPECT_EQ(TensorShape({2, 2}), outputs[0].shape());
+    });
+  }
+}
+
+TEST(DirectSessionTest, MemoryTimeline) {
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* y1 = test::graph::Matmul(&graph, a, a, false, false);
+  Node* y2 = test::graph::Matmul(&graph, y1, a, false, false);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  SessionOptions options;
+  // Keeps the matmuls from being folded into constants.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions_Level_L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_memory_timeline_max_events(100);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {}, {y2->name() + ":0"}, {},
+                            &outputs, &run_metadata));
+  ASSERT_EQ(1, outputs.size());
+
+  // Only the timeline is collected, not the per-node stats.
+  const StepStats& step_stats = run_metadata.step_stats();
+  EXPECT_EQ(0, step_stats.dev_stats_size());
+  ASSERT_EQ(1, step_stats.memory_timelines_size());
+  const MemoryTimeline& timeline = step_stats.memory_timelines(0);
+  EXPECT_EQ(0, timeline.num_dropped_events());
+  std::set<string> allocating_nodes;
+  for (const MemoryTimelineEvent& event : timeline.events()) {
+    if (event.bytes() > 0) {
+      allocating_nodes.insert(timeline.node_names(event.node()));
+    }
+  }
+  EXPECT_EQ(1, allocating_nodes.count(y1->name()));
+  EXPECT_EQ(1, allocating_nodes.count(y2->name()));
+  // The output of y1 is live while y2 computes its own.
+  EXPECT_GE(timeline.peak_bytes(), 2 * a_tensor.TotalBytes());
+  EXPECT_GE(timeline.peak_live_size(), 2);
+
+  // The option is per step.
+  RunMetadata no_timeline;
+  TF_ASSERT_OK(session->Run(RunOptions(), {}, {y2->name() + ":0"}, {},
+                            &outputs, &no_timeline));
+  EXPECT_EQ(0, no_timeline.step_stats().memory_timelines_size());
+}
+
+TEST(DirectSessionTest, MemoryTimelineWithFullTrace) {
+  Graph graph(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&graph, a_tensor);
+  Node* y1 = test::graph::Matmul(&graph, a, a, false, false);
+  Node* y2 = test::graph::Matmul(&graph, y1, a, false, false);
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+  SessionOptions options;
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions_Level_L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(def));
+
+  // Tracing turns on the per-node allocation tracking, which the timeline
+  // must not replace.
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  run_options.mutable_experimental()->set_memory_timeline_max_events(100);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {}, {y2->name() + ":0"}, {},
+                            &outputs, &run_metadata));
+  ASSERT_EQ(1, outputs.size());
+
+  const StepStats& step_stats = run_metadata.step_stats();
+  std::set<string> tracked_nodes;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      for (const AllocatorMemoryUsed& memory : node_stats.memory()) {
+        if (memory.total_bytes() > 0) {
+          tracked_nodes.insert(node_stats.node_name());
+        }
+      }
+    }
+  }
+  EXPECT_EQ(1, tracked_nodes.count(y1->name()));
+  EXPECT_EQ(1, tracked_nodes.count(y2->name()));
+
+  ASSERT_EQ(1, step_stats.memory_timelines_size());
+  const MemoryTimeline& timeline = step_stats.memory_timelines(0);
+  std::set<string> allocating_nodes;
+  for (const MemoryTimelineEvent& event : timeline.events()) {
+    if (event.bytes() > 0) {
+      allocating_nodes.insert(timeline.node_names(event.node()));
+    }
+  }
+  EXPECT_EQ(1, allocating_nodes.count(y1->name()));
+  EXPECT_EQ(1, allocating_nodes.count(y2->name()));
+}
+
+// Runs one stream of matmuls per NUMA node concurrently. With NUMA affinity,
+// each stream runs in its own session on its node's CPU device, so its
+// threads and tensors stay on one socket; without it, all streams share the
+// single CPU device. Compare the two on machines with 2 or more sockets.
+void BM_NumaMatMulThroughput(int iters, int use_numa_affinity) {
+  testing::StopTiming();
+  const int num_streams = port::NUMANumNodes();
+  const int kDim = 512;
+  const int kChainLength = 8;
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(
+      use_numa_affinity);
+  std::vector<std::unique_ptr<Session>> sessions;
+  std::vector<string> fetches;
+  for (int i = 0; i < num_streams; ++i) {
+    Graph graph(OpRegistry::Global());
+    Tensor a_tensor(DT_FLOAT, TensorShape({kDim, kDim}));
+    a_tensor.flat<float>().setConstant(1.0f / kDim);
+    Node* a = test::graph::Constant(&graph, a_tensor);
+    Node* y = a;
+    for (int j = 0; j < kChainLength; ++j) {
+      y = test::graph::Matmul(&graph, y, a, false, false);
+    }
+    GraphDef def;
+    test::graph::ToGraphDef(&graph, &def);
+    graph::SetDefaultDevice(
+        strings::StrCat("/cpu:", use_numa_affinity ? i : 0), &def);
+    sessions.emplace_back(NewSession(options));
+    TF_CHECK_OK(sessions.back()->Create(def));
+    fetches.push_back(y->name() + ":0");
+    // Ignore the first run, which includes graph setup.
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(sessions.back()->Run({}, {fetches.back()}, {}, &outputs));
+  }
+
+  testing::StartTiming();
+  std::vector<std::thread> streams;
+  for (int i = 0; i < num_streams; ++i) {
+    streams.emplace_back([&sessions, &fetches, i, iters]() {
+      for (int k = 0; k < iters; ++k) {
+        std::vector<Tensor> outputs;
+        TF_CHECK_OK(sessions[i]->Run({}, {fetches[i]}, {}, &outputs));
+      }
+    });
+  }
+  for (std::thread& stream : streams) {
+    stream.join();
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_streams *
+                          kChainLength * 2 * kDim * kDim * kDim);
+}
+
+BENCHMARK(BM_NumaMatMulThroughput)->Arg(0)->Arg(1);
+
 }  // namespace
 
 class DirectSessionCollectiveTest : public ::testing::Test {
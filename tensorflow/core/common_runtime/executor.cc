@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/step_arena.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -157,6 +158,9 @@ struct NodeItem {
   bool is_sink : 1;              // True iff IsSink(node)
   // True iff IsEnter(node) || IsExit(node) || IsNextIteration(node)
   bool is_enter_exit_or_next_iter : 1;
+  // True iff the node may allocate from the step arena (see
+  // MayUseStepArena).
+  bool use_step_arena : 1;
 
   // Cached values of node->num_inputs() and node->num_outputs(), to
   // avoid levels of indirection.
@@ -297,6 +301,9 @@ class ExecutorImpl : public Executor {
     for (auto fiter : frame_info_) {
       delete fiter.second;
     }
+    if (step_arena_cache_ != nullptr) {
+      step_arena_cache_->Unref();
+    }
   }
 
   Status Initialize();
@@ -366,6 +373,27 @@ class ExecutorImpl : public Executor {
   // A cached value of params_
   bool device_record_tensor_accesses_ = false;
 
+  // Blocks for the per-step arenas, if params_.use_step_arena is set and
+  // the device is a CPU. Owns a reference.
+  StepArenaBlockCache* step_arena_cache_ = nullptr;
+
+  // Returns true if the step about to start should measure the cost of its
+  // synchronous kernels. Always false unless params_.use_measured_costs.
+  bool ShouldMeasureCosts() const;
+
+  // Returns the measured cost of the kernel of node "id" in nanoseconds, or
+  // 0 if it has not been measured.
+  int64 NodeCost(int id) const {
+    return node_cost_nsec_[id].load(std::memory_order_relaxed);
+  }
+  void RecordNodeCost(int id, int64 nsec) const;
+
+  // If params_.use_measured_costs is set, a moving average of the measured
+  // cost of every node, indexed by node id.
+  std::unique_ptr<std::atomic<int64>[]> node_cost_nsec_;
+  // Number of steps started, used to pick the steps that measure costs.
+  mutable std::atomic<int64> num_steps_started_{0};
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
@@ -377,15 +405,6 @@ class ExecutorImpl : public Executor {
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
-// Infer memory allocation attributes of a node n's output,
-// based on its use node dst.  Note that dst might not be directly
-// connected to n by a single edge, but might be a downstream
-// consumer of n's output by reference.  *attr is updated with any
-// necessary attributes.
-Status InferAllocAttr(const Node* n, const Node* dst,
-                      const DeviceNameUtils::ParsedName& local_dev_name,
-                      AllocatorAttributes* attr);
-
 GraphView::~GraphView() {
   static_assert(std::is_trivially_destructible<AllocatorAttributes>::value,
                 "Update code if AllocatorAttributes gains a destructor");
@@ -589,6 +608,59 @@ void GetMaxPendingCounts(const Node* n, size_t* max_pending,
   *max_dead_count = num_in_edges;
 }
 
+// Returns true if the tensors that "n" allocates are expected to be dead by
+// the end of the step: "n" runs outside of any loop, keeps no state, and its
+// outputs only feed stateless nodes in the same frame through non-reference
+// inputs (in particular, never a _Send or a _Retval). Tensors forwarded by
+// consumers may still escape; the StepArena then stays alive until they die.
+static bool MayUseStepArena(const Node* n, const string& frame_name) {
+  if (!frame_name.empty() || n->op_def().is_stateful()) return false;
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge()) continue;
+    const Node* dst = e->dst();
+    if (dst->op_def().is_stateful() || IsEnter(dst) || IsExit(dst) ||
+        IsNextIteration(dst) || IsRefType(dst->input_type(e->dst_input()))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Sizes used for the per-step arenas. Large tensors gain little from the
+// arena and would quickly use it up, so they keep using the device
+// allocator.
+static const size_t kStepArenaBlockSize = 256 << 10;
+static const int kStepArenaMaxBlocks = 16;
+static const size_t kStepArenaMaxAllocationSize = 16 << 10;
+
+// With measured costs, the first kNumCostMeasurementSteps steps of an
+// executor, and every kCostMeasurementPeriod-th step after that, time their
+// kernels, so that the costs follow changes in input sizes without timing
+// every step.
+static const int64 kNumCostMeasurementSteps = 4;
+static const int64 kCostMeasurementPeriod = 64;
+
+// Nodes measured to be cheaper than kMaxInlineCostNsec run inline on the
+// thread that made them ready. Other ready nodes are grouped into tasks of at
+// least kMinTaskCostNsec, each of which is dispatched to the runner, so that
+// only work that outweighs the cost of a closure is moved to another thread.
+static const int64 kMaxInlineCostNsec = 5 * 1000;
+static const int64 kMinTaskCostNsec = 50 * 1000;
+
+bool ExecutorImpl::ShouldMeasureCosts() const {
+  if (node_cost_nsec_ == nullptr) return false;
+  const int64 step = num_steps_started_.fetch_add(1, std::memory_order_relaxed);
+  return step < kNumCostMeasurementSteps || step % kCostMeasurementPeriod == 0;
+}
+
+void ExecutorImpl::RecordNodeCost(int id, int64 nsec) const {
+  // Races between concurrent steps lose a sample at worst.
+  const int64 old_nsec = node_cost_nsec_[id].load(std::memory_order_relaxed);
+  const int64 new_nsec = old_nsec == 0 ? nsec : (3 * old_nsec + nsec) / 4;
+  node_cost_nsec_[id].store(std::max<int64>(new_nsec, 1),
+                            std::memory_order_relaxed);
+}
+
 Status ExecutorImpl::Initialize() {
   gview_.Initialize(graph_.get());
 
@@ -601,6 +673,22 @@ Status ExecutorImpl::Initialize() {
   device_record_tensor_accesses_ =
       params_.device->RequiresRecordingAccessedTensors();
 
+  const bool use_step_arena =
+      params_.use_step_arena && params_.device->device_type() == DEVICE_CPU;
+  if (use_step_arena) {
+    step_arena_cache_ = new StepArenaBlockCache(
+        params_.device->GetAllocator(AllocatorAttributes()),
+        kStepArenaBlockSize, kStepArenaMaxBlocks);
+  }
+
+  if (params_.use_measured_costs) {
+    const int num_nodes = graph_->num_node_ids();
+    node_cost_nsec_.reset(new std::atomic<int64>[num_nodes]);
+    for (int i = 0; i < num_nodes; ++i) {
+      node_cost_nsec_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
   for (auto& it : cf_info.unique_frame_names) {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
@@ -640,6 +728,7 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    item->use_step_arena = use_step_arena && MayUseStepArena(n, frame_name);
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -766,6 +855,8 @@ Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
   return s;
 }
 
+}  // namespace
+
 Status InferAllocAttr(const Node* n, const Node* dst,
                       const DeviceNameUtils::ParsedName& local_dev_name,
                       AllocatorAttributes* attr) {
@@ -832,6 +923,8 @@ Status InferAllocAttr(const Node* n, const Node* dst,
   return s;
 }
 
+namespace {
+
 // The state associated with one invocation of ExecutorImpl::Run.
 // ExecutorState dispatches nodes when they become ready and keeps
 // track of how many predecessors of a node have not done (pending_).
@@ -1236,7 +1329,11 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  // Arena for the tensors that do not escape this step, or nullptr. Owns a
+  // reference, which is dropped when the step is done.
+  StepArena* step_arena_ = nullptr;
   StepStatsCollectorInterface* const stats_collector_;
+  MemoryTimelineCollector* const memory_timeline_;
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
@@ -1245,6 +1342,8 @@ class ExecutorState {
   CancellationManager* cancellation_manager_;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
+  // True if this step measures the costs of its synchronous kernels.
+  const bool measure_costs_;
 
   // Owned.
 
@@ -1292,6 +1391,10 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
+  // Process the ready nodes in "batch", one after the other, in the current
+  // thread.
+  void ProcessBatch(const TaggedNodeSeq& batch, int64 scheduled_nsec);
+
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
                        TensorValueVec* inputs,
@@ -1320,6 +1423,12 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Like ScheduleReady(), but decides from the measured costs of the nodes,
+  // and groups nodes that are too cheap to be dispatched on their own.
+  void ScheduleReadyByCost(const TaggedNodeSeq& ready,
+                           TaggedNodeReadyQueue* inline_ready,
+                           int64 scheduled_nsec);
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
 
@@ -1359,12 +1468,14 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
       stats_collector_(args.stats_collector),
+      memory_timeline_(args.memory_timeline),
       slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
+      measure_costs_(impl->ShouldMeasureCosts()),
       num_outstanding_ops_(0) {
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
@@ -1379,6 +1490,14 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       root_frame_->pending_counts, root_frame_->total_input_tensors);
 
   outstanding_frames_.insert({root_frame_->frame_name, root_frame_});
+
+  // The allocations of a step that records a memory timeline must all go
+  // through the recording allocators.
+  if (impl_->step_arena_cache_ != nullptr && memory_timeline_ == nullptr) {
+    step_arena_ = new StepArena(impl_->step_arena_cache_,
+                                kStepArenaMaxAllocationSize,
+                                kStepArenaMaxBlocks);
+  }
 }
 
 ExecutorState::~ExecutorState() {
@@ -1389,6 +1508,9 @@ ExecutorState::~ExecutorState() {
     it->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_ != nullptr) {
+    step_arena_->Unref();
+  }
 }
 
 Status ExecutorImpl::BuildControlFlowInfo(const Graph* g,
@@ -1581,6 +1703,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
   params.stats_collector = stats_collector_;
+  params.memory_timeline = memory_timeline_;
 
   Status s;
   NodeExecStatsWrapper* stats = nullptr;
@@ -1617,6 +1740,11 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       nodestats::SetScheduled(stats, scheduled_nsec);
       nodestats::SetAllStart(stats);
     }
+    // Allocation tracking relies on the sizes reported by the device
+    // allocator, so tracked nodes do not use the step arena.
+    params.step_allocator = (item.use_step_arena && !params.track_allocations)
+                                ? step_arena_
+                                : nullptr;
 
     if (vlog_) {
       VLOG(1) << "Process node: " << id << " step " << params.step_id << " "
@@ -1720,7 +1848,12 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
         // Synchronous computes.
         OpKernelContext ctx(&params, item.num_outputs);
         nodestats::SetOpStart(stats);
+        const int64 start_nsec =
+            measure_costs_ ? Env::Default()->NowNanos() : 0;
         device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        if (measure_costs_) {
+          impl_->RecordNodeCost(id, Env::Default()->NowNanos() - start_nsec);
+        }
         nodestats::SetOpEnd(stats);
         s = ProcessOutputs(item, &ctx, &outputs, stats);
         if (s.ok() && impl_->device_record_tensor_accesses_) {
@@ -2144,6 +2277,10 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     }
     return;
   }
+  if (impl_->node_cost_nsec_ != nullptr) {
+    ScheduleReadyByCost(ready, inline_ready, scheduled_nsec);
+    return;
+  }
   const GraphView& gview = impl_->gview_;
   const TaggedNode* curr_expensive_node = nullptr;
   for (auto& tagged_node : ready) {
@@ -2174,6 +2311,57 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
   }
 }
 
+void ExecutorState::ScheduleReadyByCost(const TaggedNodeSeq& ready,
+                                        TaggedNodeReadyQueue* inline_ready,
+                                        int64 scheduled_nsec) {
+  const GraphView& gview = impl_->gview_;
+  TaggedNodeSeq batch;
+  int64 batch_cost = 0;
+  for (auto& tagged_node : ready) {
+    const int id = tagged_node.node->id();
+    const NodeItem& item = *gview.node(id);
+    // Nodes that have not been measured yet, and asynchronous nodes, which
+    // are never measured, fall back to the kernel's own estimate.
+    int64 cost = impl_->NodeCost(id);
+    if (cost == 0 && item.kernel_is_expensive) {
+      cost = kMinTaskCostNsec;
+    }
+    if (tagged_node.is_dead || cost < kMaxInlineCostNsec) {
+      inline_ready->push_back(tagged_node);
+      continue;
+    }
+    batch.push_back(tagged_node);
+    batch_cost += cost;
+    if (batch_cost >= kMinTaskCostNsec) {
+      runner_([this, batch, scheduled_nsec]() {
+        ProcessBatch(batch, scheduled_nsec);
+      });
+      batch.clear();
+      batch_cost = 0;
+    }
+  }
+  if (batch.empty()) return;
+  if (inline_ready->empty()) {
+    // The remaining work is too small to be worth another thread.
+    for (auto& tagged_node : batch) {
+      inline_ready->push_back(tagged_node);
+    }
+  } else {
+    runner_([this, batch, scheduled_nsec]() {
+      ProcessBatch(batch, scheduled_nsec);
+    });
+  }
+}
+
+void ExecutorState::ProcessBatch(const TaggedNodeSeq& batch,
+                                 int64 scheduled_nsec) {
+  // Every node in the batch counts as outstanding until it is processed, so
+  // the step cannot finish, and delete this object, before the last one.
+  for (const TaggedNode& tagged_node : batch) {
+    Process(tagged_node, scheduled_nsec);
+  }
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               int64 node_id) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
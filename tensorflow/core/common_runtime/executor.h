@@ -28,6 +28,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class MemoryTimelineCollector;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -90,6 +91,9 @@ class Executor {
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
+    // If not null, records the allocations of the kernels. Allocations
+    // recorded this way are not served by the per-step arena.
+    MemoryTimelineCollector* memory_timeline = nullptr;
 
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
@@ -138,6 +142,17 @@ struct LocalExecutorParams {
   // when the executor is deleted.
   std::function<Status(const NodeDef&, OpKernel**)> create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
+
+  // If true and the device is a CPU, each step serves the outputs and
+  // temporaries of kernels whose outputs do not escape the step from a
+  // StepArena, which is released in one shot when the step ends.
+  bool use_step_arena = false;
+
+  // If true, the executor times the kernels of a sample of its steps, and
+  // uses the measured costs instead of OpKernel::IsExpensive() to decide
+  // which ready nodes run inline and which are grouped into tasks for other
+  // threads.
+  bool use_measured_costs = false;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       std::unique_ptr<const Graph> graph,
@@ -233,6 +248,15 @@ Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
 // Deletes "kernel" returned by CreateKernel.
 void DeleteNonCachedKernel(OpKernel* kernel);
 
+// Infer memory allocation attributes of a node n's output,
+// based on its use node dst.  Note that dst might not be directly
+// connected to n by a single edge, but might be a downstream
+// consumer of n's output by reference.  *attr is updated with any
+// necessary attributes.
+Status InferAllocAttr(const Node* n, const Node* dst,
+                      const DeviceNameUtils::ParsedName& local_dev_name,
+                      AllocatorAttributes* attr);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EXECUTOR_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
@@ -61,6 +62,8 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_;
+    params.use_step_arena = use_step_arena_;
+    params.use_measured_costs = use_measured_costs_;
     params.create_kernel = [this, version](const NodeDef& ndef,
                                            OpKernel** kernel) {
       return CreateNonCachedKernel(device_, nullptr, ndef, version, kernel);
@@ -74,14 +77,18 @@ class ExecutorTest : public ::testing::Test {
     rendez_ = NewLocalRendezvous();
   }
 
-  Status Run(Rendezvous* rendez) {
+  Status Run(Rendezvous* rendez, bool collect_stats = true) {
     Executor::Args args;
     args.rendezvous = rendez;
-    args.stats_collector = &step_stats_collector_;
+    if (collect_stats) {
+      args.stats_collector = &step_stats_collector_;
+    }
     args.runner = runner_;
     return exec_->Run(args);
   }
 
+  bool use_step_arena_ = false;
+  bool use_measured_costs_ = false;
   thread::ThreadPool* thread_pool_ = nullptr;
   Device* device_ = nullptr;
   Executor* exec_ = nullptr;
@@ -193,6 +200,50 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, SelfAddWithStepArena) {
+  // Same graph as SelfAdd. The intermediate values come from the step arena,
+  // and the last Add may forward its input's buffer to the Send, so the
+  // output received after the step still refers to the arena's memory.
+  use_step_arena_ = true;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  // The device allocates from cpu_allocator(), whose allocation count shows
+  // how many tensors the arena did not serve.
+  EnableCPUAllocatorStats(true);
+  Rendezvous::Args args;
+  std::vector<Tensor> outs;
+  std::vector<int64> device_allocs;
+  for (float a : {1.0f, 2.0f}) {
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(a), false));
+    AllocatorStats before;
+    cpu_allocator()->GetStats(&before);
+    TF_ASSERT_OK(Run(rendez_, /*collect_stats=*/false));
+    AllocatorStats after;
+    cpu_allocator()->GetStats(&after);
+    device_allocs.push_back(after.num_allocs - before.num_allocs);
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    outs.push_back(out);
+  }
+  EnableCPUAllocatorStats(false);
+  EXPECT_EQ(1024.0, V(outs[0]));
+  EXPECT_EQ(2048.0, V(outs[1]));
+  // Without the arena, each of the N Adds allocates its output from the
+  // device. With it, only the last Add, whose output feeds the Send, does in
+  // the second step, as the first step already cached the arena's block.
+  EXPECT_LT(device_allocs[0], N);
+  EXPECT_LE(device_allocs[1], 1);
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -243,6 +294,25 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWithMeasuredCosts) {
+  // The first steps measure the costs, and later ones schedule by them.
+  use_measured_costs_ = true;
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  for (int i = 0; i < 8; ++i) {
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_, /*collect_stats=*/false));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -461,6 +531,60 @@ BENCHMARK(BM_executor)->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->ArgPair(1024, 1024);
 
+// Runs "width" independent chains of 16 small MatMuls, which are expensive
+// according to OpKernel::IsExpensive() but take about a microsecond each,
+// with and without scheduling by measured costs.
+static void BM_WideSmallOps(int iters, int use_measured_costs, int width) {
+  testing::StopTiming();
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  Tensor m(DT_FLOAT, TensorShape({4, 4}));
+  m.flat<float>().setConstant(0.25f);
+  Node* in = test::graph::Constant(g.get(), m);
+  const int kDepth = 16;
+  for (int w = 0; w < width; ++w) {
+    Node* v = in;
+    for (int d = 0; d < kDepth; ++d) {
+      v = test::graph::Matmul(g.get(), v, in, false, false);
+    }
+  }
+
+  Device* device =
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0");
+  const int version = g->versions().producer();
+  LocalExecutorParams params;
+  params.device = device;
+  params.use_measured_costs = use_measured_costs;
+  params.create_kernel = [device, version](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+    return CreateNonCachedKernel(device, nullptr, ndef, version, kernel);
+  };
+  params.delete_kernel = [](OpKernel* kernel) {
+    DeleteNonCachedKernel(kernel);
+  };
+  Executor* exec = nullptr;
+  TF_CHECK_OK(NewLocalExecutor(params, std::move(g), &exec));
+  thread::ThreadPool* pool = ComputePool(SessionOptions());
+  Executor::Args args;
+  args.runner = [pool](std::function<void()> fn) { pool->Schedule(fn); };
+  // Warm up, which also measures the costs.
+  for (int i = 0; i < 8; ++i) {
+    TF_CHECK_OK(exec->Run(args));
+  }
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(exec->Run(args));
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * width * kDepth);
+  delete exec;
+  delete device;
+}
+BENCHMARK(BM_WideSmallOps)
+    ->ArgPair(0, 64)
+    ->ArgPair(1, 64)
+    ->ArgPair(0, 1024)
+    ->ArgPair(1, 1024);
+
 static void BM_FeedInputFetchOutput(int iters) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
@@ -0,0 +1,89 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The virtual time a step of weight 1 advances by for each closure it runs.
+// Weights above this are clamped, so that every step makes progress.
+constexpr uint64 kVirtualTimePerClosure = 1 << 20;
+
+}  // namespace
+
+FairShareScheduler::Step::Step(int64 id, int64 weight)
+    : id_(id), weight_(weight) {}
+
+FairShareScheduler::FairShareScheduler(thread::ThreadPool* pool)
+    : pool_(pool) {
+  CHECK(pool_ != nullptr);
+}
+
+FairShareScheduler::~FairShareScheduler() {
+  mutex_lock l(mu_);
+  CHECK(ready_.empty()) << "FairShareScheduler destroyed with queued closures";
+}
+
+FairShareScheduler::Step* FairShareScheduler::NewStep(int32 priority) {
+  const int64 weight =
+      std::min<int64>(1 + std::max(priority, 0), kVirtualTimePerClosure);
+  mutex_lock l(mu_);
+  return new Step(next_step_id_++, weight);
+}
+
+void FairShareScheduler::Schedule(Step* step, std::function<void()> fn) {
+  step->Ref();
+  {
+    mutex_lock l(mu_);
+    if (step->closures_.empty()) {
+      step->start_tag_ = std::max(virtual_time_, step->finish_tag_);
+      ready_.emplace(ReadyKey(step->start_tag_, step->id_), step);
+    }
+    step->closures_.push_back(std::move(fn));
+  }
+  pool_->Schedule([this]() { RunNext(); });
+}
+
+void FairShareScheduler::RunNext() {
+  Step* step;
+  std::function<void()> fn;
+  {
+    mutex_lock l(mu_);
+    // Every queued closure has exactly one dispatch.
+    CHECK(!ready_.empty());
+    auto it = ready_.begin();
+    step = it->second;
+    ready_.erase(it);
+    fn = std::move(step->closures_.front());
+    step->closures_.pop_front();
+    virtual_time_ = step->start_tag_;
+    step->finish_tag_ =
+        step->start_tag_ + kVirtualTimePerClosure / step->weight_;
+    if (!step->closures_.empty()) {
+      step->start_tag_ = step->finish_tag_;
+      ready_.emplace(ReadyKey(step->start_tag_, step->id_), step);
+    }
+  }
+  fn();
+  step->Unref();
+}
+
+}  // namespace tensorflow
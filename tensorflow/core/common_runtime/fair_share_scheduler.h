@@ -0,0 +1,102 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Shares the threads of a thread::ThreadPool between concurrent steps.
+//
+// The closures of each step are kept in a queue of their own, and every
+// closure scheduled through the scheduler schedules one dispatch on the
+// pool. A dispatch runs the first closure of the step that is furthest
+// behind its share of the pool, as in start-time fair queueing: each closure
+// a step runs advances the step's virtual time by the inverse of its weight,
+// and a step that was idle restarts from the scheduler's current virtual
+// time, so it can neither be starved by a busy step nor claim the share it
+// did not use while it was idle.
+//
+// The pool must be drained, e.g. destroyed, before the scheduler is.
+class FairShareScheduler {
+ public:
+  // The queue of closures of one step. The scheduler's dispatches hold a
+  // reference for each queued closure, so the owner of the step may drop its
+  // reference as soon as it has stopped scheduling closures.
+  class Step : public core::RefCounted {
+   public:
+    int64 weight() const { return weight_; }
+
+   private:
+    friend class FairShareScheduler;
+
+    Step(int64 id, int64 weight);
+
+    const int64 id_;
+    const int64 weight_;
+    // The following are guarded by the scheduler's mu_.
+    std::deque<std::function<void()>> closures_;
+    uint64 start_tag_ = 0;
+    uint64 finish_tag_ = 0;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(Step);
+  };
+
+  // "pool" must outlive this object.
+  explicit FairShareScheduler(thread::ThreadPool* pool);
+  ~FairShareScheduler();
+
+  // Returns a new step whose share of the pool, while it competes with other
+  // steps, is 1 + "priority" times that of a step with priority 0. Negative
+  // priorities are treated as 0. The caller owns a reference on the step.
+  Step* NewStep(int32 priority);
+
+  // Schedules "fn" to run on the pool on behalf of "step".
+  void Schedule(Step* step, std::function<void()> fn);
+
+  thread::ThreadPool* pool() const { return pool_; }
+
+ private:
+  typedef std::pair<uint64, int64> ReadyKey;
+
+  // Runs the next closure of the step with the smallest start tag.
+  void RunNext();
+
+  thread::ThreadPool* const pool_;  // Not owned.
+
+  mutex mu_;
+  int64 next_step_id_ GUARDED_BY(mu_) = 0;
+  uint64 virtual_time_ GUARDED_BY(mu_) = 0;
+  // The steps that have queued closures, by start tag and id.
+  std::map<ReadyKey, Step*> ready_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FairShareScheduler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FAIR_SHARE_SCHEDULER_H_
@@ -0,0 +1,124 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fair_share_scheduler.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FairShareSchedulerTest : public ::testing::Test {
+ protected:
+  FairShareSchedulerTest()
+      : pool_(Env::Default(), "test", 1), scheduler_(&pool_) {}
+
+  // Queues "n" closures for each of "steps", in order, while the pool's only
+  // thread is blocked, then runs them and returns the indices of the steps
+  // in the order their closures ran.
+  std::vector<int> RunOrder(const std::vector<FairShareScheduler::Step*>& steps,
+                            int n) {
+    Notification start;
+    pool_.Schedule([&start]() { start.WaitForNotification(); });
+    mutex mu;
+    std::vector<int> order;
+    BlockingCounter done(steps.size() * n);
+    for (int s = 0; s < steps.size(); ++s) {
+      for (int i = 0; i < n; ++i) {
+        scheduler_.Schedule(steps[s], [&mu, &order, &done, s]() {
+          {
+            mutex_lock l(mu);
+            order.push_back(s);
+          }
+          done.DecrementCount();
+        });
+      }
+    }
+    start.Notify();
+    done.Wait();
+    return order;
+  }
+
+  thread::ThreadPool pool_;
+  FairShareScheduler scheduler_;
+};
+
+TEST_F(FairShareSchedulerTest, EqualPrioritiesAlternate) {
+  FairShareScheduler::Step* a = scheduler_.NewStep(0);
+  FairShareScheduler::Step* b = scheduler_.NewStep(0);
+  // a queues all of its closures before b, but they run interleaved.
+  EXPECT_EQ(std::vector<int>({0, 1, 0, 1, 0, 1, 0, 1}), RunOrder({a, b}, 4));
+  a->Unref();
+  b->Unref();
+}
+
+TEST_F(FairShareSchedulerTest, HigherPriorityGetsLargerShare) {
+  FairShareScheduler::Step* low = scheduler_.NewStep(0);
+  FairShareScheduler::Step* high = scheduler_.NewStep(3);
+  EXPECT_EQ(1, low->weight());
+  EXPECT_EQ(4, high->weight());
+  // high runs four closures for each one of low.
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 1, 1, 0, 0, 0}),
+            RunOrder({low, high}, 4));
+  low->Unref();
+  high->Unref();
+}
+
+TEST_F(FairShareSchedulerTest, NegativePriority) {
+  FairShareScheduler::Step* step = scheduler_.NewStep(-5);
+  EXPECT_EQ(1, step->weight());
+  step->Unref();
+}
+
+TEST_F(FairShareSchedulerTest, NewStepDoesNotGetPastShare) {
+  FairShareScheduler::Step* busy = scheduler_.NewStep(0);
+  RunOrder({busy}, 8);
+  // A step that starts while busy has been running alone only gets its
+  // share from now on, instead of running eight closures first.
+  FairShareScheduler::Step* late = scheduler_.NewStep(0);
+  EXPECT_EQ(std::vector<int>({1, 0, 1, 0, 1, 0, 1, 0}),
+            RunOrder({busy, late}, 4));
+  busy->Unref();
+  late->Unref();
+}
+
+TEST_F(FairShareSchedulerTest, ManyThreads) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  FairShareScheduler scheduler(&pool);
+  const int kSteps = 8;
+  const int kClosuresPerStep = 100;
+  BlockingCounter done(kSteps * kClosuresPerStep);
+  for (int s = 0; s < kSteps; ++s) {
+    FairShareScheduler::Step* step = scheduler.NewStep(s);
+    EXPECT_EQ(s + 1, step->weight());
+    for (int i = 0; i < kClosuresPerStep; ++i) {
+      // Closures scheduled from within the pool as well as from outside.
+      scheduler.Schedule(step, [&scheduler, &done, step]() {
+        scheduler.Schedule(step, [&done]() { done.DecrementCount(); });
+      });
+    }
+    step->Unref();
+  }
+  done.Wait();
+}
+
+}  // namespace
+}  // namespace tensorflow
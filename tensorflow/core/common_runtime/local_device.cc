@@ -16,13 +16,20 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include "tensorflow/core/common_runtime/local_device.h"
+
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/eigen_thread_pool.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_feature_guard.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -32,17 +39,28 @@ namespace tensorflow {
 bool LocalDevice::use_global_threadpool_ = true;
 
 struct LocalDevice::EigenThreadPoolInfo {
-  explicit EigenThreadPoolInfo(const SessionOptions& options) {
+  // If numa_node is not port::kNUMANoAffinity, the threads are pinned to that
+  // node and by default there is one per CPU of the node.
+  EigenThreadPoolInfo(const SessionOptions& options, int numa_node) {
     int32 intra_op_parallelism_threads =
         options.config.intra_op_parallelism_threads();
     if (intra_op_parallelism_threads == 0) {
       intra_op_parallelism_threads = port::NumSchedulableCPUs();
+      if (numa_node != port::kNUMANoAffinity) {
+        intra_op_parallelism_threads = std::max(
+            1, intra_op_parallelism_threads / port::NUMANumNodes());
+      }
     }
     VLOG(1) << "Local device intra op parallelism threads: "
-            << intra_op_parallelism_threads;
+            << intra_op_parallelism_threads << " numa_node: " << numa_node;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
+    const string name = numa_node == port::kNUMANoAffinity
+                            ? "Eigen"
+                            : strings::StrCat("numa_", numa_node, "_Eigen");
     eigen_worker_threads_.num_threads = intra_op_parallelism_threads;
     eigen_worker_threads_.workers = new thread::ThreadPool(
-        options.env, "Eigen", intra_op_parallelism_threads);
+        options.env, thread_options, name, intra_op_parallelism_threads);
     eigen_threadpool_wrapper_.reset(
         new EigenThreadPoolWrapper(eigen_worker_threads_.workers));
     eigen_device_.reset(new Eigen::ThreadPoolDevice(
@@ -66,17 +84,35 @@ LocalDevice::LocalDevice(const SessionOptions& options,
   // Log info messages if TensorFlow is not compiled with instructions that
   // could speed up performance and are available on the current CPU.
   port::InfoAboutUnusedCPUFeatures();
+  // Devices created with NUMA affinity carry their node in their locality.
+  const int numa_node = options.config.experimental().use_numa_affinity() &&
+                               port::NUMAEnabled()
+                           ? attributes.locality().numa_node()
+                           : port::kNUMANoAffinity;
   LocalDevice::EigenThreadPoolInfo* tp_info;
   if (use_global_threadpool_) {
     // All ThreadPoolDevices in the process will use this single fixed
-    // sized threadpool for numerical computations.
-    static LocalDevice::EigenThreadPoolInfo* global_tp_info =
-        new LocalDevice::EigenThreadPoolInfo(options);
-    tp_info = global_tp_info;
+    // sized threadpool for numerical computations, or with NUMA affinity,
+    // all ThreadPoolDevices on the same node share that node's threadpool.
+    static mutex* global_tp_mu = new mutex;
+    static std::vector<LocalDevice::EigenThreadPoolInfo*>* global_tp_info =
+        new std::vector<LocalDevice::EigenThreadPoolInfo*>;
+    // Index 0 is the pool without affinity, index n + 1 the one of node n.
+    const size_t index = numa_node + 1;
+    mutex_lock l(*global_tp_mu);
+    if (global_tp_info->size() <= index) {
+      global_tp_info->resize(index + 1, nullptr);
+    }
+    if ((*global_tp_info)[index] == nullptr) {
+      (*global_tp_info)[index] =
+          new LocalDevice::EigenThreadPoolInfo(options, numa_node);
+    }
+    tp_info = (*global_tp_info)[index];
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(options));
+    owned_tp_info_.reset(
+        new LocalDevice::EigenThreadPoolInfo(options, numa_node));
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
@@ -26,7 +26,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -284,12 +286,39 @@ void PoolAllocator::AddFreeVisitor(Visitor visitor) {
   free_visitors_.push_back(visitor);
 }
 
+namespace {
+
+// Blocks smaller than this come from the heap even when a NUMA node is set:
+// port::NUMAMalloc maps and binds whole pages with a few syscalls per call,
+// which would dominate the cost of the small blocks a PoolAllocator requests.
+// Heap blocks still land on the node on first touch, as the devices of a node
+// run their kernels on threads pinned to it.
+constexpr size_t kMinNUMAMappedBytes = 1 << 20;
+
+}  // namespace
+
 void* BasicCPUAllocator::Alloc(size_t alignment, size_t num_bytes) {
-  return port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+  if (numa_node_ == port::kNUMANoAffinity || num_bytes < kMinNUMAMappedBytes) {
+    return port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+  }
+  return port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
 }
 
 void BasicCPUAllocator::Free(void* ptr, size_t num_bytes) {
-  port::AlignedFree(ptr);
+  if (numa_node_ == port::kNUMANoAffinity || num_bytes < kMinNUMAMappedBytes) {
+    port::AlignedFree(ptr);
+  } else {
+    port::NUMAFree(ptr, num_bytes);
+  }
+}
+
+void* HugePageCPUAllocator::Alloc(size_t alignment, size_t num_bytes) {
+  return port::HugePageMalloc(numa_node_, num_bytes,
+                              static_cast<int>(alignment), prefault_);
+}
+
+void HugePageCPUAllocator::Free(void* ptr, size_t num_bytes) {
+  port::HugePageFree(ptr, num_bytes);
 }
 
 }  // namespace tensorflow
@@ -165,7 +165,9 @@ class Pow2Rounder : public RoundUpInterface {
 
 class BasicCPUAllocator : public SubAllocator {
  public:
-  // Argument numa_node is currently ignored.
+  // Memory is allocated on numa_node, unless it is port::kNUMANoAffinity.
+  // Only blocks of 1MB or more are bound to the node explicitly; smaller ones
+  // come from the heap, see Alloc. Free must be passed the size of the block.
   explicit BasicCPUAllocator(int numa_node) : numa_node_(numa_node) {}
 
   ~BasicCPUAllocator() override {}
@@ -178,5 +180,25 @@ class BasicCPUAllocator : public SubAllocator {
   int numa_node_;
 };
 
+// A SubAllocator for the large regions of a BFCAllocator, which are backed by
+// huge pages where the platform supports them, see port::HugePageMalloc.
+class HugePageCPUAllocator : public SubAllocator {
+ public:
+  // Memory is allocated on numa_node, unless it is port::kNUMANoAffinity. If
+  // prefault is true, every region is faulted in when it is allocated.
+  HugePageCPUAllocator(int numa_node, bool prefault)
+      : numa_node_(numa_node), prefault_(prefault) {}
+
+  ~HugePageCPUAllocator() override {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override;
+
+  void Free(void* ptr, size_t num_bytes) override;
+
+ private:
+  const int numa_node_;
+  const bool prefault_;
+};
+
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_POOL_ALLOCATOR_H_
@@ -20,11 +20,13 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -72,8 +74,8 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
 }
 
 VisitableAllocator* ProcessState::GetCPUAllocator(int numa_node) {
+  if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
   CHECK_GE(numa_node, 0);
-  if (!numa_enabled_) numa_node = 0;
   mutex_lock lock(mu_);
   while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
     bool use_bfc_allocator = false;
@@ -95,11 +97,46 @@ VisitableAllocator* ProcessState::GetCPUAllocator(int numa_node) {
         LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
-      allocator = new BFCAllocator(
-          new BasicCPUAllocator(numa_enabled_ ? numa_node : -1), cpu_mem_limit,
-          true /*allow_growth*/, "bfc_cpu_allocator_for_gpu" /*name*/);
+      // Large tensors allocated from regions of huge pages incur fewer page
+      // faults and TLB misses.
+      bool use_huge_pages = false;
+      status = ReadBoolFromEnvVar("TF_CPU_BFC_USE_HUGE_PAGES", false,
+                                  &use_huge_pages);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      bool prefault = false;
+      status = ReadBoolFromEnvVar("TF_CPU_BFC_PREFAULT_HUGE_PAGES", false,
+                                  &prefault);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      int64 reserve_in_mb = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_RESERVE_IN_MB", 0,
+                                   &reserve_in_mb);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      const int node = numa_enabled_ ? numa_node : -1;
+      SubAllocator* sub_allocator;
+      if (use_huge_pages) {
+        sub_allocator = new HugePageCPUAllocator(node, prefault);
+      } else {
+        sub_allocator = new BasicCPUAllocator(node);
+      }
+      allocator = new BFCAllocator(sub_allocator, cpu_mem_limit,
+                                   true /*allow_growth*/,
+                                   "bfc_cpu_allocator_for_gpu" /*name*/);
       VLOG(2) << "Using BFCAllocator with memory limit of "
-              << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
+              << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator"
+              << (use_huge_pages ? " backed by huge pages" : "");
+      if (reserve_in_mb > 0) {
+        // Maps a region up front, when the first CPU device is created, so
+        // that the first steps do not pay for growing the allocator.
+        // BFCAllocator keeps the region after the deallocation.
+        allocator->DeallocateRaw(allocator->AllocateRaw(
+            Allocator::kAllocatorAlignment, reserve_in_mb * (1LL << 20)));
+      }
     } else {
       allocator = new PoolAllocator(
           100 /*pool_size_limit*/, true /*auto_resize*/,
@@ -109,6 +146,19 @@ VisitableAllocator* ProcessState::GetCPUAllocator(int numa_node) {
               << "numa_enabled_=" << numa_enabled_
               << " numa_node=" << numa_node;
     }
+    bool use_thread_cache = false;
+    status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_THREAD_CACHE", false,
+                                &use_thread_cache);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+    }
+    if (use_thread_cache) {
+      // Serve small allocations from per-thread caches, so that concurrent
+      // kernels rarely contend for the allocator's lock.
+      allocator = new ThreadCachingAllocator(
+          allocator, port::NumSchedulableCPUs(), 4 << 20 /*max_shard_bytes*/);
+      VLOG(2) << "Using ThreadCachingAllocator for ProcessState CPU allocator";
+    }
     if (LogMemory::IsEnabled()) {
       // Wrap the allocator to track allocation ids for better logging
       // at the cost of performance.
@@ -63,8 +63,9 @@ class ProcessState {
   // If we know nothing, it's called CPU 0 with no other attributes.
   MemDesc PtrType(const void* ptr);
 
-  // Returns the one CPUAllocator used for the given numa_node.
-  // TEMPORARY: ignores numa_node.
+  // Returns the one CPUAllocator used for the given numa_node. Unless NUMA
+  // has been enabled, or if numa_node is port::kNUMANoAffinity, this is the
+  // allocator for node 0, whose memory has no particular node affinity.
   VisitableAllocator* GetCPUAllocator(int numa_node);
 
   typedef std::unordered_map<const void*, MemDesc> MDMap;
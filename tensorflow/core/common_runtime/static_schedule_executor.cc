@@ -0,0 +1,762 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_schedule_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/tensor_slice_reader_cache.h"
+
+namespace tensorflow {
+
+const char* const kStaticScheduleExecutorType = "STATIC_SCHEDULE";
+
+namespace {
+
+// The recorded cost, in nanoseconds, that a task should at least have before
+// a level is split into several tasks. Below this the cost of handing a task
+// to another thread exceeds the gain of running it in parallel.
+const int64 kMinTaskCostNsec = 50 * 1000;
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<DeviceContext*, 4> DeviceContextVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+bool IsInitializationOp(const Node* node) {
+  return node->op_def().allows_uninitialized_input();
+}
+
+// Returns OK iff the static schedule executor can run "graph" on "device".
+Status CheckSupported(const Graph& graph, const Device& device) {
+  if (device.device_type() != DEVICE_CPU) {
+    return errors::Unimplemented("Device type ", device.device_type(),
+                                 " is not supported");
+  }
+  if (device.RequiresRecordingAccessedTensors()) {
+    return errors::Unimplemented("Device ", device.name(),
+                                 " records accessed tensors");
+  }
+  for (const Node* n : graph.nodes()) {
+    if (IsControlFlow(n)) {
+      return errors::Unimplemented("Node ", n->name(), " is a control flow op");
+    }
+    if (IsScopedAllocator(n) ||
+        n->attrs().Find("_scoped_allocator") != nullptr) {
+      return errors::Unimplemented("Node ", n->name(),
+                                   " uses a scoped allocator");
+    }
+  }
+  return Status::OK();
+}
+
+class StaticScheduleExecutor : public Executor {
+ public:
+  StaticScheduleExecutor(const LocalExecutorParams& params,
+                         std::unique_ptr<const Graph> graph)
+      : params_(params), graph_(std::move(graph)) {
+    CHECK(params.create_kernel != nullptr);
+    CHECK(params.delete_kernel != nullptr);
+  }
+
+  ~StaticScheduleExecutor() override {
+    for (NodeItem& item : nodes_) {
+      if (item.kernel != nullptr) {
+        params_.delete_kernel(item.kernel);
+      }
+    }
+  }
+
+  // Returns Unimplemented if the graph has a kernel that the static schedule
+  // cannot run, in which case the graph can still be taken back with
+  // ReleaseGraph() and run by the default executor.
+  Status Initialize();
+
+  std::unique_ptr<const Graph> ReleaseGraph() { return std::move(graph_); }
+
+  void RunAsync(const Args& args, DoneCallback done) override;
+
+ private:
+  friend class StaticScheduleState;
+
+  struct OutEdge {
+    int output_slot;
+    // Index of the destination's input in the step's input slots.
+    int input_slot;
+  };
+
+  struct NodeItem {
+    const Node* node = nullptr;
+    OpKernel* kernel = nullptr;
+    int num_inputs = 0;
+    int num_outputs = 0;
+    // Index of the node's first input in the step's input slots.
+    int input_start = 0;
+    // Data edges out of the node.
+    std::vector<OutEdge> out_edges;
+    std::vector<AllocatorAttributes> output_attrs;
+  };
+
+  // For every level, the tasks that run in parallel. A task is a list of
+  // indices into nodes_, run in order on one thread.
+  typedef std::vector<std::vector<std::vector<int>>> Schedule;
+
+  // Returns the schedule for a new step, and sets "*record" if the step
+  // should record the costs of the kernels.
+  std::shared_ptr<const Schedule> StartStep(bool* record);
+
+  // Called when a step that records costs ends. "costs" holds the cost of
+  // every node, or is null if the step failed.
+  void FinishRecording(const std::vector<int64>* costs);
+
+  LocalExecutorParams params_;
+  std::unique_ptr<const Graph> graph_;
+
+  // Indexed by node id. Nodes that are not scheduled have no kernel.
+  std::vector<NodeItem> nodes_;
+  // The node ids of every level.
+  std::vector<std::vector<int>> levels_;
+  int total_inputs_ = 0;
+
+  mutex mu_;
+  bool recorded_ GUARDED_BY(mu_) = false;
+  bool recording_ GUARDED_BY(mu_) = false;
+  std::shared_ptr<const Schedule> schedule_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticScheduleExecutor);
+};
+
+Status StaticScheduleExecutor::Initialize() {
+  const int num_nodes = graph_->num_node_ids();
+  nodes_.resize(num_nodes);
+  const DeviceNameUtils::ParsedName& local_dev_name =
+      params_.device->parsed_name();
+
+  // Compute the level of every node in topological order. The source and
+  // sink nodes do nothing and are not scheduled.
+  std::vector<int> level(num_nodes, 0);
+  std::vector<int> pending(num_nodes, 0);
+  std::vector<const Node*> ready;
+  for (const Node* n : graph_->nodes()) {
+    pending[n->id()] = n->in_edges().size();
+    if (pending[n->id()] == 0) ready.push_back(n);
+  }
+  int num_visited = 0;
+  while (!ready.empty()) {
+    const Node* n = ready.back();
+    ready.pop_back();
+    ++num_visited;
+    const bool scheduled = n->IsOp();
+    if (scheduled) {
+      if (static_cast<size_t>(level[n->id()]) >= levels_.size()) {
+        levels_.resize(level[n->id()] + 1);
+      }
+      levels_[level[n->id()]].push_back(n->id());
+    }
+    for (const Edge* e : n->out_edges()) {
+      const int dst = e->dst()->id();
+      if (scheduled) {
+        level[dst] = std::max(level[dst], level[n->id()] + 1);
+      }
+      if (--pending[dst] == 0) ready.push_back(e->dst());
+    }
+  }
+  if (num_visited != graph_->num_nodes()) {
+    return errors::InvalidArgument("Graph is not acyclic");
+  }
+
+  for (const Node* n : graph_->op_nodes()) {
+    NodeItem* item = &nodes_[n->id()];
+    item->node = n;
+    item->num_inputs = n->num_inputs();
+    item->num_outputs = n->num_outputs();
+    item->input_start = total_inputs_;
+    total_inputs_ += n->num_inputs();
+  }
+
+  for (const Node* n : graph_->op_nodes()) {
+    NodeItem* item = &nodes_[n->id()];
+    Status s = params_.create_kernel(n->def(), &item->kernel);
+    if (!s.ok()) {
+      item->kernel = nullptr;
+      s = AttachDef(s, *n);
+      LOG(ERROR) << "Executor failed to create kernel. " << s;
+      return s;
+    }
+    CHECK(item->kernel);
+    // An asynchronous kernel, such as a _Recv, may wait for a node of a
+    // later level, for instance through a peer partition that waits for a
+    // _Send of this one. Only the pending counts of the default executor
+    // start that node before the kernel completes.
+    if (item->kernel->AsAsync() != nullptr) {
+      return errors::Unimplemented("Node ", n->name(),
+                                   " has an asynchronous kernel");
+    }
+
+    item->output_attrs.resize(item->num_outputs);
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      const NodeItem& dst = nodes_[e->dst()->id()];
+      item->out_edges.push_back(
+          {e->src_output(), dst.input_start + e->dst_input()});
+      AllocatorAttributes attr;
+      TF_RETURN_IF_ERROR(InferAllocAttr(n, e->dst(), local_dev_name, &attr));
+      item->output_attrs[e->src_output()].Merge(attr);
+    }
+    std::sort(item->out_edges.begin(), item->out_edges.end(),
+              [](const OutEdge& a, const OutEdge& b) {
+                return a.output_slot < b.output_slot;
+              });
+    for (int out = 0; out < item->num_outputs; ++out) {
+      if (item->kernel->output_memory_types()[out] == HOST_MEMORY) {
+        AllocatorAttributes h;
+        h.set_on_host(true);
+        item->output_attrs[out].Merge(h);
+      }
+    }
+  }
+
+  // Until the costs are recorded, every node is a task of its own.
+  Schedule* schedule = new Schedule(levels_.size());
+  for (size_t l = 0; l < levels_.size(); ++l) {
+    for (int id : levels_[l]) {
+      (*schedule)[l].push_back({id});
+    }
+  }
+  mutex_lock l(mu_);
+  schedule_.reset(schedule);
+  return Status::OK();
+}
+
+std::shared_ptr<const StaticScheduleExecutor::Schedule>
+StaticScheduleExecutor::StartStep(bool* record) {
+  mutex_lock l(mu_);
+  *record = !recorded_ && !recording_;
+  if (*record) recording_ = true;
+  return schedule_;
+}
+
+void StaticScheduleExecutor::FinishRecording(const std::vector<int64>* costs) {
+  if (costs == nullptr) {
+    mutex_lock l(mu_);
+    recording_ = false;
+    return;
+  }
+
+  Schedule* schedule = new Schedule(levels_.size());
+  for (size_t l = 0; l < levels_.size(); ++l) {
+    std::vector<std::vector<int>>* tasks = &(*schedule)[l];
+    // The kernels are spread over as many tasks as their total cost allows,
+    // longest first, always adding to the task with the least cost so far.
+    std::vector<int> nodes = levels_[l];
+    int64 cost = 0;
+    for (int id : nodes) cost += (*costs)[id];
+    std::sort(nodes.begin(), nodes.end(), [costs](int a, int b) {
+      return (*costs)[a] > (*costs)[b];
+    });
+    const int num_tasks = static_cast<int>(std::max<int64>(
+        1, std::min<int64>(nodes.size(), cost / kMinTaskCostNsec)));
+    tasks->resize(num_tasks);
+    std::vector<int64> task_cost(num_tasks, 0);
+    for (int id : nodes) {
+      const int t = std::min_element(task_cost.begin(), task_cost.end()) -
+                    task_cost.begin();
+      (*tasks)[t].push_back(id);
+      task_cost[t] += (*costs)[id];
+    }
+  }
+
+  mutex_lock l(mu_);
+  schedule_.reset(schedule);
+  recording_ = false;
+  recorded_ = true;
+}
+
+// The state of one step of a StaticScheduleExecutor.
+class StaticScheduleState {
+ public:
+  typedef StaticScheduleExecutor::NodeItem NodeItem;
+  typedef StaticScheduleExecutor::Schedule Schedule;
+
+  StaticScheduleState(const Executor::Args& args, StaticScheduleExecutor* impl,
+                      std::shared_ptr<const Schedule> schedule, bool record);
+  ~StaticScheduleState();
+
+  void RunAsync(Executor::DoneCallback done);
+
+ private:
+  // Either a tensor pointer (pass-by-reference) or a tensor (pass-by-value).
+  struct Entry {
+    Tensor val;
+    Tensor* ref = nullptr;
+    mutex* ref_mu = nullptr;
+    bool has_value = false;
+    AllocatorAttributes alloc_attr;
+
+    void Clear() {
+      val = Tensor();
+      ref = nullptr;
+      ref_mu = nullptr;
+      has_value = false;
+    }
+  };
+
+  // Runs levels, starting with the one after level_, until a level is left
+  // to be finished by another thread or the step is done.
+  void RunLevels();
+
+  // Runs the nodes of "task". Returns true iff it was the last task of its
+  // level to finish.
+  bool RunTask(const std::vector<int>& task);
+
+  // Runs the kernel of "item".
+  void Process(const NodeItem& item);
+
+  void InitParams(const NodeItem& item, OpKernelContext::Params* params,
+                  NodeExecStatsWrapper** stats);
+  Status PrepareInputs(const NodeItem& item, TensorValueVec* inputs,
+                       DeviceContextVec* input_device_contexts,
+                       AllocatorAttributeVec* input_alloc_attrs);
+  // Forwards the outputs of "ctx" to the input slots of their consumers.
+  Status ProcessOutputs(const NodeItem& item, OpKernelContext* ctx,
+                        NodeExecStatsWrapper* stats);
+  void ClearInputs(const NodeItem& item);
+  void NodeDone(const Status& s, const NodeItem& item,
+                NodeExecStatsWrapper* stats);
+
+  // Deletes this object and calls the done callback.
+  void Finish();
+
+  const bool log_memory_;
+  const int64 step_id_;
+  Rendezvous* rendezvous_;
+  CollectiveExecutor* collective_executor_ = nullptr;
+  StepStatsCollectorInterface* const stats_collector_;
+  checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
+  CancellationManager* cancellation_manager_;
+  Executor::Args::Runner runner_;
+  bool sync_on_finish_;
+
+  StaticScheduleExecutor* const impl_;
+  const std::shared_ptr<const Schedule> schedule_;
+  // Fields of OpKernelContext::Params that are the same for every node.
+  OpKernelContext::Params step_params_;
+
+  // The input slots of all nodes. Each is written by exactly one node, in
+  // an earlier level than the node that reads it.
+  std::vector<Entry> inputs_;
+
+  // If record_ is true, costs_[id] is the measured cost of node "id".
+  const bool record_;
+  std::vector<int64> costs_;
+
+  // The level whose tasks are running.
+  int level_ = -1;
+  // Number of tasks of level_ that have not finished.
+  std::atomic<int> num_pending_tasks_;
+  // Set once a node fails. The remaining nodes are skipped.
+  std::atomic<bool> aborted_;
+
+  Executor::DoneCallback done_cb_;
+
+  mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticScheduleState);
+};
+
+StaticScheduleState::StaticScheduleState(
+    const Executor::Args& args, StaticScheduleExecutor* impl,
+    std::shared_ptr<const Schedule> schedule, bool record)
+    : log_memory_(LogMemory::IsEnabled()),
+      step_id_(args.step_id),
+      rendezvous_(args.rendezvous),
+      collective_executor_(args.collective_executor),
+      stats_collector_(args.stats_collector),
+      slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
+      cancellation_manager_(args.cancellation_manager),
+      runner_(args.runner),
+      sync_on_finish_(args.sync_on_finish),
+      impl_(impl),
+      schedule_(std::move(schedule)),
+      inputs_(impl->total_inputs_),
+      record_(record),
+      num_pending_tasks_(0),
+      aborted_(false) {
+  if (record_) {
+    costs_.resize(impl_->nodes_.size(), 0);
+  }
+  Device* device = impl_->params_.device;
+  step_params_.step_id = step_id_;
+  step_params_.device = device;
+  step_params_.log_memory = log_memory_;
+  step_params_.rendezvous = rendezvous_;
+  step_params_.collective_executor = collective_executor_;
+  step_params_.session_state = args.session_state;
+  step_params_.tensor_store = args.tensor_store;
+  step_params_.cancellation_manager = cancellation_manager_;
+  step_params_.call_frame = args.call_frame;
+  step_params_.function_library = impl_->params_.function_library;
+  step_params_.resource_manager = device->resource_manager();
+  step_params_.step_container = args.step_container;
+  step_params_.slice_reader_cache = slice_reader_cache_;
+  step_params_.runner = &runner_;
+  step_params_.stats_collector = stats_collector_;
+  step_params_.memory_timeline = args.memory_timeline;
+}
+
+StaticScheduleState::~StaticScheduleState() { delete slice_reader_cache_; }
+
+void StaticScheduleState::RunAsync(Executor::DoneCallback done) {
+  done_cb_ = std::move(done);
+  runner_([this]() { RunLevels(); });
+}
+
+void StaticScheduleState::RunLevels() {
+  while (true) {
+    ++level_;
+    if (static_cast<size_t>(level_) == schedule_->size() ||
+        aborted_.load()) {
+      Finish();
+      return;
+    }
+    const std::vector<std::vector<int>>& tasks = (*schedule_)[level_];
+    num_pending_tasks_.store(tasks.size());
+    for (size_t t = 1; t < tasks.size(); ++t) {
+      const std::vector<int>* task = &tasks[t];
+      runner_([this, task]() {
+        if (RunTask(*task)) RunLevels();
+      });
+    }
+    // The first task runs inline, and the next level follows on this thread
+    // if the other tasks are already done.
+    if (!RunTask(tasks[0])) return;
+  }
+}
+
+bool StaticScheduleState::RunTask(const std::vector<int>& task) {
+  for (int id : task) {
+    if (aborted_.load(std::memory_order_relaxed)) break;
+    Process(impl_->nodes_[id]);
+  }
+  return num_pending_tasks_.fetch_sub(1) == 1;
+}
+
+void StaticScheduleState::InitParams(const NodeItem& item,
+                                     OpKernelContext::Params* params,
+                                     NodeExecStatsWrapper** stats) {
+  *params = step_params_;
+  params->op_kernel = item.kernel;
+  params->output_attr_array = item.output_attrs.data();
+  *stats = nullptr;
+  if (stats_collector_) {
+    // track allocations if and only if we are collecting statistics
+    params->track_allocations = true;
+    *stats = new NodeExecStatsWrapper(item.node->name());
+    (*stats)->RecordExecutorStarted();
+  }
+}
+
+void StaticScheduleState::Process(const NodeItem& item) {
+  TensorValueVec inputs;
+  DeviceContextVec input_device_contexts;
+  AllocatorAttributeVec input_alloc_attrs;
+  OpKernelContext::Params params;
+  NodeExecStatsWrapper* stats;
+  InitParams(item, &params, &stats);
+  params.inputs = &inputs;
+  params.input_device_contexts = &input_device_contexts;
+  params.input_alloc_attrs = &input_alloc_attrs;
+
+  Status s = PrepareInputs(item, &inputs, &input_device_contexts,
+                           &input_alloc_attrs);
+  if (s.ok()) {
+    OpKernelContext ctx(&params, item.num_outputs);
+    const int64 start_nsec = record_ ? Env::Default()->NowNanos() : 0;
+    if (stats) stats->RecordComputeStarted();
+    impl_->params_.device->Compute(item.kernel, &ctx);
+    if (stats) stats->RecordComputeEnded();
+    if (record_) {
+      costs_[item.node->id()] = Env::Default()->NowNanos() - start_nsec;
+    }
+    s = ProcessOutputs(item, &ctx, stats);
+    if (stats) stats->SetMemory(&ctx);
+  }
+  ClearInputs(item);
+  NodeDone(s, item, stats);
+}
+
+Status StaticScheduleState::PrepareInputs(
+    const NodeItem& item, TensorValueVec* inputs,
+    DeviceContextVec* input_device_contexts,
+    AllocatorAttributeVec* input_alloc_attrs) {
+  inputs->resize(item.num_inputs);
+  input_device_contexts->resize(item.num_inputs);
+  input_alloc_attrs->resize(item.num_inputs);
+
+  for (int i = 0; i < item.num_inputs; ++i) {
+    const bool expect_ref = IsRefType(item.kernel->input_type(i));
+    Entry* entry = &inputs_[item.input_start + i];
+    (*input_alloc_attrs)[i] = entry->alloc_attr;
+    TensorValue* inp = &(*inputs)[i];
+
+    if (!entry->has_value) {
+      return AttachDef(errors::Internal(i, "-th input has no value"),
+                       item.kernel->def());
+    }
+    if (entry->ref == nullptr) {
+      if (expect_ref) {
+        return AttachDef(
+            errors::InvalidArgument(i, "-th input expects a ref type"),
+            item.kernel->def());
+      }
+      inp->tensor = &entry->val;
+      continue;
+    }
+    {
+      mutex_lock ml(*entry->ref_mu);
+      if (!entry->ref->IsInitialized() && !IsInitializationOp(item.node)) {
+        return AttachDef(errors::FailedPrecondition(
+                             "Attempting to use uninitialized value ",
+                             item.kernel->requested_input(i)),
+                         item.kernel->def());
+      }
+    }
+    if (expect_ref) {
+      inp->mutex_if_ref = entry->ref_mu;
+      inp->tensor = entry->ref;
+    } else {
+      // Automatically deref the tensor ref when the op expects a tensor but
+      // is given a ref to a tensor. The input slot belongs to this node, so
+      // the dereferenced value can replace the ref.
+      {
+        mutex_lock l(*entry->ref_mu);
+        entry->val = *entry->ref;
+      }
+      entry->ref = nullptr;
+      entry->ref_mu = nullptr;
+      inp->tensor = &entry->val;
+      if (item.kernel->input_type(i) != inp->tensor->dtype()) {
+        return AttachDef(
+            errors::InvalidArgument(
+                i, "-th input expects type ",
+                DataTypeString(item.kernel->input_type(i)),
+                " but automatically dereferenced input tensor has type ",
+                DataTypeString(inp->tensor->dtype())),
+            item.kernel->def());
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status StaticScheduleState::ProcessOutputs(const NodeItem& item,
+                                           OpKernelContext* ctx,
+                                           NodeExecStatsWrapper* stats) {
+  const Node* node = item.node;
+  Status s = ctx->status();
+  if (!s.ok()) {
+    return AttachDef(s, item.kernel->def());
+  }
+
+  auto edge = item.out_edges.begin();
+  for (int i = 0; i < item.num_outputs; ++i) {
+    const TensorValue val = ctx->release_output(i);
+    if (val.tensor == nullptr) {
+      s.Update(errors::Internal("Missing ", i, "-th output from ",
+                                SummarizeNode(*node)));
+      continue;
+    }
+
+    Entry out;
+    out.has_value = true;
+    out.alloc_attr = ctx->output_alloc_attr(i);
+    DataType dtype;
+    if (val.is_ref()) {
+      mutex_lock ml(*val.mutex_if_ref);
+      dtype = MakeRefType(val->dtype());
+    } else {
+      dtype = val->dtype();
+    }
+    if (dtype != item.kernel->output_type(i)) {
+      s.Update(errors::Internal("Output ", i, " of type ",
+                                DataTypeString(dtype),
+                                " does not match declared output type ",
+                                DataTypeString(item.kernel->output_type(i)),
+                                " for node ", SummarizeNode(*node)));
+    } else {
+      if (stats && val.tensor->IsInitialized()) {
+        stats->SetOutput(i, val.tensor);
+      }
+      if (val.is_ref()) {
+        out.ref = val.tensor;
+        out.ref_mu = val.mutex_if_ref;
+      } else {
+        out.val = std::move(*val.tensor);
+      }
+      if (log_memory_) {
+        Tensor to_log;
+        if (val.is_ref()) {
+          mutex_lock l(*out.ref_mu);
+          to_log = *out.ref;
+        } else {
+          to_log = out.val;
+        }
+        LogMemory::RecordTensorOutput(ctx->op_kernel().name(), ctx->step_id(),
+                                      i, to_log);
+      }
+    }
+    if (!val.is_ref()) {
+      delete val.tensor;
+    }
+
+    // Forward the output to the input slots of its consumers.
+    while (edge != item.out_edges.end() && edge->output_slot < i) ++edge;
+    for (; edge != item.out_edges.end() && edge->output_slot == i; ++edge) {
+      inputs_[edge->input_slot] = out;
+    }
+  }
+  return s;
+}
+
+void StaticScheduleState::ClearInputs(const NodeItem& item) {
+  for (int i = 0; i < item.num_inputs; ++i) {
+    inputs_[item.input_start + i].Clear();
+  }
+}
+
+void StaticScheduleState::NodeDone(const Status& s, const NodeItem& item,
+                                   NodeExecStatsWrapper* stats) {
+  if (stats) {
+    stats->RecordExecutorEnded();
+    if (!stats->SetTimelineLabel(item.node)) {
+      // Only record non-transfer nodes.
+      stats_collector_->Save(impl_->params_.device->name(), stats);
+    } else {
+      delete stats;
+    }
+  }
+  if (s.ok()) return;
+
+  bool abort_run = false;
+  {
+    mutex_lock l(mu_);
+    if (status_.ok()) {
+      abort_run = true;
+      status_ = s;
+    }
+  }
+  if (abort_run) {
+    aborted_.store(true);
+    if (rendezvous_) {
+      rendezvous_->StartAbort(s);
+    }
+    if (collective_executor_) {
+      collective_executor_->StartAbort(s);
+    }
+    if (cancellation_manager_) {
+      cancellation_manager_->StartCancel();
+    }
+  }
+}
+
+void StaticScheduleState::Finish() {
+  mu_.lock();
+  Status status = status_;
+  mu_.unlock();
+  if (sync_on_finish_ && status.ok()) {
+    status = impl_->params_.device->Sync();
+  }
+  if (record_) {
+    impl_->FinishRecording(status.ok() ? &costs_ : nullptr);
+  }
+  auto done_cb = std::move(done_cb_);
+  auto runner = std::move(runner_);
+  delete this;
+  CHECK(done_cb != nullptr);
+  runner([=]() { done_cb(status); });
+}
+
+void StaticScheduleExecutor::RunAsync(const Args& args, DoneCallback done) {
+  bool record;
+  std::shared_ptr<const Schedule> schedule = StartStep(&record);
+  (new StaticScheduleState(args, this, std::move(schedule), record))
+      ->RunAsync(std::move(done));
+}
+
+}  // namespace
+
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 std::unique_ptr<const Graph> graph,
+                                 Executor** executor) {
+  const Status supported = CheckSupported(*graph, *params.device);
+  if (!supported.ok()) {
+    VLOG(1) << "Using the default executor: " << supported;
+    return NewLocalExecutor(params, std::move(graph), executor);
+  }
+  StaticScheduleExecutor* impl =
+      new StaticScheduleExecutor(params, std::move(graph));
+  const Status s = impl->Initialize();
+  if (s.ok()) {
+    *executor = impl;
+    return s;
+  }
+  std::unique_ptr<const Graph> released_graph = impl->ReleaseGraph();
+  delete impl;
+  if (!errors::IsUnimplemented(s)) return s;
+  VLOG(1) << "Using the default executor: " << s;
+  return NewLocalExecutor(params, std::move(released_graph), executor);
+}
+
+namespace {
+
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register(kStaticScheduleExecutorType, new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params,
+                       std::unique_ptr<const Graph> graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(
+          NewStaticScheduleExecutor(params, std::move(graph), &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar registrar;
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// The executor type, for ConfigProto.Experimental.executor_type, under which
+// the static schedule executor is registered with the ExecutorFactory.
+extern const char* const kStaticScheduleExecutorType;
+
+// Creates an Executor that replays a fixed schedule of "graph" instead of
+// tracking pending counts and dispatching nodes as they become ready.
+//
+// The nodes are sorted into levels, where every node of a level only depends
+// on nodes of earlier levels, and the input slots each output is forwarded
+// to are resolved once, here. The first step records the cost of every
+// kernel; subsequent steps partition each level into tasks of roughly equal
+// recorded cost, run the tasks of a level in parallel, and start the next
+// level when all of them are done.
+//
+// Only loop-free graphs of synchronous kernels on CPU devices are supported.
+// For any other graph this returns the executor created by
+// NewLocalExecutor(). Asynchronous kernels, such as the _Recv of a graph
+// partition, are excluded because they may wait for a node of a later level.
+//
+// The memory timeline of Executor::Args is recorded, but the per-step arena
+// of LocalExecutorParams is not used: kernels allocate from the device.
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 std::unique_ptr<const Graph> graph,
+                                 Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_EXECUTOR_H_
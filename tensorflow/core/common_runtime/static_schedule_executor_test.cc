@@ -0,0 +1,390 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_schedule_executor.h"
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+#define ALICE "/job:j/replica:0/task:0/cpu:0"
+#define BOB "/job:j/replica:0/task:0/device:GPU:0"
+
+const uint64 kIncarnation = 1;
+
+Tensor V(const float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+Tensor VB(const bool val) {
+  Tensor tensor(DT_BOOL, TensorShape({}));
+  tensor.scalar<bool>()() = val;
+  return tensor;
+}
+
+float V(const Tensor& tensor) {
+  CHECK_EQ(tensor.dtype(), DT_FLOAT);
+  CHECK(TensorShapeUtils::IsScalar(tensor.shape()));
+  return tensor.scalar<float>()();
+}
+
+Rendezvous::ParsedKey Key(const string& sender, const string& receiver,
+                          const string& name) {
+  Rendezvous::ParsedKey result;
+  CHECK(Rendezvous::ParseKey(Rendezvous::CreateKey(sender, kIncarnation,
+                                                   receiver, name,
+                                                   FrameAndIter(0, 0)),
+                             &result)
+            .ok());
+  return result;
+}
+
+// The inputs and outputs of the graphs run by the static schedule executor
+// go through a call frame, as in a DirectSession: a graph with a _Recv is run
+// by the default executor.
+Node* Arg(Graph* g, int index, DataType type) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_Arg")
+                  .Attr("T", type)
+                  .Attr("index", index)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+Node* Retval(Graph* g, int index, Node* input) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_Retval")
+                  .Input(input, 0)
+                  .Attr("index", index)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+// A call frame with one argument, which is not checked against the type of
+// the _Arg, and one return value.
+class ScalarCallFrame : public CallFrameInterface {
+ public:
+  explicit ScalarCallFrame(const Tensor& arg) : arg_(arg) {}
+
+  size_t num_args() const override { return 1; }
+  size_t num_retvals() const override { return 1; }
+
+  Status GetArg(int index, Tensor* val) const override {
+    if (index != 0) return errors::InvalidArgument("No argument ", index);
+    *val = arg_;
+    return Status::OK();
+  }
+
+  Status SetRetval(int index, const Tensor& val) override {
+    if (index != 0) return errors::InvalidArgument("No retval ", index);
+    retval_ = val;
+    has_retval_ = true;
+    return Status::OK();
+  }
+
+  const Tensor& retval() const { return retval_; }
+  bool has_retval() const { return has_retval_; }
+
+ private:
+  const Tensor arg_;
+  Tensor retval_;
+  bool has_retval_ = false;
+};
+
+class StaticScheduleExecutorTest : public ::testing::Test {
+ protected:
+  StaticScheduleExecutorTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")),
+        step_stats_collector_(&step_stats_) {
+    SessionOptions options;
+    thread_pool_ = ComputePool(options);
+  }
+
+  ~StaticScheduleExecutorTest() override {
+    delete exec_;
+    delete device_;
+  }
+
+  Executor* NewExecutor(std::unique_ptr<const Graph> graph) {
+    const int version = graph->versions().producer();
+    LocalExecutorParams params;
+    params.device = device_;
+    params.create_kernel = [this, version](const NodeDef& ndef,
+                                           OpKernel** kernel) {
+      return CreateNonCachedKernel(device_, nullptr, ndef, version, kernel);
+    };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    Executor* exec = nullptr;
+    TF_CHECK_OK(NewStaticScheduleExecutor(params, std::move(graph), &exec));
+    return exec;
+  }
+
+  void Create(std::unique_ptr<const Graph> graph) {
+    delete exec_;
+    exec_ = NewExecutor(std::move(graph));
+  }
+
+  Status Run(Executor* exec, Rendezvous* rendez, CallFrameInterface* call_frame,
+             bool collect_stats = false) {
+    Executor::Args args;
+    args.rendezvous = rendez;
+    args.call_frame = call_frame;
+    if (collect_stats) {
+      args.stats_collector = &step_stats_collector_;
+    }
+    args.runner = [this](std::function<void()> fn) {
+      thread_pool_->Schedule(fn);
+    };
+    return exec->Run(args);
+  }
+
+  // Runs the graph built by BuildTree, or a graph with the same argument
+  // and return value, with argument "a" and returns the return value.
+  float RunAB(float a) {
+    ScalarCallFrame call_frame(V(a));
+    TF_CHECK_OK(Run(exec_, nullptr, &call_frame));
+    CHECK(call_frame.has_retval());
+    return V(call_frame.retval());
+  }
+
+  thread::ThreadPool* thread_pool_ = nullptr;
+  Device* device_ = nullptr;
+  Executor* exec_ = nullptr;
+  StepStats step_stats_;
+  StepStatsCollector step_stats_collector_;
+};
+
+// Builds a graph which adds N copies of its argument, parenthesized
+// randomly, and returns the sum.
+void BuildTree(int N, Graph* g) {
+  auto in = Arg(g, 0, DT_FLOAT);
+  std::vector<Node*> nodes;
+  for (int i = 0; i < N; ++i) {
+    nodes.push_back(test::graph::Identity(g, in, 0));
+  }
+  random::PhiloxRandom philox(testing::RandomSeed(), 17);
+  random::SimplePhilox rnd(&philox);
+  while (nodes.size() > 1) {
+    int x = rnd.Uniform(nodes.size());
+    auto in0 = nodes[x];
+    nodes[x] = nodes.back();
+    nodes.resize(nodes.size() - 1);
+    x = rnd.Uniform(nodes.size());
+    auto in1 = nodes[x];
+    nodes[x] = test::graph::Add(g, in0, in1);
+  }
+  Retval(g, 0, nodes.back());
+}
+
+TEST_F(StaticScheduleExecutorTest, SelfAdd) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto v = Arg(g.get(), 0, DT_FLOAT);
+  for (int i = 0; i < 10; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  Retval(g.get(), 0, v);
+  Create(std::move(g));
+  // The first step records the schedule, the others replay it.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(1024.0 * i, RunAB(i));
+  }
+}
+
+TEST_F(StaticScheduleExecutorTest, RandomTree) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(1024, g.get());
+  Create(std::move(g));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(1024.0, RunAB(1.0));
+  }
+}
+
+TEST_F(StaticScheduleExecutorTest, ConcurrentSteps) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  BuildTree(256, g.get());
+  Create(std::move(g));
+  const int kNumSteps = 16;
+  std::vector<float> results(kNumSteps);
+  {
+    thread::ThreadPool pool(Env::Default(), "steps", 4);
+    for (int i = 0; i < kNumSteps; ++i) {
+      pool.Schedule([this, i, &results]() { results[i] = RunAB(i); });
+    }
+  }
+  for (int i = 0; i < kNumSteps; ++i) {
+    EXPECT_EQ(256.0 * i, results[i]);
+  }
+}
+
+TEST_F(StaticScheduleExecutorTest, RefInputs) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = Arg(g.get(), 0, DT_FLOAT);
+  auto var = test::graph::Var(g.get(), DT_FLOAT, TensorShape({}));
+  auto init = test::graph::Assign(g.get(), var, in);
+  // The Add dereferences the variable once it is initialized.
+  auto add = test::graph::Add(g.get(), var, var);
+  g->AddControlEdge(init, add);
+  Retval(g.get(), 0, add);
+  Create(std::move(g));
+  EXPECT_EQ(6.0, RunAB(3.0));
+  EXPECT_EQ(8.0, RunAB(4.0));
+}
+
+TEST_F(StaticScheduleExecutorTest, CollectsStats) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = test::graph::Constant(g.get(), V(1.0));
+  auto add = test::graph::Add(g.get(), in, in);
+  test::graph::Send(g.get(), add, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous* rendez = NewLocalRendezvous();
+  TF_ASSERT_OK(Run(exec_, rendez, nullptr, /*collect_stats=*/true));
+  rendez->Unref();
+  step_stats_collector_.Finalize();
+  ASSERT_EQ(1, step_stats_.dev_stats_size());
+  // The Send is a transfer node and is not recorded.
+  EXPECT_EQ(2, step_stats_.dev_stats(0).node_stats_size());
+}
+
+TEST_F(StaticScheduleExecutorTest, ErrorAbortsStep) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in = Arg(g.get(), 0, DT_FLOAT);
+  auto add = test::graph::Add(g.get(), in, in);
+  Retval(g.get(), 0, add);
+  Create(std::move(g));
+  // Pass a bool instead of a float.
+  ScalarCallFrame call_frame(VB(true));
+  EXPECT_TRUE(errors::IsInvalidArgument(Run(exec_, nullptr, &call_frame)));
+  EXPECT_FALSE(call_frame.has_retval());
+  // A failed first step does not prevent the schedule from being recorded.
+  EXPECT_EQ(4.0, RunAB(2.0));
+  EXPECT_EQ(4.0, RunAB(2.0));
+}
+
+TEST_F(StaticScheduleExecutorTest, ControlFlowUsesDefaultExecutor) {
+  std::unique_ptr<Graph> g(new Graph(OpRegistry::Global()));
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous* rendez = NewLocalRendezvous();
+  TF_ASSERT_OK(
+      rendez->Send(Key(ALICE, BOB, "a"), Rendezvous::Args(), V(1.0), false));
+  TF_ASSERT_OK(Run(exec_, rendez, nullptr));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez->Recv(Key(BOB, ALICE, "b"), Rendezvous::Args(), &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+  rendez->Unref();
+}
+
+TEST_F(StaticScheduleExecutorTest, PartitionsWithRecvUseDefaultExecutor) {
+  // Partition "alice" receives "r" at the first level, and only sends "s",
+  // from which partition "bob" computes "r", at the third.
+  std::unique_ptr<Graph> alice(new Graph(OpRegistry::Global()));
+  auto s = test::graph::Constant(alice.get(), V(1.0));
+  for (int i = 0; i < 2; ++i) {
+    s = test::graph::Unary(alice.get(), "Neg", s);
+  }
+  test::graph::Send(alice.get(), s, "s", ALICE, 1, BOB);
+  auto r = test::graph::Recv(alice.get(), "r", "float", BOB, 1, ALICE);
+  auto add = test::graph::Add(alice.get(), r, r);
+  test::graph::Send(alice.get(), add, "b", ALICE, 1, BOB);
+  std::unique_ptr<Executor> alice_exec(NewExecutor(std::move(alice)));
+
+  std::unique_ptr<Graph> bob(new Graph(OpRegistry::Global()));
+  auto in = test::graph::Recv(bob.get(), "s", "float", ALICE, 1, BOB);
+  auto neg = test::graph::Unary(bob.get(), "Neg", in);
+  test::graph::Send(bob.get(), neg, "r", BOB, 1, ALICE);
+  std::unique_ptr<Executor> bob_exec(NewExecutor(std::move(bob)));
+
+  for (int step = 0; step < 2; ++step) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Status alice_status;
+    Status bob_status;
+    {
+      thread::ThreadPool pool(Env::Default(), "partitions", 2);
+      pool.Schedule([&]() {
+        alice_status = Run(alice_exec.get(), rendez, nullptr);
+      });
+      pool.Schedule(
+          [&]() { bob_status = Run(bob_exec.get(), rendez, nullptr); });
+    }
+    TF_ASSERT_OK(alice_status);
+    TF_ASSERT_OK(bob_status);
+    Tensor out = V(0);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, BOB, "b"), Rendezvous::Args(), &out,
+                              &is_dead));
+    EXPECT_EQ(-2.0, V(out));
+    rendez->Unref();
+  }
+}
+
+TEST_F(StaticScheduleExecutorTest, RegisteredWithExecutorFactory) {
+  ExecutorFactory* factory = nullptr;
+  TF_EXPECT_OK(
+      ExecutorFactory::GetFactory(kStaticScheduleExecutorType, &factory));
+}
+
+// Runs a chain of "depth" levels of "width" independent adds with the default
+// executor or the static schedule executor.
+static void BM_SmallGraph(int iters, int use_static_schedule, int width) {
+  Graph* g = new Graph(OpRegistry::Global());
+  auto one = test::graph::Constant(g, V(1.0));
+  std::vector<Node*> nodes(width, one);
+  const int kDepth = 16;
+  for (int d = 0; d < kDepth; ++d) {
+    for (int w = 0; w < width; ++w) {
+      nodes[w] = test::graph::Add(g, nodes[w], one);
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  use_static_schedule ? kStaticScheduleExecutorType : "")
+      .Run(iters);
+  testing::ItemsProcessed(static_cast<int64>(iters) * width * kDepth);
+}
+BENCHMARK(BM_SmallGraph)
+    ->ArgPair(0, 1)
+    ->ArgPair(1, 1)
+    ->ArgPair(0, 8)
+    ->ArgPair(1, 8);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+StepArenaBlockCache::StepArenaBlockCache(Allocator* base, size_t block_size,
+                                         int max_cached_blocks)
+    : base_(base),
+      block_size_(block_size),
+      max_cached_blocks_(max_cached_blocks) {}
+
+StepArenaBlockCache::~StepArenaBlockCache() {
+  for (void* block : free_blocks_) {
+    base_->DeallocateRaw(block);
+  }
+}
+
+void* StepArenaBlockCache::Get() {
+  {
+    mutex_lock l(mu_);
+    if (!free_blocks_.empty()) {
+      void* block = free_blocks_.back();
+      free_blocks_.pop_back();
+      return block;
+    }
+  }
+  return base_->AllocateRaw(Allocator::kAllocatorAlignment, block_size_);
+}
+
+void StepArenaBlockCache::Put(void* block) {
+  {
+    mutex_lock l(mu_);
+    if (free_blocks_.size() < static_cast<size_t>(max_cached_blocks_)) {
+      free_blocks_.push_back(block);
+      return;
+    }
+  }
+  base_->DeallocateRaw(block);
+}
+
+StepArena::StepArena(StepArenaBlockCache* cache, size_t max_allocation_size,
+                     int max_blocks)
+    : cache_(cache),
+      max_allocation_size_(max_allocation_size),
+      max_blocks_(max_blocks),
+      offset_(0) {
+  CHECK_LE(max_allocation_size, cache->block_size());
+  cache_->Ref();
+}
+
+StepArena::~StepArena() {
+  for (char* block : blocks_) {
+    cache_->Put(block);
+  }
+  cache_->Unref();
+}
+
+void* StepArena::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (num_bytes <= max_allocation_size_ && alignment > 0 &&
+      alignment <= Allocator::kAllocatorAlignment) {
+    // Empty allocations still take a byte, so that every pointer returned
+    // lies strictly inside a block.
+    const size_t size = std::max<size_t>(num_bytes, 1);
+    mutex_lock l(mu_);
+    size_t offset = (offset_ + alignment - 1) / alignment * alignment;
+    if (blocks_.empty() || offset + size > cache_->block_size()) {
+      char* block = nullptr;
+      if (blocks_.size() < static_cast<size_t>(max_blocks_)) {
+        block = static_cast<char*>(cache_->Get());
+      }
+      if (block != nullptr) {
+        blocks_.push_back(block);
+        offset = 0;
+      }
+    }
+    if (!blocks_.empty() && offset + size <= cache_->block_size()) {
+      offset_ = offset + size;
+      ++num_arena_allocations_;
+      Ref();
+      return blocks_.back() + offset;
+    }
+  }
+  void* ptr = cache_->base()->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    ++num_base_allocations_;
+    Ref();
+  }
+  return ptr;
+}
+
+void StepArena::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool owned;
+  {
+    mutex_lock l(mu_);
+    owned = Owns(ptr);
+  }
+  if (!owned) {
+    cache_->base()->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+bool StepArena::Owns(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  for (const char* block : blocks_) {
+    if (p >= block && p < block + cache_->block_size()) return true;
+  }
+  return false;
+}
+
+int64 StepArena::num_arena_allocations() const {
+  mutex_lock l(mu_);
+  return num_arena_allocations_;
+}
+
+int64 StepArena::num_base_allocations() const {
+  mutex_lock l(mu_);
+  return num_base_allocations_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of equally sized memory blocks, shared by the StepArenas of one
+// executor so that successive steps reuse memory that is already mapped.
+class StepArenaBlockCache : public core::RefCounted {
+ public:
+  // Blocks are allocated from "base", which must outlive this object, and
+  // at most "max_cached_blocks" free blocks are kept.
+  StepArenaBlockCache(Allocator* base, size_t block_size,
+                      int max_cached_blocks);
+
+  Allocator* base() const { return base_; }
+  size_t block_size() const { return block_size_; }
+
+  // Returns a cached block or a new one, or nullptr if base is out of memory.
+  void* Get();
+  // Returns "block", obtained from Get(), to the cache.
+  void Put(void* block);
+
+ private:
+  ~StepArenaBlockCache() override;
+
+  Allocator* const base_;  // Not owned.
+  const size_t block_size_;
+  const int max_cached_blocks_;
+  mutex mu_;
+  std::vector<void*> free_blocks_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaBlockCache);
+};
+
+// An allocator for the tensors of a single step, which serves small
+// allocations by bumping a pointer through blocks taken from a
+// StepArenaBlockCache. Individual deallocations do not free memory: all
+// blocks go back to the cache at once when the arena is destroyed.
+//
+// Every allocation holds a reference on the arena, and the owner of the step
+// holds one more, which it drops when the step ends. A tensor that outlives
+// the step is therefore always safe to use, but keeps the arena's blocks
+// alive until it is freed, so the arena should only be given to kernels
+// whose outputs are not expected to escape the step.
+//
+// Allocations larger than "max_allocation_size", with an alignment larger
+// than Allocator::kAllocatorAlignment, or that would grow the arena past
+// "max_blocks" blocks, are forwarded to the cache's base allocator.
+class StepArena : public Allocator, public core::RefCounted {
+ public:
+  StepArena(StepArenaBlockCache* cache, size_t max_allocation_size,
+            int max_blocks);
+
+  string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Number of allocations served from the arena and from the base allocator.
+  int64 num_arena_allocations() const;
+  int64 num_base_allocations() const;
+
+ private:
+  ~StepArena() override;
+
+  // Returns true iff "ptr" lies in one of the arena's blocks.
+  bool Owns(const void* ptr) const EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  StepArenaBlockCache* const cache_;  // Holds a reference.
+  const size_t max_allocation_size_;
+  const int max_blocks_;
+
+  mutable mutex mu_;
+  std::vector<char*> blocks_ GUARDED_BY(mu_);
+  // Offset of the first free byte in blocks_.back().
+  size_t offset_ GUARDED_BY(mu_);
+  int64 num_arena_allocations_ GUARDED_BY(mu_) = 0;
+  int64 num_base_allocations_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_H_
@@ -0,0 +1,132 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class StepArenaTest : public ::testing::Test {
+ protected:
+  StepArenaTest()
+      : cache_(new StepArenaBlockCache(cpu_allocator(), 1024,
+                                       /*max_cached_blocks=*/2)) {}
+  ~StepArenaTest() override { cache_->Unref(); }
+
+  StepArenaBlockCache* cache_;
+};
+
+TEST_F(StepArenaTest, BumpAllocatesWithinBlocks) {
+  StepArena* arena =
+      new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/2);
+  char* a = static_cast<char*>(arena->AllocateRaw(64, 100));
+  char* b = static_cast<char*>(arena->AllocateRaw(64, 100));
+  EXPECT_EQ(a + 128, b);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) % 64);
+  arena->DeallocateRaw(a);
+  arena->DeallocateRaw(b);
+  EXPECT_EQ(2, arena->num_arena_allocations());
+  EXPECT_EQ(0, arena->num_base_allocations());
+  arena->Unref();
+}
+
+TEST_F(StepArenaTest, LargeAllocationsGoToBase) {
+  StepArena* arena =
+      new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/1);
+  void* large = arena->AllocateRaw(64, 512);
+  ASSERT_NE(nullptr, large);
+  // The single block fills up after four 256 byte allocations.
+  std::vector<void*> small;
+  for (int i = 0; i < 5; ++i) {
+    small.push_back(arena->AllocateRaw(64, 256));
+    ASSERT_NE(nullptr, small.back());
+  }
+  EXPECT_EQ(4, arena->num_arena_allocations());
+  EXPECT_EQ(2, arena->num_base_allocations());
+  arena->DeallocateRaw(large);
+  for (void* ptr : small) {
+    arena->DeallocateRaw(ptr);
+  }
+  arena->Unref();
+}
+
+TEST_F(StepArenaTest, BlocksAreReusedAcrossSteps) {
+  StepArena* arena =
+      new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/2);
+  void* first = arena->AllocateRaw(64, 16);
+  arena->DeallocateRaw(first);
+  arena->Unref();
+
+  arena = new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/2);
+  void* second = arena->AllocateRaw(64, 16);
+  EXPECT_EQ(first, second);
+  arena->DeallocateRaw(second);
+  arena->Unref();
+}
+
+TEST_F(StepArenaTest, TensorsOutliveTheStep) {
+  StepArena* arena =
+      new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/2);
+  Tensor t(arena, DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&t, {1, 2, 3, 4});
+  // The step ends while t still refers to the arena's memory.
+  arena->Unref();
+  test::ExpectTensorEqual<float>(t, test::AsTensor<float>({1, 2, 3, 4}));
+}
+
+TEST_F(StepArenaTest, StringTensors) {
+  StepArena* arena =
+      new StepArena(cache_, /*max_allocation_size=*/256, /*max_blocks=*/2);
+  {
+    Tensor t(arena, DT_STRING, TensorShape({2}));
+    t.vec<string>()(0) = "a string long enough to be heap allocated";
+    t.vec<string>()(1) = "b";
+  }
+  EXPECT_EQ(1, arena->num_arena_allocations());
+  arena->Unref();
+}
+
+static void BM_Allocation(int iters, int use_arena) {
+  StepArenaBlockCache* cache =
+      new StepArenaBlockCache(cpu_allocator(), 1 << 20, 4);
+  const int kAllocationsPerStep = 100;
+  std::vector<void*> ptrs(kAllocationsPerStep);
+  for (int i = 0; i < iters; ++i) {
+    StepArena* arena = new StepArena(cache, 16 << 10, 4);
+    Allocator* allocator = use_arena ? arena : cpu_allocator();
+    for (int j = 0; j < kAllocationsPerStep; ++j) {
+      ptrs[j] = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                       64 + 8 * j);
+    }
+    for (void* ptr : ptrs) {
+      allocator->DeallocateRaw(ptr);
+    }
+    arena->Unref();
+  }
+  cache->Unref();
+  testing::ItemsProcessed(static_cast<int64>(iters) * kAllocationsPerStep);
+}
+BENCHMARK(BM_Allocation)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,324 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Size classes are 64, 96, 128, 192, 256, 384, ... up to kMaxCachedSize, so
+// that at most a third of a cached block is wasted by rounding.
+constexpr int kNumSizeClasses = 25;
+constexpr size_t kMinClassSize = 64;
+
+// The space in front of every block that holds its header.
+constexpr size_t kHeaderSpace = Allocator::kAllocatorAlignment;
+
+// The number of blocks moved between a shard and the central lists at once
+// is such that a batch holds about this many bytes.
+constexpr size_t kBatchBytes = 64 << 10;
+constexpr int kMaxBatchSize = 32;
+
+// The size class of uncached blocks.
+constexpr int kUncached = -1;
+
+int SizeClass(size_t num_bytes) {
+  if (num_bytes <= kMinClassSize) return 0;
+  const int k = Log2Ceiling64(num_bytes);
+  // num_bytes is in (2^(k-1), 2^k].
+  const int pow2_class = 2 * (k - 6);
+  return num_bytes <= (size_t{3} << (k - 2)) ? pow2_class - 1 : pow2_class;
+}
+
+size_t ClassSize(int size_class) {
+  return size_class % 2 == 0 ? kMinClassSize << (size_class / 2)
+                             : (kMinClassSize * 3 / 2) << (size_class / 2);
+}
+
+int BatchSize(int size_class) {
+  return std::max<int>(
+      1, std::min<size_t>(kMaxBatchSize, kBatchBytes / ClassSize(size_class)));
+}
+
+}  // namespace
+
+struct ThreadCachingAllocator::Header {
+  // The pointer returned by base_.
+  void* base_ptr;
+  size_t requested_size;
+  size_t allocated_size;
+  int size_class;
+};
+
+// Free blocks, as pointers returned by base_, by size class.
+struct ThreadCachingAllocator::FreeLists {
+  std::vector<void*> blocks[kNumSizeClasses];
+  size_t bytes = 0;
+};
+
+struct ThreadCachingAllocator::Shard {
+  mutex mu;
+  FreeLists free GUARDED_BY(mu);
+  int64 num_allocs GUARDED_BY(mu) = 0;
+  // May be negative, when blocks are freed by other threads than the ones
+  // that allocated them.
+  int64 bytes_in_use GUARDED_BY(mu) = 0;
+  // Keeps the shards on separate cache lines.
+  char padding[Allocator::kAllocatorAlignment];
+};
+
+ThreadCachingAllocator::ThreadCachingAllocator(VisitableAllocator* base,
+                                               int num_shards,
+                                               size_t max_shard_bytes)
+    : base_(base),
+      max_shard_bytes_(max_shard_bytes),
+      max_central_bytes_(max_shard_bytes * num_shards),
+      shards_(new Shard[num_shards]),
+      num_shards_(num_shards),
+      central_(new FreeLists) {
+  CHECK_GT(num_shards, 0);
+  CHECK_EQ(SizeClass(kMaxCachedSize), kNumSizeClasses - 1);
+}
+
+ThreadCachingAllocator::~ThreadCachingAllocator() {
+  std::vector<std::pair<int, void*>> blocks;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    TrimLocked(&shards_[i], 0, &blocks);
+  }
+  for (const auto& block : blocks) {
+    base_->DeallocateRaw(block.second);
+  }
+  mutex_lock l(central_mu_);
+  for (int c = 0; c < kNumSizeClasses; ++c) {
+    for (void* block : central_->blocks[c]) {
+      base_->DeallocateRaw(block);
+    }
+  }
+}
+
+ThreadCachingAllocator::Shard* ThreadCachingAllocator::MyShard() {
+  static std::atomic<uint32> next_thread_index(0);
+  thread_local const uint32 thread_index = next_thread_index++;
+  return &shards_[thread_index % num_shards_];
+}
+
+void* ThreadCachingAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (alignment > kAllocatorAlignment || num_bytes > kMaxCachedSize) {
+    return AllocateUncached(alignment, num_bytes);
+  }
+  const int size_class = SizeClass(num_bytes);
+  Shard* shard = MyShard();
+  void* block = nullptr;
+  {
+    mutex_lock l(shard->mu);
+    std::vector<void*>* list = &shard->free.blocks[size_class];
+    if (!list->empty()) {
+      block = list->back();
+      list->pop_back();
+      shard->free.bytes -= ClassSize(size_class);
+    }
+    ++shard->num_allocs;
+    shard->bytes_in_use += ClassSize(size_class);
+  }
+  if (block == nullptr) {
+    block = Refill(shard, size_class);
+    if (block == nullptr) {
+      mutex_lock l(shard->mu);
+      --shard->num_allocs;
+      shard->bytes_in_use -= ClassSize(size_class);
+      return nullptr;
+    }
+  }
+  char* ptr = static_cast<char*>(block) + kHeaderSpace;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->base_ptr = block;
+  header->requested_size = num_bytes;
+  header->allocated_size = ClassSize(size_class);
+  header->size_class = size_class;
+  return ptr;
+}
+
+void* ThreadCachingAllocator::AllocateUncached(size_t alignment,
+                                               size_t num_bytes) {
+  // Keeps the returned pointer aligned to "alignment".
+  const size_t offset = std::max(alignment, kHeaderSpace);
+  void* block = base_->AllocateRaw(alignment, num_bytes + offset);
+  if (block == nullptr) return nullptr;
+  char* ptr = static_cast<char*>(block) + offset;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->base_ptr = block;
+  header->requested_size = num_bytes;
+  header->allocated_size = num_bytes;
+  header->size_class = kUncached;
+  Shard* shard = MyShard();
+  mutex_lock l(shard->mu);
+  ++shard->num_allocs;
+  shard->bytes_in_use += num_bytes;
+  return ptr;
+}
+
+void* ThreadCachingAllocator::Refill(Shard* shard, int size_class) {
+  const int batch_size = BatchSize(size_class);
+  std::vector<void*> batch;
+  {
+    mutex_lock l(central_mu_);
+    std::vector<void*>* list = &central_->blocks[size_class];
+    const int n = std::min<int>(batch_size, list->size());
+    batch.assign(list->end() - n, list->end());
+    list->resize(list->size() - n);
+    central_->bytes -= n * ClassSize(size_class);
+  }
+  if (batch.empty()) {
+    // The central lists are refilled by the shards that free blocks, so a
+    // miss only allocates the block that is needed.
+    return base_->AllocateRaw(kAllocatorAlignment,
+                              ClassSize(size_class) + kHeaderSpace);
+  }
+  void* block = batch.back();
+  batch.pop_back();
+  if (!batch.empty()) {
+    std::vector<std::pair<int, void*>> overflow;
+    {
+      mutex_lock l(shard->mu);
+      std::vector<void*>* list = &shard->free.blocks[size_class];
+      list->insert(list->end(), batch.begin(), batch.end());
+      shard->free.bytes += batch.size() * ClassSize(size_class);
+      if (shard->free.bytes > max_shard_bytes_) {
+        TrimLocked(shard, max_shard_bytes_ / 2, &overflow);
+      }
+    }
+    Flush(overflow);
+  }
+  return block;
+}
+
+void ThreadCachingAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  const Header* header = static_cast<const Header*>(ptr) - 1;
+  const int size_class = header->size_class;
+  Shard* shard = MyShard();
+  if (size_class == kUncached) {
+    {
+      mutex_lock l(shard->mu);
+      shard->bytes_in_use -= header->allocated_size;
+    }
+    base_->DeallocateRaw(header->base_ptr);
+    return;
+  }
+  void* block = header->base_ptr;
+  std::vector<std::pair<int, void*>> overflow;
+  {
+    mutex_lock l(shard->mu);
+    shard->bytes_in_use -= ClassSize(size_class);
+    std::vector<void*>* list = &shard->free.blocks[size_class];
+    list->push_back(block);
+    shard->free.bytes += ClassSize(size_class);
+    if (shard->free.bytes > max_shard_bytes_) {
+      TrimLocked(shard, max_shard_bytes_ / 2, &overflow);
+    } else if (list->size() > 2 * BatchSize(size_class)) {
+      // Hands a batch to the threads that allocate what this one frees.
+      const int n = BatchSize(size_class);
+      for (auto it = list->end() - n; it != list->end(); ++it) {
+        overflow.emplace_back(size_class, *it);
+      }
+      list->resize(list->size() - n);
+      shard->free.bytes -= n * ClassSize(size_class);
+    }
+  }
+  Flush(overflow);
+}
+
+void ThreadCachingAllocator::TrimLocked(
+    Shard* shard, size_t target_bytes,
+    std::vector<std::pair<int, void*>>* blocks) {
+  // Large blocks go first, so that few blocks leave the shard.
+  for (int c = kNumSizeClasses - 1; c >= 0 && shard->free.bytes > target_bytes;
+       --c) {
+    std::vector<void*>* list = &shard->free.blocks[c];
+    while (!list->empty() && shard->free.bytes > target_bytes) {
+      blocks->emplace_back(c, list->back());
+      list->pop_back();
+      shard->free.bytes -= ClassSize(c);
+    }
+  }
+}
+
+void ThreadCachingAllocator::Flush(
+    const std::vector<std::pair<int, void*>>& blocks) {
+  if (blocks.empty()) return;
+  std::vector<void*> released;
+  {
+    mutex_lock l(central_mu_);
+    for (const auto& block : blocks) {
+      const size_t size = ClassSize(block.first);
+      if (central_->bytes + size > max_central_bytes_) {
+        released.push_back(block.second);
+      } else {
+        central_->blocks[block.first].push_back(block.second);
+        central_->bytes += size;
+      }
+    }
+  }
+  for (void* block : released) {
+    base_->DeallocateRaw(block);
+  }
+}
+
+size_t ThreadCachingAllocator::RequestedSize(const void* ptr) {
+  return (static_cast<const Header*>(ptr) - 1)->requested_size;
+}
+
+size_t ThreadCachingAllocator::AllocatedSize(const void* ptr) {
+  return (static_cast<const Header*>(ptr) - 1)->allocated_size;
+}
+
+size_t ThreadCachingAllocator::cached_bytes() {
+  size_t bytes = 0;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    bytes += shards_[i].free.bytes;
+  }
+  mutex_lock l(central_mu_);
+  return bytes + central_->bytes;
+}
+
+void ThreadCachingAllocator::GetStats(AllocatorStats* stats) {
+  base_->GetStats(stats);
+  stats->num_allocs = 0;
+  stats->bytes_in_use = 0;
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    stats->num_allocs += shards_[i].num_allocs;
+    stats->bytes_in_use += shards_[i].bytes_in_use;
+  }
+}
+
+void ThreadCachingAllocator::ClearStats() {
+  base_->ClearStats();
+  for (int i = 0; i < num_shards_; ++i) {
+    mutex_lock l(shards_[i].mu);
+    shards_[i].num_allocs = 0;
+  }
+}
+
+}  // namespace tensorflow
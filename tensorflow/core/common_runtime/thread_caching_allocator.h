@@ -0,0 +1,115 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/visitable_allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A front-end for a shared allocator, such as a BFCAllocator or a
+// PoolAllocator, that serves small allocations from caches of free blocks
+// so that the threads allocating concurrently rarely take the lock of the
+// underlying allocator.
+//
+// Small requests are rounded up to one of a set of size classes. Every
+// thread uses one of "num_shards" shards, each of which keeps a free list
+// per size class under its own lock, which is in practice uncontended.
+// Empty lists are refilled from, and overlong lists are flushed to, central
+// free lists in batches; the central lists, which are bounded as well,
+// allocate from and release to the underlying allocator. Each shard caches
+// at most "max_shard_bytes" bytes.
+//
+// Every block carries a small header in front of the returned pointer, which
+// records its size class and requested size, so that deallocation and the
+// size queries need no lookup in a shared structure.
+//
+// GetStats() returns the underlying allocator's stats, except for the number
+// of allocations and the bytes in use, which count the blocks held by
+// clients of this allocator and not the blocks in its caches.
+class ThreadCachingAllocator : public VisitableAllocator {
+ public:
+  // Takes ownership of "base".
+  ThreadCachingAllocator(VisitableAllocator* base, int num_shards,
+                         size_t max_shard_bytes);
+  ~ThreadCachingAllocator() override;
+
+  string Name() override { return base_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  void AddAllocVisitor(Visitor visitor) override {
+    base_->AddAllocVisitor(visitor);
+  }
+  void AddFreeVisitor(Visitor visitor) override {
+    base_->AddFreeVisitor(visitor);
+  }
+
+  bool TracksAllocationSizes() override { return true; }
+  size_t RequestedSize(const void* ptr) override;
+  size_t AllocatedSize(const void* ptr) override;
+
+  void GetStats(AllocatorStats* stats) override;
+  void ClearStats() override;
+
+  // Requests larger than this are forwarded to the underlying allocator.
+  static constexpr size_t kMaxCachedSize = 256 << 10;
+
+  // Returns the number of bytes held in all caches.
+  size_t cached_bytes();
+
+ private:
+  struct Header;
+  struct FreeLists;
+  struct Shard;
+
+  // Returns the shard of the calling thread.
+  Shard* MyShard();
+
+  // Returns a block of "size_class" from the central lists or from base_.
+  void* Refill(Shard* shard, int size_class);
+  // Moves blocks from "shard" until it caches at most "target_bytes", and
+  // returns them in "blocks" as (size class, block) pairs.
+  void TrimLocked(Shard* shard, size_t target_bytes,
+                  std::vector<std::pair<int, void*>>* blocks);
+  // Moves "blocks" to the central lists or, when those are full, to base_.
+  void Flush(const std::vector<std::pair<int, void*>>& blocks);
+
+  void* AllocateUncached(size_t alignment, size_t num_bytes);
+
+  const std::unique_ptr<VisitableAllocator> base_;
+  const size_t max_shard_bytes_;
+  const size_t max_central_bytes_;
+  std::unique_ptr<Shard[]> shards_;
+  const int num_shards_;
+
+  mutex central_mu_;
+  std::unique_ptr<FreeLists> central_ GUARDED_BY(central_mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ThreadCachingAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
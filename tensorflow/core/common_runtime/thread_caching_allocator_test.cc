@@ -0,0 +1,195 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+VisitableAllocator* NewBFCAllocator() {
+  return new BFCAllocator(new BasicCPUAllocator(port::kNUMANoAffinity),
+                          1LL << 30, true /*allow_growth*/, "bfc");
+}
+
+TEST(ThreadCachingAllocatorTest, SizesAndAlignment) {
+  ThreadCachingAllocator a(NewBFCAllocator(), 4, 1 << 20);
+  EXPECT_TRUE(a.TracksAllocationSizes());
+  void* small = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(100, a.RequestedSize(small));
+  EXPECT_EQ(128, a.AllocatedSize(small));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(small) %
+                   Allocator::kAllocatorAlignment);
+
+  void* aligned = a.AllocateRaw(4096, 100);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(aligned) % 4096);
+  EXPECT_EQ(100, a.RequestedSize(aligned));
+
+  const size_t kLarge = ThreadCachingAllocator::kMaxCachedSize + 1;
+  void* large = a.AllocateRaw(Allocator::kAllocatorAlignment, kLarge);
+  EXPECT_EQ(kLarge, a.RequestedSize(large));
+  EXPECT_EQ(kLarge, a.AllocatedSize(large));
+
+  a.DeallocateRaw(small);
+  a.DeallocateRaw(aligned);
+  a.DeallocateRaw(large);
+  // Only the small block is cached.
+  EXPECT_EQ(128, a.cached_bytes());
+}
+
+TEST(ThreadCachingAllocatorTest, ReusesFreedBlocks) {
+  ThreadCachingAllocator a(NewBFCAllocator(), 1, 1 << 20);
+  void* first = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a.DeallocateRaw(first);
+  // Rounded up to the same size class.
+  void* second = a.AllocateRaw(Allocator::kAllocatorAlignment, 1020);
+  EXPECT_EQ(first, second);
+  a.DeallocateRaw(second);
+}
+
+TEST(ThreadCachingAllocatorTest, CachesAreBounded) {
+  const size_t kMaxShardBytes = 64 << 10;
+  const int kNumShards = 2;
+  ThreadCachingAllocator a(NewBFCAllocator(), kNumShards, kMaxShardBytes);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    ptrs.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment, 1024));
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  EXPECT_LE(a.cached_bytes(), kMaxShardBytes * (kNumShards + 1));
+}
+
+TEST(ThreadCachingAllocatorTest, Stats) {
+  ThreadCachingAllocator a(NewBFCAllocator(), 4, 1 << 20);
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  void* p2 = a.AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(2, stats.num_allocs);
+  EXPECT_EQ(320, stats.bytes_in_use);
+
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  a.GetStats(&stats);
+  EXPECT_EQ(2, stats.num_allocs);
+  EXPECT_EQ(0, stats.bytes_in_use);
+
+  a.ClearStats();
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.num_allocs);
+}
+
+TEST(ThreadCachingAllocatorTest, VisitorsSeeUnderlyingRegions) {
+  ThreadCachingAllocator a(NewBFCAllocator(), 4, 1 << 20);
+  int64 visited_bytes = 0;
+  a.AddAllocVisitor(
+      [&visited_bytes](void* ptr, size_t num_bytes) {
+        visited_bytes += num_bytes;
+      });
+  void* ptr = a.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  EXPECT_GT(visited_bytes, 0);
+  a.DeallocateRaw(ptr);
+}
+
+TEST(ThreadCachingAllocatorTest, ConcurrentAllocations) {
+  ThreadCachingAllocator a(NewBFCAllocator(), 4, 256 << 10);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<char*> live;
+        for (int i = 0; i < 10000; ++i) {
+          const size_t num_bytes = 1 + (i * 7919 + t) % 10000;
+          char* ptr = static_cast<char*>(
+              a.AllocateRaw(Allocator::kAllocatorAlignment, num_bytes));
+          ASSERT_NE(nullptr, ptr);
+          ptr[0] = ptr[num_bytes - 1] = static_cast<char>(t);
+          live.push_back(ptr);
+          if (live.size() > 16) {
+            EXPECT_EQ(static_cast<char>(t), live.front()[0]);
+            a.DeallocateRaw(live.front());
+            live.erase(live.begin());
+          }
+        }
+        for (char* ptr : live) {
+          a.DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(8 * 10000, stats.num_allocs);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+// Allocates and frees small blocks on "num_threads" threads at once.
+static void BM_MultiThreadedAllocation(int iters, int use_cache,
+                                       int num_threads) {
+  testing::StopTiming();
+  std::unique_ptr<VisitableAllocator> allocator(NewBFCAllocator());
+  if (use_cache) {
+    allocator.reset(new ThreadCachingAllocator(allocator.release(),
+                                               num_threads, 1 << 20));
+  }
+  thread::ThreadPool pool(Env::Default(), "bench", num_threads);
+  const int kAllocationsPerBatch = 16;
+  testing::UseRealTime();
+  testing::StartTiming();
+  {
+    BlockingCounter done(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&allocator, &done, iters, num_threads, t]() {
+        void* ptrs[kAllocationsPerBatch];
+        for (int i = t; i < iters; i += num_threads) {
+          for (int j = 0; j < kAllocationsPerBatch; ++j) {
+            ptrs[j] = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                             64 << (j % 8));
+          }
+          for (int j = 0; j < kAllocationsPerBatch; ++j) {
+            allocator->DeallocateRaw(ptrs[j]);
+          }
+        }
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * kAllocationsPerBatch);
+}
+BENCHMARK(BM_MultiThreadedAllocation)
+    ->ArgPair(0, 1)
+    ->ArgPair(1, 1)
+    ->ArgPair(0, 8)
+    ->ArgPair(1, 8)
+    ->ArgPair(0, 32)
+    ->ArgPair(1, 32);
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <vector>
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -28,17 +30,40 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
  public:
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<Device*>* devices) override {
-    // TODO(zhifengc/tucker): Figure out the number of available CPUs
-    // and/or NUMA configuration.
-    int n = 1;
+    const bool use_numa_affinity =
+        options.config.experimental().use_numa_affinity() &&
+        port::NUMAEnabled();
+    if (options.config.experimental().use_numa_affinity() &&
+        !use_numa_affinity) {
+      LOG(WARNING) << "NUMA affinity requested but not supported on this "
+                   << "platform; creating CPU devices without it.";
+    }
+    const int num_numa_nodes = port::NUMANumNodes();
+    int n = use_numa_affinity ? num_numa_nodes : 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
+    if (use_numa_affinity) {
+      ProcessState::singleton()->EnableNUMA();
+    }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
-      devices->push_back(new ThreadPoolDevice(
-          options, name, Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+      if (use_numa_affinity) {
+        // Each device computes on the threads of, and allocates from the
+        // memory of, a single NUMA node.
+        const int numa_node = i % num_numa_nodes;
+        DeviceLocality locality;
+        locality.set_numa_node(numa_node);
+        VLOG(1) << "Assigning " << name << " to NUMA node " << numa_node;
+        devices->push_back(new ThreadPoolDevice(
+            options, name, Bytes(256 << 20), locality,
+            ProcessState::singleton()->GetCPUAllocator(numa_node)));
+      } else {
+        devices->push_back(new ThreadPoolDevice(options, name, Bytes(256 << 20),
+                                                DeviceLocality(),
+                                                cpu_allocator()));
+      }
     }
 
     return Status::OK();
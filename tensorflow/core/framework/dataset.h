@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <deque>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/dataset_stateful_op_whitelist.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -274,6 +276,11 @@ class IteratorContext {
 
     // The Allocator to be used to allocate the output of an iterator.
     std::function<Allocator*(AllocatorAttributes)> allocator_getter = nullptr;
+
+    // The model of the input pipeline, to which the iterators report their
+    // statistics and through which their tunable parameters are set, or
+    // null.
+    std::shared_ptr<model::Model> model = nullptr;
   };
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
@@ -325,6 +332,12 @@ class IteratorContext {
     return params_.stats_aggregator_getter;
   }
 
+  const std::shared_ptr<model::Model>& model() const { return params_.model; }
+
+  void set_model(std::shared_ptr<model::Model> model) {
+    params_.model = std::move(model);
+  }
+
  private:
   Params params_;
 };
@@ -540,7 +553,10 @@ class DatasetBaseIterator : public IteratorBase {
     params_.dataset->Ref();
   }
 
-  ~DatasetBaseIterator() override { params_.dataset->Unref(); }
+  ~DatasetBaseIterator() override {
+    if (node_) model_->RemoveNode(node_);
+    params_.dataset->Unref();
+  }
 
   // The sequence of iterators leading up to this iterator.
   const string& prefix() const { return params_.prefix; }
@@ -556,7 +572,17 @@ class DatasetBaseIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final {
     tracing::ScopedActivity activity(params_.prefix);
+    model::Node* node = model_node(ctx);
+    if (node) node->RecordStart();
     Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    if (node) {
+      int64 element_bytes = -1;
+      if (s.ok() && !*end_of_sequence) {
+        element_bytes = 0;
+        for (const Tensor& t : *out_tensors) element_bytes += t.TotalBytes();
+      }
+      node->RecordStop(element_bytes);
+    }
     if (TF_PREDICT_FALSE(errors::IsOutOfRange(s) && !*end_of_sequence)) {
       s = errors::Internal(
           "Iterator \"", params_.prefix,
@@ -583,8 +609,29 @@ class DatasetBaseIterator : public IteratorBase {
     return strings::StrCat(params_.prefix, ":", name);
   }
 
+  // Returns the node of this iterator in the model of the first context with
+  // a model it was called with, or null if "ctx" has no model. The pipelines
+  // without tunable parameters run without a model, at no cost. An iterator
+  // that registers parameters with the node must remove them in its
+  // destructor.
+  model::Node* model_node(IteratorContext* ctx) {
+    if (!ctx->model()) return nullptr;
+    std::call_once(model_node_once_, [this, ctx]() {
+      model_ = ctx->model();
+      node_ = model_->AddNode(params_.prefix);
+    });
+    return node_.get();
+  }
+
+  // Returns the node of this iterator once model_node(ctx) was called, or null.
+  model::Node* model_node() const { return node_.get(); }
+
  private:
   BaseParams params_;
+
+  std::once_flag model_node_once_;
+  std::shared_ptr<model::Model> model_;
+  std::shared_ptr<model::Node> node_;
 };
 
 // Represents an iterator that is associated with a particular dataset
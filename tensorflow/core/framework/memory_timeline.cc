@@ -0,0 +1,177 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/memory_timeline.h"
+
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+MemoryTimelineCollector::NodeAllocator::NodeAllocator(
+    MemoryTimelineCollector* collector, Allocator* allocator,
+    int32 allocator_index, int32 node_index)
+    : collector_(collector),
+      allocator_(allocator),
+      allocator_index_(allocator_index),
+      node_index_(node_index) {
+  collector_->Ref();
+}
+
+MemoryTimelineCollector::NodeAllocator::~NodeAllocator() {
+  collector_->Unref();
+}
+
+void* MemoryTimelineCollector::NodeAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) return nullptr;
+  Ref();
+  collector_->RecordAllocation(allocator_index_, node_index_, ptr, num_bytes);
+  return ptr;
+}
+
+void MemoryTimelineCollector::NodeAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    allocator_->DeallocateRaw(ptr);
+    return;
+  }
+  // Recorded first, so that the address is not reused before it is
+  // forgotten.
+  collector_->RecordDeallocation(allocator_index_, node_index_, ptr);
+  allocator_->DeallocateRaw(ptr);
+  Unref();
+}
+
+MemoryTimelineCollector::MemoryTimelineCollector(int64 max_events)
+    : max_events_(max_events) {
+  CHECK_GT(max_events, 0);
+}
+
+MemoryTimelineCollector::NodeAllocator* MemoryTimelineCollector::WrapAllocator(
+    Allocator* allocator, const string& node_name) {
+  const string allocator_name = allocator->Name();
+  int32 allocator_index;
+  int32 node_index;
+  {
+    mutex_lock l(mu_);
+    auto allocator_it =
+        allocator_indices_.emplace(allocator_name, allocators_.size()).first;
+    if (allocator_it->second == allocators_.size()) {
+      allocators_.emplace_back();
+      allocators_.back().name = allocator_name;
+    }
+    allocator_index = allocator_it->second;
+    auto node_it = node_indices_.emplace(node_name, node_names_.size()).first;
+    if (node_it->second == node_names_.size()) {
+      node_names_.push_back(node_name);
+    }
+    node_index = node_it->second;
+  }
+  return new NodeAllocator(this, allocator, allocator_index, node_index);
+}
+
+void MemoryTimelineCollector::RecordAllocation(int32 allocator_index,
+                                               int32 node_index,
+                                               const void* ptr,
+                                               int64 num_bytes) {
+  const int64 now = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  const int64 allocation_id = next_allocation_id_++;
+  live_[ptr] = std::make_pair(allocation_id, num_bytes);
+  AllocatorState* state = &allocators_[allocator_index];
+  state->live_bytes += num_bytes;
+  if (state->live_bytes > state->peak_bytes) {
+    state->peak_bytes = state->live_bytes;
+    state->peak_micros = now;
+    state->peak_event = num_events_;
+  }
+  // Empty allocations do not change the live bytes and are not recorded, so
+  // that the sign of "bytes" tells the events apart.
+  if (num_bytes > 0) {
+    AppendLocked({now, num_bytes, allocation_id, allocator_index, node_index});
+  }
+}
+
+void MemoryTimelineCollector::RecordDeallocation(int32 allocator_index,
+                                                 int32 node_index,
+                                                 const void* ptr) {
+  const int64 now = Env::Default()->NowMicros();
+  mutex_lock l(mu_);
+  auto it = live_.find(ptr);
+  CHECK(it != live_.end()) << "Deallocating an unknown pointer " << ptr;
+  const int64 allocation_id = it->second.first;
+  const int64 num_bytes = it->second.second;
+  live_.erase(it);
+  allocators_[allocator_index].live_bytes -= num_bytes;
+  if (num_bytes > 0) {
+    AppendLocked({now, -num_bytes, allocation_id, allocator_index, node_index});
+  }
+}
+
+void MemoryTimelineCollector::AppendLocked(const Event& event) {
+  if (num_events_ < max_events_) {
+    events_.push_back(event);
+  } else {
+    events_[num_events_ % max_events_] = event;
+  }
+  ++num_events_;
+  ++allocators_[event.allocator_index].num_events;
+}
+
+void MemoryTimelineCollector::Export(StepStats* step_stats) {
+  mutex_lock l(mu_);
+  const int64 first_event = std::max<int64>(0, num_events_ - max_events_);
+  for (int32 a = 0; a < allocators_.size(); ++a) {
+    const AllocatorState& state = allocators_[a];
+    MemoryTimeline* timeline = step_stats->add_memory_timelines();
+    timeline->set_allocator_name(state.name);
+    for (const string& node_name : node_names_) {
+      timeline->add_node_names(node_name);
+    }
+    timeline->set_peak_bytes(state.peak_bytes);
+    timeline->set_peak_micros(state.peak_micros);
+    // The allocations that were live at the peak, by allocation id, as
+    // indices into timeline->events().
+    std::map<int64, int> peak_live;
+    for (int64 s = first_event; s < num_events_; ++s) {
+      const Event& event = events_[s % max_events_];
+      if (event.allocator_index != a) continue;
+      if (s <= state.peak_event) {
+        if (event.bytes > 0) {
+          peak_live[event.allocation_id] = timeline->events_size();
+        } else {
+          peak_live.erase(event.allocation_id);
+        }
+      }
+      MemoryTimelineEvent* exported = timeline->add_events();
+      exported->set_time_micros(event.time_micros);
+      exported->set_bytes(event.bytes);
+      exported->set_node(event.node_index);
+      exported->set_allocation_id(event.allocation_id);
+    }
+    timeline->set_num_dropped_events(state.num_events -
+                                     timeline->events_size());
+    for (const auto& live : peak_live) {
+      *timeline->add_peak_live() = timeline->events(live.second);
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,157 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_MEMORY_TIMELINE_H_
+#define TENSORFLOW_CORE_FRAMEWORK_MEMORY_TIMELINE_H_
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// MemoryTimelineCollector records the allocations and deallocations made by
+// the kernels of a step, with the nodes that made them, so that the live
+// memory of every allocator can be followed over the step. It is much
+// cheaper than LogMemory or the TrackingAllocators used for tracing: an
+// event is a small fixed-size record appended to a ring buffer, and nothing
+// is formatted until Export() is called.
+//
+// The ring buffer keeps the "max_events" most recent events. The peak of
+// the live bytes of each allocator is maintained as the events are
+// recorded, so that it is exact even when earlier events are dropped.
+//
+// Allocations may outlive the step: the wrappers returned by
+// WrapAllocator() hold a reference on the collector for as long as any of
+// their allocations is live.
+class MemoryTimelineCollector : public core::RefCounted {
+ public:
+  // Wraps an allocator on behalf of a node. The caller owns a reference,
+  // and every live allocation holds another.
+  class NodeAllocator : public Allocator, public core::RefCounted {
+   public:
+    NodeAllocator(MemoryTimelineCollector* collector, Allocator* allocator,
+                  int32 allocator_index, int32 node_index);
+
+    string Name() override { return allocator_->Name(); }
+    void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+      return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+    }
+    void* AllocateRaw(size_t alignment, size_t num_bytes,
+                      const AllocationAttributes& allocation_attr) override;
+    void DeallocateRaw(void* ptr) override;
+    bool TracksAllocationSizes() override {
+      return allocator_->TracksAllocationSizes();
+    }
+    bool ShouldAllocateEmptyTensors() override {
+      return allocator_->ShouldAllocateEmptyTensors();
+    }
+    size_t RequestedSize(const void* ptr) override {
+      return allocator_->RequestedSize(ptr);
+    }
+    size_t AllocatedSize(const void* ptr) override {
+      return allocator_->AllocatedSize(ptr);
+    }
+    int64 AllocationId(const void* ptr) override {
+      return allocator_->AllocationId(ptr);
+    }
+    size_t AllocatedSizeSlow(const void* ptr) override {
+      return allocator_->AllocatedSizeSlow(ptr);
+    }
+    void GetStats(AllocatorStats* stats) override {
+      allocator_->GetStats(stats);
+    }
+    void ClearStats() override { allocator_->ClearStats(); }
+
+   private:
+    ~NodeAllocator() override;
+
+    MemoryTimelineCollector* const collector_;  // Holds a reference.
+    Allocator* const allocator_;                // Not owned.
+    const int32 allocator_index_;
+    const int32 node_index_;
+
+    TF_DISALLOW_COPY_AND_ASSIGN(NodeAllocator);
+  };
+
+  // REQUIRES: max_events > 0.
+  explicit MemoryTimelineCollector(int64 max_events);
+
+  // Returns an allocator that records the allocations made through
+  // "allocator" as made by the node "node_name". The caller must Unref() it.
+  NodeAllocator* WrapAllocator(Allocator* allocator, const string& node_name);
+
+  // Appends a MemoryTimeline for every allocator that was wrapped to
+  // "step_stats". Events recorded afterwards, such as the deallocations of
+  // the tensors returned by the step, are not exported.
+  void Export(StepStats* step_stats);
+
+ private:
+  struct Event {
+    int64 time_micros;
+    // Negative for deallocations.
+    int64 bytes;
+    int64 allocation_id;
+    int32 allocator_index;
+    int32 node_index;
+  };
+
+  struct AllocatorState {
+    string name;
+    int64 num_events = 0;
+    int64 live_bytes = 0;
+    int64 peak_bytes = 0;
+    int64 peak_micros = 0;
+    // The sequence number of the event that first reached peak_bytes, or -1.
+    int64 peak_event = -1;
+  };
+
+  void RecordAllocation(int32 allocator_index, int32 node_index,
+                        const void* ptr, int64 num_bytes);
+  void RecordDeallocation(int32 allocator_index, int32 node_index,
+                          const void* ptr);
+  void AppendLocked(const Event& event) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 max_events_;
+
+  mutex mu_;
+  // A ring buffer holding the events with the sequence numbers in
+  // [max(0, num_events_ - max_events_), num_events_), the event with
+  // sequence number "s" at index s % max_events_.
+  std::vector<Event> events_ GUARDED_BY(mu_);
+  int64 num_events_ GUARDED_BY(mu_) = 0;
+  int64 next_allocation_id_ GUARDED_BY(mu_) = 0;
+  // The id and size of each live allocation, by address.
+  std::unordered_map<const void*, std::pair<int64, int64>> live_
+      GUARDED_BY(mu_);
+  std::vector<AllocatorState> allocators_ GUARDED_BY(mu_);
+  std::unordered_map<string, int32> allocator_indices_ GUARDED_BY(mu_);
+  std::vector<string> node_names_ GUARDED_BY(mu_);
+  std::unordered_map<string, int32> node_indices_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryTimelineCollector);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_MEMORY_TIMELINE_H_
@@ -0,0 +1,147 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/memory_timeline.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class NoMemoryAllocator : public Allocator {
+ public:
+  string Name() override { return "no_memory"; }
+  void* AllocateRaw(size_t /*alignment*/, size_t num_bytes) override {
+    return nullptr;
+  }
+  void DeallocateRaw(void* ptr) override {}
+};
+
+TEST(MemoryTimelineTest, RecordsEventsAndPeak) {
+  MemoryTimelineCollector* collector = new MemoryTimelineCollector(100);
+  auto* a = collector->WrapAllocator(cpu_allocator(), "a");
+  auto* b = collector->WrapAllocator(cpu_allocator(), "b");
+
+  void* a1 = a->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b1 = b->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  a->DeallocateRaw(a1);
+  void* b2 = b->AllocateRaw(Allocator::kAllocatorAlignment, 50);
+  b->DeallocateRaw(b1);
+  b->DeallocateRaw(b2);
+
+  StepStats step_stats;
+  collector->Export(&step_stats);
+  ASSERT_EQ(1, step_stats.memory_timelines_size());
+  const MemoryTimeline& timeline = step_stats.memory_timelines(0);
+  EXPECT_EQ(cpu_allocator()->Name(), timeline.allocator_name());
+  ASSERT_EQ(2, timeline.node_names_size());
+  EXPECT_EQ("a", timeline.node_names(0));
+  EXPECT_EQ("b", timeline.node_names(1));
+  EXPECT_EQ(0, timeline.num_dropped_events());
+
+  const int64 expected_bytes[] = {100, 200, -100, 50, -200, -50};
+  const int32 expected_nodes[] = {0, 1, 0, 1, 1, 1};
+  ASSERT_EQ(6, timeline.events_size());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(expected_bytes[i], timeline.events(i).bytes());
+    EXPECT_EQ(expected_nodes[i], timeline.events(i).node());
+    EXPECT_GE(timeline.events(i).time_micros(),
+              timeline.events(i > 0 ? i - 1 : 0).time_micros());
+  }
+  // A deallocation has the id of its allocation.
+  EXPECT_EQ(timeline.events(0).allocation_id(),
+            timeline.events(2).allocation_id());
+  EXPECT_EQ(timeline.events(1).allocation_id(),
+            timeline.events(4).allocation_id());
+
+  EXPECT_EQ(300, timeline.peak_bytes());
+  EXPECT_EQ(timeline.events(1).time_micros(), timeline.peak_micros());
+  ASSERT_EQ(2, timeline.peak_live_size());
+  EXPECT_EQ(100, timeline.peak_live(0).bytes());
+  EXPECT_EQ(0, timeline.peak_live(0).node());
+  EXPECT_EQ(200, timeline.peak_live(1).bytes());
+  EXPECT_EQ(1, timeline.peak_live(1).node());
+
+  a->Unref();
+  b->Unref();
+  collector->Unref();
+}
+
+TEST(MemoryTimelineTest, OneTimelinePerAllocator) {
+  MemoryTimelineCollector* collector = new MemoryTimelineCollector(100);
+  NoMemoryAllocator no_memory;
+  auto* a = collector->WrapAllocator(cpu_allocator(), "a");
+  auto* b = collector->WrapAllocator(&no_memory, "a");
+  void* ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 16);
+  EXPECT_EQ(nullptr, b->AllocateRaw(Allocator::kAllocatorAlignment, 16));
+  a->DeallocateRaw(ptr);
+
+  StepStats step_stats;
+  collector->Export(&step_stats);
+  ASSERT_EQ(2, step_stats.memory_timelines_size());
+  EXPECT_EQ(2, step_stats.memory_timelines(0).events_size());
+  EXPECT_EQ("no_memory", step_stats.memory_timelines(1).allocator_name());
+  // Failed allocations are not recorded.
+  EXPECT_EQ(0, step_stats.memory_timelines(1).events_size());
+  EXPECT_EQ(1, step_stats.memory_timelines(1).node_names_size());
+
+  a->Unref();
+  b->Unref();
+  collector->Unref();
+}
+
+TEST(MemoryTimelineTest, KeepsMostRecentEvents) {
+  MemoryTimelineCollector* collector = new MemoryTimelineCollector(4);
+  auto* a = collector->WrapAllocator(cpu_allocator(), "a");
+  void* big = a->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a->DeallocateRaw(big);
+  for (int i = 1; i <= 4; ++i) {
+    a->DeallocateRaw(a->AllocateRaw(Allocator::kAllocatorAlignment, i));
+  }
+
+  StepStats step_stats;
+  collector->Export(&step_stats);
+  const MemoryTimeline& timeline = step_stats.memory_timelines(0);
+  EXPECT_EQ(6, timeline.num_dropped_events());
+  ASSERT_EQ(4, timeline.events_size());
+  EXPECT_EQ(3, timeline.events(0).bytes());
+  EXPECT_EQ(-3, timeline.events(1).bytes());
+  EXPECT_EQ(4, timeline.events(2).bytes());
+  EXPECT_EQ(-4, timeline.events(3).bytes());
+  // The peak is exact, but its events were dropped.
+  EXPECT_EQ(1000, timeline.peak_bytes());
+  EXPECT_EQ(0, timeline.peak_live_size());
+
+  a->Unref();
+  collector->Unref();
+}
+
+TEST(MemoryTimelineTest, AllocationsOutliveTheCollector) {
+  MemoryTimelineCollector* collector = new MemoryTimelineCollector(100);
+  auto* a = collector->WrapAllocator(cpu_allocator(), "a");
+  void* ptr = a->AllocateRaw(Allocator::kAllocatorAlignment, 16);
+  StepStats step_stats;
+  collector->Export(&step_stats);
+  EXPECT_EQ(1, step_stats.memory_timelines(0).events_size());
+  EXPECT_EQ(1, step_stats.memory_timelines(0).peak_live_size());
+  a->Unref();
+  collector->Unref();
+  // The live allocation keeps both alive.
+  a->DeallocateRaw(ptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
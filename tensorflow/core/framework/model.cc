@@ -0,0 +1,453 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/model.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace model {
+
+const char kParallelism[] = "parallelism";
+const char kBufferSize[] = "buffer_size";
+
+namespace {
+
+// Parallelism is only increased while the modeled time per element improves
+// by at least this fraction.
+constexpr double kMinImprovement = 0.01;
+// A buffer is doubled when at least this fraction of at least
+// kMinBufferGets gets since the last optimization found it empty.
+constexpr int64 kMinBufferGets = 10;
+constexpr double kMaxEmptyBufferGets = 0.1;
+constexpr int64 kMaxOptimizationPeriodMicros = 1000 * 1000;
+
+// The nodes of the stages running on this thread, innermost last, with the
+// time at which each last started to run.
+struct ActiveNode {
+  Node* node;
+  int64 start_nanos;
+};
+
+std::vector<ActiveNode>* ActiveNodes() {
+  static thread_local std::vector<ActiveNode> active_nodes;
+  return &active_nodes;
+}
+
+// Returns the name of the stage of the node "name", without the indices of
+// its components: "A::B::C" for "A::B[3]::C". The inputs of a flat_map or an
+// interleave thus share one stage however many of them are created.
+string StageName(const string& name) {
+  string stage;
+  stage.reserve(name.size());
+  size_t begin = 0;
+  while (begin < name.size()) {
+    size_t end = name.find("::", begin);
+    if (end == string::npos) end = name.size();
+    size_t component_end = end;
+    if (component_end > begin && name[component_end - 1] == ']') {
+      const size_t index = name.rfind('[', component_end - 1);
+      if (index != string::npos && index >= begin) component_end = index;
+    }
+    stage.append(name, begin, component_end - begin);
+    if (end < name.size()) stage.append("::");
+    begin = end + 2;
+  }
+  return stage;
+}
+
+// Returns the name of the parent stage of the stage "name": "A::B" for
+// "A::B::C", or "" for a root.
+string ParentName(const string& name) {
+  const size_t pos = name.rfind("::");
+  if (pos == string::npos) return "";
+  return name.substr(0, pos);
+}
+
+}  // namespace
+
+void Node::AddParameter(const string& name, int64 value, int64 min, int64 max,
+                        Setter setter) {
+  {
+    mutex_lock l(mu_);
+    parameters_.push_back({name, value, min, max, std::move(setter)});
+  }
+  if (min < max) model_->StartOptimizationThread();
+}
+
+void Node::RemoveParameters() {
+  mutex_lock l(mu_);
+  parameters_.clear();
+}
+
+void Node::RecordStart() {
+  const int64 now = Env::Default()->NowNanos();
+  std::vector<ActiveNode>* active_nodes = ActiveNodes();
+  if (!active_nodes->empty()) {
+    ActiveNode& consumer = active_nodes->back();
+    if (!consumer.node->async_) {
+      consumer.node->processing_nanos_ += now - consumer.start_nanos;
+    }
+  }
+  active_nodes->push_back({this, now});
+}
+
+void Node::RecordStop(int64 element_bytes) {
+  const int64 now = Env::Default()->NowNanos();
+  std::vector<ActiveNode>* active_nodes = ActiveNodes();
+  DCHECK(!active_nodes->empty() && active_nodes->back().node == this);
+  if (!async_) {
+    processing_nanos_ += now - active_nodes->back().start_nanos;
+  }
+  active_nodes->pop_back();
+  if (!active_nodes->empty()) {
+    active_nodes->back().start_nanos = now;
+  }
+  if (element_bytes >= 0) {
+    ++num_elements_;
+    element_bytes_ += element_bytes;
+  }
+}
+
+struct Model::Stage {
+  bool async = false;
+  Statistics stats;
+  // The parallelism the stage is modeled with, and its range if tunable.
+  int64 parallelism = 1;
+  bool tunable = false;
+  int64 min_parallelism = 1;
+  int64 max_parallelism = 1;
+  std::vector<Stage*> inputs;
+
+  double ElementBytes() const {
+    return stats.num_elements > 0
+               ? static_cast<double>(stats.element_bytes) / stats.num_elements
+               : 0;
+  }
+};
+
+struct Model::Buffer {
+  Node* node;
+  const Stage* stage;
+  int64 value;
+  int64 max;
+  int64 gets;
+  int64 empty_gets;
+};
+
+Model::Model(const Options& options) : options_(options) {}
+
+Model::~Model() {
+  std::unique_ptr<Thread> optimization_thread;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+    optimization_thread = std::move(optimization_thread_);
+  }
+}
+
+std::shared_ptr<Node> Model::AddNode(const string& name) {
+  std::shared_ptr<Node> node(new Node(this, name));
+  mutex_lock l(mu_);
+  const int64 id = next_node_id_++;
+  nodes_[id] = node;
+  node_ids_[node.get()] = id;
+  return node;
+}
+
+void Model::RemoveNode(const std::shared_ptr<Node>& node) {
+  mutex_lock l(mu_);
+  auto it = node_ids_.find(node.get());
+  if (it == node_ids_.end()) return;
+  nodes_.erase(it->second);
+  node_ids_.erase(it);
+  // Keyed by stage, so that the inputs of an interleave, which are removed
+  // as they are exhausted, do not grow the map without bound.
+  Statistics* retired = &retired_[StageName(node->name())];
+  retired->num_elements += node->num_elements_;
+  retired->processing_nanos += node->processing_nanos_;
+  retired->element_bytes += node->element_bytes_;
+}
+
+std::vector<Model::Stage*> Model::CollectStages(
+    std::vector<std::shared_ptr<Node>>* nodes,
+    std::map<string, Stage>* stages, std::vector<Buffer>* buffers) {
+  {
+    mutex_lock l(mu_);
+    for (const auto& node : nodes_) {
+      nodes->push_back(node.second);
+    }
+    for (const auto& retired : retired_) {
+      Statistics* stats = &(*stages)[retired.first].stats;
+      stats->num_elements += retired.second.num_elements;
+      stats->processing_nanos += retired.second.processing_nanos;
+      stats->element_bytes += retired.second.element_bytes;
+    }
+  }
+  for (const auto& node : *nodes) {
+    Stage* stage = &(*stages)[StageName(node->name())];
+    stage->async |= node->async_;
+    stage->stats.num_elements += node->num_elements_;
+    stage->stats.processing_nanos += node->processing_nanos_;
+    stage->stats.element_bytes += node->element_bytes_;
+    mutex_lock l(node->mu_);
+    for (const Node::Parameter& parameter : node->parameters_) {
+      if (parameter.name == kParallelism) {
+        // Nodes of the same stage, such as the inputs of an interleave,
+        // share its parallelism.
+        stage->parallelism = parameter.value;
+        if (parameter.min < parameter.max) {
+          stage->tunable = true;
+          stage->min_parallelism = parameter.min;
+          stage->max_parallelism = parameter.max;
+        }
+      } else if (parameter.name == kBufferSize && buffers != nullptr &&
+                 parameter.min < parameter.max) {
+        const int64 gets = node->num_buffer_gets_;
+        const int64 empty_gets = node->num_empty_buffer_gets_;
+        buffers->push_back({node.get(), stage, parameter.value, parameter.max,
+                            gets - node->last_buffer_gets_,
+                            empty_gets - node->last_empty_buffer_gets_});
+        node->last_buffer_gets_ = gets;
+        node->last_empty_buffer_gets_ = empty_gets;
+      }
+    }
+  }
+  std::vector<Stage*> roots;
+  for (auto& stage : *stages) {
+    string parent = ParentName(stage.first);
+    auto it = stages->end();
+    while (!parent.empty() && (it = stages->find(parent)) == stages->end()) {
+      parent = ParentName(parent);
+    }
+    if (parent.empty()) {
+      roots.push_back(&stage.second);
+    } else {
+      it->second.inputs.push_back(&stage.second);
+    }
+  }
+  return roots;
+}
+
+double Model::StageTime(const Stage& stage) {
+  const double self_time =
+      stage.stats.num_elements > 0
+          ? static_cast<double>(stage.stats.processing_nanos) /
+                stage.stats.num_elements
+          : 0;
+  double input_time = 0;
+  for (const Stage* input : stage.inputs) {
+    if (input->stats.num_elements == 0) continue;
+    const double inputs_per_element =
+        stage.stats.num_elements > 0
+            ? static_cast<double>(input->stats.num_elements) /
+                  stage.stats.num_elements
+            : 1;
+    input_time += inputs_per_element * StageTime(*input);
+  }
+  if (stage.async) {
+    return std::max(self_time / stage.parallelism, input_time);
+  }
+  return self_time + input_time;
+}
+
+double Model::OutputTime() {
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::map<string, Stage> stages;
+  double output_time = 0;
+  for (const Stage* root : CollectStages(&nodes, &stages, nullptr)) {
+    output_time += StageTime(*root);
+  }
+  return output_time;
+}
+
+void Model::Optimize() {
+  mutex_lock optimize_lock(optimize_mu_);
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::map<string, Stage> stages;
+  std::vector<Buffer> buffers;
+  const std::vector<Stage*> roots = CollectStages(&nodes, &stages, &buffers);
+  auto output_time = [&roots]() {
+    double output_time = 0;
+    for (const Stage* root : roots) {
+      output_time += StageTime(*root);
+    }
+    return output_time;
+  };
+
+  int64 ram = 0;
+  for (const Buffer& buffer : buffers) {
+    ram += buffer.value * buffer.stage->ElementBytes();
+  }
+
+  // Grows the parallelism of the tunable stages from their minimum, one step
+  // at a time, for the stage that most reduces the output time. Nothing is
+  // changed before any element was produced.
+  std::map<string, int64> parallelism;
+  double best_time = output_time();
+  if (best_time > 0) {
+    std::vector<Stage*> tunable;
+    int64 cpu = 0;
+    for (auto& stage : stages) {
+      if (!stage.second.tunable) continue;
+      stage.second.parallelism = stage.second.min_parallelism;
+      cpu += stage.second.parallelism;
+      ram += stage.second.parallelism * stage.second.ElementBytes();
+      tunable.push_back(&stage.second);
+    }
+    best_time = output_time();
+    // Returns the output time after growing "steps" by one each, or -1 if
+    // that does not fit the budgets.
+    auto time_after = [&](const std::vector<Stage*>& steps) -> double {
+      double bytes = 0;
+      for (Stage* stage : steps) bytes += stage->ElementBytes();
+      if (cpu + static_cast<int64>(steps.size()) > options_.cpu_budget ||
+          ram + bytes > options_.ram_budget) {
+        return -1;
+      }
+      double time = -1;
+      size_t grown = 0;
+      for (; grown < steps.size(); ++grown) {
+        if (steps[grown]->parallelism >= steps[grown]->max_parallelism) break;
+        ++steps[grown]->parallelism;
+      }
+      if (grown == steps.size()) time = output_time();
+      while (grown > 0) --steps[--grown]->parallelism;
+      return time;
+    };
+    while (true) {
+      // A single step may not help when the output time is bound by two
+      // stages at once, so pairs of steps are tried when none does.
+      std::vector<Stage*> best_steps;
+      double best_steps_time = best_time * (1 - kMinImprovement);
+      for (Stage* stage : tunable) {
+        const double time = time_after({stage});
+        if (time >= 0 && time < best_steps_time) {
+          best_steps = {stage};
+          best_steps_time = time;
+        }
+      }
+      for (size_t i = 0; best_steps.empty() && i < tunable.size(); ++i) {
+        for (size_t j = i; j < tunable.size(); ++j) {
+          const double time = time_after({tunable[i], tunable[j]});
+          if (time >= 0 && time < best_steps_time) {
+            best_steps = {tunable[i], tunable[j]};
+            best_steps_time = time;
+          }
+        }
+      }
+      if (best_steps.empty()) break;
+      for (Stage* stage : best_steps) {
+        ++stage->parallelism;
+        ++cpu;
+        ram += stage->ElementBytes();
+      }
+      best_time = best_steps_time;
+    }
+    for (const auto& stage : stages) {
+      if (stage.second.tunable) {
+        parallelism[stage.first] = stage.second.parallelism;
+      }
+    }
+  }
+
+  // Doubles the buffers that were often found empty.
+  std::map<const Node*, int64> buffer_sizes;
+  for (const Buffer& buffer : buffers) {
+    if (buffer.gets < kMinBufferGets ||
+        buffer.empty_gets < buffer.gets * kMaxEmptyBufferGets) {
+      continue;
+    }
+    const int64 value = buffer.value > buffer.max / 2
+                            ? buffer.max
+                            : std::max<int64>(1, buffer.value * 2);
+    const double bytes = (value - buffer.value) * buffer.stage->ElementBytes();
+    if (value == buffer.value || ram + bytes > options_.ram_budget) continue;
+    ram += bytes;
+    buffer_sizes[buffer.node] = value;
+  }
+
+  // The parameters may have been removed since they were collected, in which
+  // case there is nothing to set.
+  for (const auto& node : nodes) {
+    auto parallelism_it = parallelism.find(StageName(node->name()));
+    auto buffer_size_it = buffer_sizes.find(node.get());
+    if (parallelism_it == parallelism.end() &&
+        buffer_size_it == buffer_sizes.end()) {
+      continue;
+    }
+    mutex_lock l(node->mu_);
+    for (Node::Parameter& parameter : node->parameters_) {
+      if (parameter.min >= parameter.max) continue;
+      int64 value = parameter.value;
+      if (parameter.name == kParallelism &&
+          parallelism_it != parallelism.end()) {
+        value = parallelism_it->second;
+      } else if (parameter.name == kBufferSize &&
+                 buffer_size_it != buffer_sizes.end()) {
+        value = buffer_size_it->second;
+      }
+      value = std::min(std::max(value, parameter.min), parameter.max);
+      if (value != parameter.value) {
+        VLOG(2) << "Setting " << parameter.name << " of " << node->name()
+                << " to " << value;
+        parameter.value = value;
+        parameter.setter(value);
+      }
+    }
+  }
+}
+
+bool Model::tunable() {
+  mutex_lock l(mu_);
+  return tunable_;
+}
+
+void Model::StartOptimizationThread() {
+  mutex_lock l(mu_);
+  tunable_ = true;
+  if (!optimization_thread_ && !cancelled_ &&
+      options_.initial_optimization_period_micros > 0) {
+    optimization_thread_.reset(Env::Default()->StartThread(
+        {}, "tf_data_model", [this]() { OptimizationLoop(); }));
+  }
+}
+
+void Model::OptimizationLoop() {
+  int64 period_micros = options_.initial_optimization_period_micros;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      const int64 deadline_micros = Env::Default()->NowMicros() + period_micros;
+      for (int64 now = Env::Default()->NowMicros();
+           !cancelled_ && now < deadline_micros;
+           now = Env::Default()->NowMicros()) {
+        cond_var_.wait_for(l,
+                           std::chrono::microseconds(deadline_micros - now));
+      }
+      if (cancelled_) return;
+    }
+    Optimize();
+    period_micros =
+        std::min(period_micros * 2, kMaxOptimizationPeriodMicros);
+  }
+}
+
+}  // namespace model
+}  // namespace tensorflow
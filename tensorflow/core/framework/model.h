@@ -0,0 +1,226 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
+#define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace model {
+
+class Model;
+
+// The value of a tunable argument, such as `num_parallel_calls`, that asks
+// for the value to be chosen by the model.
+constexpr int64 kAutoTune = -1;
+
+// The names of the tunable parameters.
+extern const char kParallelism[];
+extern const char kBufferSize[];
+
+// The statistics of one stage of an input pipeline, shared between the
+// iterator of the stage, which reports them, and the `Model` of the pipeline.
+//
+// Every iterator has a node, named after the prefix of the iterator. The
+// nodes form a tree by their names, ignoring the indices of their components:
+// the parent of "A::B::C" or of "A::B[3]::C" is "A::B". Nodes with the same
+// name up to the indices, such as the inputs of an interleave, are treated as
+// one stage.
+//
+// An iterator may register tunable parameters with its node, which the model
+// sets until RemoveParameters() is called.
+class Node {
+ public:
+  // Called with the new value of a parameter, which is within the range it
+  // was registered with.
+  using Setter = std::function<void(int64)>;
+
+  const string& name() const { return name_; }
+
+  // Marks the stage as asynchronous: its output is produced in the
+  // background, so the time its consumers spend in GetNext() is waiting
+  // rather than processing, and is not counted.
+  void set_async(bool async) { async_ = async; }
+  bool async() const { return async_; }
+
+  // Registers a parameter named "name", such as kParallelism, with its
+  // current value. If "min" < "max" the model chooses its value in
+  // [min, max] and calls "setter" with it, in the background; otherwise the
+  // value is fixed but still informs the model.
+  //
+  // Must not be called with a lock held that "setter" acquires.
+  void AddParameter(const string& name, int64 value, int64 min, int64 max,
+                    Setter setter) LOCKS_EXCLUDED(mu_);
+  // Unregisters all parameters, waiting for the setters that are running.
+  // Must be called before the state the setters use is destroyed, without a
+  // lock held that a setter acquires.
+  void RemoveParameters() LOCKS_EXCLUDED(mu_);
+
+  // Bracket the synchronous work of the stage on the calling thread. Time
+  // spent in the nested RecordStart()/RecordStop() of input stages is
+  // charged to those instead. "element_bytes" is the size of the produced
+  // element, or -1 if none was produced.
+  void RecordStart();
+  void RecordStop(int64 element_bytes);
+
+  // Charges work done outside of GetNext(), such as the invocations of the
+  // function of a parallel map, to the stage.
+  void AddProcessingTime(int64 nanos) { processing_nanos_ += nanos; }
+
+  // Records whether a GetNext() call found the output buffer of an
+  // asynchronous stage empty.
+  void RecordBufferGet(bool empty) {
+    ++num_buffer_gets_;
+    if (empty) ++num_empty_buffer_gets_;
+  }
+
+ private:
+  friend class Model;
+
+  struct Parameter {
+    string name;
+    int64 value;
+    int64 min;
+    int64 max;
+    Setter setter;
+  };
+
+  Node(Model* model, const string& name) : model_(model), name_(name) {}
+
+  Model* const model_;  // Not owned.
+  const string name_;
+  std::atomic<bool> async_{false};
+
+  std::atomic<int64> num_elements_{0};
+  std::atomic<int64> processing_nanos_{0};
+  std::atomic<int64> element_bytes_{0};
+  std::atomic<int64> num_buffer_gets_{0};
+  std::atomic<int64> num_empty_buffer_gets_{0};
+
+  mutex mu_;
+  std::vector<Parameter> parameters_ GUARDED_BY(mu_);
+  // The counts of buffer gets at the last optimization.
+  int64 last_buffer_gets_ GUARDED_BY(mu_) = 0;
+  int64 last_empty_buffer_gets_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Node);
+};
+
+// A model of the throughput of an input pipeline, which chooses the values
+// of the tunable parameters of its stages.
+//
+// Every stage is modeled by the time it takes to produce an element: the
+// processing time of an element of the stage itself, plus the time of its
+// inputs, weighted by the number of input elements consumed per element. An
+// asynchronous stage with a parallelism of `p` overlaps its own processing,
+// divided by `p`, with that of its inputs.
+//
+// Parallelism is increased greedily, one step at a time, for the stage that
+// most reduces the time per element of the whole pipeline, for as long as
+// that helps and the total parallelism fits the CPU budget. Buffers are
+// doubled when their consumers often find them empty. Both, counting every
+// parallel invocation as a buffered element, must fit the RAM budget.
+class Model {
+ public:
+  struct Options {
+    // The total parallelism of the tunable stages.
+    int64 cpu_budget = 1;
+    // The memory held by the buffers and invocations of the tunable stages.
+    int64 ram_budget = 1LL << 30;
+    // If positive, Optimize() is called in the background once a tunable
+    // parameter is registered, first after this many microseconds and then at
+    // doubling intervals up to 1 second.
+    int64 initial_optimization_period_micros = 10 * 1000;
+  };
+
+  explicit Model(const Options& options);
+  ~Model();
+
+  // Returns a new node of the given name.
+  std::shared_ptr<Node> AddNode(const string& name) LOCKS_EXCLUDED(mu_);
+  // Removes a node, keeping its statistics for the stage of its name.
+  void RemoveNode(const std::shared_ptr<Node>& node) LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of all stages from their current statistics.
+  void Optimize() LOCKS_EXCLUDED(mu_);
+
+  // Returns the modeled time per element of the pipeline in nanoseconds,
+  // with the current values of the parameters.
+  double OutputTime() LOCKS_EXCLUDED(mu_);
+
+  // Returns true once a node has registered a tunable parameter. A model
+  // that has none need not be attached to the pipeline.
+  bool tunable() LOCKS_EXCLUDED(mu_);
+
+ private:
+  friend class Node;
+
+  struct Stage;
+  struct Statistics {
+    int64 num_elements = 0;
+    int64 processing_nanos = 0;
+    int64 element_bytes = 0;
+  };
+
+  struct Buffer;
+
+  // Collects the stages of the live and the removed nodes, with the current
+  // values of their parameters, and returns the roots. If "buffers" is not
+  // null, also collects the tunable buffers with their gets since the last
+  // call.
+  std::vector<Stage*> CollectStages(
+      std::vector<std::shared_ptr<Node>>* nodes,
+      std::map<string, Stage>* stages, std::vector<Buffer>* buffers)
+      LOCKS_EXCLUDED(mu_);
+  static double StageTime(const Stage& stage);
+
+  void StartOptimizationThread() LOCKS_EXCLUDED(mu_);
+  void OptimizationLoop();
+
+  const Options options_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  int64 next_node_id_ GUARDED_BY(mu_) = 0;
+  // The live nodes, by the order in which they were added.
+  std::map<int64, std::shared_ptr<Node>> nodes_ GUARDED_BY(mu_);
+  std::map<const Node*, int64> node_ids_ GUARDED_BY(mu_);
+  // The statistics of the removed nodes, by stage name.
+  std::map<string, Statistics> retired_ GUARDED_BY(mu_);
+  std::unique_ptr<Thread> optimization_thread_ GUARDED_BY(mu_);
+  bool tunable_ GUARDED_BY(mu_) = false;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+
+  // Serializes Optimize().
+  mutex optimize_mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(Model);
+};
+
+}  // namespace model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
@@ -0,0 +1,252 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/model.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace model {
+namespace {
+
+constexpr int64 kMillis = 1000 * 1000;
+
+Model::Options TestOptions(int64 cpu_budget) {
+  Model::Options options;
+  options.cpu_budget = cpu_budget;
+  // Optimize() is only called by the tests.
+  options.initial_optimization_period_micros = 0;
+  return options;
+}
+
+// Records "num_elements" elements of "element_bytes" each, produced by
+// "node" with "processing_nanos" of work each.
+void Produce(Node* node, int num_elements, int64 processing_nanos,
+             int64 element_bytes = 8) {
+  for (int i = 0; i < num_elements; ++i) {
+    node->RecordStart();
+    node->AddProcessingTime(processing_nanos);
+    node->RecordStop(element_bytes);
+  }
+}
+
+TEST(ModelTest, GrowsParallelismOfTheBottleneck) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->set_async(true);
+  std::vector<int64> values;
+  map->AddParameter(kParallelism, 1, 1, 16,
+                    [&values](int64 value) { values.push_back(value); });
+  std::shared_ptr<Node> range = model.AddNode("Iterator::Map::Range");
+  Produce(map.get(), 10, 10 * kMillis);
+  Produce(range.get(), 10, kMillis / 10);
+
+  const double output_time = model.OutputTime();
+  EXPECT_GE(output_time, 10 * kMillis);
+  model.Optimize();
+  ASSERT_EQ(1, values.size());
+  EXPECT_EQ(4, values[0]);
+  EXPECT_LT(model.OutputTime(), output_time / 3);
+
+  // Nothing changed, so nothing is set.
+  model.Optimize();
+  EXPECT_EQ(1, values.size());
+  map->RemoveParameters();
+}
+
+TEST(ModelTest, DoesNotGrowParallelismOfAnInputBoundStage) {
+  Model model(TestOptions(8));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->set_async(true);
+  int64 parallelism = 3;
+  map->AddParameter(kParallelism, parallelism, 1, 16,
+                    [&parallelism](int64 value) { parallelism = value; });
+  // Nested inputs, such as those of an interleave, are found by name.
+  std::shared_ptr<Node> input = model.AddNode("Iterator::Map::Interleave[0]");
+  Produce(map.get(), 10, 10 * kMillis);
+  Produce(input.get(), 10, 20 * kMillis);
+
+  model.Optimize();
+  EXPECT_EQ(1, parallelism);
+  map->RemoveParameters();
+}
+
+TEST(ModelTest, SharesTheBudgetBetweenStages) {
+  Model model(TestOptions(6));
+  std::shared_ptr<Node> outer = model.AddNode("Iterator::Map");
+  std::shared_ptr<Node> inner = model.AddNode("Iterator::Map::Map");
+  int64 outer_parallelism = 1;
+  int64 inner_parallelism = 1;
+  for (auto* node : {outer.get(), inner.get()}) {
+    node->set_async(true);
+    int64* parallelism =
+        node == outer.get() ? &outer_parallelism : &inner_parallelism;
+    node->AddParameter(kParallelism, 1, 1, 16,
+                       [parallelism](int64 value) { *parallelism = value; });
+  }
+  Produce(outer.get(), 10, 10 * kMillis);
+  Produce(inner.get(), 10, 20 * kMillis);
+
+  model.Optimize();
+  EXPECT_EQ(2, outer_parallelism);
+  EXPECT_EQ(4, inner_parallelism);
+  outer->RemoveParameters();
+  inner->RemoveParameters();
+}
+
+TEST(ModelTest, RespectsTheRamBudget) {
+  Model::Options options = TestOptions(16);
+  options.ram_budget = 2500;
+  Model model(options);
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->set_async(true);
+  int64 parallelism = 1;
+  map->AddParameter(kParallelism, 1, 1, 16,
+                    [&parallelism](int64 value) { parallelism = value; });
+  Produce(map.get(), 10, 10 * kMillis, 1000);
+
+  model.Optimize();
+  EXPECT_EQ(2, parallelism);
+  map->RemoveParameters();
+}
+
+TEST(ModelTest, GrowsBuffersThatAreOftenEmpty) {
+  Model model(TestOptions(1));
+  std::shared_ptr<Node> prefetch = model.AddNode("Iterator::Prefetch");
+  prefetch->set_async(true);
+  int64 buffer_size = 1;
+  prefetch->AddParameter(kBufferSize, 1, 1, 3,
+                         [&buffer_size](int64 value) { buffer_size = value; });
+  Produce(prefetch.get(), 10, 0);
+
+  for (int i = 0; i < 20; ++i) prefetch->RecordBufferGet(i % 2 == 0);
+  model.Optimize();
+  EXPECT_EQ(2, buffer_size);
+
+  // Only the gets since the last optimization count.
+  for (int i = 0; i < 20; ++i) prefetch->RecordBufferGet(false);
+  model.Optimize();
+  EXPECT_EQ(2, buffer_size);
+
+  for (int i = 0; i < 20; ++i) prefetch->RecordBufferGet(true);
+  model.Optimize();
+  EXPECT_EQ(3, buffer_size);
+  prefetch->RemoveParameters();
+}
+
+TEST(ModelTest, IsTunableOnlyWithATunableParameter) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->AddParameter(kParallelism, 2, 2, 2, [](int64 value) {});
+  EXPECT_FALSE(model.tunable());
+  std::shared_ptr<Node> prefetch = model.AddNode("Iterator::Map::Prefetch");
+  prefetch->AddParameter(kBufferSize, 1, 1, 16, [](int64 value) {});
+  EXPECT_TRUE(model.tunable());
+  map->RemoveParameters();
+  prefetch->RemoveParameters();
+}
+
+TEST(ModelTest, RemovedParametersAreNotSet) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->set_async(true);
+  bool called = false;
+  map->AddParameter(kParallelism, 1, 1, 16,
+                    [&called](int64 value) { called = true; });
+  Produce(map.get(), 10, 10 * kMillis);
+  map->RemoveParameters();
+  model.Optimize();
+  EXPECT_FALSE(called);
+}
+
+TEST(ModelTest, RemovedNodesKeepTheirStatistics) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  Produce(map.get(), 10, 10 * kMillis);
+  model.RemoveNode(map);
+  EXPECT_GE(model.OutputTime(), 10 * kMillis);
+}
+
+TEST(ModelTest, RemovedInputsOfAnInterleaveShareAStage) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> interleave = model.AddNode("Iterator::Interleave");
+  Produce(interleave.get(), 100, 0);
+  // Each input produces one element and is removed, as an interleave does.
+  for (int i = 0; i < 100; ++i) {
+    std::shared_ptr<Node> input = model.AddNode(
+        strings::StrCat("Iterator::Interleave[", i, "]::Range"));
+    Produce(input.get(), 1, 10 * kMillis);
+    model.RemoveNode(input);
+  }
+  const double output_time = model.OutputTime();
+  EXPECT_GE(output_time, 10 * kMillis);
+  EXPECT_LT(output_time, 11 * kMillis);
+}
+
+TEST(ModelTest, SetsParallelismOfAnInputOfAnInterleave) {
+  Model model(TestOptions(4));
+  std::shared_ptr<Node> interleave = model.AddNode("Iterator::Interleave");
+  // The stage of the input is named without its index.
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Interleave[1]::Map");
+  map->set_async(true);
+  std::vector<int64> values;
+  map->AddParameter(kParallelism, 1, 1, 16,
+                    [&values](int64 value) { values.push_back(value); });
+  Produce(interleave.get(), 10, kMillis / 10);
+  Produce(map.get(), 10, 10 * kMillis);
+
+  model.Optimize();
+  ASSERT_EQ(1, values.size());
+  EXPECT_GT(values[0], 1);
+  map->RemoveParameters();
+}
+
+TEST(ModelTest, ChargesNestedTimeToTheInput) {
+  Model model(TestOptions(1));
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  std::shared_ptr<Node> range = model.AddNode("Iterator::Map::Range");
+  map->RecordStart();
+  range->RecordStart();
+  range->AddProcessingTime(10 * kMillis);
+  range->RecordStop(8);
+  map->RecordStop(8);
+  // Both take the time of "range"; it is not counted twice.
+  const double output_time = model.OutputTime();
+  EXPECT_GE(output_time, 10 * kMillis);
+  EXPECT_LT(output_time, 15 * kMillis);
+}
+
+TEST(ModelTest, OptimizesInTheBackground) {
+  Model::Options options = TestOptions(4);
+  options.initial_optimization_period_micros = 1000;
+  Model model(options);
+  std::shared_ptr<Node> map = model.AddNode("Iterator::Map");
+  map->set_async(true);
+  Notification set;
+  map->AddParameter(kParallelism, 1, 1, 16, [&set](int64 value) {
+    if (!set.HasBeenNotified()) set.Notify();
+  });
+  Produce(map.get(), 10, 10 * kMillis);
+  set.WaitForNotification();
+  map->RemoveParameters();
+}
+
+}  // namespace
+}  // namespace model
+}  // namespace tensorflow
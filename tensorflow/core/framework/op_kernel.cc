@@ -282,6 +282,9 @@ OpKernelContext::~OpKernelContext() {
     }
   }
   if (params_->record_tensor_accesses) referenced_tensors_.Destroy();
+  for (const auto& wrapped : timeline_allocators_) {
+    wrapped.second->Unref();
+  }
 }
 
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
@@ -293,19 +296,38 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
     allocator = params_->device->GetAllocator(attr);
   }
   if (TF_PREDICT_FALSE(track_allocations())) {
+    allocator = GetTrackingAllocator(allocator);
+  }
+  // The timeline wrapper goes on top of the tracking allocator, so that a
+  // step can both collect per-node stats and record a memory timeline.
+  if (TF_PREDICT_FALSE(params_->memory_timeline != nullptr)) {
     mutex_lock lock(mu_);
-    for (const auto& wrapped : wrapped_allocators_) {
+    for (const auto& wrapped : timeline_allocators_) {
       if (wrapped.first == allocator) {
         return wrapped.second;
       }
     }
-    TrackingAllocator* wrapped_allocator =
-        new TrackingAllocator(allocator, params_->track_allocations);
-    wrapped_allocators_.push_back(std::make_pair(allocator, wrapped_allocator));
+    MemoryTimelineCollector::NodeAllocator* wrapped_allocator =
+        params_->memory_timeline->WrapAllocator(allocator,
+                                                params_->op_kernel->name());
+    timeline_allocators_.push_back(
+        std::make_pair(allocator, wrapped_allocator));
     return wrapped_allocator;
-  } else {
-    return allocator;
   }
+  return allocator;
+}
+
+Allocator* OpKernelContext::GetTrackingAllocator(Allocator* allocator) {
+  mutex_lock lock(mu_);
+  for (const auto& wrapped : wrapped_allocators_) {
+    if (wrapped.first == allocator) {
+      return wrapped.second;
+    }
+  }
+  TrackingAllocator* wrapped_allocator =
+      new TrackingAllocator(allocator, params_->track_allocations);
+  wrapped_allocators_.push_back(std::make_pair(allocator, wrapped_allocator));
+  return wrapped_allocator;
 }
 
 void OpKernelContext::SetStatus(const Status& status) {
@@ -673,8 +695,12 @@ Status OpKernelContext::allocate_output(StringPiece name,
 
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
-    AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+    AllocatorAttributes attr, const AllocationAttributes& allocation_attr,
+    bool step_scoped) {
+  Allocator* a = (step_scoped && params_->step_allocator != nullptr &&
+                  attr.value == 0 && attr.scope_id == 0)
+                     ? params_->step_allocator
+                     : get_allocator(attr);
   AllocationAttributes logged_attr(allocation_attr);
   logged_attr.allocation_will_be_logged = true;
   Tensor new_tensor(a, type, shape, logged_attr);
@@ -703,7 +729,8 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   DCHECK(!IsRefType(type));
   DCHECK(mutable_output(index) == nullptr);
   Tensor* output_tensor = new Tensor();
-  Status s = allocate_tensor(type, shape, output_tensor, attr);
+  Status s = allocate_tensor(type, shape, output_tensor, attr,
+                             /*step_scoped=*/true);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor);
     *output = outputs_[index].tensor;
@@ -715,8 +742,8 @@ Status OpKernelContext::allocate_temp(
     DataType type, const TensorShape& shape, Tensor* out_temp,
     AllocatorAttributes allocator_attr,
     const AllocationAttributes& allocation_attr) {
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Status s = allocate_tensor(type, shape, out_temp, allocator_attr,
+                             allocation_attr, /*step_scoped=*/true);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
@@ -733,7 +760,8 @@ Status OpKernelContext::allocate_persistent(DataType type,
                                             Tensor** out_tensor,
                                             AllocatorAttributes attr) {
   Tensor persistent;
-  Status s = allocate_tensor(type, shape, &persistent, attr);
+  Status s = allocate_tensor(type, shape, &persistent, attr,
+                             /*step_scoped=*/false);
   if (s.ok()) {
     *out_persistent = PersistentTensor(persistent);
     if (out_tensor) {
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/kernel_def.pb.h"
 #include "tensorflow/core/framework/kernel_def_builder.h"
+#include "tensorflow/core/framework/memory_timeline.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"  // TODO(b/62899350): Remove
 #include "tensorflow/core/framework/rendezvous.h"
@@ -525,6 +526,16 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, an allocator for memory that is not expected to outlive
+    // the step, such as the executor's per-step arena. allocate_temp() and
+    // allocate_output() use it for requests with default allocator
+    // attributes; persistent tensors never do.
+    Allocator* step_allocator = nullptr;
+
+    // If not null, records the allocations made through get_allocator() in
+    // a memory timeline of the step, as made by this node.
+    MemoryTimelineCollector* memory_timeline = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -1101,6 +1112,10 @@ class OpKernelContext {
  private:
   Allocator* get_allocator(AllocatorAttributes attr);
 
+  // Returns the TrackingAllocator that wraps "allocator" for this kernel,
+  // creating it on first use.
+  Allocator* GetTrackingAllocator(Allocator* allocator) LOCKS_EXCLUDED(mu_);
+
   // Internal method to add a tensor's buffer to the list of buffers
   // referenced during the execution of the Op, so that GPUs may
   // accurately track the memory that may not be reused until the Op
@@ -1109,16 +1124,19 @@ class OpKernelContext {
   void really_record_tensor_reference(const Tensor& tensor);
 
   // Internal common method used when allocating tensor memory
+  // If "step_scoped" is true, the tensor may be allocated from
+  // params_->step_allocator.
   Status allocate_tensor(DataType type, const TensorShape& shape,
-                         Tensor* out_tensor,
-                         AllocatorAttributes allocator_attr) {
+                         Tensor* out_tensor, AllocatorAttributes allocator_attr,
+                         bool step_scoped) {
     return allocate_tensor(type, shape, out_tensor, allocator_attr,
-                           AllocationAttributes());
+                           AllocationAttributes(), step_scoped);
   }
 
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
-                         const AllocationAttributes& allocation_attr);
+                         const AllocationAttributes& allocation_attr,
+                         bool step_scoped);
 
   // This is called by PersistentTensor::AccessTensor whenever the
   // wrapped tensor is retrieved, to ensure the runtime knows that the
@@ -1133,6 +1151,11 @@ class OpKernelContext {
   Params* params_;                  // not owned
   mutable mutex mu_;  // mutable so const accessors can acquire the lock
   gtl::InlinedVector<WrappedAllocator, 4> wrapped_allocators_ GUARDED_BY(mu_);
+  // The allocators wrapped for <params->memory_timeline>, which hold a
+  // reference on their wrappers.
+  gtl::InlinedVector<
+      std::pair<Allocator*, MemoryTimelineCollector::NodeAllocator*>, 2>
+      timeline_allocators_ GUARDED_BY(mu_);
   gtl::InlinedVector<TensorValue, 4> outputs_;
 
   // Constructed only if <params->record_tensor_accesses>.
@@ -155,15 +155,16 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = ShardForKey(key_hash);
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       return s;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || queue->front()->IsSendValue()) {
       // There is no waiter for this message. Append the message
       // into the queue. The waiter will pick it up when arrives.
@@ -176,14 +177,14 @@ class LocalRendezvousImpl : public Rendezvous {
         item->send_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return Status::OK();
     }
 
     // There is an earliest waiter to consume this message.
     Item* item = queue->front();
     queue->pop_front();
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Notify the waiter by invoking its done closure, outside the
     // lock.
@@ -198,16 +199,17 @@ class LocalRendezvousImpl : public Rendezvous {
     uint64 key_hash = KeyHash(key.FullKey());
     VLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
 
-    mu_.lock();
-    if (!status_.ok()) {
+    Shard* shard = ShardForKey(key_hash);
+    shard->mu.lock();
+    if (!shard->status.ok()) {
       // Rendezvous has been aborted.
-      Status s = status_;
-      mu_.unlock();
+      Status s = shard->status;
+      shard->mu.unlock();
       done(s, Args(), recv_args, Tensor(), false);
       return;
     }
 
-    ItemQueue* queue = &table_[key_hash];
+    ItemQueue* queue = &shard->table[key_hash];
     if (queue->empty() || !queue->front()->IsSendValue()) {
       // There is no message to pick up.
       // Only recv-related fields need to be filled.
@@ -218,7 +220,7 @@ class LocalRendezvousImpl : public Rendezvous {
         item->recv_args.device_context->Ref();
       }
       queue->push_back(item);
-      mu_.unlock();
+      shard->mu.unlock();
       return;
     }
 
@@ -226,7 +228,7 @@ class LocalRendezvousImpl : public Rendezvous {
     // this key.  Consumes the message and invokes the done closure.
     Item* item = queue->front();
     queue->pop_front();
-    mu_.unlock();
+    shard->mu.unlock();
 
     // Invokes the done() by invoking its done closure, outside scope
     // of the table lock.
@@ -237,18 +239,22 @@ class LocalRendezvousImpl : public Rendezvous {
 
   void StartAbort(const Status& status) override {
     CHECK(!status.ok());
-    Table table;
-    {
-      mutex_lock l(mu_);
-      status_.Update(status);
-      table_.swap(table);
-    }
-    for (auto& p : table) {
-      for (Item* item : p.second) {
-        if (!item->IsSendValue()) {
-          item->waiter(status, Args(), Args(), Tensor(), false);
+    // Each shard is aborted in turn. Once the loop is done, every Send and
+    // RecvAsync fails, and every pending waiter has been called exactly once.
+    for (Shard& shard : shards_) {
+      Table table;
+      {
+        mutex_lock l(shard.mu);
+        shard.status.Update(status);
+        shard.table.swap(table);
+      }
+      for (auto& p : table) {
+        for (Item* item : p.second) {
+          if (!item->IsSendValue()) {
+            item->waiter(status, Args(), Args(), Tensor(), false);
+          }
+          delete item;
         }
-        delete item;
       }
     }
   }
@@ -290,13 +296,34 @@ class LocalRendezvousImpl : public Rendezvous {
   typedef std::deque<Item*> ItemQueue;
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ GUARDED_BY(mu_);
-  Status status_ GUARDED_BY(mu_);
+  // The keys are spread over shards with separate locks, so that the
+  // Sends and Recvs of different edges rarely contend.
+  static constexpr int kNumShardsLog2 = 4;
+  static constexpr int kNumShards = 1 << kNumShardsLog2;
+
+  struct Shard {
+    mutex mu;
+    Table table GUARDED_BY(mu);
+    // Every shard records the abort status, so that Send and RecvAsync only
+    // take the lock of their key's shard.
+    Status status GUARDED_BY(mu);
+  };
+
+  // The shard is picked by the high bits of the hash, as the table within
+  // the shard uses the low bits.
+  Shard* ShardForKey(uint64 key_hash) {
+    return &shards_[key_hash >> (64 - kNumShardsLog2)];
+  }
+
+  Shard shards_[kNumShards];
 
   ~LocalRendezvousImpl() override {
-    if (!table_.empty()) {
+    bool empty = true;
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      empty = empty && shard.table.empty();
+    }
+    if (!empty) {
       StartAbort(errors::Cancelled("LocalRendezvousImpl deleted"));
     }
   }
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -262,6 +264,34 @@ TEST_F(LocalRendezvousTest, RecvSleepAbort) {
   EXPECT_TRUE(errors::IsAborted(status));
 }
 
+TEST_F(LocalRendezvousTest, AbortManyKeys) {
+  // Enough keys to have pending waiters in every shard.
+  const int kNumKeys = 256;
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  mutex mu;
+  int num_aborted = 0;
+  for (const auto& key : keys) {
+    rendez_->RecvAsync(
+        key, Rendezvous::Args(),
+        [&mu, &num_aborted](const Status& s, const Rendezvous::Args& send_args,
+                            const Rendezvous::Args& recv_args, const Tensor& v,
+                            const bool is_dead) {
+          EXPECT_TRUE(errors::IsAborted(s));
+          mutex_lock l(mu);
+          ++num_aborted;
+        });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  EXPECT_EQ(kNumKeys, num_aborted);
+  for (const auto& key : keys) {
+    EXPECT_TRUE(errors::IsAborted(
+        rendez_->Send(key, Rendezvous::Args(), V("hello"), false)));
+  }
+}
+
 TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
   rendez_->StartAbort(errors::Aborted(""));
   Tensor val(DT_STRING);
@@ -358,5 +388,39 @@ void BM_PingPong(int iters) {
 }
 BENCHMARK(BM_PingPong);
 
+// "num_threads" threads each send and receive values on their own edges.
+void BM_ConcurrentSendRecv(int iters, int num_threads) {
+  testing::StopTiming();
+  const int kEdgesPerThread = 16;
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads * kEdgesPerThread; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("edge", i)));
+  }
+  Rendezvous* rendez = NewLocalRendezvous();
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int t = 0; t < num_threads; ++t) {
+    pool->Schedule([rendez, &keys, iters, num_threads, t]() {
+      Tensor orig = V("val");
+      Tensor val(DT_STRING, TensorShape({}));
+      bool is_dead = false;
+      Rendezvous::Args args;
+      for (int i = t; i < iters; i += num_threads) {
+        const Rendezvous::ParsedKey& key =
+            keys[t * kEdgesPerThread + i % kEdgesPerThread];
+        TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+        TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+      }
+    });
+  }
+  // Waits for the threads to finish.
+  delete pool;
+  testing::StopTiming();
+  rendez->Unref();
+}
+BENCHMARK(BM_ConcurrentSendRecv)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
 }  // namespace
 }  // namespace tensorflow
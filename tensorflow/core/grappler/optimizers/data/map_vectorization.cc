@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorization_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -37,11 +38,20 @@ void CopyAttribute(const string& attr_name, const NodeDef& from, NodeDef* to) {
   (*to->mutable_attr())[attr_name] = from.attr().at(attr_name);
 }
 
+std::vector<PartialTensorShape> GetOutputShapes(const NodeDef& node) {
+  std::vector<PartialTensorShape> shapes;
+  for (const TensorShapeProto& shape :
+       node.attr().at("output_shapes").list().shape()) {
+    shapes.emplace_back(shape);
+  }
+  return shapes;
+}
+
 FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
+                                   const NodeDef& input_node,
                                    const FunctionDef& orig_func,
+                                   const FunctionLibraryDefinition& flib,
                                    FunctionDefLibrary* library) {
-  // If we decide to use a different method of vectorization, we can just
-  // swap out this part.
   FunctionDef* vectorized_func = library->add_function();
   // Function inputs and outputs are the same as original, just
   // with different shapes.
@@ -49,7 +59,19 @@ FunctionDef* AddVectorizedFunction(const NodeDef& map_node,
   graph_utils::SetUniqueGraphFunctionName("vectorized_function", library,
                                           vectorized_func);
 
-  // Add MapDefun node
+  // Vectorize the nodes of the function that have a vectorizer, and call the
+  // rest once per element with MapDefun.
+  Status s = vectorization_utils::VectorizeFunction(
+      orig_func, GetOutputShapes(input_node), GetOutputShapes(map_node), flib,
+      library, vectorized_func);
+  if (s.ok()) {
+    return vectorized_func;
+  }
+  VLOG(1) << "Calling all of " << orig_func.signature().name()
+          << " once per element: " << s;
+
+  // Otherwise, add a MapDefun node that calls the whole function once per
+  // element.
   NodeDef* map_defun_node = vectorized_func->mutable_node_def()->Add();
   map_defun_node->set_op("MapDefun");
   graph_utils::SetUniqueFunctionNodeName(map_defun_node->op(), vectorized_func,
@@ -227,8 +249,8 @@ Status MapVectorization::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
-    FunctionDef* vectorized_func =
-        AddVectorizedFunction(*map_node, *orig_func, library);
+    FunctionDef* vectorized_func = AddVectorizedFunction(
+        *map_node, *input_node, *orig_func, function_library, library);
     CHECK_NOTNULL(vectorized_func);
 
     auto* new_batch_node = graph.AddNode(
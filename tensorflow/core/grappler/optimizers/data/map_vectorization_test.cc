@@ -162,6 +162,42 @@ TEST(MapVectorizationTest, VectorizeMapWithBatchV2) {
   EXPECT_EQ(batch_node.input(0), "range");
 }
 
+TEST(MapVectorizationTest, VectorizeFunctionNodes) {
+  FunctionDef cast = FunctionDefHelper::Create(
+      "CastToFloat", {"x: int64"}, {"y: float"}, {},
+      {{{"cast"}, "Cast", {"x"}, {{"SrcT", DT_INT64}, {"DstT", DT_FLOAT}}}},
+      {{"y", "cast:y:0"}});
+  GrapplerItem item;
+  item.graph = GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("batch_size", "Const", {}, {{"value", 2}, {"dtype", DT_INT64}}),
+       MakeRangeNode("range", {"start", "stop", "step"}),
+       MakeMapNode("map", "range", "CastToFloat", {{}}, {DT_FLOAT}),
+       MakeBatchNode("batch", "map", "batch_size", {{-1}}, {DT_FLOAT})},
+      // FunctionLib
+      {cast});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const FunctionDef* vectorized_func = nullptr;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() == map_node.attr().at("f").func().name()) {
+      vectorized_func = &func;
+    }
+  }
+  ASSERT_NE(vectorized_func, nullptr);
+  // The cast is applied to the whole batch, without calling a function per
+  // element.
+  ASSERT_EQ(vectorized_func->node_def_size(), 1);
+  EXPECT_EQ(vectorized_func->node_def(0).op(), "Cast");
+  EXPECT_EQ(vectorized_func->node_def(0).input(0), "x");
+}
+
 TEST(MapVectorizationTest, VectorizeWithUndefinedOutputShape) {
   GrapplerItem item;
   item.graph = GDef(
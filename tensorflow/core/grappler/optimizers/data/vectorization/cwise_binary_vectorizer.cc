@@ -0,0 +1,119 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+// Vectorizes a binary op that broadcasts its inputs, such as `Add` or `Less`.
+//
+// Broadcasting aligns the trailing dimensions of the inputs, so an unstacked
+// input still broadcasts against the stacked ones as long as its rank is at
+// most theirs. A stacked input of a lower rank than the other input gets
+// dimensions of size 1 inserted after its leading batch dimension, so that
+// the rest of its dimensions line up as they did for a single element.
+class CwiseBinaryVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const NodeDef& node,
+                   gtl::ArraySlice<VectorizedTensor> inputs,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes,
+                   FunctionDef* outer_scope,
+                   std::vector<string>* outputs) override {
+    if (inputs.size() != 2) {
+      return errors::InvalidArgument("Expected 2 inputs to ", node.op(),
+                                     ", got ", inputs.size());
+    }
+    int rank = 0;
+    for (const VectorizedTensor& input : inputs) {
+      if (input.shape.unknown_rank()) {
+        return errors::Unimplemented("Cannot vectorize ", node.op(),
+                                     " with an input of unknown rank.");
+      }
+      rank = std::max(rank, input.shape.dims());
+    }
+    // `LogicalAnd` and `LogicalOr` have no type attr.
+    DataType dtype = DT_BOOL;
+    if (HasNodeAttr(node, "T")) {
+      TF_RETURN_IF_ERROR(GetNodeAttr(node, "T", &dtype));
+    }
+    std::vector<string> input_names;
+    for (const VectorizedTensor& input : inputs) {
+      string name = input.name;
+      if (input.stacked) {
+        for (int i = input.shape.dims(); i < rank; ++i) {
+          name = ExpandDims(name, dtype, outer_scope);
+        }
+      }
+      input_names.push_back(name);
+    }
+    return AddCopy(node, input_names, outer_scope, outputs);
+  }
+
+ private:
+  // Inserts a dimension of size 1 after the leading dimension of `input`.
+  static string ExpandDims(const string& input, DataType dtype,
+                           FunctionDef* scope) {
+    Tensor dim(DT_INT32, TensorShape({}));
+    dim.scalar<int32>()() = 1;
+    const string dim_name = AddConstant(dim, scope);
+    NodeDef* node = AddNode("ExpandDims", scope);
+    node->add_input(input);
+    node->add_input(dim_name);
+    auto* attr = node->mutable_attr();
+    (*attr)["T"].set_type(dtype);
+    (*attr)["Tdim"].set_type(DT_INT32);
+    return strings::StrCat(node->name(), ":output:0");
+  }
+};
+
+REGISTER_VECTORIZER("Add", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("AddV2", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Atan2", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("BitwiseAnd", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("BitwiseOr", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("BitwiseXor", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Div", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Equal", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("FloorDiv", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("FloorMod", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Greater", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("GreaterEqual", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Less", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("LessEqual", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("LogicalAnd", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("LogicalOr", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Maximum", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Minimum", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Mod", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Mul", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("NotEqual", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Pow", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("RealDiv", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("SquaredDifference", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("Sub", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("TruncateDiv", CwiseBinaryVectorizer);
+REGISTER_VECTORIZER("TruncateMod", CwiseBinaryVectorizer);
+
+}  // namespace
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
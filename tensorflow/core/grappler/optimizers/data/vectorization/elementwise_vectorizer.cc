@@ -0,0 +1,148 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+// Vectorizes an op that computes each value of its output from the value at
+// the same position of its first input, such as `Sqrt`, `Cast` or
+// `StringToNumber`. Any other inputs are parameters, such as the pattern of
+// `RegexReplace`, which must be the same for all elements; the op then
+// computes the outputs of all elements at once from the stacked first input.
+class ElementwiseVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const NodeDef& node,
+                   gtl::ArraySlice<VectorizedTensor> inputs,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes,
+                   FunctionDef* outer_scope,
+                   std::vector<string>* outputs) override {
+    if (inputs.empty() || !inputs[0].stacked) {
+      return errors::Unimplemented("Cannot vectorize ", node.op(),
+                                   " without a stacked first input.");
+    }
+    std::vector<string> input_names;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (i > 0 && inputs[i].stacked) {
+        return errors::Unimplemented("Cannot vectorize ", node.op(),
+                                     " with parameters that differ between "
+                                     "elements.");
+      }
+      input_names.push_back(inputs[i].name);
+    }
+    return AddCopy(node, input_names, outer_scope, outputs);
+  }
+};
+
+// `DecodeRaw` also appends a dimension of the length of its input strings,
+// which only lines up across a batch if the strings of all elements are
+// equally long. That is only known when its output shape is, e.g. because it
+// is reshaped to a fixed shape; otherwise it is called once per element.
+class DecodeRawVectorizer : public ElementwiseVectorizer {
+ public:
+  Status Vectorize(const NodeDef& node,
+                   gtl::ArraySlice<VectorizedTensor> inputs,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes,
+                   FunctionDef* outer_scope,
+                   std::vector<string>* outputs) override {
+    if (output_shapes.empty() || !output_shapes[0].IsFullyDefined()) {
+      return errors::Unimplemented(
+          "Cannot vectorize DecodeRaw of strings whose lengths may differ "
+          "between elements.");
+    }
+    return ElementwiseVectorizer::Vectorize(node, inputs, output_shapes,
+                                            outer_scope, outputs);
+  }
+};
+
+// Math.
+REGISTER_VECTORIZER("Abs", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Acos", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Acosh", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Angle", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Asin", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Asinh", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Atan", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Atanh", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Ceil", ElementwiseVectorizer);
+REGISTER_VECTORIZER("ComplexAbs", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Conj", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Cos", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Cosh", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Digamma", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Elu", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Erf", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Erfc", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Exp", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Expm1", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Floor", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Imag", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Invert", ElementwiseVectorizer);
+REGISTER_VECTORIZER("IsFinite", ElementwiseVectorizer);
+REGISTER_VECTORIZER("IsInf", ElementwiseVectorizer);
+REGISTER_VECTORIZER("IsNan", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Lgamma", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Log", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Log1p", ElementwiseVectorizer);
+REGISTER_VECTORIZER("LogicalNot", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Neg", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Real", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Reciprocal", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Relu", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Relu6", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Rint", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Round", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Rsqrt", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Selu", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Sigmoid", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Sign", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Sin", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Sinh", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Softplus", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Softsign", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Sqrt", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Square", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Tan", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Tanh", ElementwiseVectorizer);
+
+// Identity and casts.
+REGISTER_VECTORIZER("Cast", ElementwiseVectorizer);
+REGISTER_VECTORIZER("Identity", ElementwiseVectorizer);
+
+// Strings.
+REGISTER_VECTORIZER("AsString", ElementwiseVectorizer);
+REGISTER_VECTORIZER("DecodeBase64", ElementwiseVectorizer);
+REGISTER_VECTORIZER("DecodeCompressed", ElementwiseVectorizer);
+REGISTER_VECTORIZER("DecodeRaw", DecodeRawVectorizer);
+REGISTER_VECTORIZER("EncodeBase64", ElementwiseVectorizer);
+REGISTER_VECTORIZER("RegexFullMatch", ElementwiseVectorizer);
+REGISTER_VECTORIZER("RegexReplace", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StaticRegexReplace", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringLength", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringStrip", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringToHashBucket", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketFast", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringToHashBucketStrong", ElementwiseVectorizer);
+REGISTER_VECTORIZER("StringToNumber", ElementwiseVectorizer);
+
+}  // namespace
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,103 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+// Vectorizes `ParseSingleExample` as `ParseExample` of the batch of serialized
+// examples, which parses them all in one pass.
+//
+// Only dense features of fully defined shapes are supported: `ParseExample`
+// returns sparse features as one `SparseTensor` of the whole batch, whose
+// parts are not the stacked parts of the `SparseTensor` of each example.
+class ParseSingleExampleVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const NodeDef& node,
+                   gtl::ArraySlice<VectorizedTensor> inputs,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes,
+                   FunctionDef* outer_scope,
+                   std::vector<string>* outputs) override {
+    int64 num_sparse;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "num_sparse", &num_sparse));
+    if (num_sparse > 0) {
+      return errors::Unimplemented(
+          "Cannot vectorize ParseSingleExample with sparse features.");
+    }
+    std::vector<string> dense_keys;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "dense_keys", &dense_keys));
+    DataTypeVector dense_types;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "Tdense", &dense_types));
+    std::vector<PartialTensorShape> dense_shapes;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "dense_shapes", &dense_shapes));
+    for (const PartialTensorShape& shape : dense_shapes) {
+      if (!shape.IsFullyDefined()) {
+        return errors::Unimplemented(
+            "Cannot vectorize ParseSingleExample of variable-length dense "
+            "features.");
+      }
+    }
+    if (inputs.size() != 1 + dense_keys.size()) {
+      return errors::InvalidArgument("Expected ", 1 + dense_keys.size(),
+                                     " inputs to ParseSingleExample, got ",
+                                     inputs.size());
+    }
+    if (!inputs[0].stacked) {
+      return errors::Unimplemented(
+          "Cannot vectorize ParseSingleExample without stacked examples.");
+    }
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      if (inputs[i].stacked) {
+        return errors::Unimplemented(
+            "Cannot vectorize ParseSingleExample with defaults that differ "
+            "between elements.");
+      }
+    }
+
+    NodeDef* parse = AddNode("ParseExample", outer_scope);
+    parse->add_input(inputs[0].name);
+    // names
+    parse->add_input(
+        AddConstant(Tensor(DT_STRING, TensorShape({0})), outer_scope));
+    for (const string& key : dense_keys) {
+      Tensor key_tensor(DT_STRING, TensorShape({}));
+      key_tensor.scalar<string>()() = key;
+      parse->add_input(AddConstant(key_tensor, outer_scope));
+    }
+    for (size_t i = 1; i < inputs.size(); ++i) {
+      parse->add_input(inputs[i].name);
+    }
+    AddNodeAttr("Nsparse", 0, parse);
+    AddNodeAttr("Ndense", static_cast<int64>(dense_keys.size()), parse);
+    AddNodeAttr("sparse_types", DataTypeVector(), parse);
+    AddNodeAttr("Tdense", dense_types, parse);
+    AddNodeAttr("dense_shapes", dense_shapes, parse);
+    // With no sparse features, the outputs of both ops are the dense values.
+    return GetOutputNames(*parse, outputs);
+  }
+};
+
+REGISTER_VECTORIZER("ParseSingleExample", ParseSingleExampleVectorizer);
+
+}  // namespace
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+// Vectorizes `Reshape` of a stacked tensor to a shape that is the same for all
+// elements, by reshaping the batch to that shape prefixed with the batch size.
+class ReshapeVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const NodeDef& node,
+                   gtl::ArraySlice<VectorizedTensor> inputs,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes,
+                   FunctionDef* outer_scope,
+                   std::vector<string>* outputs) override {
+    if (inputs.size() != 2) {
+      return errors::InvalidArgument("Expected 2 inputs to Reshape, got ",
+                                     inputs.size());
+    }
+    if (!inputs[0].stacked || inputs[1].stacked) {
+      return errors::Unimplemented(
+          "Cannot vectorize Reshape to shapes that differ between elements.");
+    }
+    DataType dtype;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "T", &dtype));
+    DataType shape_dtype;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "Tshape", &shape_dtype));
+
+    // batch_size = Shape(tensor)[0:1]
+    NodeDef* shape = AddNode("Shape", outer_scope);
+    shape->add_input(inputs[0].name);
+    (*shape->mutable_attr())["T"].set_type(dtype);
+    (*shape->mutable_attr())["out_type"].set_type(shape_dtype);
+
+    NodeDef* batch_size = AddNode("Slice", outer_scope);
+    batch_size->add_input(strings::StrCat(shape->name(), ":output:0"));
+    batch_size->add_input(AddConstant(VectorOf(0), outer_scope));
+    batch_size->add_input(AddConstant(VectorOf(1), outer_scope));
+    (*batch_size->mutable_attr())["T"].set_type(shape_dtype);
+    (*batch_size->mutable_attr())["Index"].set_type(DT_INT32);
+
+    // batch_shape = Concat([batch_size, shape], axis=0)
+    Tensor axis(DT_INT32, TensorShape({}));
+    axis.scalar<int32>()() = 0;
+    NodeDef* batch_shape = AddNode("ConcatV2", outer_scope);
+    batch_shape->add_input(strings::StrCat(batch_size->name(), ":output:0"));
+    batch_shape->add_input(inputs[1].name);
+    batch_shape->add_input(AddConstant(axis, outer_scope));
+    (*batch_shape->mutable_attr())["N"].set_i(2);
+    (*batch_shape->mutable_attr())["T"].set_type(shape_dtype);
+    (*batch_shape->mutable_attr())["Tidx"].set_type(DT_INT32);
+
+    return AddCopy(node,
+                   {inputs[0].name,
+                    strings::StrCat(batch_shape->name(), ":output:0")},
+                   outer_scope, outputs);
+  }
+
+ private:
+  static Tensor VectorOf(int32 value) {
+    Tensor t(DT_INT32, TensorShape({1}));
+    t.vec<int32>()(0) = value;
+    return t;
+  }
+};
+
+REGISTER_VECTORIZER("Reshape", ReshapeVectorizer);
+
+}  // namespace
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,574 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorization_utils.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+// Where a node of the original function ends up.
+enum class Placement {
+  // The node does not depend on the arguments, so it is copied as is.
+  kInvariant,
+  // The node is vectorized, and the body does not depend on it.
+  kBefore,
+  // The node is called once per element, in the body of the `MapDefun` node.
+  kBody,
+  // The node is vectorized, and depends on the body.
+  kAfter,
+};
+
+class FunctionVectorizer {
+ public:
+  FunctionVectorizer(const FunctionDef& func,
+                     gtl::ArraySlice<PartialTensorShape> arg_shapes,
+                     gtl::ArraySlice<PartialTensorShape> output_shapes)
+      : func_(func), arg_shapes_(arg_shapes), output_shapes_(output_shapes) {}
+
+  Status Initialize(const FunctionLibraryDefinition& flib);
+
+  Status Vectorize(FunctionDefLibrary* library, FunctionDef* vectorized_func);
+
+ private:
+  // Returns the index of the node that produces `tensor`, or -1 if it is an
+  // argument.
+  int Producer(const string& tensor) const;
+
+  Status InferShapes(const FunctionLibraryDefinition& flib);
+  Status SortNodes();
+
+  // Places the nodes in the body that are, or are between, unsupported nodes.
+  std::vector<Placement> Partition(const std::vector<bool>& unsupported) const;
+
+  // Converts the function with the given placement. If a node cannot be
+  // vectorized, stores its index in `failed_node`.
+  Status Convert(const std::vector<Placement>& placement, FunctionDef* result,
+                 FunctionDef* body, int* failed_node);
+  Status VectorizeNode(int index, FunctionDef* result);
+  Status AddMapDefun(const std::vector<Placement>& placement,
+                     FunctionDef* result, FunctionDef* body, int* failed_node);
+
+  const FunctionDef& func_;
+  const gtl::ArraySlice<PartialTensorShape> arg_shapes_;
+  const gtl::ArraySlice<PartialTensorShape> output_shapes_;
+
+  std::unordered_map<string, int> node_indices_;
+  // The names of the outputs of each node.
+  std::vector<std::vector<string>> outputs_;
+  // The shapes and types of the tensors of the function, for one element.
+  std::unordered_map<string, PartialTensorShape> shapes_;
+  std::unordered_map<string, DataType> types_;
+  // The nodes in topological order, and the consumers of each node.
+  std::vector<int> order_;
+  std::vector<std::vector<int>> consumers_;
+  std::vector<bool> invariant_;
+
+  // The tensors of the converted function, by the original tensors.
+  std::unordered_map<string, VectorizedTensor> converted_;
+};
+
+Status FunctionVectorizer::Initialize(const FunctionLibraryDefinition& flib) {
+  const OpDef& signature = func_.signature();
+  if (arg_shapes_.size() != signature.input_arg_size() ||
+      output_shapes_.size() != signature.output_arg_size()) {
+    return errors::InvalidArgument(
+        "Expected shapes of ", signature.input_arg_size(), " arguments and ",
+        signature.output_arg_size(), " outputs of ", signature.name());
+  }
+  for (int i = 0; i < func_.node_def_size(); ++i) {
+    node_indices_[func_.node_def(i).name()] = i;
+  }
+  auto check_tensor = [this](const string& tensor) -> Status {
+    if (tensor[0] == '^') {
+      return errors::Unimplemented("Cannot vectorize control dependencies.");
+    }
+    const size_t colon = tensor.find(':');
+    if (colon == string::npos) {
+      for (const OpDef::ArgDef& arg : func_.signature().input_arg()) {
+        if (arg.name() == tensor) return Status::OK();
+      }
+    } else if (node_indices_.count(tensor.substr(0, colon)) > 0) {
+      return Status::OK();
+    }
+    return errors::InvalidArgument("Unknown tensor ", tensor);
+  };
+  for (const NodeDef& node : func_.node_def()) {
+    for (const string& input : node.input()) {
+      TF_RETURN_IF_ERROR(check_tensor(input));
+    }
+  }
+  for (const OpDef::ArgDef& output_arg : signature.output_arg()) {
+    auto it = func_.ret().find(output_arg.name());
+    if (it == func_.ret().end()) {
+      return errors::InvalidArgument("Missing output ", output_arg.name());
+    }
+    TF_RETURN_IF_ERROR(check_tensor(it->second));
+  }
+
+  outputs_.resize(func_.node_def_size());
+  for (int i = 0; i < func_.node_def_size(); ++i) {
+    TF_RETURN_IF_ERROR(GetOutputNames(func_.node_def(i), &outputs_[i]));
+  }
+  TF_RETURN_IF_ERROR(InferShapes(flib));
+  TF_RETURN_IF_ERROR(SortNodes());
+
+  invariant_.assign(func_.node_def_size(), false);
+  for (int i : order_) {
+    bool invariant = true;
+    for (const string& input : func_.node_def(i).input()) {
+      const int producer = Producer(input);
+      invariant = invariant && producer >= 0 && invariant_[producer];
+    }
+    invariant_[i] = invariant;
+  }
+  return Status::OK();
+}
+
+int FunctionVectorizer::Producer(const string& tensor) const {
+  const size_t colon = tensor.find(':');
+  if (colon == string::npos) return -1;
+  return node_indices_.at(tensor.substr(0, colon));
+}
+
+Status FunctionVectorizer::InferShapes(const FunctionLibraryDefinition& flib) {
+  for (int i = 0; i < func_.signature().input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = func_.signature().input_arg(i);
+    shapes_[arg.name()] = arg_shapes_[i];
+    types_[arg.name()] = arg.type();
+  }
+
+  // Instantiate the function, to run shape inference on its graph.
+  InstantiationResult result;
+  TF_RETURN_IF_ERROR(InstantiateFunction(
+      func_, AttrSlice(),
+      [&flib](const string& op, const OpDef** sig) {
+        return flib.LookUpOpDef(op, sig);
+      },
+      &result));
+  Graph graph(flib);
+  GraphConstructorOptions options;
+  options.allow_internal_ops = true;
+  TF_RETURN_IF_ERROR(ConvertNodeDefsToGraph(options, result.nodes, &graph));
+
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::unordered_map<string, const Node*> graph_nodes;
+  for (Node* node : order) {
+    TF_RETURN_IF_ERROR(refiner.AddNode(node));
+    if (node->type_string() == "_Arg") {
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(node->attrs(), "index", &index));
+      if (index < 0 || index >= arg_shapes_.size()) {
+        return errors::Internal("Invalid argument index ", index);
+      }
+      shape_inference::InferenceContext* c = refiner.GetContext(node);
+      shape_inference::ShapeHandle shape;
+      TF_RETURN_IF_ERROR(
+          c->MakeShapeFromPartialTensorShape(arg_shapes_[index], &shape));
+      TF_RETURN_IF_ERROR(refiner.SetShape(node, 0, shape));
+    }
+    graph_nodes[node->name()] = node;
+  }
+
+  for (int i = 0; i < func_.node_def_size(); ++i) {
+    auto it = graph_nodes.find(func_.node_def(i).name());
+    if (it == graph_nodes.end() ||
+        it->second->num_outputs() != outputs_[i].size()) {
+      return errors::Internal("Could not infer the shapes of ",
+                              func_.node_def(i).name());
+    }
+    shape_inference::InferenceContext* c = refiner.GetContext(it->second);
+    for (int j = 0; j < outputs_[i].size(); ++j) {
+      TensorShapeProto shape;
+      c->ShapeHandleToProto(c->output(j), &shape);
+      shapes_[outputs_[i][j]] = PartialTensorShape(shape);
+      types_[outputs_[i][j]] = it->second->output_type(j);
+    }
+  }
+
+  // A `Reshape` to a shape that is the same for all elements also fixes the
+  // number of values of its input, and so the one dimension of the input that
+  // shape inference could not tell, such as the length of a `DecodeRaw`.
+  for (int i = 0; i < func_.node_def_size(); ++i) {
+    const NodeDef& node = func_.node_def(i);
+    TensorShape output_shape;
+    if (node.op() != "Reshape" || node.input_size() < 1 ||
+        !shapes_.at(outputs_[i][0]).AsTensorShape(&output_shape)) {
+      continue;
+    }
+    PartialTensorShape* input_shape = &shapes_.at(node.input(0));
+    if (input_shape->unknown_rank()) continue;
+    int unknown_dim = -1;
+    int num_unknown_dims = 0;
+    int64 known_elements = 1;
+    for (int d = 0; d < input_shape->dims(); ++d) {
+      if (input_shape->dim_size(d) < 0) {
+        unknown_dim = d;
+        ++num_unknown_dims;
+      } else {
+        known_elements *= input_shape->dim_size(d);
+      }
+    }
+    if (num_unknown_dims != 1 || known_elements == 0 ||
+        output_shape.num_elements() % known_elements != 0) {
+      continue;
+    }
+    auto dims = input_shape->dim_sizes();
+    dims[unknown_dim] = output_shape.num_elements() / known_elements;
+    *input_shape = PartialTensorShape(dims);
+  }
+  return Status::OK();
+}
+
+Status FunctionVectorizer::SortNodes() {
+  const int num_nodes = func_.node_def_size();
+  consumers_.assign(num_nodes, {});
+  std::vector<int> num_pending(num_nodes, 0);
+  std::deque<int> ready;
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : func_.node_def(i).input()) {
+      const int producer = Producer(input);
+      if (producer >= 0) {
+        consumers_[producer].push_back(i);
+        ++num_pending[i];
+      }
+    }
+    if (num_pending[i] == 0) ready.push_back(i);
+  }
+  while (!ready.empty()) {
+    const int i = ready.front();
+    ready.pop_front();
+    order_.push_back(i);
+    for (int consumer : consumers_[i]) {
+      if (--num_pending[consumer] == 0) ready.push_back(consumer);
+    }
+  }
+  if (order_.size() != num_nodes) {
+    return errors::InvalidArgument("The function ", func_.signature().name(),
+                                   " has a cycle.");
+  }
+  return Status::OK();
+}
+
+std::vector<Placement> FunctionVectorizer::Partition(
+    const std::vector<bool>& unsupported) const {
+  const int num_nodes = func_.node_def_size();
+  // Whether each node depends on, or feeds, an unsupported node.
+  std::vector<bool> depends(num_nodes, false);
+  std::vector<bool> feeds(num_nodes, false);
+  for (int i : order_) {
+    depends[i] = unsupported[i];
+    for (const string& input : func_.node_def(i).input()) {
+      const int producer = Producer(input);
+      if (producer >= 0 && depends[producer]) depends[i] = true;
+    }
+  }
+  for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+    feeds[*it] = unsupported[*it];
+    for (int consumer : consumers_[*it]) {
+      if (feeds[consumer]) feeds[*it] = true;
+    }
+  }
+  std::vector<Placement> placement(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    if (invariant_[i]) {
+      placement[i] = Placement::kInvariant;
+    } else if (depends[i] && feeds[i]) {
+      placement[i] = Placement::kBody;
+    } else if (depends[i]) {
+      placement[i] = Placement::kAfter;
+    } else {
+      placement[i] = Placement::kBefore;
+    }
+  }
+  return placement;
+}
+
+Status FunctionVectorizer::Vectorize(FunctionDefLibrary* library,
+                                     FunctionDef* vectorized_func) {
+  FunctionDef body_template;
+  graph_utils::SetUniqueGraphFunctionName("map_defun_fn", library,
+                                          &body_template);
+
+  std::vector<bool> unsupported(func_.node_def_size(), false);
+  for (int i = 0; i < func_.node_def_size(); ++i) {
+    unsupported[i] =
+        !invariant_[i] &&
+        VectorizerRegistry::Global()->Get(func_.node_def(i).op()) == nullptr;
+  }
+  // Every failure to vectorize a node moves it to the body, so this ends.
+  while (true) {
+    const std::vector<Placement> placement = Partition(unsupported);
+    FunctionDef result;
+    *result.mutable_signature() = vectorized_func->signature();
+    FunctionDef body = body_template;
+    int failed_node = -1;
+    Status s = Convert(placement, &result, &body, &failed_node);
+    if (failed_node >= 0) {
+      VLOG(2) << "Calling " << func_.node_def(failed_node).name()
+              << " once per element: " << s;
+      unsupported[failed_node] = true;
+      continue;
+    }
+    TF_RETURN_IF_ERROR(s);
+    if (std::find(placement.begin(), placement.end(), Placement::kBefore) ==
+            placement.end() &&
+        std::find(placement.begin(), placement.end(), Placement::kAfter) ==
+            placement.end()) {
+      return errors::Unimplemented("None of the nodes of ",
+                                   func_.signature().name(),
+                                   " can be vectorized.");
+    }
+    if (body.node_def_size() > 0) {
+      *library->add_function() = std::move(body);
+    }
+    *vectorized_func->mutable_node_def() = result.node_def();
+    *vectorized_func->mutable_ret() = result.ret();
+    return Status::OK();
+  }
+}
+
+Status FunctionVectorizer::Convert(const std::vector<Placement>& placement,
+                                   FunctionDef* result, FunctionDef* body,
+                                   int* failed_node) {
+  converted_.clear();
+  for (int i = 0; i < func_.signature().input_arg_size(); ++i) {
+    const string& arg = func_.signature().input_arg(i).name();
+    converted_[arg] = {arg, true, arg_shapes_[i]};
+  }
+  for (int i : order_) {
+    if (placement[i] == Placement::kInvariant) {
+      *result->add_node_def() = func_.node_def(i);
+      for (const string& output : outputs_[i]) {
+        converted_[output] = {output, false, shapes_.at(output)};
+      }
+    }
+  }
+  for (int i : order_) {
+    if (placement[i] == Placement::kBefore) {
+      Status s = VectorizeNode(i, result);
+      if (!s.ok()) {
+        *failed_node = i;
+        return s;
+      }
+    }
+  }
+  TF_RETURN_IF_ERROR(AddMapDefun(placement, result, body, failed_node));
+  for (int i : order_) {
+    if (placement[i] == Placement::kAfter) {
+      Status s = VectorizeNode(i, result);
+      if (!s.ok()) {
+        *failed_node = i;
+        return s;
+      }
+    }
+  }
+
+  for (const OpDef::ArgDef& output_arg : func_.signature().output_arg()) {
+    const VectorizedTensor& output =
+        converted_.at(func_.ret().at(output_arg.name()));
+    if (!output.stacked) {
+      return errors::Unimplemented(
+          "Cannot vectorize an output that is the same for all elements.");
+    }
+    (*result->mutable_ret())[output_arg.name()] = output.name;
+  }
+  return Status::OK();
+}
+
+Status FunctionVectorizer::VectorizeNode(int index, FunctionDef* result) {
+  const NodeDef& node = func_.node_def(index);
+  std::vector<VectorizedTensor> inputs;
+  for (const string& input : node.input()) {
+    inputs.push_back(converted_.at(input));
+  }
+  std::vector<PartialTensorShape> output_shapes;
+  for (const string& output : outputs_[index]) {
+    output_shapes.push_back(shapes_.at(output));
+  }
+  std::vector<string> outputs;
+  TF_RETURN_IF_ERROR(VectorizerRegistry::Global()->Get(node.op())->Vectorize(
+      node, inputs, output_shapes, result, &outputs));
+  if (outputs.size() != outputs_[index].size()) {
+    return errors::Internal("Vectorizing ", node.name(), " produced ",
+                            outputs.size(), " outputs instead of ",
+                            outputs_[index].size());
+  }
+  for (int i = 0; i < outputs.size(); ++i) {
+    const string& output = outputs_[index][i];
+    converted_[output] = {outputs[i], true, shapes_.at(output)};
+  }
+  return Status::OK();
+}
+
+Status FunctionVectorizer::AddMapDefun(const std::vector<Placement>& placement,
+                                       FunctionDef* result, FunctionDef* body,
+                                       int* failed_node) {
+  // The arguments of the body are the stacked tensors it uses from outside,
+  // which `MapDefun` slices. It gets its own copy of invariant tensors.
+  std::unordered_map<string, string> arg_names;
+  std::vector<string> arguments;
+  DataTypeVector argument_types;
+  std::vector<bool> copied(func_.node_def_size(), false);
+  std::function<void(int)> copy_invariant = [&](int i) {
+    if (copied[i]) return;
+    copied[i] = true;
+    for (const string& input : func_.node_def(i).input()) {
+      copy_invariant(Producer(input));
+    }
+    *body->add_node_def() = func_.node_def(i);
+  };
+  for (int i : order_) {
+    if (placement[i] != Placement::kBody) continue;
+    NodeDef* node = body->add_node_def();
+    *node = func_.node_def(i);
+    for (int j = 0; j < node->input_size(); ++j) {
+      const string input = node->input(j);
+      const int producer = Producer(input);
+      if (producer >= 0 && placement[producer] == Placement::kBody) continue;
+      if (producer >= 0 && placement[producer] == Placement::kInvariant) {
+        copy_invariant(producer);
+        continue;
+      }
+      auto it = arg_names.find(input);
+      if (it == arg_names.end()) {
+        string name = strings::StrCat("arg_", arg_names.size());
+        while (node_indices_.count(name) > 0) name += "_";
+        OpDef::ArgDef* arg = body->mutable_signature()->add_input_arg();
+        arg->set_name(name);
+        arg->set_type(types_.at(input));
+        arguments.push_back(converted_.at(input).name);
+        argument_types.push_back(types_.at(input));
+        it = arg_names.emplace(input, name).first;
+      }
+      node->set_input(j, it->second);
+    }
+  }
+
+  // The outputs of the body are the tensors used after it.
+  std::unordered_map<string, PartialTensorShape> ret_shapes;
+  for (int i = 0; i < func_.signature().output_arg_size(); ++i) {
+    ret_shapes[func_.ret().at(func_.signature().output_arg(i).name())] =
+        output_shapes_[i];
+  }
+  std::vector<string> exported;
+  std::unordered_map<string, int> consumers;
+  auto maybe_export = [&](const string& tensor, int consumer) {
+    const int producer = Producer(tensor);
+    if (producer < 0 || placement[producer] != Placement::kBody ||
+        consumers.count(tensor) > 0) {
+      return;
+    }
+    exported.push_back(tensor);
+    consumers[tensor] = consumer;
+  };
+  for (int i : order_) {
+    if (placement[i] != Placement::kAfter) continue;
+    for (const string& input : func_.node_def(i).input()) {
+      maybe_export(input, i);
+    }
+  }
+  for (const auto& ret : ret_shapes) {
+    maybe_export(ret.first, -1);
+  }
+  if (exported.empty()) {
+    body->Clear();
+    return Status::OK();
+  }
+  if (arguments.empty()) {
+    return errors::Unimplemented("Cannot call a function without arguments "
+                                 "once per element.");
+  }
+
+  DataTypeVector output_types;
+  std::vector<PartialTensorShape> output_shapes;
+  for (int i = 0; i < exported.size(); ++i) {
+    const string& tensor = exported[i];
+    auto it = ret_shapes.find(tensor);
+    const PartialTensorShape& shape =
+        it != ret_shapes.end() ? it->second : shapes_.at(tensor);
+    if (!shape.IsFullyDefined()) {
+      // `MapDefun` can only stack outputs of the same shape for all elements,
+      // so the consumer of the tensor moves to the body.
+      *failed_node = consumers.at(tensor);
+      return errors::Unimplemented("The shape of ", tensor,
+                                   " is not fully defined.");
+    }
+    const string name = strings::StrCat("output_", i);
+    OpDef::ArgDef* output_arg = body->mutable_signature()->add_output_arg();
+    output_arg->set_name(name);
+    output_arg->set_type(types_.at(tensor));
+    (*body->mutable_ret())[name] = tensor;
+    output_types.push_back(types_.at(tensor));
+    output_shapes.push_back(shape);
+  }
+
+  NodeDef* map_defun = AddNode("MapDefun", result);
+  for (const string& argument : arguments) {
+    map_defun->add_input(argument);
+  }
+  NameAttrList f;
+  f.set_name(body->signature().name());
+  AddNodeAttr("f", f, map_defun);
+  AddNodeAttr("Targuments", argument_types, map_defun);
+  AddNodeAttr("output_types", output_types, map_defun);
+  AddNodeAttr("output_shapes", output_shapes, map_defun);
+  for (int i = 0; i < exported.size(); ++i) {
+    converted_[exported[i]] = {
+        strings::StrCat(map_defun->name(), ":output:", i), true,
+        output_shapes[i]};
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status VectorizeFunction(const FunctionDef& func,
+                         gtl::ArraySlice<PartialTensorShape> arg_shapes,
+                         gtl::ArraySlice<PartialTensorShape> output_shapes,
+                         const FunctionLibraryDefinition& flib,
+                         FunctionDefLibrary* library,
+                         FunctionDef* vectorized_func) {
+  FunctionVectorizer vectorizer(func, arg_shapes, output_shapes);
+  TF_RETURN_IF_ERROR(vectorizer.Initialize(flib));
+  return vectorizer.Vectorize(library, vectorized_func);
+}
+
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
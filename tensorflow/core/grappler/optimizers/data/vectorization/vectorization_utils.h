@@ -0,0 +1,55 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZATION_UTILS_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZATION_UTILS_H_
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+
+// Converts `func`, which computes one element of a dataset, into
+// `vectorized_func`, which computes a batch of elements from their inputs
+// stacked along a new leading dimension.
+//
+// Nodes with a registered `Vectorizer` are converted to nodes that compute
+// the whole batch at once. The nodes that cannot be converted, and the nodes
+// that both depend on them and feed them, are moved to a new function in
+// `library`, which a `MapDefun` node of `vectorized_func` calls once per
+// element. `arg_shapes` are the shapes of the arguments of `func` and
+// `output_shapes` the fully defined shapes of its outputs, for one element.
+// `vectorized_func` must have the signature of `func` and no nodes.
+//
+// Returns an error, leaving `library` and `vectorized_func` unchanged, if
+// `func` cannot be converted or none of its nodes can be vectorized.
+Status VectorizeFunction(const FunctionDef& func,
+                         gtl::ArraySlice<PartialTensorShape> arg_shapes,
+                         gtl::ArraySlice<PartialTensorShape> output_shapes,
+                         const FunctionLibraryDefinition& flib,
+                         FunctionDefLibrary* library,
+                         FunctionDef* vectorized_func);
+
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZATION_UTILS_H_
@@ -0,0 +1,265 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorization_utils.h"
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+namespace {
+
+using FDH = FunctionDefHelper;
+
+class VectorizeFunctionTest : public ::testing::Test {
+ protected:
+  // Vectorizes `func` as the map vectorization optimizer does, into
+  // `vectorized_func_`.
+  Status Vectorize(const FunctionDef& func,
+                   gtl::ArraySlice<PartialTensorShape> arg_shapes,
+                   gtl::ArraySlice<PartialTensorShape> output_shapes) {
+    *library_.add_function() = func;
+    FunctionLibraryDefinition flib(OpRegistry::Global(), library_);
+    vectorized_func_ = library_.add_function();
+    *vectorized_func_->mutable_signature() = func.signature();
+    vectorized_func_->mutable_signature()->set_name("vectorized_function");
+    return VectorizeFunction(func, arg_shapes, output_shapes, flib, &library_,
+                             vectorized_func_);
+  }
+
+  // Returns the nodes of `func` of the given op.
+  static std::vector<const NodeDef*> NodesOf(const FunctionDef& func,
+                                             const string& op) {
+    std::vector<const NodeDef*> nodes;
+    for (const NodeDef& node : func.node_def()) {
+      if (node.op() == op) nodes.push_back(&node);
+    }
+    return nodes;
+  }
+
+  // Returns the node of `func` that produces the output `name`.
+  static const NodeDef* OutputNode(const FunctionDef& func,
+                                   const string& name) {
+    const string& tensor = func.ret().at(name);
+    const string node_name = tensor.substr(0, tensor.find(':'));
+    for (const NodeDef& node : func.node_def()) {
+      if (node.name() == node_name) return &node;
+    }
+    return nullptr;
+  }
+
+  FunctionDefLibrary library_;
+  FunctionDef* vectorized_func_ = nullptr;
+};
+
+TEST_F(VectorizeFunctionTest, ElementwiseOps) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: int32"}, {"y: float"}, {},
+      {FDH::Const("two", 2),
+       {{"mul"}, "Mul", {"x", "two:output:0"}, {{"T", DT_INT32}}},
+       {{"cast"},
+        "Cast",
+        {"mul:z:0"},
+        {{"SrcT", DT_INT32}, {"DstT", DT_FLOAT}}}},
+      {{"y", "cast:y:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({3})},
+                         {PartialTensorShape({3})}));
+
+  // The whole function is vectorized, so there is no MapDefun body.
+  EXPECT_EQ(2, library_.function_size());
+  EXPECT_TRUE(NodesOf(*vectorized_func_, "MapDefun").empty());
+  ASSERT_EQ(1, NodesOf(*vectorized_func_, "Mul").size());
+  const NodeDef* cast = OutputNode(*vectorized_func_, "y");
+  ASSERT_NE(nullptr, cast);
+  EXPECT_EQ("Cast", cast->op());
+  EXPECT_EQ(NodesOf(*vectorized_func_, "Mul")[0]->name() + ":z:0",
+            cast->input(0));
+}
+
+TEST_F(VectorizeFunctionTest, BroadcastsStackedInputsOfLowerRank) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: float", "y: float"}, {"z: float"}, {},
+      {{{"add"}, "Add", {"x", "y"}, {{"T", DT_FLOAT}}}}, {{"z", "add:z:0"}});
+  TF_ASSERT_OK(Vectorize(func,
+                         {PartialTensorShape({3}), PartialTensorShape({2, 3})},
+                         {PartialTensorShape({2, 3})}));
+
+  std::vector<const NodeDef*> expand_dims =
+      NodesOf(*vectorized_func_, "ExpandDims");
+  ASSERT_EQ(1, expand_dims.size());
+  EXPECT_EQ("x", expand_dims[0]->input(0));
+  const NodeDef* add = OutputNode(*vectorized_func_, "z");
+  ASSERT_NE(nullptr, add);
+  EXPECT_EQ(expand_dims[0]->name() + ":output:0", add->input(0));
+  EXPECT_EQ("y", add->input(1));
+}
+
+TEST_F(VectorizeFunctionTest, Reshape) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: int32"}, {"y: int32"}, {},
+      {FDH::Const<int32>("shape", {6}),
+       {{"reshape"},
+        "Reshape",
+        {"x", "shape:output:0"},
+        {{"T", DT_INT32}, {"Tshape", DT_INT32}}}},
+      {{"y", "reshape:output:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({2, 3})},
+                         {PartialTensorShape({6})}));
+
+  EXPECT_TRUE(NodesOf(*vectorized_func_, "MapDefun").empty());
+  const NodeDef* reshape = OutputNode(*vectorized_func_, "y");
+  ASSERT_NE(nullptr, reshape);
+  ASSERT_EQ(1, NodesOf(*vectorized_func_, "ConcatV2").size());
+  EXPECT_EQ(NodesOf(*vectorized_func_, "ConcatV2")[0]->name() + ":output:0",
+            reshape->input(1));
+}
+
+TEST_F(VectorizeFunctionTest, ParseSingleExample) {
+  FunctionDef func = FDH::Create(
+      "f", {"serialized: string"}, {"value: float"}, {},
+      {FDH::Const<float>("default", {0.0f}),
+       {{"parse"},
+        "ParseSingleExample",
+        {"serialized", "default:output:0"},
+        {{"num_sparse", 0},
+         {"sparse_keys", std::vector<string>()},
+         {"dense_keys", std::vector<string>({"feature"})},
+         {"sparse_types", DataTypeVector()},
+         {"Tdense", DataTypeVector({DT_FLOAT})},
+         {"dense_shapes",
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})}}}},
+      {{"value", "parse:dense_values:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({})},
+                         {PartialTensorShape({1})}));
+
+  const NodeDef* parse = OutputNode(*vectorized_func_, "value");
+  ASSERT_NE(nullptr, parse);
+  EXPECT_EQ("ParseExample", parse->op());
+  EXPECT_EQ(parse->name() + ":dense_values:0",
+            vectorized_func_->ret().at("value"));
+  // serialized, names, one dense key and its default.
+  ASSERT_EQ(4, parse->input_size());
+  EXPECT_EQ("serialized", parse->input(0));
+  EXPECT_EQ("default:output:0", parse->input(3));
+}
+
+TEST_F(VectorizeFunctionTest, DecodeRawReshapedToAFixedShape) {
+  FunctionDef func = FDH::Create(
+      "f", {"bytes: string"}, {"values: int32"}, {},
+      {{{"decode"}, "DecodeRaw", {"bytes"}, {{"out_type", DT_INT32}}},
+       FDH::Const<int32>("shape", {2, 2}),
+       {{"reshape"},
+        "Reshape",
+        {"decode:output:0", "shape:output:0"},
+        {{"T", DT_INT32}, {"Tshape", DT_INT32}}}},
+      {{"values", "reshape:output:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({})},
+                         {PartialTensorShape({2, 2})}));
+
+  // The strings of all elements hold 4 values, so they decode as a batch.
+  EXPECT_TRUE(NodesOf(*vectorized_func_, "MapDefun").empty());
+  ASSERT_EQ(1, NodesOf(*vectorized_func_, "DecodeRaw").size());
+  EXPECT_EQ("bytes", NodesOf(*vectorized_func_, "DecodeRaw")[0]->input(0));
+}
+
+TEST_F(VectorizeFunctionTest, DecodeRawOfStringsOfAnyLength) {
+  FunctionDef func = FDH::Create(
+      "f", {"bytes: string"}, {"sum: int32"}, {},
+      {{{"decode"}, "DecodeRaw", {"bytes"}, {{"out_type", DT_INT32}}},
+       FDH::Const<int32>("axis", 0),
+       {{"sum"},
+        "Sum",
+        {"decode:output:0", "axis:output:0"},
+        {{"T", DT_INT32}, {"Tidx", DT_INT32}}},
+       {{"neg"}, "Neg", {"sum:output:0"}, {{"T", DT_INT32}}}},
+      {{"sum", "neg:y:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({})},
+                         {PartialTensorShape({})}));
+
+  // The strings may differ in length, so they are decoded once per element.
+  ASSERT_EQ(3, library_.function_size());
+  EXPECT_EQ(1, NodesOf(library_.function(2), "DecodeRaw").size());
+  EXPECT_TRUE(NodesOf(*vectorized_func_, "DecodeRaw").empty());
+  EXPECT_EQ("Neg", OutputNode(*vectorized_func_, "sum")->op());
+}
+
+TEST_F(VectorizeFunctionTest, MapDefunForUnsupportedNodes) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: float"}, {"y: float"}, {},
+      {{{"neg"}, "Neg", {"x"}, {{"T", DT_FLOAT}}},
+       FDH::Const<int32>("perm", {1, 0}),
+       {{"transpose"},
+        "Transpose",
+        {"neg:y:0", "perm:output:0"},
+        {{"T", DT_FLOAT}, {"Tperm", DT_INT32}}},
+       {{"exp"}, "Exp", {"transpose:y:0"}, {{"T", DT_FLOAT}}}},
+      {{"y", "exp:y:0"}});
+  TF_ASSERT_OK(Vectorize(func, {PartialTensorShape({2, 3})},
+                         {PartialTensorShape({3, 2})}));
+
+  // Only the transpose is called once per element.
+  ASSERT_EQ(3, library_.function_size());
+  const FunctionDef& body = library_.function(2);
+  EXPECT_EQ(1, NodesOf(body, "Transpose").size());
+  EXPECT_EQ(1, NodesOf(body, "Const").size());
+  EXPECT_TRUE(NodesOf(body, "Neg").empty());
+  EXPECT_TRUE(NodesOf(*vectorized_func_, "Transpose").empty());
+
+  std::vector<const NodeDef*> map_defun =
+      NodesOf(*vectorized_func_, "MapDefun");
+  ASSERT_EQ(1, map_defun.size());
+  EXPECT_EQ(body.signature().name(),
+            map_defun[0]->attr().at("f").func().name());
+  ASSERT_EQ(1, NodesOf(*vectorized_func_, "Neg").size());
+  EXPECT_EQ(NodesOf(*vectorized_func_, "Neg")[0]->name() + ":y:0",
+            map_defun[0]->input(0));
+  EXPECT_EQ("Exp", OutputNode(*vectorized_func_, "y")->op());
+}
+
+TEST_F(VectorizeFunctionTest, NothingToVectorize) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: float"}, {"y: float"}, {},
+      {FDH::Const<int32>("perm", {1, 0}),
+       {{"transpose"},
+        "Transpose",
+        {"x", "perm:output:0"},
+        {{"T", DT_FLOAT}, {"Tperm", DT_INT32}}}},
+      {{"y", "transpose:y:0"}});
+  EXPECT_TRUE(errors::IsUnimplemented(Vectorize(
+      func, {PartialTensorShape({2, 3})}, {PartialTensorShape({3, 2})})));
+  EXPECT_EQ(2, library_.function_size());
+  EXPECT_EQ(0, vectorized_func_->node_def_size());
+}
+
+TEST_F(VectorizeFunctionTest, ControlDependencies) {
+  FunctionDef func = FDH::Create(
+      "f", {"x: float"}, {"y: float"}, {},
+      {{{"neg"}, "Neg", {"x"}, {{"T", DT_FLOAT}}},
+       {{"exp"}, "Exp", {"x"}, {{"T", DT_FLOAT}}, {"neg"}}},
+      {{"y", "exp:y:0"}});
+  EXPECT_TRUE(errors::IsUnimplemented(
+      Vectorize(func, {PartialTensorShape({3})}, {PartialTensorShape({3})})));
+  EXPECT_EQ(0, vectorized_func_->node_def_size());
+}
+
+}  // namespace
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
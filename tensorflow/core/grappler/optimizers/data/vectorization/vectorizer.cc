@@ -0,0 +1,76 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+
+NodeDef* AddNode(StringPiece op, FunctionDef* scope) {
+  NodeDef* node = scope->add_node_def();
+  node->set_op(string(op));
+  graph_utils::SetUniqueFunctionNodeName(op, scope, node);
+  return node;
+}
+
+string AddConstant(const Tensor& value, FunctionDef* scope) {
+  NodeDef* node = AddNode("Const", scope);
+  auto* attr = node->mutable_attr();
+  (*attr)["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*attr)["value"].mutable_tensor());
+  return strings::StrCat(node->name(), ":output:0");
+}
+
+Status AddCopy(const NodeDef& node, gtl::ArraySlice<string> inputs,
+               FunctionDef* scope, std::vector<string>* outputs) {
+  NodeDef* copy = scope->add_node_def();
+  *copy = node;
+  copy->clear_name();
+  graph_utils::SetUniqueFunctionNodeName(node.name(), scope, copy);
+  copy->clear_input();
+  for (const string& input : inputs) {
+    copy->add_input(input);
+  }
+  return GetOutputNames(*copy, outputs);
+}
+
+Status GetOutputNames(const NodeDef& node, std::vector<string>* outputs) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+  NameRangeMap output_ranges;
+  TF_RETURN_IF_ERROR(
+      NameRangesForNode(node, *op_def, nullptr, &output_ranges));
+  outputs->clear();
+  for (const OpDef::ArgDef& output_arg : op_def->output_arg()) {
+    const auto& range = output_ranges.at(output_arg.name());
+    for (int i = 0; i < range.second - range.first; ++i) {
+      outputs->push_back(
+          strings::StrCat(node.name(), ":", output_arg.name(), ":", i));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
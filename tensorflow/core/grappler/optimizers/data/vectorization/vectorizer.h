@@ -0,0 +1,87 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+
+// A tensor of the vectorized function, which computes a batch of elements at
+// once, in place of a tensor of the original function, which computes one
+// element.
+struct VectorizedTensor {
+  // The name of the tensor in the vectorized function.
+  string name;
+  // Whether the tensor has the values of the original tensor for all elements
+  // of the batch, stacked along a new leading dimension. Otherwise the values
+  // are the same for all elements, and the tensor is the original one.
+  bool stacked;
+  // The shape of the original tensor, i.e. of one element.
+  PartialTensorShape shape;
+};
+
+// Converts a node of a function that computes one element into nodes that
+// compute the same for a batch of elements.
+class Vectorizer {
+ public:
+  virtual ~Vectorizer() {}
+
+  // Adds nodes to `outer_scope` that compute the outputs of `node` for all
+  // elements of a batch, from the vectorized data `inputs` of `node`, of which
+  // at least one is stacked. `output_shapes` are the shapes of the outputs of
+  // `node` for one element. Stores the names of the (stacked) outputs in
+  // `outputs`, one for each output of `node`.
+  //
+  // Returns an error if `node` cannot be vectorized with these inputs, in
+  // which case the nodes added to `outer_scope` are discarded.
+  virtual Status Vectorize(const NodeDef& node,
+                           gtl::ArraySlice<VectorizedTensor> inputs,
+                           gtl::ArraySlice<PartialTensorShape> output_shapes,
+                           FunctionDef* outer_scope,
+                           std::vector<string>* outputs) = 0;
+};
+
+// Adds a node of the given op, with a unique name, to `scope`.
+NodeDef* AddNode(StringPiece op, FunctionDef* scope);
+
+// Adds a `Const` node of the given value to `scope`, and returns the name of
+// its output.
+string AddConstant(const Tensor& value, FunctionDef* scope);
+
+// Adds a copy of `node` with a unique name and the given data inputs to
+// `scope`, and stores the names of its outputs in `outputs`.
+Status AddCopy(const NodeDef& node, gtl::ArraySlice<string> inputs,
+               FunctionDef* scope, std::vector<string>* outputs);
+
+// Stores the names of the outputs of `node`, a node of a function, in
+// `outputs`, in order.
+Status GetOutputNames(const NodeDef& node, std::vector<string>* outputs);
+
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_H_
@@ -0,0 +1,70 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_REGISTRY_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_REGISTRY_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/grappler/optimizers/data/vectorization/vectorizer.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace vectorization_utils {
+
+// The vectorizers of ops, by op type.
+class VectorizerRegistry {
+ public:
+  static VectorizerRegistry* Global();
+
+  // Returns the vectorizer of the given op, or nullptr if there is none.
+  Vectorizer* Get(const string& op_type);
+
+  // Registers the vectorizer of an op during program initialization. This is
+  // not thread-safe.
+  void Register(const string& op_type, std::unique_ptr<Vectorizer> vectorizer);
+
+ private:
+  std::unordered_map<string, std::unique_ptr<Vectorizer>> vectorizers_;
+};
+
+class VectorizerRegistrar {
+ public:
+  VectorizerRegistrar(const string& op_type,
+                      std::unique_ptr<Vectorizer> vectorizer) {
+    VectorizerRegistry::Global()->Register(op_type, std::move(vectorizer));
+  }
+};
+
+#define REGISTER_VECTORIZER(op_type, MyVectorizerClass) \
+  REGISTER_VECTORIZER_UNIQ_HELPER(__COUNTER__, op_type, MyVectorizerClass)
+
+#define REGISTER_VECTORIZER_UNIQ_HELPER(ctr, op_type, MyVectorizerClass) \
+  REGISTER_VECTORIZER_UNIQ(ctr, op_type, MyVectorizerClass)
+
+#define REGISTER_VECTORIZER_UNIQ(ctr, op_type, MyVectorizerClass)      \
+  static ::tensorflow::grappler::vectorization_utils::VectorizerRegistrar \
+      vectorizer_registrar_##ctr(                                         \
+          (op_type),                                                      \
+          ::std::unique_ptr<                                              \
+              ::tensorflow::grappler::vectorization_utils::Vectorizer>(   \
+              new MyVectorizerClass))
+
+}  // namespace vectorization_utils
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZATION_VECTORIZER_REGISTRY_H_
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/recycling_allocator.h"
 #include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
@@ -116,7 +117,16 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params) {}
 
+      ~Iterator() override {
+        if (batch_allocator_) batch_allocator_->Unref();
+      }
+
       Status Initialize(IteratorContext* ctx) override {
+        // Batches are allocated through a recycling allocator, which reuses
+        // the buffers of the batches that the consumer has released.
+        batch_allocator_ = new RecyclingAllocator(
+            ctx->allocator({}),
+            kNumRecycledBatches * dataset()->output_dtypes().size());
         return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
       }
 
@@ -172,7 +182,7 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
           const Tensor& first_element = batch_elements[0][component_index];
           TensorShape batch_component_shape({num_batch_elements});
           batch_component_shape.AppendShape(first_element.shape());
-          Tensor batch_component(ctx->allocator({}), first_element.dtype(),
+          Tensor batch_component(batch_allocator_, first_element.dtype(),
                                  batch_component_shape);
           // Build the output tuple component by copying one slice
           // from each input element in the batch.
@@ -223,6 +233,7 @@ class BatchDatasetOp : public UnaryDatasetOpKernel {
      private:
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
+      RecyclingAllocator* batch_allocator_ = nullptr;
     };
 
     const int64 batch_size_;
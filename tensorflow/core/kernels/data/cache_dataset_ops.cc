@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <deque>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/memory_cache.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -29,7 +32,15 @@ namespace {
 class CacheDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit CacheDatasetOp(OpKernelConstruction* ctx)
-      : UnaryDatasetOpKernel(ctx) {}
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("memory_limit", &memory_limit_));
+    OP_REQUIRES(ctx, memory_limit_ >= 0,
+                errors::InvalidArgument("memory_limit must be non-negative."));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("compression_type", &compression_type_));
+    OP_REQUIRES_OK(ctx, MemoryCache::ParseCompression(compression_type_,
+                                                      &compression_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("spill_directory", &spill_directory_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
@@ -39,7 +50,12 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                    ParseScalarArgument<string>(ctx, "filename", &filename));
 
     if (filename.empty()) {
-      *output = new MemoryDataset(ctx, input);
+      MemoryCache::Options options;
+      options.memory_limit = memory_limit_;
+      options.compression = compression_;
+      options.spill_directory = spill_directory_;
+      options.env = ctx->env();
+      *output = new MemoryDataset(ctx, input, options, compression_type_);
     } else {
       *output = new FileDataset(ctx, input, filename, ctx->env());
     }
@@ -541,10 +557,14 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
 
   class MemoryDataset : public DatasetBase {
    public:
-    explicit MemoryDataset(OpKernelContext* ctx, const DatasetBase* input)
+    explicit MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
+                           const MemoryCache::Options& options,
+                           string compression_type)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
-          cache_(new MemoryCache()) {
+          options_(options),
+          compression_type_(std::move(compression_type)),
+          cache_(new MemoryCache(options)) {
       input->Ref();
     }
 
@@ -576,85 +596,22 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
       Node* filename_node = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(string(""), &filename_node));
-      TF_RETURN_IF_ERROR(
-          b->AddDataset(this, {input_node, filename_node}, output));
+      AttrValue memory_limit;
+      b->BuildAttrValue(options_.memory_limit, &memory_limit);
+      AttrValue compression_type;
+      b->BuildAttrValue(compression_type_, &compression_type);
+      AttrValue spill_directory;
+      b->BuildAttrValue(options_.spill_directory, &spill_directory);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {input_node, filename_node},
+          {std::make_pair("memory_limit", memory_limit),
+           std::make_pair("compression_type", compression_type),
+           std::make_pair("spill_directory", spill_directory)},
+          output));
       return Status::OK();
     }
 
    private:
-    // A thread-safe data structure for caching dataset elements.
-    //
-    // The expected use is that a single `MemoryWriterIterator` populates the
-    // cache with dataset elements. Once all elements are cached, the cache can
-    // be used by one or more `MemoryReaderIterator`s.
-    class MemoryCache {
-     public:
-      MemoryCache() = default;
-
-      // Marks the cache as completed.
-      void Complete() {
-        mutex_lock l(mu_);
-        completed_ = true;
-      }
-
-      // Returns whether the cache is claimed.
-      bool IsClaimed() {
-        tf_shared_lock l(mu_);
-        return claimed_;
-      }
-
-      // Returns whether the cache is completed.
-      bool IsCompleted() {
-        tf_shared_lock l(mu_);
-        return completed_;
-      }
-
-      // Attempts to claim the cache, returning whether the cache was claimed.
-      bool MaybeClaim() {
-        mutex_lock l(mu_);
-        if (!claimed_) {
-          claimed_ = true;
-          return true;
-        }
-        return false;
-      }
-
-      // Resets the cache.
-      void Reset() {
-        mutex_lock l(mu_);
-        claimed_ = false;
-        completed_ = false;
-        cache_.clear();
-      }
-
-      // Returns the element at the given index.
-      const std::vector<Tensor>& at(int64 index) {
-        tf_shared_lock l(mu_);
-        DCHECK(index < cache_.size());
-        return cache_[index];
-      }
-
-      // Adds the element to the cache.
-      void emplace_back(std::vector<Tensor> element) {
-        mutex_lock l(mu_);
-        cache_.emplace_back(std::move(element));
-      }
-
-      // Returns the size of the cache.
-      size_t size() {
-        tf_shared_lock l(mu_);
-        return cache_.size();
-      }
-
-     private:
-      mutex mu_;
-      // Determines whether a writer has claimed the cache.
-      bool claimed_ GUARDED_BY(mu_) = false;
-      // Determines whether all elements of the dataset have been cached.
-      bool completed_ GUARDED_BY(mu_) = false;
-      std::vector<std::vector<Tensor>> cache_ GUARDED_BY(mu_);
-    };
-
     class MemoryIterator : public DatasetIterator<MemoryDataset> {
      public:
       explicit MemoryIterator(const Params& params,
@@ -691,7 +648,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           TF_RETURN_IF_ERROR(
               writer->WriteScalar(full_name("cache_size"), cache_size));
           for (size_t i = 0; i < cache_size; i++) {
-            auto& element = cache_->at(i);
+            std::vector<Tensor> element;
+            TF_RETURN_IF_ERROR(cache_->Get(i, &element));
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat("cache[", i, "].size")),
                 element.size()));
@@ -744,10 +702,10 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                   full_name(strings::StrCat("cache[", i, "][", j, "]")),
                   &element.back()));
             }
-            cache_->emplace_back(std::move(element));
+            TF_RETURN_IF_ERROR(cache_->Add(std::move(element)));
           }
           if (reader->Contains(full_name("cache_completed"))) {
-            cache_->Complete();
+            TF_RETURN_IF_ERROR(cache_->Complete());
           }
         }
         InitializeIterator();
@@ -789,11 +747,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
           TF_RETURN_IF_ERROR(
               input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
           if (*end_of_sequence) {
-            cache_->Complete();
-            return Status::OK();
+            return cache_->Complete();
           }
-          cache_->emplace_back(*out_tensors);
-          return Status::OK();
+          return cache_->Add(*out_tensors);
         }
 
        protected:
@@ -837,6 +793,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("index"), &temp));
             index_ = static_cast<size_t>(temp);
           }
+          // The outstanding reads complete in the background.
+          reads_.clear();
           return Status::OK();
         }
 
@@ -844,23 +802,65 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                                std::vector<Tensor>* out_tensors,
                                bool* end_of_sequence) override {
           mutex_lock l(mu_);
-          if (index_ < cache_->size()) {
-            const std::vector<Tensor>& cache_tensors = cache_->at(index_);
-            out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
-                                cache_tensors.end());
-            index_++;
-            *end_of_sequence = false;
-            return Status::OK();
-          } else {
+          const size_t cache_size = cache_->size();
+          if (index_ >= cache_size) {
             *end_of_sequence = true;
             return Status::OK();
           }
+          *end_of_sequence = false;
+          if (!cache_->encoded()) {
+            TF_RETURN_IF_ERROR(cache_->Get(index_, out_tensors));
+            index_++;
+            return Status::OK();
+          }
+          // Encoded elements are decompressed, or read from the spill file,
+          // ahead of time and in parallel.
+          while (reads_.size() < kReadAhead &&
+                 index_ + reads_.size() < cache_size) {
+            std::shared_ptr<Read> read = std::make_shared<Read>();
+            const int64 index = index_ + reads_.size();
+            std::shared_ptr<MemoryCache> cache = cache_;
+            (*ctx->runner())([cache, index, read]() {
+              std::vector<Tensor> element;
+              Status s = cache->Get(index, &element);
+              mutex_lock l(read->mu);
+              read->status = s;
+              read->element = std::move(element);
+              read->done = true;
+              read->cond_var.notify_all();
+            });
+            reads_.push_back(std::move(read));
+          }
+          std::shared_ptr<Read> read = std::move(reads_.front());
+          reads_.pop_front();
+          index_++;
+          mutex_lock read_l(read->mu);
+          while (!read->done) {
+            read->cond_var.wait(read_l);
+          }
+          TF_RETURN_IF_ERROR(read->status);
+          *out_tensors = std::move(read->element);
+          return Status::OK();
         }
 
        private:
+        // The number of elements read ahead of the one being returned.
+        static constexpr size_t kReadAhead = 16;
+
+        // A read of an element, scheduled ahead of time.
+        struct Read {
+          mutex mu;
+          condition_variable cond_var;
+          bool done GUARDED_BY(mu) = false;
+          Status status GUARDED_BY(mu);
+          std::vector<Tensor> element GUARDED_BY(mu);
+        };
+
         mutex mu_;
         const std::shared_ptr<MemoryCache> cache_;
         size_t index_ GUARDED_BY(mu_);
+        // The reads of the elements at `index_`, `index_ + 1`, ... .
+        std::deque<std::shared_ptr<Read>> reads_ GUARDED_BY(mu_);
       };  // MemoryReaderIterator
 
       void InitializeIterator() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -883,8 +883,15 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     };  // MemoryIterator
 
     const DatasetBase* const input_;
+    const MemoryCache::Options options_;
+    const string compression_type_;
     const std::shared_ptr<MemoryCache> cache_;
   };  // MemoryDataset
+
+  int64 memory_limit_;
+  string compression_type_;
+  MemoryCache::Compression compression_;
+  string spill_directory_;
 };    // CacheDatasetOp
 
 REGISTER_KERNEL_BUILDER(Name("CacheDataset").Device(DEVICE_CPU),
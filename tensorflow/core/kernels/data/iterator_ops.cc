@@ -32,7 +32,9 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -106,6 +108,7 @@ class IteratorResource : public ResourceBase {
     if (captured_iterator) {
       CHECK_NOTNULL(lib_);
       ctx->set_lib(lib_);
+      ctx->set_model(model_);
       return captured_iterator->GetNext(ctx, out_tensors, end_of_sequence);
     } else {
       return errors::FailedPrecondition(
@@ -161,11 +164,13 @@ class IteratorResource : public ResourceBase {
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(outputs[0], &dataset));
 
     std::unique_ptr<IteratorBase> iterator;
+    std::shared_ptr<model::Model> model = NewModel();
     IteratorContext iter_ctx(ctx);
     iter_ctx.set_lib(lib);
+    iter_ctx.set_model(model);
     TF_RETURN_IF_ERROR(
         dataset->MakeIterator(std::move(iter_ctx), "Iterator", &iterator));
-    TF_RETURN_IF_ERROR(set_iterator(std::move(iterator)));
+    TF_RETURN_IF_ERROR(set_iterator(std::move(iterator), std::move(model)));
     std::shared_ptr<IteratorBase> captured_iterator(iterator_);
 
     if (captured_iterator) {
@@ -177,6 +182,7 @@ class IteratorResource : public ResourceBase {
       params.allocator_getter = [device](AllocatorAttributes attrs) {
         return device->GetAllocator(attrs);
       };
+      params.model = model_;
       IteratorContext iter_ctx(std::move(params));
 
       TF_RETURN_IF_ERROR(captured_iterator->Restore(&iter_ctx, reader));
@@ -201,14 +207,32 @@ class IteratorResource : public ResourceBase {
 
   FunctionLibraryRuntime* function_library_runtime() { return lib_; }
 
+  // Returns a new model for the input pipeline of an iterator, with which
+  // the iterator is to be created and passed to set_iterator().
+  static std::shared_ptr<model::Model> NewModel() {
+    model::Model::Options options;
+    options.cpu_budget = port::NumSchedulableCPUs();
+    // A tenth of the available memory, if known.
+    const int64 available_ram = port::AvailableRam();
+    if (available_ram != kint64max) options.ram_budget = available_ram / 10;
+    return std::make_shared<model::Model>(options);
+  }
+
   // Transfers ownership of iterator to this. This method is thread-safe.
-  Status set_iterator(std::unique_ptr<IteratorBase> iterator) {
+  //
+  // "model" is the model the iterator was created with. It is attached to
+  // the GetNext() calls only if a parameter of the pipeline is set to
+  // `model::kAutoTune`, so that the other pipelines do not pay for it.
+  Status set_iterator(std::unique_ptr<IteratorBase> iterator,
+                      std::shared_ptr<model::Model> model) {
     if (iterator) {
       TF_RETURN_IF_ERROR(
           VerifyTypesMatch(output_dtypes_, iterator->output_dtypes()));
       TF_RETURN_IF_ERROR(
           VerifyShapesCompatible(output_shapes_, iterator->output_shapes()));
     }
+    if (model && !model->tunable()) model.reset();
+    model_ = std::move(model);
     iterator_.reset(iterator.release());
     return Status::OK();
   }
@@ -230,6 +254,8 @@ class IteratorResource : public ResourceBase {
   std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
   FunctionLibraryRuntime* lib_ = nullptr;  // not owned.
   std::shared_ptr<IteratorBase> iterator_;
+  // The model of the current iterator, or null if it has nothing to tune.
+  std::shared_ptr<model::Model> model_;
   mutex mu_;
   std::shared_ptr<const FunctionLibraryDefinition> lib_def_ GUARDED_BY(mu_);
   const DataTypeVector output_dtypes_;
@@ -615,11 +641,14 @@ void MakeIteratorOp::Compute(OpKernelContext* ctx) {
   core::ScopedUnref unref(iterator_resource);
 
   std::unique_ptr<IteratorBase> iterator;
+  std::shared_ptr<model::Model> model = IteratorResource::NewModel();
   IteratorContext iter_ctx(ctx);
   iter_ctx.set_lib(iterator_resource->function_library_runtime());
+  iter_ctx.set_model(model);
   OP_REQUIRES_OK(
       ctx, dataset->MakeIterator(std::move(iter_ctx), "Iterator", &iterator));
-  OP_REQUIRES_OK(ctx, iterator_resource->set_iterator(std::move(iterator)));
+  OP_REQUIRES_OK(ctx, iterator_resource->set_iterator(std::move(iterator),
+                                                      std::move(model)));
 }
 
 class ToSingleElementOp : public AsyncOpKernel {
@@ -842,11 +871,14 @@ class OneShotIteratorOp : public AsyncOpKernel {
     DatasetBase* dataset;
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(return_values[0], &dataset));
     std::unique_ptr<IteratorBase> iter;
+    std::shared_ptr<model::Model> model = IteratorResource::NewModel();
     IteratorContext iter_ctx(ctx);
     iter_ctx.set_lib(lib);
+    iter_ctx.set_model(model);
     TF_RETURN_IF_ERROR(
         dataset->MakeIterator(std::move(iter_ctx), "Iterator", &iter));
-    TF_RETURN_IF_ERROR((*iterator)->set_iterator(std::move(iter)));
+    TF_RETURN_IF_ERROR(
+        (*iterator)->set_iterator(std::move(iter), std::move(model)));
 
     (*iterator)->Ref();
     return Status::OK();
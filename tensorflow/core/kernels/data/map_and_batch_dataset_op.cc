@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/function.h"
@@ -21,12 +22,15 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
+#include "tensorflow/core/kernels/data/recycling_allocator.h"
 #include "tensorflow/core/kernels/inplace_ops_functor.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
 
@@ -77,7 +81,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       case 2:
         OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                                 &num_parallel_calls));
-        OP_REQUIRES(ctx, num_parallel_calls > 0,
+        OP_REQUIRES(ctx,
+                    num_parallel_calls > 0 ||
+                        num_parallel_calls == model::kAutoTune,
                     errors::InvalidArgument(
                         "num_parallel_calls must be greater than zero."));
         break;
@@ -190,9 +196,14 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
     class Iterator : public DatasetIterator<Dataset> {
      public:
       explicit Iterator(const Params& params)
-          : DatasetIterator<Dataset>(params) {}
+          : DatasetIterator<Dataset>(params),
+            num_parallel_calls_(params.dataset->num_parallel_calls_ ==
+                                        model::kAutoTune
+                                    ? 1
+                                    : params.dataset->num_parallel_calls_) {}
 
       ~Iterator() override {
+        if (model_node()) model_node()->RemoveParameters();
         mutex_lock l(mu_);
         // Cancel the runner thread.
         cancelled_ = true;
@@ -201,9 +212,34 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         while (num_calls_ > 0) {
           cond_var_.wait(l);
         }
+        if (batch_allocator_) batch_allocator_->Unref();
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        // Recycle the buffers of the batches that the consumer releases.
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        batch_allocator_ = new RecyclingAllocator(
+            ctx->allocator(attr),
+            kNumRecycledBatches * dataset()->output_dtypes().size());
+        model::Node* node = model_node(ctx);
+        if (node) {
+          node->set_async(true);
+          const bool autotune =
+              dataset()->num_parallel_calls_ == model::kAutoTune;
+          const int64 min = autotune ? 1 : num_parallel_calls_;
+          const int64 max = autotune ? port::NumSchedulableCPUs() : min;
+          node->AddParameter(model::kParallelism, num_parallel_calls_, min,
+                             std::max(min, max), [this](int64 value) {
+                               mutex_lock l(mu_);
+                               num_parallel_calls_ = value;
+                               cond_var_.notify_all();
+                             });
+        } else if (dataset()->num_parallel_calls_ == model::kAutoTune) {
+          // Without a model, use one call per core.
+          mutex_lock l(mu_);
+          num_parallel_calls_ = port::NumSchedulableCPUs();
+        }
         TF_RETURN_IF_ERROR(
             dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_));
         return dataset()->captured_func_->Instantiate(ctx);
@@ -292,7 +328,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                     int64 offset, const Status& status) LOCKS_EXCLUDED(mu_) {
         result->UpdateStatus(status);
         if (status.ok()) {
-          EnsureOutputAllocated(ctx, result, return_values);
+          EnsureOutputAllocated(result, return_values);
           for (size_t i = 0; i < return_values->size(); ++i) {
             const Tensor& tensor = return_values->at(i);
             Tensor* batch = &(result->output)[i];
@@ -307,10 +343,16 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                   ", [batch]: ", batch_shape.DebugString()));
               break;
             }
-            // TODO(mrry): Add a version of DoParallelConcat that allows us to
-            // move `tensor` where possible, to speed up string tensor batching.
-            Status copy_status = ::tensorflow::functor::DoParallelConcat(
-                *dataset()->device_, tensor, offset, batch);
+            Status copy_status;
+            if (tensor.dtype() == DT_STRING || tensor.dtype() == DT_VARIANT) {
+              // Move the values of `tensor` into the batch if nothing else
+              // refers to them, rather than copying them.
+              copy_status = batch_util::CopyElementToSlice(
+                  std::move((*return_values)[i]), batch, offset);
+            } else {
+              copy_status = ::tensorflow::functor::DoParallelConcat(
+                  *dataset()->device_, tensor, offset, batch);
+            }
             if (!copy_status.ok()) {
               result->UpdateStatus(copy_status);
               break;
@@ -361,9 +403,16 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                                    std::vector<Tensor> input_element) {
               std::shared_ptr<std::vector<Tensor>> return_values(
                   new std::vector<Tensor>());
+              model::Node* node = model_node(ctx.get());
+              const int64 start_nanos = node ? ctx->env()->NowNanos() : 0;
               dataset()->captured_func_->RunAsync(
                   ctx.get(), std::move(input_element), return_values.get(),
-                  [this, ctx, result, return_values, offset](Status status) {
+                  [this, ctx, node, start_nanos, result, return_values,
+                   offset](Status status) {
+                    if (node) {
+                      node->AddProcessingTime(ctx->env()->NowNanos() -
+                                              start_nanos);
+                    }
                     Callback(ctx, result, return_values, offset, status);
                   });
             },
@@ -402,7 +451,6 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       }
 
       void EnsureOutputAllocated(
-          const std::shared_ptr<IteratorContext>& ctx,
           const std::shared_ptr<BatchResult>& result,
           const std::shared_ptr<std::vector<Tensor>>& return_values) {
         mutex_lock l(result->mu);
@@ -413,9 +461,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         for (size_t i = 0; i < num_components; ++i) {
           TensorShape component_shape({dataset()->batch_size_});
           component_shape.AppendShape(return_values->at(i).shape());
-          AllocatorAttributes attr;
-          attr.set_gpu_compatible(true);
-          Tensor component(ctx->allocator(attr), return_values->at(i).dtype(),
+          Tensor component(batch_allocator_, return_values->at(i).dtype(),
                            component_shape);
           result->output.emplace_back(std::move(component));
         }
@@ -423,7 +469,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       }
 
       int MaxBatchResults() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        return (dataset()->num_parallel_calls_ + dataset()->batch_size_ - 1) /
+        return (num_parallel_calls_ + dataset()->batch_size_ - 1) /
                dataset()->batch_size_;
       }
 
@@ -455,9 +501,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
           for (size_t i = 0; i < output.size(); ++i) {
             TensorShape component_shape(result->output[i].shape());
             component_shape.set_dim(0, result->num_elements);
-            AllocatorAttributes attr;
-            attr.set_gpu_compatible(true);
-            Tensor component(ctx->allocator(attr), output[i].dtype(),
+            Tensor component(batch_allocator_, output[i].dtype(),
                              component_shape);
             TF_RETURN_IF_ERROR(
                 CopyPartialBatch(&component, output[i], result->num_elements));
@@ -475,12 +519,11 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       void RunnerThread(const std::shared_ptr<IteratorContext>& ctx)
           LOCKS_EXCLUDED(mu_) {
         std::vector<std::pair<std::shared_ptr<BatchResult>, int64>> new_calls;
-        new_calls.reserve(dataset()->num_parallel_calls_);
         while (true) {
           {
             mutex_lock l(mu_);
             while (!cancelled_ &&
-                   (num_calls_ >= dataset()->num_parallel_calls_ ||
+                   (num_calls_ >= num_parallel_calls_ ||
                     batch_results_.size() > MaxBatchResults() ||
                     (batch_results_.size() == MaxBatchResults() &&
                      call_counter_ % dataset()->batch_size_ == 0))) {
@@ -491,7 +534,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
               return;
             }
 
-            while (num_calls_ < dataset()->num_parallel_calls_ &&
+            while (num_calls_ < num_parallel_calls_ &&
                    (batch_results_.size() < MaxBatchResults() ||
                     (batch_results_.size() == MaxBatchResults() &&
                      call_counter_ % dataset()->batch_size_ != 0))) {
@@ -543,9 +586,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
           if (t.dim_size(0) < dataset()->batch_size_) {
             TensorShape component_shape(t.shape());
             component_shape.set_dim(0, dataset()->batch_size_);
-            AllocatorAttributes attr;
-            attr.set_gpu_compatible(true);
-            Tensor new_t(ctx->allocator(attr), t.dtype(), component_shape);
+            Tensor new_t(batch_allocator_, t.dtype(), component_shape);
             TF_RETURN_IF_ERROR(CopyPartialBatch(&new_t, t, t.dim_size(0)));
             result->output.emplace_back(std::move(new_t));
           } else {
@@ -638,6 +679,9 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       // user specified level of parallelism and there are slots available in
       // the `batch_results_` buffer.
       condition_variable cond_var_;
+      // The number of calls that may be outstanding, which the model may
+      // change if the dataset was created with `model::kAutoTune`.
+      int64 num_parallel_calls_ GUARDED_BY(mu_);
       // Counts the number of outstanding calls for this batch.
       int64 num_calls_ GUARDED_BY(mu_) = 0;
       // Counts the total number of calls.
@@ -647,6 +691,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
       std::deque<std::shared_ptr<BatchResult>> batch_results_ GUARDED_BY(mu_);
       std::unique_ptr<Thread> runner_thread_ GUARDED_BY(mu_);
       bool cancelled_ GUARDED_BY(mu_) = false;
+      // Allocates the batches; set by Initialize().
+      RecyclingAllocator* batch_allocator_ = nullptr;
     };
 
     const DatasetBase* const input_;
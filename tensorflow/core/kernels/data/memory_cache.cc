@@ -0,0 +1,370 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/memory_cache.h"
+
+#include <zlib.h>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+// An encoded element is the varint64 number of its components, followed by
+// the varint64 length and the serialized `TensorProto` of each component.
+// With snappy compression that is compressed as a whole; with zlib
+// compression it is preceded by its varint64 length and then compressed.
+
+namespace {
+
+Status EncodeTensors(const std::vector<Tensor>& element, string* encoded) {
+  core::PutVarint64(encoded, element.size());
+  string serialized;
+  for (const Tensor& t : element) {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    if (!proto.SerializeToString(&serialized)) {
+      return errors::Internal("Could not serialize a tensor of shape ",
+                              t.shape().DebugString(), " for the cache.");
+    }
+    core::PutVarint64(encoded, serialized.size());
+    encoded->append(serialized);
+  }
+  return Status::OK();
+}
+
+Status DecodeTensors(StringPiece encoded, std::vector<Tensor>* element) {
+  uint64 num_components;
+  if (!core::GetVarint64(&encoded, &num_components)) {
+    return errors::DataLoss("Corrupted cache element.");
+  }
+  element->clear();
+  element->reserve(num_components);
+  for (uint64 i = 0; i < num_components; ++i) {
+    uint64 length;
+    if (!core::GetVarint64(&encoded, &length) || length > encoded.size()) {
+      return errors::DataLoss("Corrupted cache element.");
+    }
+    TensorProto proto;
+    element->emplace_back();
+    if (!proto.ParseFromArray(encoded.data(), length) ||
+        !element->back().FromProto(proto)) {
+      return errors::DataLoss("Corrupted tensor in cache element.");
+    }
+    encoded.remove_prefix(length);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+/* static */
+Status MemoryCache::ParseCompression(StringPiece compression_type,
+                                     Compression* compression) {
+  if (compression_type.empty()) {
+    *compression = Compression::kNone;
+  } else if (compression_type == "SNAPPY") {
+    *compression = Compression::kSnappy;
+  } else if (compression_type == "ZLIB") {
+    *compression = Compression::kZlib;
+  } else {
+    return errors::InvalidArgument(
+        "Unsupported cache compression type: \"", compression_type,
+        "\"; expected \"\", \"SNAPPY\" or \"ZLIB\".");
+  }
+  return Status::OK();
+}
+
+MemoryCache::MemoryCache(const Options& options) : options_(options) {}
+
+MemoryCache::~MemoryCache() {
+  mutex_lock l(mu_);
+  DeleteSpillFile();
+}
+
+Status MemoryCache::Complete() {
+  mutex_lock l(mu_);
+  if (spill_file_ != nullptr) {
+    TF_RETURN_IF_ERROR(spill_file_->Close());
+    spill_file_.reset();
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    if (options_.env->NewReadOnlyMemoryRegionFromFile(spill_filename_, &region)
+            .ok()) {
+      spill_region_ = std::move(region);
+      spill_reader_.reset();
+    }
+  }
+  completed_ = true;
+  return Status::OK();
+}
+
+bool MemoryCache::IsClaimed() {
+  tf_shared_lock l(mu_);
+  return claimed_;
+}
+
+bool MemoryCache::IsCompleted() {
+  tf_shared_lock l(mu_);
+  return completed_;
+}
+
+bool MemoryCache::MaybeClaim() {
+  mutex_lock l(mu_);
+  if (!claimed_) {
+    claimed_ = true;
+    return true;
+  }
+  return false;
+}
+
+void MemoryCache::Reset() {
+  mutex_lock l(mu_);
+  claimed_ = false;
+  completed_ = false;
+  entries_.clear();
+  bytes_in_memory_ = 0;
+  num_spilled_ = 0;
+  DeleteSpillFile();
+}
+
+Status MemoryCache::Add(std::vector<Tensor> element) {
+  Entry entry;
+  string encoded;
+  bool is_encoded = false;
+  int64 bytes = 0;
+  if (options_.compression != Compression::kNone) {
+    TF_RETURN_IF_ERROR(Encode(element, &encoded));
+    is_encoded = true;
+    bytes = encoded.size();
+  } else {
+    for (const Tensor& t : element) {
+      bytes += t.TotalBytes();
+    }
+  }
+
+  mutex_lock l(mu_);
+  DCHECK(!completed_);
+  // Once an element is spilled, so are all the following ones, which keeps
+  // the elements in the file in the order in which they are read.
+  if (options_.memory_limit > 0 &&
+      (num_spilled_ > 0 || bytes_in_memory_ + bytes > options_.memory_limit)) {
+    if (!is_encoded) {
+      TF_RETURN_IF_ERROR(Encode(element, &encoded));
+    }
+    TF_RETURN_IF_ERROR(Spill(encoded, &entry));
+  } else if (is_encoded) {
+    entry.encoded = std::move(encoded);
+    bytes_in_memory_ += bytes;
+  } else {
+    entry.tensors = std::move(element);
+    bytes_in_memory_ += bytes;
+  }
+  entries_.push_back(std::move(entry));
+  return Status::OK();
+}
+
+Status MemoryCache::Get(int64 index, std::vector<Tensor>* element) {
+  {
+    tf_shared_lock l(mu_);
+    if (spill_file_ == nullptr) {
+      return GetLocked(index, element);
+    }
+  }
+  // The cache is being written to the spill file, whose buffered contents
+  // must be flushed before they are read.
+  mutex_lock l(mu_);
+  if (spill_file_ != nullptr) {
+    TF_RETURN_IF_ERROR(spill_file_->Flush());
+  }
+  return GetLocked(index, element);
+}
+
+int64 MemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return entries_.size();
+}
+
+int64 MemoryCache::bytes_in_memory() {
+  tf_shared_lock l(mu_);
+  return bytes_in_memory_;
+}
+
+int64 MemoryCache::num_spilled() {
+  tf_shared_lock l(mu_);
+  return num_spilled_;
+}
+
+Status MemoryCache::Encode(const std::vector<Tensor>& element,
+                           string* encoded) const {
+  if (options_.compression == Compression::kNone) {
+    return EncodeTensors(element, encoded);
+  }
+  string uncompressed;
+  TF_RETURN_IF_ERROR(EncodeTensors(element, &uncompressed));
+  switch (options_.compression) {
+    case Compression::kSnappy:
+      if (!port::Snappy_Compress(uncompressed.data(), uncompressed.size(),
+                                 encoded)) {
+        return errors::Unimplemented(
+            "Snappy compression is not supported on this platform.");
+      }
+      return Status::OK();
+    case Compression::kZlib: {
+      encoded->clear();
+      core::PutVarint64(encoded, uncompressed.size());
+      const size_t header_size = encoded->size();
+      uLongf compressed_size = compressBound(uncompressed.size());
+      encoded->resize(header_size + compressed_size);
+      // The cache is compressed to save memory on the way to the next
+      // stage, so favor speed over the compression ratio.
+      const int result = compress2(
+          reinterpret_cast<Bytef*>(&(*encoded)[header_size]), &compressed_size,
+          reinterpret_cast<const Bytef*>(uncompressed.data()),
+          uncompressed.size(), Z_BEST_SPEED);
+      if (result != Z_OK) {
+        return errors::Internal("zlib compression failed with error ",
+                                result);
+      }
+      encoded->resize(header_size + compressed_size);
+      return Status::OK();
+    }
+    case Compression::kNone:
+      break;
+  }
+  return errors::Internal("Unknown cache compression.");
+}
+
+Status MemoryCache::Decode(StringPiece encoded,
+                           std::vector<Tensor>* element) const {
+  string uncompressed;
+  switch (options_.compression) {
+    case Compression::kNone:
+      return DecodeTensors(encoded, element);
+    case Compression::kSnappy: {
+      size_t length;
+      if (!port::Snappy_GetUncompressedLength(encoded.data(), encoded.size(),
+                                              &length)) {
+        return errors::DataLoss("Corrupted snappy-compressed cache element.");
+      }
+      uncompressed.resize(length);
+      if (!port::Snappy_Uncompress(encoded.data(), encoded.size(),
+                                   &uncompressed[0])) {
+        return errors::DataLoss("Corrupted snappy-compressed cache element.");
+      }
+      break;
+    }
+    case Compression::kZlib: {
+      uint64 length;
+      if (!core::GetVarint64(&encoded, &length)) {
+        return errors::DataLoss("Corrupted zlib-compressed cache element.");
+      }
+      uncompressed.resize(length);
+      uLongf uncompressed_size = length;
+      if (uncompress(reinterpret_cast<Bytef*>(&uncompressed[0]),
+                     &uncompressed_size,
+                     reinterpret_cast<const Bytef*>(encoded.data()),
+                     encoded.size()) != Z_OK ||
+          uncompressed_size != length) {
+        return errors::DataLoss("Corrupted zlib-compressed cache element.");
+      }
+      break;
+    }
+  }
+  return DecodeTensors(uncompressed, element);
+}
+
+Status MemoryCache::Spill(const string& encoded, Entry* entry) {
+  if (spill_file_ == nullptr) {
+    DCHECK(spill_filename_.empty());
+    bool created;
+    if (options_.spill_directory.empty()) {
+      created = options_.env->LocalTempFilename(&spill_filename_);
+    } else {
+      TF_RETURN_IF_ERROR(
+          options_.env->RecursivelyCreateDir(options_.spill_directory));
+      spill_filename_ = io::JoinPath(options_.spill_directory, "cache-");
+      created = options_.env->CreateUniqueFileName(&spill_filename_, ".spill");
+    }
+    if (!created) {
+      spill_filename_.clear();
+      return errors::Unavailable(
+          "Could not create a spill file for the cache.");
+    }
+    TF_RETURN_IF_ERROR(
+        options_.env->NewWritableFile(spill_filename_, &spill_file_));
+    TF_RETURN_IF_ERROR(
+        options_.env->NewRandomAccessFile(spill_filename_, &spill_reader_));
+    VLOG(1) << "Spilling cached elements beyond " << bytes_in_memory_
+            << " bytes to " << spill_filename_;
+  }
+  TF_RETURN_IF_ERROR(spill_file_->Append(encoded));
+  entry->offset = spill_file_size_;
+  entry->length = encoded.size();
+  spill_file_size_ += encoded.size();
+  ++num_spilled_;
+  return Status::OK();
+}
+
+Status MemoryCache::GetLocked(int64 index, std::vector<Tensor>* element) {
+  if (index < 0 || index >= static_cast<int64>(entries_.size())) {
+    return errors::OutOfRange("Index ", index,
+                              " is out of range of a cache of ",
+                              entries_.size(), " elements.");
+  }
+  const Entry& entry = entries_[index];
+  if (entry.offset < 0) {
+    if (options_.compression == Compression::kNone) {
+      *element = entry.tensors;
+      return Status::OK();
+    }
+    return Decode(entry.encoded, element);
+  }
+  if (spill_region_ != nullptr) {
+    return Decode(
+        StringPiece(static_cast<const char*>(spill_region_->data()) +
+                        entry.offset,
+                    entry.length),
+        element);
+  }
+  string scratch;
+  scratch.resize(entry.length);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(
+      spill_reader_->Read(entry.offset, entry.length, &data, &scratch[0]));
+  if (static_cast<int64>(data.size()) != entry.length) {
+    return errors::DataLoss("Truncated cache spill file ", spill_filename_);
+  }
+  return Decode(data, element);
+}
+
+void MemoryCache::DeleteSpillFile() {
+  spill_file_.reset();
+  spill_reader_.reset();
+  spill_region_.reset();
+  if (!spill_filename_.empty()) {
+    Status s = options_.env->DeleteFile(spill_filename_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Could not delete the cache spill file "
+                   << spill_filename_ << ": " << s;
+    }
+    spill_filename_.clear();
+  }
+  spill_file_size_ = 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,155 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_MEMORY_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_MEMORY_CACHE_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A thread-safe data structure for caching dataset elements.
+//
+// The expected use is that a single writer populates the cache with dataset
+// elements, in order, and marks it as completed. Once all elements are
+// cached, the cache can be read by one or more readers, concurrently.
+//
+// By default every element is kept in memory as is. Elements can instead be
+// kept compressed, and once the cached elements take up more than a given
+// amount of memory, the following elements are spilled to a local file. The
+// first elements stay in memory: since the cache is read in order, keeping
+// a prefix in memory and streaming the rest from the file serves each epoch
+// with a single sequential pass over the file, which evicting the least
+// recently used elements would not. Once the cache is completed, the file is
+// memory-mapped if the file system supports it.
+class MemoryCache {
+ public:
+  enum class Compression { kNone, kSnappy, kZlib };
+
+  struct Options {
+    // The number of bytes of cached elements to keep in memory before
+    // spilling to a file, or 0 to keep all elements in memory.
+    int64 memory_limit = 0;
+    Compression compression = Compression::kNone;
+    // The directory of the spill file. A local temporary directory is used if
+    // empty.
+    string spill_directory;
+    Env* env = Env::Default();
+  };
+
+  // Parses "", "SNAPPY" or "ZLIB".
+  static Status ParseCompression(StringPiece compression_type,
+                                 Compression* compression);
+
+  MemoryCache() : MemoryCache(Options()) {}
+  explicit MemoryCache(const Options& options);
+  ~MemoryCache();
+
+  // Marks the cache as completed. The cache must not be added to afterwards.
+  Status Complete() LOCKS_EXCLUDED(mu_);
+
+  // Returns whether the cache is claimed.
+  bool IsClaimed() LOCKS_EXCLUDED(mu_);
+
+  // Returns whether the cache is completed.
+  bool IsCompleted() LOCKS_EXCLUDED(mu_);
+
+  // Attempts to claim the cache, returning whether the cache was claimed.
+  bool MaybeClaim() LOCKS_EXCLUDED(mu_);
+
+  // Resets the cache, deleting its spill file.
+  void Reset() LOCKS_EXCLUDED(mu_);
+
+  // Adds the element to the end of the cache.
+  Status Add(std::vector<Tensor> element) LOCKS_EXCLUDED(mu_);
+
+  // Stores the element at the given index in `*element`.
+  Status Get(int64 index, std::vector<Tensor>* element) LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of elements in the cache.
+  int64 size() LOCKS_EXCLUDED(mu_);
+
+  // Returns whether Get() has to decode elements, in which case concurrent
+  // reads of several elements are worthwhile.
+  bool encoded() const {
+    return options_.memory_limit > 0 ||
+           options_.compression != Compression::kNone;
+  }
+
+  // Returns the number of bytes of the elements kept in memory.
+  int64 bytes_in_memory() LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of elements spilled to the file.
+  int64 num_spilled() LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    // The element, if it is kept in memory without compression.
+    std::vector<Tensor> tensors;
+    // The encoded element, if it is kept in memory with compression.
+    string encoded;
+    // The location of the encoded element in the spill file, if it was
+    // spilled.
+    int64 offset = -1;
+    int64 length = 0;
+  };
+
+  Status Encode(const std::vector<Tensor>& element, string* encoded) const;
+  Status Decode(StringPiece encoded, std::vector<Tensor>* element) const;
+
+  Status Spill(const string& encoded, Entry* entry)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status GetLocked(int64 index, std::vector<Tensor>* element)
+      SHARED_LOCKS_REQUIRED(mu_);
+  void DeleteSpillFile() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  mutex mu_;
+  // Determines whether a writer has claimed the cache.
+  bool claimed_ GUARDED_BY(mu_) = false;
+  // Determines whether all elements of the dataset have been cached.
+  bool completed_ GUARDED_BY(mu_) = false;
+  // A deque, so that readers of an entry are not affected by appends.
+  std::deque<Entry> entries_ GUARDED_BY(mu_);
+  int64 bytes_in_memory_ GUARDED_BY(mu_) = 0;
+  int64 num_spilled_ GUARDED_BY(mu_) = 0;
+
+  string spill_filename_ GUARDED_BY(mu_);
+  int64 spill_file_size_ GUARDED_BY(mu_) = 0;
+  // The spill file, while it is written.
+  std::unique_ptr<WritableFile> spill_file_ GUARDED_BY(mu_);
+  // The spill file, for reading. Once the cache is completed, `spill_region_`
+  // is used instead if the file could be memory-mapped.
+  std::unique_ptr<RandomAccessFile> spill_reader_ GUARDED_BY(mu_);
+  std::unique_ptr<ReadOnlyMemoryRegion> spill_region_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_MEMORY_CACHE_H_
@@ -0,0 +1,144 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/memory_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns an element of two components; elements 0 to 9 are of equal size.
+std::vector<Tensor> Element(int64 i) {
+  return {test::AsTensor<int64>({i, i + 1, i + 2}),
+          test::AsTensor<string>({strings::StrCat("element ", i)})};
+}
+
+int64 ElementBytes() {
+  int64 bytes = 0;
+  for (const Tensor& t : Element(0)) {
+    bytes += t.TotalBytes();
+  }
+  return bytes;
+}
+
+void ExpectElement(MemoryCache* cache, int64 i) {
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(cache->Get(i, &element));
+  ASSERT_EQ(2, element.size());
+  test::ExpectTensorEqual<int64>(Element(i)[0], element[0]);
+  test::ExpectTensorEqual<string>(Element(i)[1], element[1]);
+}
+
+void FillAndCheck(MemoryCache* cache, int64 num_elements) {
+  ASSERT_TRUE(cache->MaybeClaim());
+  for (int64 i = 0; i < num_elements; ++i) {
+    TF_ASSERT_OK(cache->Add(Element(i)));
+  }
+  // Elements can be read before the cache is completed, e.g. to save it.
+  ExpectElement(cache, 0);
+  ExpectElement(cache, num_elements - 1);
+  TF_ASSERT_OK(cache->Complete());
+  EXPECT_TRUE(cache->IsCompleted());
+  EXPECT_EQ(num_elements, cache->size());
+  for (int64 i = 0; i < num_elements; ++i) {
+    ExpectElement(cache, i);
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(cache->Get(num_elements, &element)));
+}
+
+TEST(MemoryCacheTest, Unbounded) {
+  MemoryCache cache;
+  EXPECT_FALSE(cache.encoded());
+  FillAndCheck(&cache, 10);
+  EXPECT_EQ(0, cache.num_spilled());
+  EXPECT_FALSE(cache.MaybeClaim());
+  cache.Reset();
+  EXPECT_FALSE(cache.IsCompleted());
+  EXPECT_EQ(0, cache.size());
+  EXPECT_TRUE(cache.MaybeClaim());
+}
+
+TEST(MemoryCacheTest, Compressed) {
+  for (const char* compression_type : {"SNAPPY", "ZLIB"}) {
+    MemoryCache::Options options;
+    TF_ASSERT_OK(MemoryCache::ParseCompression(compression_type,
+                                               &options.compression));
+    MemoryCache cache(options);
+    EXPECT_TRUE(cache.encoded());
+    Status s = cache.Add(Element(0));
+    if (errors::IsUnimplemented(s)) {
+      LOG(INFO) << compression_type << " is not supported, skipping.";
+      continue;
+    }
+    TF_ASSERT_OK(s);
+    cache.Reset();
+    FillAndCheck(&cache, 10);
+    EXPECT_EQ(0, cache.num_spilled());
+  }
+}
+
+TEST(MemoryCacheTest, InvalidCompression) {
+  MemoryCache::Compression compression;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      MemoryCache::ParseCompression("GZIP", &compression)));
+}
+
+TEST(MemoryCacheTest, SpillsBeyondTheMemoryLimit) {
+  const string dir = io::JoinPath(testing::TmpDir(), "memory_cache_spill");
+  MemoryCache::Options options;
+  // Room for 4 elements.
+  options.memory_limit = 4 * ElementBytes() + ElementBytes() / 2;
+  options.spill_directory = dir;
+  {
+    MemoryCache cache(options);
+    EXPECT_TRUE(cache.encoded());
+    FillAndCheck(&cache, 10);
+    EXPECT_EQ(4 * ElementBytes(), cache.bytes_in_memory());
+    EXPECT_EQ(6, cache.num_spilled());
+    std::vector<string> children;
+    TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+    EXPECT_EQ(1, children.size());
+
+    // The cache can be filled again after a reset.
+    cache.Reset();
+    TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+    EXPECT_TRUE(children.empty());
+    FillAndCheck(&cache, 5);
+    EXPECT_EQ(1, cache.num_spilled());
+  }
+  // The spill file is deleted with the cache.
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST(MemoryCacheTest, SpillsCompressedElements) {
+  MemoryCache::Options options;
+  options.memory_limit = 1;
+  options.compression = MemoryCache::Compression::kZlib;
+  MemoryCache cache(options);
+  FillAndCheck(&cache, 10);
+  EXPECT_EQ(0, cache.bytes_in_memory());
+  EXPECT_EQ(10, cache.num_spilled());
+}
+
+}  // namespace
+}  // namespace tensorflow
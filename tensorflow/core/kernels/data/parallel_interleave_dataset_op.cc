@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/stats_aggregator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/captured_function.h"
 #include "tensorflow/core/kernels/data/dataset.h"
@@ -31,6 +32,17 @@ namespace {
 // See documentation in ../ops/dataset_ops.cc for a high-level
 // description of the following op.
 
+// The histogram to which the time that `GetNext()` was blocked on each input
+// element is added, once the input element is exhausted.
+constexpr char kInputStallMicros[] =
+    "parallel_interleave:input_stall_microseconds";
+
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& t : element) bytes += t.TotalBytes();
+  return bytes;
+}
+
 class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ParallelInterleaveDatasetOp(OpKernelConstruction* ctx)
@@ -39,6 +51,13 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &interleave_func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("buffer_output_bytes", &buffer_output_bytes_));
+    OP_REQUIRES(ctx, buffer_output_bytes_ >= 0,
+                errors::InvalidArgument("`buffer_output_bytes` must be >= 0"));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("max_reordering", &max_reordering_));
+    OP_REQUIRES(ctx, max_reordering_ >= 0,
+                errors::InvalidArgument("`max_reordering` must be >= 0"));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -85,10 +104,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         ctx, CapturedFunction::Create(
                  interleave_func_, std::move(other_arguments), &captured_func));
 
-    *output =
-        new Dataset(ctx, input, interleave_func_, std::move(captured_func),
-                    cycle_length, block_length, sloppy, buffer_output_elements,
-                    prefetch_input_elements, output_types_, output_shapes_);
+    *output = new Dataset(ctx, input, interleave_func_,
+                          std::move(captured_func), cycle_length, block_length,
+                          sloppy, buffer_output_elements, buffer_output_bytes_,
+                          prefetch_input_elements, max_reordering_,
+                          output_types_, output_shapes_);
   }
 
  private:
@@ -98,7 +118,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
             const NameAttrList& func,
             std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
             int64 block_length, bool sloppy, int64 buffer_output_elements,
-            int64 prefetch_input_elements, const DataTypeVector& output_types,
+            int64 buffer_output_bytes, int64 prefetch_input_elements,
+            int64 max_reordering, const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
@@ -108,7 +129,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           block_length_(block_length),
           sloppy_(sloppy),
           buffer_output_elements_(buffer_output_elements),
+          buffer_output_bytes_(buffer_output_bytes),
           prefetch_input_elements_(prefetch_input_elements),
+          max_reordering_(max_reordering),
           output_types_(output_types),
           output_shapes_(output_shapes) {
       input_->Ref();
@@ -166,6 +189,10 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       b->BuildAttrValue(interleave_func_, &f);
       AttrValue other_arguments_types_attr;
       b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+      AttrValue buffer_output_bytes;
+      b->BuildAttrValue(buffer_output_bytes_, &buffer_output_bytes);
+      AttrValue max_reordering;
+      b->BuildAttrValue(max_reordering_, &max_reordering);
 
       TF_RETURN_IF_ERROR(b->AddDataset(
           this,
@@ -176,7 +203,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
            {5, buffer_output_elements_node},
            {6, prefetch_input_elements_node}},
           {{1, other_arguments}},
-          {{"f", f}, {"Targuments", other_arguments_types_attr}}, output));
+          {{"f", f},
+           {"Targuments", other_arguments_types_attr},
+           {"buffer_output_bytes", buffer_output_bytes},
+           {"max_reordering", max_reordering}},
+          output));
       return Status::OK();
     }
 
@@ -185,6 +216,10 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       return cycle_length_ + prefetch_input_elements_;
     }
 
+    // Whether `GetNext()` may produce an element from an input other than
+    // the one whose turn it is.
+    bool may_reorder() const { return sloppy_ || max_reordering_ > 0; }
+
     // Parallel interleave's implementation is designed around a few principles:
     //  1. Thread creation is relatively expensive. (Not reusing
     //     threads causes a number of indirect costs such as poorer tcmalloc
@@ -220,6 +255,21 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
     // `staging_indices_` as output iterators (run by the worker threads) are
     // exhausted.
     //
+    // Each worker buffers up to `buffer_output_elements_` elements, and, if
+    // `buffer_output_bytes_` is set, stops early once its buffer holds that
+    // many bytes, so that inputs with large elements do not hold on to a
+    // multiple of the memory of the others. Staged workers fill their buffers
+    // before they join the cycle, which hides the latency of opening inputs.
+    //
+    // When the worker whose turn it is (the "head" of the cycle) has no
+    // element ready, a sloppy iterator takes an element from any other worker.
+    // With `max_reordering_` set, a deterministic iterator does the same, but
+    // only for up to `max_reordering_` consecutive elements, after which it
+    // waits for the head. The head's elements are thus delayed by at most
+    // `max_reordering_` positions, which smooths over straggling inputs while
+    // keeping the order close to that of `interleave()`. The time that the
+    // client spends blocked on each head is reported to the stats aggregator.
+    //
     // `input_impl_` is the input iterator that generates arguments for the
     // flat-map function (`captured_func_`). It is set to an iterator at
     // Iterator construction, and is fixed until we consume all input elements.
@@ -257,7 +307,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
 
       // It is implemented so that it matches the deterministic interleave
       // unless getting the next element would block and we are allowed to be
-      // sloppy.
+      // sloppy or to reorder elements.
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
@@ -269,6 +319,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           // not have an item readily available.
           bool can_produce_elements = false;
           bool must_wait_for_input = true;
+          // Set once the head of the cycle has no element ready and we may
+          // take an element from a later worker instead.
+          bool reordering = false;
           for (int64 i = 0; i < interleave_indices_.size(); ++i) {
             int64 index = (next_index_ + i) % interleave_indices_.size();
             int64 current_worker_index = interleave_indices_[index];
@@ -279,6 +332,13 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
             can_produce_elements |= current_worker->MayHaveElements();
             if (!current_worker->outputs.empty()) {
               // We have an element!
+              *end_of_sequence = false;
+              if (reordering) {
+                // Leave the block and cycle pointers at the head, which
+                // produces the next element in the regular order.
+                reordered_elements_++;
+                return TakeOutputLocked(current_worker, out_tensors);
+              }
               next_index_ = index;
               const bool element_acquired_sloppily =
                   dataset()->sloppy_ && i > 1;
@@ -286,6 +346,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                 // If the element was acquired in the regular (non-sloppy)
                 // order, then advance the current block and cycle pointers to
                 // the next element in the regular order.
+                reordered_elements_ = 0;
                 block_count_++;
                 if (block_count_ == dataset()->block_length_) {
                   next_index_ = (index + 1) % interleave_indices_.size();
@@ -294,12 +355,11 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
               } else {
                 block_count_ = 0;
               }
-              *end_of_sequence = false;
-              Status s = current_worker->outputs.front().status;
-              current_worker->outputs.front().output.swap(*out_tensors);
-              current_worker->outputs.pop_front();
-              current_worker->cond_var.notify_one();
-              return s;
+              return TakeOutputLocked(current_worker, out_tensors);
+            } else if (reordering) {
+              // Workers after the head are only checked for ready elements;
+              // exhausted ones are replaced when they become the head.
+              continue;
             } else if (current_worker->is_producing && !dataset()->sloppy_) {
               // current_worker.outputs.empty(), and we must wait for this
               // iterator.
@@ -308,9 +368,14 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                 next_index_ = index;
                 block_count_ = 0;
               }
+              if (reordered_elements_ < dataset()->max_reordering_) {
+                reordering = true;
+                continue;
+              }
               break;
             } else if (!current_worker->is_producing) {
               // This iterator has reached end of input.
+              RecordInputStallLocked(ctx, current_worker);
               interleave_indices_[index] = -1;
               if (input_impl_) {
                 // Start prefetching a new iterator.
@@ -349,10 +414,16 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
 
           if (must_wait_for_input) {
             // Wait for elements to become available.
-            if (dataset()->sloppy_) {
-              sloppy_cond_var_.wait(l);
+            const int64 head_index = interleave_indices_[next_index_];
+            const uint64 start = ctx->env()->NowMicros();
+            if (dataset()->may_reorder()) {
+              any_output_cond_var_.wait(l);
             } else {
-              workers_[interleave_indices_[next_index_]].cond_var.wait(l);
+              workers_[head_index].cond_var.wait(l);
+            }
+            if (head_index >= 0) {
+              workers_[head_index].stall_micros +=
+                  ctx->env()->NowMicros() - start;
             }
           }
         }
@@ -512,17 +583,22 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         std::vector<Tensor> input;
         // The buffered output elements.
         std::deque<OutputElem> outputs;
+        // The total size of the tensors in `outputs`.
+        int64 output_bytes = 0;
         // Set to true iff the worker thread expects to append more elements to
         // outputs. is_producing can be false despite !outputs.empty().
         // Concretely, all output elements will have been consumed only when:
         // is_producing == false && outputs.empty();
         bool is_producing = false;
+        // The time that the main thread has spent waiting for this worker to
+        // produce an element from its current input.
+        uint64 stall_micros = 0;
         // Condition variable used to coordinate between threads. The worker
         // thread waits on this condition variable when it is either (1) waiting
         // for the main thread to add arguments to `input`, or (2) waiting for
         // the main thread to consume an element of `outputs`. The main thread
         // waits on cond_var if it is waiting for the worker thread to produce
-        // an element into `outputs` (this implies sloppy_==false).
+        // an element into `outputs` (this implies !may_reorder()).
         condition_variable cond_var;
 
         inline bool MayHaveElements() const {
@@ -568,6 +644,50 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
         WorkerThreadState() : output_elem(Status::OK()) {}
       };
 
+      // Returns whether `worker` must wait for the main thread to consume an
+      // element before it produces another one.
+      bool OutputBufferFullLocked(const WorkerState& worker) const
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return worker.outputs.size() >= dataset()->buffer_output_elements_ ||
+               (dataset()->buffer_output_bytes_ > 0 &&
+                worker.output_bytes >= dataset()->buffer_output_bytes_);
+      }
+
+      // Moves the oldest element buffered by `worker` to `out_tensors`.
+      Status TakeOutputLocked(WorkerState* worker,
+                              std::vector<Tensor>* out_tensors)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Status s = worker->outputs.front().status;
+        worker->outputs.front().output.swap(*out_tensors);
+        worker->outputs.pop_front();
+        worker->output_bytes -= ElementBytes(*out_tensors);
+        worker->cond_var.notify_one();
+        return s;
+      }
+
+      // Wakes the main thread if it is waiting for the worker thread
+      // `thread_index` to produce an element.
+      void NotifyOutputLocked(int64 thread_index)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (dataset()->may_reorder()) {
+          any_output_cond_var_.notify_one();
+        } else {
+          workers_[thread_index].cond_var.notify_one();
+        }
+      }
+
+      // Reports the time that the main thread was blocked on the input of
+      // `worker`, which has been exhausted.
+      void RecordInputStallLocked(IteratorContext* ctx, WorkerState* worker)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (stats_aggregator) {
+          stats_aggregator->AddToHistogram(
+              kInputStallMicros, {static_cast<double>(worker->stall_micros)});
+        }
+        worker->stall_micros = 0;
+      }
+
       Status EnsureWorkerThreadsStarted(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (worker_threads_.empty()) {
@@ -711,8 +831,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           if (!iterator_creation_status.ok()) {
             mutex_lock l(mu_);
             // Wait for space in the prefetch queue.
-            while (!cancelled_ && workers_[thread_index].outputs.size() ==
-                                      dataset()->buffer_output_elements_) {
+            while (!cancelled_ &&
+                   OutputBufferFullLocked(workers_[thread_index])) {
               workers_[thread_index].cond_var.wait(l);
             }
             if (cancelled_) return;
@@ -725,7 +845,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
             // CHECKPOINT_MARKER_C
             // Non-OK iterator creation status has been notified to the
             // client.
-            workers_[thread_index].cond_var.notify_one();
+            NotifyOutputLocked(thread_index);
           } else {
             bool end_of_sequence = false;
             while (!end_of_sequence) {
@@ -760,8 +880,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                 mutex_lock l(mu_);
 
                 // Wait for space in the prefetch queue.
-                while (!cancelled_ && workers_[thread_index].outputs.size() ==
-                                          dataset()->buffer_output_elements_) {
+                while (!cancelled_ &&
+                       OutputBufferFullLocked(workers_[thread_index])) {
                   workers_[thread_index].cond_var.wait(l);
                 }
                 if (cancelled_) return;
@@ -782,14 +902,12 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
                       worker_thread_states_[thread_index].output_elem.status);
                   workers_[thread_index].outputs.back().output.swap(
                       worker_thread_states_[thread_index].output_elem.output);
+                  workers_[thread_index].output_bytes += ElementBytes(
+                      workers_[thread_index].outputs.back().output);
                 }
                 worker_thread_states_[thread_index].output_elem.status =
                     Status::OK();
-                if (dataset()->sloppy_) {
-                  sloppy_cond_var_.notify_one();
-                } else {
-                  workers_[thread_index].cond_var.notify_one();
-                }
+                NotifyOutputLocked(thread_index);
                 // CHECKPOINT_MARKER_E
                 // Output element or iterator status has been sent to the
                 // client.
@@ -850,6 +968,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           TF_RETURN_IF_ERROR(ReadOutputElemLocked(
               reader, &workers_[index].outputs.back(),
               full_name(strings::StrCat(worker_prefix, "_outputs_", i))));
+          workers_[index].output_bytes +=
+              ElementBytes(workers_[index].outputs.back().output);
         }
         if (reader->Contains(
                 full_name(strings::StrCat(worker_prefix, "_is_producing")))) {
@@ -1005,9 +1125,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       // Mutex & condition variable to guard mutable iterator internals and
       // coordinate among worker threads and client thread[s].
       mutex mu_ ACQUIRED_BEFORE(ckpt_mu_);
-      // The main thread waits on this condition variable if running in sloppy
-      // mode and no values are available.
-      condition_variable sloppy_cond_var_;
+      // The main thread waits on this condition variable if it may reorder
+      // elements and no values are available.
+      condition_variable any_output_cond_var_;
       // Mutex used to wait for a consistent state while checkpointing.
       // Only Save and Restore require an exclusive lock on this mutex. In
       // other scenarios we just acquire a shared lock so the pipeline's
@@ -1038,6 +1158,10 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
       size_t next_index_ GUARDED_BY(mu_) = 0;
       // The number of items produced so far within the block
       size_t block_count_ GUARDED_BY(mu_) = 0;
+      // The number of items produced out of order since the last item from
+      // the head of the cycle. This is not checkpointed, since reordered
+      // output is not deterministic anyway.
+      int64 reordered_elements_ GUARDED_BY(mu_) = 0;
       // Flag to instruct the worker threads to exit.
       bool cancelled_ GUARDED_BY(mu_) = false;
       // The worker threads. This must be last to ensure the
@@ -1053,7 +1177,9 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
     const int64 block_length_;
     const bool sloppy_;
     const int64 buffer_output_elements_;
+    const int64 buffer_output_bytes_;
     const int64 prefetch_input_elements_;
+    const int64 max_reordering_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
   };
@@ -1062,6 +1188,8 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   NameAttrList interleave_func_;
+  int64 buffer_output_bytes_;
+  int64 max_reordering_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParallelInterleaveDataset").Device(DEVICE_CPU),
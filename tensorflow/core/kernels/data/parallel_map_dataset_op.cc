@@ -54,7 +54,9 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     int32 num_parallel_calls;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                             &num_parallel_calls));
-    OP_REQUIRES(ctx, num_parallel_calls > 0,
+    OP_REQUIRES(ctx,
+                num_parallel_calls > 0 ||
+                    num_parallel_calls == model::kAutoTune,
                 errors::InvalidArgument(
                     "num_parallel_calls must be greater than zero."));
 
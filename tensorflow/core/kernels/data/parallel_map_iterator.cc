@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_map_iterator.h"
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/platform/cpu_info.h"
+
 namespace tensorflow {
 namespace {
 
@@ -33,9 +37,11 @@ class ParallelMapIterator : public DatasetBaseIterator {
         input_dataset_(input_dataset),
         init_func_(std::move(init_func)),
         map_func_(std::move(map_func)),
-        num_parallel_calls_(num_parallel_calls) {}
+        autotune_(num_parallel_calls == model::kAutoTune),
+        num_parallel_calls_(autotune_ ? 1 : num_parallel_calls) {}
 
   ~ParallelMapIterator() override {
+    if (model_node()) model_node()->RemoveParameters();
     // TODO(mrry): Replace this cancellation logic with a
     // CancellationManager. The syntax would be more heavyweight,
     // but it would be possible to thread a cancellation manager
@@ -52,6 +58,23 @@ class ParallelMapIterator : public DatasetBaseIterator {
   }
 
   Status Initialize(IteratorContext* ctx) override {
+    model::Node* node = model_node(ctx);
+    if (node) {
+      node->set_async(true);
+      const int64 min = autotune_ ? 1 : num_parallel_calls_;
+      const int64 max = autotune_ ? port::NumSchedulableCPUs() : min;
+      node->AddParameter(model::kParallelism, num_parallel_calls_, min,
+                         std::max(min, max), [this](int64 value) {
+                           mutex_lock l(mu_);
+                           num_parallel_calls_ = value;
+                           cond_var_.notify_all();
+                         });
+    } else if (autotune_) {
+      // Without a model, as in a function of a pipeline with nothing else to
+      // tune, use one call per core.
+      mutex_lock l(mu_);
+      num_parallel_calls_ = port::NumSchedulableCPUs();
+    }
     TF_RETURN_IF_ERROR(
         input_dataset_->MakeIterator(ctx, prefix(), &input_impl_));
     if (init_func_) {
@@ -195,7 +218,10 @@ class ParallelMapIterator : public DatasetBaseIterator {
     // Call `func_(input_element)`, store the result in
     // `result->return_values`, and notify `result->notification` to unblock
     // a consumer.
-    auto done = [this, result](Status status) {
+    model::Node* node = model_node(ctx.get());
+    const int64 start_nanos = node ? ctx->env()->NowNanos() : 0;
+    auto done = [this, ctx, node, start_nanos, result](Status status) {
+      if (node) node->AddProcessingTime(ctx->env()->NowNanos() - start_nanos);
       result->status.Update(status);
       CallCompleted(result);
     };
@@ -204,7 +230,9 @@ class ParallelMapIterator : public DatasetBaseIterator {
               std::move(done));
   }
 
-  int64 MaxInvocationResults() { return num_parallel_calls_; }
+  int64 MaxInvocationResults() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return num_parallel_calls_;
+  }
 
   Status ProcessResult(const std::shared_ptr<InvocationResult>& result,
                        std::vector<Tensor>* out_tensors,
@@ -226,7 +254,6 @@ class ParallelMapIterator : public DatasetBaseIterator {
 
   void RunnerThread(const std::shared_ptr<IteratorContext>& ctx) {
     std::vector<std::shared_ptr<InvocationResult>> new_calls;
-    new_calls.reserve(num_parallel_calls_);
     while (true) {
       {
         mutex_lock l(mu_);
@@ -294,9 +321,11 @@ class ParallelMapIterator : public DatasetBaseIterator {
   const DatasetBase* const input_dataset_;  // Not owned.
   const std::function<Status(IteratorContext*)> init_func_;
   const ParallelMapIteratorFunction map_func_;
-  const int32 num_parallel_calls_;
+  // Whether `num_parallel_calls_` is chosen by the model.
+  const bool autotune_;
   // Used for coordination between the main thread and the runner thread.
   mutex mu_;
+  int64 num_parallel_calls_ GUARDED_BY(mu_);
   // Used for coordination between the main thread and the runner thread. In
   // particular, the runner thread should only schedule new calls when the
   // number of in-flight calls is less than the user specified level of
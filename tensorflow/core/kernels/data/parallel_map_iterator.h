@@ -33,7 +33,8 @@ using ParallelMapIteratorFunction =
                        std::vector<Tensor>*, StatusCallback)>;
 
 // Returns a new iterator that applies `map_func` to the elements of
-// `input_dataset` using the given degree of parallelism. `init_func` (if
+// `input_dataset` using the given degree of parallelism, or one chosen by the
+// model of the iterator context if it is `model::kAutoTune`. `init_func` (if
 // specified) will be executed when the iterator is initialized (see
 // `IteratorBase::Initialize()`) and enables the user to specify error checking
 // logic that can fail early.
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
@@ -81,6 +82,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       // but it would be possible to thread a cancellation manager
       // through the IteratorContext to upstream,
       // potentially-blocking iterators, when we add these.
+      if (model_node()) model_node()->RemoveParameters();
       {
         mutex_lock l(mu_);
         cancelled_ = true;
@@ -89,6 +91,24 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     }
 
     Status Initialize(IteratorContext* ctx) override {
+      model::Node* node = model_node(ctx);
+      if (node) {
+        node->set_async(true);
+        // With a model, an autotuned buffer size is chosen by the model
+        // rather than by `auto_tuner_`.
+        if (dataset()->buffer_size_ == model::kAutoTune) {
+          {
+            mutex_lock l(mu_);
+            tuned_buffer_limit_ = 1;
+          }
+          node->AddParameter(model::kBufferSize, 1, 1, kint64max,
+                             [this](int64 value) {
+                               mutex_lock l(mu_);
+                               tuned_buffer_limit_ = value;
+                               cond_var_.notify_all();
+                             });
+        }
+      }
       return dataset()->input_->MakeIterator(ctx, prefix(), &input_impl_);
     }
 
@@ -98,10 +118,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
+        model::Node* node = model_node(ctx);
+        if (node) node->RecordBufferGet(buffer_.empty());
         // Wait until the next element in the buffer has been
         // produced, or we are shutting down.
         while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
-               auto_tuner_.buffer_limit() != 0) {
+               BufferLimit() != 0) {
           auto_tuner_.RecordEmpty();
           cond_var_.wait(l);
         }
@@ -120,7 +142,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
 
-        DCHECK_EQ(auto_tuner_.buffer_limit(), 0);
+        DCHECK_EQ(BufferLimit(), 0);
       }
 
       mutex_lock parent_l(parent_mu_);
@@ -220,6 +242,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       return s;
     }
 
+    int64 BufferLimit() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return tuned_buffer_limit_ >= 0 ? tuned_buffer_limit_
+                                      : auto_tuner_.buffer_limit();
+    }
+
     Status EnsurePrefetchThreadStarted(IteratorContext* ctx)
         EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!prefetch_thread_) {
@@ -243,7 +270,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 1. Wait for a slot in the buffer.
         {
           mutex_lock l(mu_);
-          while (!cancelled_ && buffer_.size() >= auto_tuner_.buffer_limit()) {
+          while (!cancelled_ && buffer_.size() >= BufferLimit()) {
             cond_var_.wait(l);
           }
 
@@ -325,6 +352,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(parent_mu_);
     condition_variable cond_var_;
     PrefetchAutotuner auto_tuner_ GUARDED_BY(mu_);
+    // The buffer size chosen by the model, or -1 if it is left to
+    // `auto_tuner_`.
+    int64 tuned_buffer_limit_ GUARDED_BY(mu_) = -1;
     std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
     std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(mu_);
     bool cancelled_ GUARDED_BY(mu_) = false;
@@ -12,12 +12,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <deque>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -500,7 +503,10 @@ REGISTER_KERNEL_BUILDER(Name("FixedLengthRecordDataset").Device(DEVICE_CPU),
 
 class TFRecordDatasetOp : public DatasetOpKernel {
  public:
-  using DatasetOpKernel::DatasetOpKernel;
+  explicit TFRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_index", &use_index_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
     const Tensor* filenames_tensor;
@@ -525,19 +531,24 @@ class TFRecordDatasetOp : public DatasetOpKernel {
     OP_REQUIRES(ctx, buffer_size >= 0,
                 errors::InvalidArgument(
                     "`buffer_size` must be >= 0 (0 == no buffering)"));
+    OP_REQUIRES(ctx, !use_index_ || compression_type.empty(),
+                errors::InvalidArgument(
+                    "Compressed TFRecord files cannot be read by index."));
 
-    *output =
-        new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+    *output = new Dataset(ctx, std::move(filenames), compression_type,
+                          buffer_size, use_index_);
   }
 
  private:
   class Dataset : public DatasetBase {
    public:
     explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                     const string& compression_type, int64 buffer_size)
+                     const string& compression_type, int64 buffer_size,
+                     bool use_index)
         : DatasetBase(DatasetContext(ctx)),
           filenames_(std::move(filenames)),
           compression_type_(compression_type),
+          use_index_(use_index),
           options_(io::RecordReaderOptions::CreateRecordReaderOptions(
               compression_type)) {
       if (buffer_size > 0) {
@@ -547,6 +558,10 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
+      if (use_index_) {
+        return std::unique_ptr<IteratorBase>(new IndexedIterator(
+            {this, strings::StrCat(prefix, "::TFRecord")}));
+      }
       return std::unique_ptr<IteratorBase>(
           new Iterator({this, strings::StrCat(prefix, "::TFRecord")}));
     }
@@ -574,8 +589,11 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
       Node* buffer_size = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-      TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {filenames, compression_type, buffer_size}, output));
+      AttrValue use_index;
+      b->BuildAttrValue(use_index_, &use_index);
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {filenames, compression_type, buffer_size},
+                        {std::make_pair("use_index", use_index)}, output));
       return Status::OK();
     }
 
@@ -681,10 +699,188 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       std::unique_ptr<io::SequentialRecordReader> reader_ GUARDED_BY(mu_);
     };
 
+    // Reads the files by their indexes. Each file is split into chunks of
+    // consecutive records, which are read with a single positional read each
+    // and verified in parallel on the runner, and returned in order.
+    class IndexedIterator : public DatasetIterator<Dataset> {
+     public:
+      explicit IndexedIterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently processing a file, so try to return the next
+          // record.
+          if (reader_) {
+            if (next_record_ < reader_->num_records()) {
+              ScheduleChunksLocked(ctx);
+              std::shared_ptr<Chunk> chunk = chunks_.front();
+              {
+                mutex_lock chunk_l(chunk->mu);
+                while (!chunk->done) {
+                  chunk->cond_var.wait(chunk_l);
+                }
+                TF_RETURN_IF_ERROR(chunk->status);
+                Tensor result_tensor(ctx->allocator({}), DT_STRING, {});
+                result_tensor.scalar<string>()() =
+                    std::move(chunk->records[next_record_ - chunk->begin]);
+                out_tensors->emplace_back(std::move(result_tensor));
+              }
+              if (++next_record_ == chunk->end) {
+                chunks_.pop_front();
+              }
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+
+            // We have reached the end of the current file, so maybe
+            // move on to next file.
+            ResetStreamsLocked();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env(), 0));
+        } while (true);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+
+        if (reader_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("next_record"), next_record_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        ResetStreamsLocked();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        if (reader->Contains(full_name("next_record"))) {
+          int64 next_record;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("next_record"), &next_record));
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env(), next_record));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // The number of bytes of records read at once. Chunks are large enough
+      // to amortize the latency of a read, and enough of them are in flight
+      // to keep a fast local disk busy.
+      static constexpr uint64 kChunkBytes = 4 << 20;
+      static constexpr size_t kMaxChunksInFlight = 8;
+
+      // The read of records [begin, end) of the current file.
+      struct Chunk {
+        int64 begin;
+        int64 end;
+        mutex mu;
+        condition_variable cond_var;
+        bool done GUARDED_BY(mu) = false;
+        Status status GUARDED_BY(mu);
+        std::vector<string> records GUARDED_BY(mu);
+      };
+
+      // Sets up the reader of the file at `current_file_index_`, to return
+      // its records from `first_record` on.
+      Status SetupStreamsLocked(Env* env, int64 first_record)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+
+        const string& next_filename =
+            dataset()->filenames_[current_file_index_];
+        std::unique_ptr<io::IndexedRecordReader> reader;
+        TF_RETURN_IF_ERROR(
+            io::IndexedRecordReader::Open(env, next_filename, &reader));
+        if (first_record < 0 || first_record > reader->num_records()) {
+          return errors::InvalidArgument(
+              "Record ", first_record, " is out of range of the ",
+              reader->num_records(), " records of ", next_filename);
+        }
+        reader_ = std::move(reader);
+        next_record_ = first_record;
+        next_chunk_begin_ = first_record;
+        return Status::OK();
+      }
+
+      // Schedules the reads of the chunks following the last scheduled one.
+      void ScheduleChunksLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_records = reader_->num_records();
+        while (chunks_.size() < kMaxChunksInFlight &&
+               next_chunk_begin_ < num_records) {
+          std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+          chunk->begin = next_chunk_begin_;
+          chunk->end = chunk->begin + 1;
+          const uint64 limit =
+              reader_->record_offset(chunk->begin) + kChunkBytes;
+          while (chunk->end < num_records &&
+                 reader_->record_offset(chunk->end + 1) <= limit) {
+            ++chunk->end;
+          }
+          next_chunk_begin_ = chunk->end;
+          std::shared_ptr<const io::IndexedRecordReader> reader = reader_;
+          (*ctx->runner())([reader, chunk]() {
+            std::vector<string> records;
+            Status s = reader->ReadRecords(chunk->begin, chunk->end, &records);
+            mutex_lock l(chunk->mu);
+            chunk->status = s;
+            chunk->records = std::move(records);
+            chunk->done = true;
+            chunk->cond_var.notify_all();
+          });
+          chunks_.push_back(std::move(chunk));
+        }
+      }
+
+      // Resets the reader. The outstanding reads complete in the background.
+      void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        chunks_.clear();
+        reader_.reset();
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      // Shared with the outstanding reads.
+      std::shared_ptr<const io::IndexedRecordReader> reader_ GUARDED_BY(mu_);
+      // The next record to return.
+      int64 next_record_ GUARDED_BY(mu_) = 0;
+      // The first record of the next chunk to schedule.
+      int64 next_chunk_begin_ GUARDED_BY(mu_) = 0;
+      // The scheduled chunks, the first of which holds `next_record_`.
+      std::deque<std::shared_ptr<Chunk>> chunks_ GUARDED_BY(mu_);
+    };
+
     const std::vector<string> filenames_;
     const string compression_type_;
+    const bool use_index_;
     io::RecordReaderOptions options_;
   };
+
+  bool use_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TFRecordDataset").Device(DEVICE_CPU),
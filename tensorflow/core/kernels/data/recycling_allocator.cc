@@ -0,0 +1,97 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/recycling_allocator.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+RecyclingAllocator::RecyclingAllocator(Allocator* allocator,
+                                       int64 max_cached_buffers)
+    : allocator_(allocator), max_cached_buffers_(max_cached_buffers) {}
+
+RecyclingAllocator::~RecyclingAllocator() {
+  DCHECK(in_use_.empty());
+  for (const Buffer& buffer : cached_) {
+    allocator_->DeallocateRaw(buffer.ptr);
+  }
+}
+
+void* RecyclingAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    // The most recently deallocated buffers are the most likely to still be
+    // in the cache.
+    for (auto it = cached_.rbegin(); it != cached_.rend(); ++it) {
+      if (it->num_bytes == num_bytes && it->alignment == alignment) {
+        const Buffer buffer = *it;
+        cached_.erase(std::next(it).base());
+        in_use_[buffer.ptr] = buffer;
+        ++ref_;
+        return buffer.ptr;
+      }
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  mutex_lock l(mu_);
+  in_use_[ptr] = {ptr, alignment, num_bytes};
+  ++ref_;
+  return ptr;
+}
+
+void RecyclingAllocator::DeallocateRaw(void* ptr) {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    auto it = in_use_.find(ptr);
+    CHECK(it != in_use_.end()) << "Deallocating a buffer of another allocator";
+    cached_.push_back(it->second);
+    in_use_.erase(it);
+    if (cached_.size() > max_cached_buffers_) {
+      allocator_->DeallocateRaw(cached_.front().ptr);
+      cached_.pop_front();
+    }
+    should_delete = UnrefLocked();
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+void RecyclingAllocator::Unref() {
+  bool should_delete;
+  {
+    mutex_lock l(mu_);
+    should_delete = UnrefLocked();
+  }
+  if (should_delete) {
+    delete this;
+  }
+}
+
+int64 RecyclingAllocator::num_cached_buffers() {
+  mutex_lock l(mu_);
+  return cached_.size();
+}
+
+bool RecyclingAllocator::UnrefLocked() {
+  DCHECK_GT(ref_, 0);
+  return --ref_ == 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_RECYCLING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_RECYCLING_ALLOCATOR_H_
+
+#include <deque>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The number of batches whose buffers batching iterators keep for reuse.
+constexpr int64 kNumRecycledBatches = 4;
+
+// An allocator that keeps the buffers that are deallocated through it, and
+// hands them out again for allocations of the same size, instead of going
+// back to the wrapped allocator.
+//
+// Batching iterators allocate their batches through one, since they allocate
+// buffers of the same sizes over and over: once the consumers of the first
+// batches have released them, the buffers of the following batches are
+// recycled, which saves the allocator calls and the page faults of freshly
+// allocated memory. At most `max_cached_buffers` buffers are kept, the most
+// recently deallocated ones.
+//
+// Tensors allocated through the allocator may outlive its owner. The owner
+// calls Unref() instead of deleting the allocator, which deletes itself once
+// all the buffers it allocated have been deallocated.
+class RecyclingAllocator : public Allocator {
+ public:
+  RecyclingAllocator(Allocator* allocator, int64 max_cached_buffers);
+
+  string Name() override { return allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  // Releases the reference of the owner.
+  void Unref() LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of buffers that are kept for later allocations.
+  int64 num_cached_buffers() LOCKS_EXCLUDED(mu_);
+
+ protected:
+  ~RecyclingAllocator() override;
+
+ private:
+  struct Buffer {
+    void* ptr;
+    size_t alignment;
+    size_t num_bytes;
+  };
+
+  // Returns whether the allocator should be deleted.
+  bool UnrefLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const allocator_;  // Not owned.
+  const int64 max_cached_buffers_;
+
+  mutex mu_;
+  // The reference of the owner, plus one for every allocated buffer.
+  int64 ref_ GUARDED_BY(mu_) = 1;
+  std::unordered_map<void*, Buffer> in_use_ GUARDED_BY(mu_);
+  // The cached buffers, from the least to the most recently deallocated.
+  std::deque<Buffer> cached_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecyclingAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_RECYCLING_ALLOCATOR_H_
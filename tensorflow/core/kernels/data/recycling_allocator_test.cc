@@ -0,0 +1,91 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/recycling_allocator.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const void* DataOf(const Tensor& t) { return t.tensor_data().data(); }
+
+TEST(RecyclingAllocatorTest, RecyclesBuffersOfTheSameSize) {
+  RecyclingAllocator* allocator =
+      new RecyclingAllocator(cpu_allocator(), /*max_cached_buffers=*/4);
+  const void* data;
+  {
+    Tensor t(allocator, DT_FLOAT, TensorShape({32, 8}));
+    data = DataOf(t);
+  }
+  EXPECT_EQ(1, allocator->num_cached_buffers());
+  {
+    // A buffer of another size is allocated afresh.
+    Tensor other(allocator, DT_FLOAT, TensorShape({32, 4}));
+    EXPECT_NE(data, DataOf(other));
+    EXPECT_EQ(1, allocator->num_cached_buffers());
+
+    Tensor t(allocator, DT_FLOAT, TensorShape({32, 8}));
+    EXPECT_EQ(data, DataOf(t));
+    EXPECT_EQ(0, allocator->num_cached_buffers());
+  }
+  EXPECT_EQ(2, allocator->num_cached_buffers());
+  allocator->Unref();
+}
+
+TEST(RecyclingAllocatorTest, RecyclesStringBuffers) {
+  RecyclingAllocator* allocator =
+      new RecyclingAllocator(cpu_allocator(), /*max_cached_buffers=*/4);
+  {
+    Tensor t(allocator, DT_STRING, TensorShape({2}));
+    t.vec<string>()(0) = string(1000, 'a');
+    t.vec<string>()(1) = "b";
+  }
+  Tensor t(allocator, DT_STRING, TensorShape({2}));
+  // The strings are constructed anew in the recycled buffer.
+  EXPECT_TRUE(t.vec<string>()(0).empty());
+  EXPECT_TRUE(t.vec<string>()(1).empty());
+  allocator->Unref();
+}
+
+TEST(RecyclingAllocatorTest, KeepsTheMostRecentlyDeallocatedBuffers) {
+  RecyclingAllocator* allocator =
+      new RecyclingAllocator(cpu_allocator(), /*max_cached_buffers=*/2);
+  std::vector<Tensor> tensors;
+  for (int64 i = 1; i <= 3; ++i) {
+    tensors.emplace_back(allocator, DT_INT64, TensorShape({i}));
+  }
+  const void* last = DataOf(tensors[2]);
+  tensors.clear();
+  EXPECT_EQ(2, allocator->num_cached_buffers());
+  Tensor t(allocator, DT_INT64, TensorShape({3}));
+  EXPECT_EQ(last, DataOf(t));
+  allocator->Unref();
+}
+
+TEST(RecyclingAllocatorTest, BuffersOutliveTheOwner) {
+  RecyclingAllocator* allocator =
+      new RecyclingAllocator(cpu_allocator(), /*max_cached_buffers=*/4);
+  Tensor t(allocator, DT_INT32, TensorShape({4}));
+  allocator->Unref();
+  // The allocator deletes itself once `t` is released.
+  t.flat<int32>().setConstant(7);
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({7, 7, 7, 7}), t);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -59,6 +59,14 @@ class ThreadPool {
   // Schedules fn() for execution in the pool of threads.
   void Schedule(std::function<void()> fn);
 
+  // Like Schedule(), but if called from a thread outside of the pool, puts
+  // fn() in the queue of one of the threads in [start, limit). A thread of
+  // the pool always puts fn() in its own queue. In both cases idle threads
+  // may steal fn() from the queue it was put in.
+  //
+  // REQUIRES: 0 <= start < limit <= NumThreads()
+  void ScheduleWithHint(std::function<void()> fn, int start, int limit);
+
   // ParallelFor shards the "total" units of work assuming each unit of work
   // having roughly "cost_per_unit" cost, in cycles. Each unit of work is
   // indexed 0, 1, ..., total - 1. Each shard contains 1 or more units of work
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -61,6 +62,49 @@ TEST(ThreadPool, DoWork) {
   }
 }
 
+TEST(ThreadPool, ScheduleWithHint) {
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    const int kWorkItems = 15;
+    std::atomic<int> work[kWorkItems];
+    for (int i = 0; i < kWorkItems; i++) {
+      work[i] = 0;
+    }
+    {
+      ThreadPool pool(Env::Default(), "test", num_threads);
+      for (int i = 0; i < kWorkItems; i++) {
+        const int hint = i % num_threads;
+        pool.ScheduleWithHint(
+            [&pool, &work, i]() {
+              // Work scheduled from inside the pool goes to the local queue.
+              pool.ScheduleWithHint([&work, i]() { work[i]++; }, 0, 1);
+              work[i]++;
+            },
+            hint, hint + 1);
+      }
+    }
+    for (int i = 0; i < kWorkItems; i++) {
+      ASSERT_EQ(2, work[i].load());
+    }
+  }
+}
+
+TEST(ThreadPool, NumaNodeAffinity) {
+  if (!port::NUMAEnabled()) return;
+  for (int node = 0; node < port::NUMANumNodes(); ++node) {
+    std::atomic<int> affinity(port::kNUMANoAffinity);
+    {
+      ThreadOptions thread_options;
+      thread_options.numa_node = node;
+      ThreadPool pool(Env::Default(), thread_options, "test", 2);
+      pool.Schedule([&affinity]() {
+        affinity.store(port::NUMAGetThreadNodeAffinity());
+      });
+    }
+    EXPECT_EQ(node, affinity.load());
+  }
+}
+
 TEST(ThreadPool, ParallelFor) {
   Context outer_context(ContextKind::kThread);
   // Make ParallelFor use as many threads as possible.
@@ -0,0 +1,219 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <string.h>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace io {
+
+const char kRecordIndexSuffix[] = ".idx";
+const char kRecordIndexMagic[] = "TFRIDX01";
+
+namespace {
+
+// The sizes of the header and the footer of a record; see RecordWriter.
+constexpr uint64 kHeaderSize = sizeof(uint64) + sizeof(uint32);
+constexpr uint64 kFooterSize = sizeof(uint32);
+
+// The buffer size of the scan of a file by BuildRecordIndex().
+constexpr int64 kBuildBufferSize = 256 << 10;
+
+bool HasValidChecksum(const char* data, size_t n) {
+  const uint32 masked_crc = core::DecodeFixed32(data + n);
+  return crc32c::Unmask(masked_crc) == crc32c::Value(data, n);
+}
+
+Status WriteRecordIndex(RandomAccessFile* file, WritableFile* index_file) {
+  RecordReaderOptions options;
+  options.buffer_size = kBuildBufferSize;
+  RecordReader reader(file, options);
+  RecordIndexWriter writer(index_file);
+  uint64 offset = 0;
+  string record;
+  while (true) {
+    const uint64 record_offset = offset;
+    Status s = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    TF_RETURN_IF_ERROR(writer.Add(record_offset));
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  return index_file->Close();
+}
+
+}  // namespace
+
+string RecordIndexFilename(const string& filename) {
+  return strings::StrCat(filename, kRecordIndexSuffix);
+}
+
+RecordIndexWriter::RecordIndexWriter(WritableFile* dest) : dest_(dest) {}
+
+Status RecordIndexWriter::Add(uint64 offset) {
+  TF_RETURN_IF_ERROR(MaybeWriteHeader());
+  char entry[sizeof(uint64)];
+  core::EncodeFixed64(entry, offset);
+  return dest_->Append(StringPiece(entry, sizeof(entry)));
+}
+
+Status RecordIndexWriter::Finish() { return MaybeWriteHeader(); }
+
+Status RecordIndexWriter::MaybeWriteHeader() {
+  if (header_written_) return Status::OK();
+  TF_RETURN_IF_ERROR(dest_->Append(kRecordIndexMagic));
+  header_written_ = true;
+  return Status::OK();
+}
+
+Status BuildRecordIndex(Env* env, const string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  // The index is renamed into place once it is complete, so that readers
+  // never see a partial index.
+  const string index_filename = RecordIndexFilename(filename);
+  const string tmp_filename = strings::StrCat(index_filename, ".tmp");
+  std::unique_ptr<WritableFile> index_file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &index_file));
+  Status s = WriteRecordIndex(file.get(), index_file.get());
+  if (s.ok()) {
+    s = env->RenameFile(tmp_filename, index_filename);
+  }
+  if (!s.ok()) {
+    index_file.reset();
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+/* static */
+Status IndexedRecordReader::Open(Env* env, const string& filename,
+                                 std::unique_ptr<IndexedRecordReader>* reader) {
+  const string index_filename = RecordIndexFilename(filename);
+  string index;
+  Status s = ReadFileToString(env, index_filename, &index);
+  if (errors::IsNotFound(s)) {
+    return errors::NotFound("The TFRecord file ", filename,
+                            " has no index file ", index_filename, ".");
+  }
+  TF_RETURN_IF_ERROR(s);
+  const size_t magic_size = strlen(kRecordIndexMagic);
+  if (index.size() < magic_size ||
+      StringPiece(index.data(), magic_size) != kRecordIndexMagic ||
+      (index.size() - magic_size) % sizeof(uint64) != 0) {
+    return errors::DataLoss("Corrupted record index ", index_filename);
+  }
+
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  const size_t num_records = (index.size() - magic_size) / sizeof(uint64);
+  std::vector<uint64> offsets;
+  offsets.reserve(num_records + 1);
+  // Every record takes at least a header and a footer, and the records are
+  // contiguous from the start of the file.
+  uint64 min_offset = 0;
+  for (size_t i = 0; i < num_records; ++i) {
+    const uint64 offset = core::DecodeFixed64(index.data() + magic_size +
+                                              i * sizeof(uint64));
+    if (file_size < kHeaderSize + kFooterSize || (i == 0 && offset != 0) ||
+        offset < min_offset ||
+        offset > file_size - kHeaderSize - kFooterSize) {
+      return errors::DataLoss("The record index ", index_filename,
+                              " does not match ", filename, ".");
+    }
+    offsets.push_back(offset);
+    min_offset = offset + kHeaderSize + kFooterSize;
+  }
+  if (num_records == 0 && file_size != 0) {
+    return errors::DataLoss("The record index ", index_filename,
+                            " does not match ", filename, ".");
+  }
+  offsets.push_back(file_size);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  reader->reset(
+      new IndexedRecordReader(filename, std::move(file), std::move(offsets)));
+  return Status::OK();
+}
+
+IndexedRecordReader::IndexedRecordReader(const string& filename,
+                                         std::unique_ptr<RandomAccessFile> file,
+                                         std::vector<uint64> offsets)
+    : filename_(filename),
+      file_(std::move(file)),
+      offsets_(std::move(offsets)) {}
+
+Status IndexedRecordReader::ReadRecord(int64 index, string* record) const {
+  std::vector<string> records;
+  TF_RETURN_IF_ERROR(ReadRecords(index, index + 1, &records));
+  *record = std::move(records[0]);
+  return Status::OK();
+}
+
+Status IndexedRecordReader::ReadRecords(int64 begin, int64 end,
+                                        std::vector<string>* records) const {
+  if (begin < 0 || begin > end || end > num_records()) {
+    return errors::OutOfRange("Records [", begin, ", ", end,
+                              ") are out of range of the ", num_records(),
+                              " records of ", filename_);
+  }
+  if (begin == end) return Status::OK();
+
+  const uint64 offset = offsets_[begin];
+  const size_t n = offsets_[end] - offset;
+  string scratch;
+  scratch.resize(n);
+  StringPiece data;
+  Status s = file_->Read(offset, n, &data, &scratch[0]);
+  if (data.size() != n) {
+    if (s.ok() || errors::IsOutOfRange(s)) {
+      return errors::DataLoss("truncated record at ", offset, " of ",
+                              filename_);
+    }
+    return s;
+  }
+
+  records->reserve(records->size() + (end - begin));
+  for (int64 i = begin; i < end; ++i) {
+    const char* record = data.data() + (offsets_[i] - offset);
+    const uint64 size = offsets_[i + 1] - offsets_[i];
+    if (!HasValidChecksum(record, sizeof(uint64))) {
+      return errors::DataLoss("corrupted record at ", offsets_[i], " of ",
+                              filename_);
+    }
+    const uint64 length = core::DecodeFixed64(record);
+    if (length != size - kHeaderSize - kFooterSize) {
+      return errors::DataLoss("The record at ", offsets_[i], " of ", filename_,
+                              " does not match its index.");
+    }
+    if (!HasValidChecksum(record + kHeaderSize, length)) {
+      return errors::DataLoss("corrupted record at ", offsets_[i], " of ",
+                              filename_);
+    }
+    records->emplace_back(record + kHeaderSize, length);
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
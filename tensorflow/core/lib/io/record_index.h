@@ -0,0 +1,119 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// The index of a TFRecord file holds the offset of every record in the file,
+// so that the records can be read in parallel, or at random, without
+// scanning the file. Only uncompressed files can be indexed.
+//
+// The index is stored in a sidecar file, named after the TFRecord file with
+// `kRecordIndexSuffix` appended. It consists of the 8 bytes of
+// `kRecordIndexMagic`, followed by the fixed64 offset of each record, in
+// order.
+
+extern const char kRecordIndexSuffix[];
+extern const char kRecordIndexMagic[];
+
+// Returns the name of the index file of the TFRecord file `filename`.
+string RecordIndexFilename(const string& filename);
+
+// Writes an index to a file.
+//
+// Note: this class is not thread safe; external synchronization required.
+class RecordIndexWriter {
+ public:
+  // Create a writer that will append the index to "*dest".
+  // "*dest" must be initially empty.
+  // "*dest" must remain live while this Writer is in use.
+  explicit RecordIndexWriter(WritableFile* dest);
+
+  // Adds the offset of the next record, which must be greater than the
+  // offsets added before.
+  Status Add(uint64 offset);
+
+  // Writes the header of an index without records, if nothing was added.
+  // Does *not* close the WritableFile.
+  Status Finish();
+
+ private:
+  Status MaybeWriteHeader();
+
+  WritableFile* const dest_;
+  bool header_written_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordIndexWriter);
+};
+
+// Scans the uncompressed TFRecord file `filename`, verifying the checksums of
+// its records, and writes its index file.
+Status BuildRecordIndex(Env* env, const string& filename);
+
+// Reads the records of an uncompressed TFRecord file by its index.
+//
+// A range of records is read with a single positional read of the file, and
+// every method is thread safe, so that ranges can be read and verified in
+// parallel.
+class IndexedRecordReader {
+ public:
+  // Opens `filename` and reads its index file.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<IndexedRecordReader>* reader);
+
+  // Returns the number of records in the file.
+  int64 num_records() const { return offsets_.size() - 1; }
+
+  // Returns the offset of record `index` in the file, or the size of the file
+  // if `index` is `num_records()`.
+  uint64 record_offset(int64 index) const { return offsets_[index]; }
+
+  // Reads record `index` into `*record`. Returns OUT_OF_RANGE if there is no
+  // such record.
+  Status ReadRecord(int64 index, string* record) const;
+
+  // Reads records [begin, end) and appends them to `*records`, returning
+  // DATA_LOSS if a record is corrupted or does not match the index.
+  Status ReadRecords(int64 begin, int64 end,
+                     std::vector<string>* records) const;
+
+ private:
+  IndexedRecordReader(const string& filename,
+                      std::unique_ptr<RandomAccessFile> file,
+                      std::vector<uint64> offsets);
+
+  const string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  // The offsets of the records, followed by the size of the file.
+  const std::vector<uint64> offsets_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
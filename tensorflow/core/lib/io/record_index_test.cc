@@ -0,0 +1,145 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+std::vector<string> Records(int num_records) {
+  std::vector<string> records;
+  for (int i = 0; i < num_records; ++i) {
+    records.push_back(string(i * 7, 'a' + i % 26));
+  }
+  return records;
+}
+
+// Writes `records` to `filename`, with its index if `write_index`.
+void WriteRecords(const string& filename, const std::vector<string>& records,
+                  bool write_index) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(filename, &file));
+  std::unique_ptr<WritableFile> index_file;
+  if (write_index) {
+    TF_ASSERT_OK(
+        env->NewWritableFile(RecordIndexFilename(filename), &index_file));
+  }
+  RecordWriter writer(file.get(), RecordWriterOptions(), index_file.get());
+  for (const string& record : records) {
+    TF_ASSERT_OK(writer.WriteRecord(record));
+  }
+  TF_ASSERT_OK(writer.Close());
+  TF_ASSERT_OK(file->Close());
+  if (index_file != nullptr) {
+    TF_ASSERT_OK(index_file->Close());
+  }
+}
+
+void ExpectRecords(const string& filename,
+                   const std::vector<string>& expected) {
+  std::unique_ptr<IndexedRecordReader> reader;
+  TF_ASSERT_OK(IndexedRecordReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(expected.size(), reader->num_records());
+  std::vector<string> records;
+  TF_ASSERT_OK(reader->ReadRecords(0, reader->num_records(), &records));
+  EXPECT_EQ(expected, records);
+  // Random access, from the back.
+  for (int64 i = reader->num_records() - 1; i >= 0; --i) {
+    string record;
+    TF_ASSERT_OK(reader->ReadRecord(i, &record));
+    EXPECT_EQ(expected[i], record);
+  }
+  string record;
+  EXPECT_TRUE(errors::IsOutOfRange(
+      reader->ReadRecord(reader->num_records(), &record)));
+}
+
+TEST(RecordIndexTest, WrittenByRecordWriter) {
+  const string filename = io::JoinPath(testing::TmpDir(), "written_index");
+  const std::vector<string> records = Records(30);
+  WriteRecords(filename, records, true);
+  ExpectRecords(filename, records);
+
+  std::unique_ptr<IndexedRecordReader> reader;
+  TF_ASSERT_OK(IndexedRecordReader::Open(Env::Default(), filename, &reader));
+  std::vector<string> range;
+  TF_ASSERT_OK(reader->ReadRecords(10, 13, &range));
+  EXPECT_EQ(std::vector<string>(records.begin() + 10, records.begin() + 13),
+            range);
+  EXPECT_EQ(0, reader->record_offset(0));
+  EXPECT_LT(reader->record_offset(10), reader->record_offset(11));
+}
+
+TEST(RecordIndexTest, BuiltOffline) {
+  const string filename = io::JoinPath(testing::TmpDir(), "built_index");
+  const std::vector<string> records = Records(30);
+  WriteRecords(filename, records, false);
+  std::unique_ptr<IndexedRecordReader> reader;
+  EXPECT_TRUE(errors::IsNotFound(
+      IndexedRecordReader::Open(Env::Default(), filename, &reader)));
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename));
+  ExpectRecords(filename, records);
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const string filename = io::JoinPath(testing::TmpDir(), "empty_index");
+  WriteRecords(filename, {}, true);
+  ExpectRecords(filename, {});
+  TF_ASSERT_OK(BuildRecordIndex(Env::Default(), filename));
+  ExpectRecords(filename, {});
+}
+
+TEST(RecordIndexTest, DetectsCorruption) {
+  const string filename = io::JoinPath(testing::TmpDir(), "corrupted_index");
+  WriteRecords(filename, Records(10), true);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  std::unique_ptr<IndexedRecordReader> reader;
+  TF_ASSERT_OK(IndexedRecordReader::Open(Env::Default(), filename, &reader));
+  // Flip a byte of the payload of record 5.
+  const uint64 offset = reader->record_offset(5) + 12;
+  contents[offset] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  TF_ASSERT_OK(IndexedRecordReader::Open(Env::Default(), filename, &reader));
+  string record;
+  TF_EXPECT_OK(reader->ReadRecord(4, &record));
+  EXPECT_TRUE(errors::IsDataLoss(reader->ReadRecord(5, &record)));
+  std::vector<string> records;
+  EXPECT_TRUE(errors::IsDataLoss(reader->ReadRecords(0, 10, &records)));
+
+  // An index of another file does not match.
+  contents[offset] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 strings::StrCat(contents, contents)));
+  TF_ASSERT_OK(IndexedRecordReader::Open(Env::Default(), filename, &reader));
+  EXPECT_TRUE(errors::IsDataLoss(reader->ReadRecord(9, &record)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
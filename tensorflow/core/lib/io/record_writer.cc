@@ -56,7 +56,18 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
+    : RecordWriter(dest, options, nullptr) {}
+
+RecordWriter::RecordWriter(WritableFile* dest,
+                           const RecordWriterOptions& options,
+                           WritableFile* index_dest)
     : dest_(dest), options_(options) {
+  if (index_dest != nullptr) {
+    if (options.compression_type != RecordWriterOptions::NONE) {
+      LOG(FATAL) << "Record indexes are unsupported with compression.";
+    }
+    index_writer_.reset(new RecordIndexWriter(index_dest));
+  }
   if (IsZlibCompressed(options)) {
 // We don't have zlib available on all embedded platforms, so fail.
 #if defined(IS_SLIM_BUILD)
@@ -111,11 +122,20 @@ Status RecordWriter::WriteRecord(StringPiece data) {
 
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (index_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(index_writer_->Add(offset_));
+  }
+  offset_ += sizeof(header) + data.size() + sizeof(footer);
+  return Status::OK();
 }
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
+  if (index_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(index_writer_->Finish());
+    index_writer_.reset();
+  }
 #if !defined(IS_SLIM_BUILD)
   if (IsZlibCompressed(options_)) {
     Status s = dest_->Close();
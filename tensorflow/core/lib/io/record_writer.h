@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
@@ -53,6 +54,14 @@ class RecordWriter {
   RecordWriter(WritableFile* dest,
                const RecordWriterOptions& options = RecordWriterOptions());
 
+  // Create a writer that will also append the index of the records to
+  // "*index_dest" (see record_index.h), unless "index_dest" is null.
+  // Indexes are only supported without compression.
+  // "*index_dest" must be initially empty.
+  // "*index_dest" must remain live while this Writer is in use.
+  RecordWriter(WritableFile* dest, const RecordWriterOptions& options,
+               WritableFile* index_dest);
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -66,7 +75,8 @@ class RecordWriter {
   // WritableFile.
   Status Flush();
 
-  // Writes all output to the file. Does *not* close the WritableFile.
+  // Writes all output to the file, and to the index file if any. Does *not*
+  // close the WritableFiles.
   //
   // After calling Close(), any further calls to `WriteRecord()` or `Flush()`
   // are invalid.
@@ -75,6 +85,9 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  std::unique_ptr<RecordIndexWriter> index_writer_;
+  // The number of bytes written, which is the offset of the next record.
+  uint64 offset_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
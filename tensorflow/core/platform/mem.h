@@ -29,6 +29,19 @@ namespace port {
 void* AlignedMalloc(size_t size, int minimum_alignment);
 void AlignedFree(void* aligned_memory);
 
+// Allocates "size" bytes, for use as a large region of a BFCAllocator or
+// similar, from memory that the platform is asked to back with huge pages:
+// explicitly reserved huge pages if any are available, transparent huge
+// pages otherwise. If "node" is not kNUMANoAffinity, the memory prefers that
+// NUMA node. If "prefault" is true, the memory is faulted in before this
+// returns, rather than on first touch.
+//
+// Platforms without huge page support fall back to AlignedMalloc.
+// Memory allocated by HugePageMalloc must be freed via HugePageFree.
+void* HugePageMalloc(int node, size_t size, int minimum_alignment,
+                     bool prefault);
+void HugePageFree(void* ptr, size_t size);
+
 void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
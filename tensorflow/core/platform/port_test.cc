@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -33,6 +34,21 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, HugePageMalloc) {
+  for (bool prefault : {false, true}) {
+    const size_t size = (3 << 20) + 100;
+    char* p = static_cast<char*>(HugePageMalloc(kNUMANoAffinity, size, 64,
+                                                prefault));
+    ASSERT_TRUE(p != nullptr) << "HugePageMalloc(" << size << ")";
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % 64, 0);
+    p[0] = 1;
+    p[size - 1] = 2;
+    EXPECT_EQ(1, p[0]);
+    EXPECT_EQ(2, p[size - 1]);
+    HugePageFree(p, size);
+  }
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
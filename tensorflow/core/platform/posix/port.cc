@@ -28,12 +28,16 @@ limitations under the License.
 
 #if defined(__linux__) && !defined(__ANDROID__)
 #include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
 #endif
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <vector>
 #ifdef TF_USE_SNAPPY
 #include "snappy.h"
 #endif
@@ -78,6 +82,102 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// Memory policy constants from <numaif.h>, which is part of libnuma rather
+// than of the C library.
+constexpr int kMPOLPreferred = 1;
+constexpr int kMPOLFNode = 1 << 0;
+constexpr int kMPOLFAddr = 1 << 1;
+// Size in bits of the node masks passed to mbind.
+constexpr int kMaxNUMANodes = 8 * sizeof(unsigned long);
+
+// Parses a sysfs CPU list such as "0-7,16-23" into *cpus.
+bool ParseCPUList(const char* list, cpu_set_t* cpus) {
+  CPU_ZERO(cpus);
+  const char* p = list;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const long first = strtol(p, &end, 10);
+    if (end == p) return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p) return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+      CPU_SET(cpu, cpus);
+    }
+    if (*p == ',') ++p;
+  }
+  return true;
+}
+
+// The CPUs of each NUMA node, as exposed by sysfs. Empty if the topology
+// cannot be read. Nodes are assumed to be numbered contiguously from 0.
+const std::vector<cpu_set_t>& NUMANodeCPUs() {
+  static const std::vector<cpu_set_t>* node_cpus = [] {
+    auto* result = new std::vector<cpu_set_t>;
+    for (int node = 0; node < kMaxNUMANodes; ++node) {
+      char path[64];
+      snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+               node);
+      FILE* file = fopen(path, "r");
+      if (file == nullptr) break;
+      char list[4096];
+      cpu_set_t cpus;
+      const bool ok = fgets(list, sizeof(list), file) != nullptr &&
+                      ParseCPUList(list, &cpus);
+      fclose(file);
+      if (!ok) break;
+      result->push_back(cpus);
+    }
+    return result;
+  }();
+  return *node_cpus;
+}
+
+// Node set by NUMASetThreadNodeAffinity for the current thread.
+thread_local int thread_numa_node = kNUMANoAffinity;
+
+}  // namespace
+
+bool NUMAEnabled() { return !NUMANodeCPUs().empty(); }
+
+int NUMANumNodes() {
+  const int num_nodes = NUMANodeCPUs().size();
+  return num_nodes > 0 ? num_nodes : 1;
+}
+
+void NUMASetThreadNodeAffinity(int node) {
+  const std::vector<cpu_set_t>& node_cpus = NUMANodeCPUs();
+  cpu_set_t cpus;
+  if (node == kNUMANoAffinity) {
+    CPU_ZERO(&cpus);
+    for (const cpu_set_t& n : node_cpus) {
+      CPU_OR(&cpus, &cpus, &n);
+    }
+  } else if (node >= 0 && node < static_cast<int>(node_cpus.size())) {
+    cpus = node_cpus[node];
+  } else {
+    LOG(ERROR) << "NUMASetThreadNodeAffinity: invalid node " << node;
+    return;
+  }
+  if (CPU_COUNT(&cpus) == 0) return;
+  if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+    LOG(ERROR) << "NUMASetThreadNodeAffinity: sched_setaffinity failed with "
+               << strerror(errno);
+    return;
+  }
+  thread_numa_node = node;
+}
+
+int NUMAGetThreadNodeAffinity() { return thread_numa_node; }
+#else
 bool NUMAEnabled() {
   // Not yet implemented: coming soon.
   return false;
@@ -90,6 +190,7 @@ void NUMASetThreadNodeAffinity(int node) {}
 int NUMAGetThreadNodeAffinity() {
   return kNUMANoAffinity;
 }
+#endif  // defined(__linux__) && !defined(__ANDROID__)
 
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #if defined(__ANDROID__)
@@ -140,6 +241,123 @@ void Free(void* ptr) {
 #endif
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// Sets a preferred policy for node "node" on the pages of [ptr, ptr + size),
+// which must be page-aligned. Does nothing if "node" is not a valid node.
+void BindToNUMANode(void* ptr, size_t size, int node) {
+  if (node < 0 || node >= NUMANumNodes()) return;
+  unsigned long node_mask = 1UL << node;
+  if (syscall(SYS_mbind, ptr, size, kMPOLPreferred, &node_mask,
+              kMaxNUMANodes + 1, 0) != 0) {
+    VLOG(1) << "mbind failed with " << strerror(errno);
+  }
+}
+
+}  // namespace
+
+// When NUMA is enabled, memory is mapped directly so that a placement policy
+// can be attached to whole pages. Every call maps, binds and later unmaps its
+// own page-rounded region, so callers should only use it for large blocks:
+// BasicCPUAllocator serves blocks under 1MB from the heap instead. The policy
+// is "preferred" rather than "bind" so that allocation still succeeds once
+// the node runs out of memory.
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  if (!NUMAEnabled()) return AlignedMalloc(size, minimum_alignment);
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  if (minimum_alignment > static_cast<int>(page_size)) {
+    LOG(ERROR) << "NUMAMalloc: alignment " << minimum_alignment
+               << " exceeds the page size";
+    return nullptr;
+  }
+  const size_t mapped_size = (size + page_size - 1) / page_size * page_size;
+  void* ptr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) return nullptr;
+  BindToNUMANode(ptr, mapped_size, node);
+  return ptr;
+}
+
+void NUMAFree(void* ptr, size_t size) {
+  if (!NUMAEnabled()) {
+    Free(ptr);
+    return;
+  }
+  if (ptr == nullptr) return;
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  munmap(ptr, (size + page_size - 1) / page_size * page_size);
+}
+
+int NUMAGetMemAffinity(const void* addr) {
+  if (!NUMAEnabled()) return kNUMANoAffinity;
+  int node = kNUMANoAffinity;
+  if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr,
+              kMPOLFNode | kMPOLFAddr) != 0) {
+    return kNUMANoAffinity;
+  }
+  return node;
+}
+
+namespace {
+
+constexpr size_t kHugePageSize = 2 << 20;
+
+size_t HugePageMappedSize(size_t size) {
+  return (size + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+}
+
+}  // namespace
+
+void* HugePageMalloc(int node, size_t size, int minimum_alignment,
+                     bool prefault) {
+  if (minimum_alignment > static_cast<int>(kHugePageSize)) {
+    LOG(ERROR) << "HugePageMalloc: alignment " << minimum_alignment
+               << " exceeds the huge page size";
+    return nullptr;
+  }
+  const size_t mapped_size = HugePageMappedSize(size);
+  const int populate = prefault ? MAP_POPULATE : 0;
+  // Explicit huge pages are only available if the administrator reserved
+  // some, and are placed at allocation time, so the node policy can only be
+  // honored for transparent huge pages.
+  if (node == kNUMANoAffinity) {
+    void* ptr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1,
+                     0);
+    if (ptr != MAP_FAILED) return ptr;
+  }
+  // Maps one more huge page than needed, and trims the mapping so that it
+  // starts and ends on huge page boundaries.
+  char* mapped = static_cast<char*>(
+      mmap(nullptr, mapped_size + kHugePageSize, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (mapped == MAP_FAILED) return nullptr;
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(mapped);
+  char* ptr = mapped + (kHugePageSize - addr % kHugePageSize) % kHugePageSize;
+  char* mapped_end = mapped + mapped_size + kHugePageSize;
+  if (ptr > mapped) munmap(mapped, ptr - mapped);
+  munmap(ptr + mapped_size, mapped_end - (ptr + mapped_size));
+  if (madvise(ptr, mapped_size, MADV_HUGEPAGE) != 0) {
+    VLOG(1) << "HugePageMalloc: madvise failed with " << strerror(errno);
+  }
+  BindToNUMANode(ptr, mapped_size, node);
+  if (prefault) {
+    // Touching the pages after madvise and mbind faults them in as huge pages
+    // on the requested node.
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < mapped_size; offset += page_size) {
+      ptr[offset] = 0;
+    }
+  }
+  return ptr;
+}
+
+void HugePageFree(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+  munmap(ptr, HugePageMappedSize(size));
+}
+#else
 void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
   return AlignedMalloc(size, minimum_alignment);
 }
@@ -150,6 +368,16 @@ int NUMAGetMemAffinity(const void* addr) {
   return kNUMANoAffinity;
 }
 
+void* HugePageMalloc(int node, size_t size, int minimum_alignment,
+                     bool prefault) {
+  void* ptr = AlignedMalloc(size, minimum_alignment);
+  if (ptr != nullptr && prefault) memset(ptr, 0, size);
+  return ptr;
+}
+
+void HugePageFree(void* ptr, size_t size) { AlignedFree(ptr); }
+#endif  // defined(__linux__) && !defined(__ANDROID__)
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
@@ -128,6 +128,15 @@ void NUMAFree(void* ptr, size_t size) { Free(ptr); }
 
 int NUMAGetMemAffinity(const void* addr) { return kNUMANoAffinity; }
 
+void* HugePageMalloc(int node, size_t size, int minimum_alignment,
+                     bool prefault) {
+  void* ptr = AlignedMalloc(size, minimum_alignment);
+  if (ptr != nullptr && prefault) memset(ptr, 0, size);
+  return ptr;
+}
+
+void HugePageFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -321,6 +323,51 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+// An Example with a packed float and a packed int64 feature of `num_values`
+// values each; `int64_offset` is added to the int64 values.
+Example ExampleWithPackedFeatures(int num_values, int64 int64_offset) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  FloatList* float_list = features["float_list"].mutable_float_list();
+  Int64List* int64_list = features["int64_list"].mutable_int64_list();
+  for (int i = 0; i < num_values; ++i) {
+    float_list->add_value(i * 0.5f);
+    int64_list->add_value(int64_offset + i);
+  }
+  return example;
+}
+
+TEST(FastParse, DensePacked) {
+  // Small and large values, so that the varints are decoded both as runs of
+  // single bytes and one by one.
+  for (int64 int64_offset : {int64{0}, int64{-3}, int64{1} << 40}) {
+    const int kNumValues = 37;
+    std::vector<string> serialized(
+        3, Serialize(ExampleWithPackedFeatures(kNumValues, int64_offset)));
+    FastParseExampleConfig config;
+    AddDenseFeature("float_list", DT_FLOAT, {kNumValues}, false, kNumValues,
+                    &config);
+    AddDenseFeature("int64_list", DT_INT64, {kNumValues}, false, kNumValues,
+                    &config);
+    Result result;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+    auto floats = result.dense_values[0].matrix<float>();
+    auto int64s = result.dense_values[1].matrix<int64>();
+    for (size_t i = 0; i < serialized.size(); ++i) {
+      for (int j = 0; j < kNumValues; ++j) {
+        EXPECT_EQ(j * 0.5f, floats(i, j));
+        EXPECT_EQ(int64_offset + j, int64s(i, j));
+      }
+    }
+
+    // Too many values.
+    config.dense[1].shape = PartialTensorShape({kNumValues - 1});
+    config.dense[1].elements_per_stride = kNumValues - 1;
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        FastParseExample(config, serialized, {}, nullptr, &result)));
+  }
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -422,6 +469,32 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// B == batch size, F == number of values of each packed feature.
+static void BM_FastParseDensePacked(int iters, int batch_size,
+                                    int num_values) {
+  testing::StopTiming();
+  std::vector<string> serialized(
+      batch_size, Serialize(ExampleWithPackedFeatures(num_values, 0)));
+  FastParseExampleConfig config;
+  AddDenseFeature("float_list", DT_FLOAT, {num_values}, false, num_values,
+                  &config);
+  AddDenseFeature("int64_list", DT_INT64, {num_values}, false, num_values,
+                  &config);
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch_size * num_values *
+                          2);
+  testing::BytesProcessed(static_cast<int64>(iters) * batch_size *
+                          serialized[0].size());
+  testing::StartTiming();
+  while (iters--) {
+    Result result;
+    TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  }
+}
+BENCHMARK(BM_FastParseDensePacked)
+    ->ArgPair(128, 10)
+    ->ArgPair(128, 100)
+    ->ArgPair(128, 1000);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
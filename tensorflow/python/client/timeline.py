@@ -606,6 +606,30 @@ class Timeline(object):
                                         total_bytes)
     self._allocator_maximums = alloc_maxes
 
+  def _show_memory_timelines(self):
+    """Produce a counter series for each recorded memory timeline.
+
+    The timelines are collected with
+    `RunOptions.Experimental.memory_timeline_max_events`, without tracing.
+    Their peaks are reported in the allocator maximums of allocators that
+    are not otherwise tracked.
+    """
+    for memory_timeline in self._step_stats.memory_timelines:
+      allocator = memory_timeline.allocator_name
+      total_bytes = 0
+      for event in memory_timeline.events:
+        total_bytes += event.bytes
+        self._chrome_trace.emit_counter('Memory timeline', allocator,
+                                        self._allocators_pid,
+                                        event.time_micros, allocator,
+                                        total_bytes)
+      if allocator not in self._allocator_maximums:
+        self._allocator_maximums[allocator] = AllocationMaximum(
+            timestamp=memory_timeline.peak_micros,
+            num_bytes=memory_timeline.peak_bytes,
+            tensors=set(memory_timeline.node_names[event.node]
+                        for event in memory_timeline.peak_live))
+
   def analyze_step_stats(self, show_dataflow=True, show_memory=True):
     self._allocate_pids()
     self._assign_lanes()
@@ -613,6 +637,7 @@ class Timeline(object):
     self._show_compute(show_dataflow)
     if show_memory:
       self._show_memory_counters()
+    self._show_memory_timelines()
     return StepStatsAnalysis(
         chrome_trace=self._chrome_trace,
         allocator_maximums=self._allocator_maximums)
@@ -24,8 +24,10 @@ from tensorflow.core.protobuf import config_pb2
 from tensorflow.python.client import session
 from tensorflow.python.client import timeline
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
@@ -200,6 +202,39 @@ class TimelineTest(test.TestCase):
         show_memory=False, show_dataflow=False)
     self._validateTrace(ctf)
 
+  def testMemoryTimeline(self):
+    run_options = config_pb2.RunOptions()
+    run_options.experimental.memory_timeline_max_events = 1000
+    run_metadata = config_pb2.RunMetadata()
+
+    with session.Session() as sess:
+      # Fed, so that the matmuls are not folded into constants.
+      x = array_ops.placeholder(dtypes.float32, shape=[2, 2], name='x')
+      product = math_ops.matmul(x, x, name='product')
+      result = math_ops.matmul(product, x, name='result')
+      sess.run(
+          result,
+          feed_dict={x: [[1.0, 2.0], [3.0, 4.0]]},
+          options=run_options,
+          run_metadata=run_metadata)
+
+    self.assertTrue(run_metadata.step_stats.memory_timelines)
+    tl = timeline.Timeline(run_metadata.step_stats)
+    step_analysis = tl.analyze_step_stats(show_memory=False)
+    ctf = step_analysis.chrome_trace.format_to_string()
+    self._validateTrace(ctf)
+    counters = [
+        event for event in json.loads(ctf)['traceEvents']
+        if event['ph'] == 'C' and event['cat'] == 'Memory timeline'
+    ]
+    self.assertTrue(counters)
+    maximums = step_analysis.allocator_maximums
+    allocator = run_metadata.step_stats.memory_timelines[0].allocator_name
+    self.assertTrue(allocator in maximums)
+    # At least the outputs of product and result, four float32s each.
+    self.assertGreaterEqual(maximums[allocator].num_bytes, 32)
+    self.assertTrue('product' in maximums[allocator].tensors)
+
 
 if __name__ == '__main__':
   test.main()
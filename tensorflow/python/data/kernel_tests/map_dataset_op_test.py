@@ -243,6 +243,21 @@ class MapDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next)
 
+  def testParallelMapAndPrefetchAutotune(self):
+    # -1 (`tf.contrib.data.AUTOTUNE`) lets the model of the pipeline choose
+    # the parallelism and the buffer size; the output is unchanged.
+    dataset = (dataset_ops.Dataset.range(1000)
+               .map(lambda x: x * x, num_parallel_calls=-1)
+               .prefetch(-1))
+    iterator = dataset.make_one_shot_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      for i in range(1000):
+        self.assertEqual(i * i, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
   def testPrefetchError(self):
     components = np.array([1., 2., 3., np.nan, 5.]).astype(np.float32)
 
@@ -996,7 +996,9 @@ class Dataset(object):
        `self.output_types`) to another nested structure of tensors.
       num_parallel_calls: (Optional.) A `tf.int32` scalar `tf.Tensor`,
         representing the number elements to process in parallel. If not
-        specified, elements will be processed sequentially.
+        specified, elements will be processed sequentially. If the value
+        `tf.contrib.data.AUTOTUNE` is used, the number is chosen, and
+        adjusted while iterating, by the model of the input pipeline.
 
     Returns:
       Dataset: A `Dataset`.
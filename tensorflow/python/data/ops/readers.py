@@ -122,7 +122,8 @@ class ParallelInterleaveDataset(dataset_ops.InterleaveDataset):
   """A `Dataset` that maps a function over its input and flattens the result."""
 
   def __init__(self, input_dataset, map_func, cycle_length, block_length,
-               sloppy, buffer_output_elements, prefetch_input_elements):
+               sloppy, buffer_output_elements, prefetch_input_elements,
+               buffer_output_bytes=None, max_reordering=None):
     """See `tf.contrib.data.parallel_interleave()` for details."""
     super(ParallelInterleaveDataset, self).__init__(input_dataset, map_func,
                                                     cycle_length, block_length)
@@ -136,6 +137,8 @@ class ParallelInterleaveDataset(dataset_ops.InterleaveDataset):
         "prefetch_input_elements",
         prefetch_input_elements,
         argument_default=2 * cycle_length)
+    self._buffer_output_bytes = buffer_output_bytes or 0
+    self._max_reordering = max_reordering or 0
 
   def _as_variant_tensor(self):
     # pylint: disable=protected-access
@@ -148,6 +151,8 @@ class ParallelInterleaveDataset(dataset_ops.InterleaveDataset):
         self._buffer_output_elements,
         self._prefetch_input_elements,
         f=self._map_func,
+        buffer_output_bytes=self._buffer_output_bytes,
+        max_reordering=self._max_reordering,
         **dataset_ops.flat_structure(self))
     # pylint: enable=protected-access
 